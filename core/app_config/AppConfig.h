@@ -415,6 +415,7 @@ public:
     friend class InputPrometheusUnittest;
     friend class InputContainerStdioUnittest;
     friend class BatcherUnittest;
+    friend class CheckpointManagerUnittest;
 #endif
 };
 
@@ -22,6 +22,7 @@
 
 #include "app_config/AppConfig.h"
 #include "checkpoint/CheckPointManager.h"
+#include "checkpoint/CheckpointManagerV2.h"
 #include "common/CrashBackTraceUtil.h"
 #include "common/Flags.h"
 #include "common/MachineInfoUtil.h"
@@ -45,11 +46,13 @@
 #include "monitor/Monitor.h"
 #include "pipeline/InstanceConfigManager.h"
 #include "pipeline/PipelineManager.h"
+#include "pipeline/batch/TimeoutFlushManager.h"
 #include "pipeline/plugin/PluginRegistry.h"
 #include "runner/LogProcess.h"
 #include "pipeline/queue/ExactlyOnceQueueManager.h"
 #include "pipeline/queue/SenderQueueManager.h"
 #include "runner/FlusherRunner.h"
+#include "runner/sink/file/FileSink.h"
 #include "runner/sink/http/HttpSink.h"
 #ifdef __ENTERPRISE__
 #include "config/provider/EnterpriseConfigProvider.h"
@@ -208,7 +211,10 @@ void Application::Start() { // GCOVR_EXCL_START
 #endif
     BoundedSenderQueueInterface::SetFeedback(ProcessQueueManager::GetInstance());
 
-    HttpSink::GetInstance()->Init();
+    for (size_t i = 0; i < SenderQueueManager::GetInstance()->GetShardCnt(); ++i) {
+        HttpSink::GetInstance(i)->Init();
+    }
+    FileSink::GetInstance()->Init();
     FlusherRunner::GetInstance()->Init();
 
     {
@@ -273,6 +279,7 @@ void Application::Start() { // GCOVR_EXCL_START
     }
 
     LogProcess::GetInstance()->Start();
+    TimeoutFlushManager::GetInstance()->Init();
 
     time_t curTime = 0, lastProfilingCheckTime = 0, lastConfigCheckTime = 0, lastUpdateMetricTime = 0,
            lastCheckTagsTime = 0, lastQueueGCTime = 0;
@@ -363,6 +370,10 @@ void Application::Exit() {
 #endif
 
     PipelineManager::GetInstance()->StopAllPipelines();
+    if (BOOL_FLAG(enable_checkpoint_group_commit)) {
+        // range checkpoints are no longer written after all pipelines are stopped
+        CheckpointManagerV2::GetInstance()->StopAsyncWrites();
+    }
 
     PluginRegistry::GetInstance()->UnloadPlugins();
 
@@ -380,7 +391,10 @@ void Application::Exit() {
     // from now on, alarm should not be used.
 
     FlusherRunner::GetInstance()->Stop();
-    HttpSink::GetInstance()->Stop();
+    for (size_t i = 0; i < SenderQueueManager::GetInstance()->GetShardCnt(); ++i) {
+        HttpSink::GetInstance(i)->Stop();
+    }
+    FileSink::GetInstance()->Stop();
 
     // TODO: make it common
     FlusherSLS::RecycleResourceIfNotUsed();
@@ -0,0 +1,289 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "checkpoint/CheckPointJournal.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "common/FileSystemUtil.h"
+#include "common/Flags.h"
+#include "logger/Logger.h"
+#include "xxhash/xxhash.h"
+
+DEFINE_FLAG_INT32(checkpoint_journal_compact_ratio,
+                  "rewrite the checkpoint journal when its records exceed live checkpoints by this ratio",
+                  4);
+DEFINE_FLAG_INT32(checkpoint_journal_compact_min_records,
+                  "min records in the checkpoint journal before it is rewritten",
+                  4096);
+
+using namespace std;
+
+namespace logtail {
+
+namespace {
+
+const char kJournalMagic[8] = {'L', 'T', 'C', 'P', 'J', 'N', 'L', '\x01'};
+// body size and checksum
+const size_t kRecordHeaderSize = 2 * sizeof(uint32_t);
+// type and key size
+const size_t kRecordBodyHeaderSize = sizeof(uint8_t) + sizeof(uint32_t);
+
+uint32_t Checksum(const char* data, size_t size) {
+    return static_cast<uint32_t>(XXH64(data, size, 0));
+}
+
+} // namespace
+
+bool CheckPointJournal::Load(const string& path,
+                             unordered_map<string, string>& records,
+                             int32_t& version,
+                             int32_t& dumpTime) {
+    records.clear();
+    mPath = path;
+    Reset();
+    version = 0;
+    dumpTime = 0;
+
+    bool res = false;
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            res = parse(static_cast<const char*>(data), st.st_size, records);
+            munmap(data, st.st_size);
+        } else {
+            LOG_ERROR(sLogger, ("failed to map checkpoint journal", path)("errno", errno));
+        }
+    }
+    close(fd);
+#else
+    ifstream in(path, ios::binary);
+    if (!in) {
+        return false;
+    }
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    res = parse(data.data(), data.size(), records);
+#endif
+    if (!res) {
+        LOG_ERROR(sLogger, ("invalid checkpoint journal", path));
+        records.clear();
+        return false;
+    }
+    auto iter = records.find(string());
+    if (iter != records.end()) {
+        if (iter->second.size() == 2 * sizeof(int32_t)) {
+            memcpy(&version, iter->second.data(), sizeof(int32_t));
+            memcpy(&dumpTime, iter->second.data() + sizeof(int32_t), sizeof(int32_t));
+        }
+        records.erase(iter);
+    }
+    for (const auto& item : records) {
+        mPersisted.emplace(item.first, XXH64(item.second.data(), item.second.size(), 0));
+    }
+    return true;
+}
+
+bool CheckPointJournal::parse(const char* data, size_t size, unordered_map<string, string>& records) {
+    if (size < sizeof(kJournalMagic) || memcmp(data, kJournalMagic, sizeof(kJournalMagic)) != 0) {
+        return false;
+    }
+    struct Operation {
+        RecordType mType;
+        const char* mKey;
+        uint32_t mKeySize;
+        const char* mValue;
+        size_t mValueSize;
+    };
+    vector<Operation> batch;
+    size_t pos = sizeof(kJournalMagic), committedPos = pos, recordCount = 0;
+    while (pos + kRecordHeaderSize <= size) {
+        uint32_t bodySize = 0, checksum = 0;
+        memcpy(&bodySize, data + pos, sizeof(uint32_t));
+        memcpy(&checksum, data + pos + sizeof(uint32_t), sizeof(uint32_t));
+        const char* body = data + pos + kRecordHeaderSize;
+        if (bodySize < kRecordBodyHeaderSize || size - pos - kRecordHeaderSize < bodySize
+            || Checksum(body, bodySize) != checksum) {
+            // torn write
+            break;
+        }
+        uint8_t type = static_cast<uint8_t>(body[0]);
+        uint32_t keySize = 0;
+        memcpy(&keySize, body + sizeof(uint8_t), sizeof(uint32_t));
+        if (keySize > bodySize - kRecordBodyHeaderSize) {
+            break;
+        }
+        const char* key = body + kRecordBodyHeaderSize;
+        batch.push_back({static_cast<RecordType>(type),
+                         key,
+                         keySize,
+                         key + keySize,
+                         bodySize - kRecordBodyHeaderSize - keySize});
+        pos += kRecordHeaderSize + bodySize;
+        if (type != RECORD_COMMIT) {
+            continue;
+        }
+        for (const auto& op : batch) {
+            string recordKey(op.mKey, op.mKeySize);
+            switch (op.mType) {
+                case RECORD_PUT:
+                    records[recordKey].assign(op.mValue, op.mValueSize);
+                    break;
+                case RECORD_DELETE:
+                    records.erase(recordKey);
+                    break;
+                case RECORD_COMMIT:
+                    // commit info is kept with the empty key
+                    records[string()].assign(op.mValue, op.mValueSize);
+                    break;
+                default:
+                    break;
+            }
+        }
+        recordCount += batch.size();
+        batch.clear();
+        committedPos = pos;
+    }
+    mRecordCount = recordCount;
+    mNeedCompaction = committedPos != size;
+    if (mNeedCompaction) {
+        LOG_WARNING(sLogger,
+                    ("checkpoint journal has uncommitted records, which are discarded",
+                     "")("committed size", committedPos)("file size", size));
+    }
+    return true;
+}
+
+void CheckPointJournal::BeginDump(const string& path) {
+    if (path != mPath) {
+        mPath = path;
+        Reset();
+    }
+    mCurrent.clear();
+    mWrittenRecordCount = 0;
+    mWriteFailed = false;
+    mCompacting = mNeedCompaction || !CheckExistance(mPath)
+        || mRecordCount > max(mPersisted.size() * INT32_FLAG(checkpoint_journal_compact_ratio),
+                              static_cast<size_t>(INT32_FLAG(checkpoint_journal_compact_min_records)));
+    if (mCompacting) {
+        mOut.open(mPath + ".bak", ios::binary | ios::trunc);
+        mOut.write(kJournalMagic, sizeof(kJournalMagic));
+    } else {
+        mOut.open(mPath, ios::binary | ios::app);
+    }
+    if (!mOut) {
+        LOG_ERROR(sLogger, ("open checkpoint journal error", mPath)("compacting", mCompacting));
+        mWriteFailed = true;
+    }
+}
+
+void CheckPointJournal::Put(const string& key, const string& value) {
+    uint64_t hash = XXH64(value.data(), value.size(), 0);
+    mCurrent[key] = hash;
+    if (!mCompacting) {
+        auto iter = mPersisted.find(key);
+        if (iter != mPersisted.end() && iter->second == hash) {
+            return;
+        }
+    }
+    writeRecord(RECORD_PUT, key, value.data(), value.size());
+}
+
+bool CheckPointJournal::CommitDump(int32_t version, int32_t dumpTime) {
+    if (!mCompacting) {
+        for (const auto& item : mPersisted) {
+            if (mCurrent.find(item.first) == mCurrent.end()) {
+                writeRecord(RECORD_DELETE, item.first, nullptr, 0);
+            }
+        }
+    }
+    char commitInfo[2 * sizeof(int32_t)];
+    memcpy(commitInfo, &version, sizeof(int32_t));
+    memcpy(commitInfo + sizeof(int32_t), &dumpTime, sizeof(int32_t));
+    writeRecord(RECORD_COMMIT, string(), commitInfo, sizeof(commitInfo));
+
+    mOut.flush();
+    bool res = !mWriteFailed && mOut.good();
+    mOut.close();
+    if (res && mCompacting) {
+#if defined(_MSC_VER)
+        // The rename on Windows will fail if the destination is existing.
+        remove(mPath.c_str());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+        if (rename((mPath + ".bak").c_str(), mPath.c_str()) == -1) {
+            LOG_ERROR(sLogger, ("rename checkpoint journal fail, errno", errno));
+            res = false;
+        }
+    }
+    if (!res) {
+        LOG_ERROR(sLogger, ("write checkpoint journal failed", mPath)("compacting", mCompacting));
+        // the tail of the journal may be an uncommitted batch now
+        mNeedCompaction = true;
+        mCurrent.clear();
+        return false;
+    }
+    mRecordCount = (mCompacting ? 0 : mRecordCount) + mWrittenRecordCount;
+    mPersisted.swap(mCurrent);
+    mCurrent.clear();
+    mNeedCompaction = false;
+    LOG_DEBUG(sLogger,
+              ("dump checkpoint journal, records written", mWrittenRecordCount)("compacted", mCompacting)(
+                  "live records", mPersisted.size())("journal records", mRecordCount));
+    return true;
+}
+
+void CheckPointJournal::Reset() {
+    mPersisted.clear();
+    mRecordCount = 0;
+    mNeedCompaction = true;
+}
+
+void CheckPointJournal::writeRecord(RecordType type, const string& key, const char* value, size_t valueSize) {
+    uint32_t keySize = static_cast<uint32_t>(key.size());
+    uint32_t bodySize = static_cast<uint32_t>(kRecordBodyHeaderSize + key.size() + valueSize);
+    mRecordBuffer.resize(kRecordHeaderSize + bodySize);
+    char* body = &mRecordBuffer[kRecordHeaderSize];
+    body[0] = static_cast<char>(type);
+    memcpy(body + sizeof(uint8_t), &keySize, sizeof(uint32_t));
+    memcpy(body + kRecordBodyHeaderSize, key.data(), key.size());
+    if (valueSize > 0) {
+        memcpy(body + kRecordBodyHeaderSize + key.size(), value, valueSize);
+    }
+    uint32_t checksum = Checksum(body, bodySize);
+    memcpy(&mRecordBuffer[0], &bodySize, sizeof(uint32_t));
+    memcpy(&mRecordBuffer[sizeof(uint32_t)], &checksum, sizeof(uint32_t));
+    mOut.write(mRecordBuffer.data(), mRecordBuffer.size());
+    ++mWrittenRecordCount;
+}
+
+} // namespace logtail
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+namespace logtail {
+
+// CheckPointJournal persists checkpoints as an append-only log of binary key-value records, so that each dump only
+// writes the records changed since the last one. A dump is a batch of put and delete records ended by a commit record,
+// and batches not committed (e.g. interrupted by a crash) are ignored on load. The log is rewritten as a snapshot of
+// live records once it grows too large compared to them.
+//
+// Usage of a dump: BeginDump, Put every live record, then CommitDump. Records not put are deleted.
+class CheckPointJournal {
+public:
+    // Replay the journal at path into records.
+    // @return false if the journal does not exist or is not a valid journal.
+    bool Load(const std::string& path,
+              std::unordered_map<std::string, std::string>& records,
+              int32_t& version,
+              int32_t& dumpTime);
+
+    void BeginDump(const std::string& path);
+    void Put(const std::string& key, const std::string& value);
+    bool CommitDump(int32_t version, int32_t dumpTime);
+
+    // Forget what has been persisted, so that the next dump writes a snapshot.
+    void Reset();
+
+private:
+    enum RecordType : uint8_t { RECORD_PUT = 1, RECORD_DELETE = 2, RECORD_COMMIT = 3 };
+
+    bool parse(const char* data, size_t size, std::unordered_map<std::string, std::string>& records);
+    void writeRecord(RecordType type, const std::string& key, const char* value, size_t valueSize);
+
+    std::string mPath;
+    std::ofstream mOut;
+    bool mCompacting = false;
+    bool mWriteFailed = false;
+    // the journal must be rewritten if its tail is not a committed batch, otherwise appended batches are unreachable
+    bool mNeedCompaction = true;
+    size_t mRecordCount = 0;
+    size_t mWrittenRecordCount = 0;
+    // hash of the value of each record persisted, and of each record put in the current dump
+    std::unordered_map<std::string, uint64_t> mPersisted;
+    std::unordered_map<std::string, uint64_t> mCurrent;
+    std::string mRecordBuffer;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class CheckPointJournalUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -16,6 +16,8 @@
 
 #include <fcntl.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <thread>
@@ -43,9 +45,140 @@ DEFINE_FLAG_INT32(check_point_version, "now check point version xx.xx.xx such as
 DEFINE_FLAG_INT32(check_point_dump_interval, "default 15 min", 15 * 60);
 DEFINE_FLAG_INT32(check_point_max_count, "max check point count", 100000);
 DEFINE_FLAG_INT32(checkpoint_find_max_file_count, "", 1000);
+DEFINE_FLAG_BOOL(enable_checkpoint_journal,
+                 "dump checkpoints to a binary journal incrementally instead of rewriting the json checkpoint file, the json "
+                 "file is kept but no longer updated while enabled, so a version without journal resumes from the "
+                 "offsets at migration",
+                 false);
 
 namespace logtail {
 
+namespace {
+
+const char kFileCheckPointKeyPrefix = 'f';
+const char kDirCheckPointKeyPrefix = 'd';
+const uint8_t kJournalValueFormat = 1;
+
+template <typename T>
+void AppendValue(string& buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendString(string& buffer, const string& value) {
+    AppendValue<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+class JournalValueReader {
+public:
+    JournalValueReader(const string& buffer, size_t pos) : mBuffer(buffer), mPos(pos) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        if (mBuffer.size() - mPos < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, mBuffer.data() + mPos, sizeof(T));
+        mPos += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(string& value) {
+        uint32_t size = 0;
+        if (!Read(size) || mBuffer.size() - mPos < size) {
+            return false;
+        }
+        value.assign(mBuffer.data() + mPos, size);
+        mPos += size;
+        return true;
+    }
+
+    bool IsEnd() const { return mPos == mBuffer.size(); }
+
+private:
+    const string& mBuffer;
+    size_t mPos;
+};
+
+void EncodeFileCheckPoint(const CheckPoint& checkPoint, string& key, string& value) {
+    key.clear();
+    key.push_back(kFileCheckPointKeyPrefix);
+    AppendValue<uint64_t>(key, checkPoint.mDevInode.dev);
+    AppendValue<uint64_t>(key, checkPoint.mDevInode.inode);
+    key.append(checkPoint.mConfigName);
+
+    value.clear();
+    AppendValue<uint8_t>(value, kJournalValueFormat);
+    AppendValue<int64_t>(value, checkPoint.mOffset);
+    AppendValue<uint64_t>(value, checkPoint.mSignatureHash);
+    AppendValue<uint32_t>(value, checkPoint.mSignatureSize);
+    AppendValue<int32_t>(value, checkPoint.mLastUpdateTime);
+    AppendValue<uint8_t>(value, checkPoint.mFileOpenFlag);
+    AppendValue<uint8_t>(value, checkPoint.mContainerStopped);
+    AppendValue<uint8_t>(value, checkPoint.mLastForceRead);
+    AppendValue<int32_t>(value, checkPoint.mIdxInReaderArray);
+    AppendString(value, checkPoint.mFileName);
+    AppendString(value, checkPoint.mRealFileName);
+}
+
+CheckPoint* DecodeFileCheckPoint(const string& key, const string& value) {
+    const size_t devInodeSize = 2 * sizeof(uint64_t);
+    if (key.size() < 1 + devInodeSize) {
+        return nullptr;
+    }
+    unique_ptr<CheckPoint> checkPoint(new CheckPoint());
+    memcpy(&checkPoint->mDevInode.dev, key.data() + 1, sizeof(uint64_t));
+    memcpy(&checkPoint->mDevInode.inode, key.data() + 1 + sizeof(uint64_t), sizeof(uint64_t));
+    checkPoint->mConfigName = key.substr(1 + devInodeSize);
+
+    JournalValueReader reader(value, 0);
+    uint8_t format = 0, fileOpenFlag = 0, containerStopped = 0, lastForceRead = 0;
+    if (!reader.Read(format) || format != kJournalValueFormat || !reader.Read(checkPoint->mOffset)
+        || !reader.Read(checkPoint->mSignatureHash) || !reader.Read(checkPoint->mSignatureSize)
+        || !reader.Read(checkPoint->mLastUpdateTime) || !reader.Read(fileOpenFlag) || !reader.Read(containerStopped)
+        || !reader.Read(lastForceRead) || !reader.Read(checkPoint->mIdxInReaderArray)
+        || !reader.ReadString(checkPoint->mFileName) || !reader.ReadString(checkPoint->mRealFileName)) {
+        return nullptr;
+    }
+    checkPoint->mFileOpenFlag = fileOpenFlag != 0;
+    checkPoint->mContainerStopped = containerStopped != 0;
+    checkPoint->mLastForceRead = lastForceRead != 0;
+    return checkPoint.release();
+}
+
+void EncodeDirCheckPoint(const string& dirName, const DirCheckPoint& checkPoint, string& key, string& value) {
+    key.clear();
+    key.push_back(kDirCheckPointKeyPrefix);
+    key.append(dirName);
+
+    // update time is not recorded, which is the time of the dump, otherwise every dir would change in each dump
+    value.clear();
+    AppendValue<uint8_t>(value, kJournalValueFormat);
+    AppendValue<uint32_t>(value, static_cast<uint32_t>(checkPoint.mSubDir.size()));
+    for (const auto& subDir : checkPoint.mSubDir) {
+        AppendString(value, subDir);
+    }
+}
+
+bool DecodeDirCheckPoint(const string& value, DirCheckPoint& checkPoint) {
+    JournalValueReader reader(value, 0);
+    uint8_t format = 0;
+    uint32_t count = 0;
+    if (!reader.Read(format) || format != kJournalValueFormat || !reader.Read(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        string subDir;
+        if (!reader.ReadString(subDir)) {
+            return false;
+        }
+        checkPoint.mSubDir.insert(std::move(subDir));
+    }
+    return true;
+}
+
+} // namespace
+
 bool CheckPointManager::CheckVersion() {
     return (mLoadVersion == NO_CHECKPOINT_VERSION) || (mLoadVersion / 10000 == INT32_FLAG(check_point_version) / 10000);
 }
@@ -104,6 +237,10 @@ CheckPointManager::DevInodeCheckPointHashMap& CheckPointManager::GetAllFileCheck
     return mDevInodeCheckPointPtrMap;
 }
 
+std::string CheckPointManager::GetJournalFilePath() const {
+    return AppConfig::GetInstance()->GetCheckPointFilePath() + ".journal";
+}
+
 
 void CheckPointManager::AddDirCheckPoint(const string& dirname) {
     if (dirname.size() == 0)
@@ -123,6 +260,10 @@ void CheckPointManager::AddDirCheckPoint(const string& dirname) {
     ptr->mSubDir.insert(dirname);
 }
 void CheckPointManager::LoadCheckPoint() {
+    // the journal only exists if it was written by the last dump, see DumpCheckPointToLocal
+    if (loadCheckPointFromJournal()) {
+        return;
+    }
     Json::Value root;
     ParseConfResult cptRes = ParseConfig(AppConfig::GetInstance()->GetCheckPointFilePath(), root);
     // if new checkpoint file not exist, check old checkpoint file.
@@ -313,6 +454,94 @@ void CheckPointManager::LoadFileCheckPoint(const Json::Value& root) {
         }
     }
 }
+bool CheckPointManager::loadCheckPointFromJournal() {
+    unordered_map<string, string> records;
+    int32_t version = 0, dumpTime = 0;
+    if (!mJournal.Load(GetJournalFilePath(), records, version, dumpTime)) {
+        return false;
+    }
+    mLoadVersion = version;
+    int32_t fileCount = 0, invalidCount = 0;
+    for (const auto& record : records) {
+        const string& key = record.first;
+        if (key[0] == kFileCheckPointKeyPrefix) {
+            CheckPoint* ptr = DecodeFileCheckPoint(key, record.second);
+            if (ptr == nullptr) {
+                ++invalidCount;
+                continue;
+            }
+            AddCheckPoint(ptr);
+            ++fileCount;
+        } else if (key[0] == kDirCheckPointKeyPrefix) {
+            string dirname = key.substr(1);
+            // dir checkpoints are all refreshed in each dump
+            if (dumpTime < time(NULL) - INT32_FLAG(file_check_point_time_out)) {
+                LOG_INFO(sLogger, ("load timeout dir check point, ignore", dirname)(ToString(dumpTime), time(NULL)));
+                continue;
+            }
+            DirCheckPointPtr dir(new DirCheckPoint(dirname));
+            dir->mUpdateTime = dumpTime;
+            if (!DecodeDirCheckPoint(record.second, *dir)) {
+                ++invalidCount;
+                continue;
+            }
+            mDirNameMap.insert(make_pair(dirname, dir));
+        } else {
+            ++invalidCount;
+        }
+    }
+    mReaderCount = fileCount;
+    if (invalidCount > 0) {
+        LOG_ERROR(sLogger, ("failed to parse checkpoints in journal, count", invalidCount));
+        LogtailAlarm::GetInstance()->SendAlarm(CHECKPOINT_ALARM,
+                                               "failed to parse checkpoints in journal, count:"
+                                                   + ToString(invalidCount));
+    }
+    LOG_INFO(sLogger,
+             ("load checkpoint from journal, version", mLoadVersion)("file check point",
+                                                                     mDevInodeCheckPointPtrMap.size())(
+                 "dir check point", mDirNameMap.size()));
+    return true;
+}
+
+vector<CheckPoint*> CheckPointManager::getCheckPointsToDump() {
+    vector<CheckPoint*> checkPoints;
+    checkPoints.reserve(mDevInodeCheckPointPtrMap.size());
+    for (auto it = mDevInodeCheckPointPtrMap.begin(); it != mDevInodeCheckPointPtrMap.end(); ++it) {
+        checkPoints.push_back(it->second.get());
+    }
+    if (checkPoints.size() > (size_t)INT32_FLAG(check_point_max_count)) {
+        sort(checkPoints.begin(), checkPoints.end(), CheckPointManager::CheckPointCmpByUpdateTime);
+        checkPoints.resize(INT32_FLAG(check_point_max_count));
+        LOG_WARNING(sLogger, ("Too many check point", mDevInodeCheckPointPtrMap.size()));
+        LogtailAlarm::GetInstance()->SendAlarm(CHECKPOINT_ALARM,
+                                               "Too many check point:" + ToString(mDevInodeCheckPointPtrMap.size()));
+    }
+    return checkPoints;
+}
+
+bool CheckPointManager::dumpCheckPointToJournal(const vector<CheckPoint*>& checkPoints) {
+    mJournal.BeginDump(GetJournalFilePath());
+    string key, value;
+    for (const CheckPoint* checkPointPtr : checkPoints) {
+        EncodeFileCheckPoint(*checkPointPtr, key, value);
+        mJournal.Put(key, value);
+    }
+    for (const auto& dir : mDirNameMap) {
+        EncodeDirCheckPoint(dir.first, *dir.second, key, value);
+        mJournal.Put(key, value);
+    }
+    if (!mJournal.CommitDump(INT32_FLAG(check_point_version), mLastDumpTime)) {
+        LogtailAlarm::GetInstance()->SendAlarm(CHECKPOINT_ALARM, "dump check point to journal failed");
+        return false;
+    }
+    // the json checkpoint file is kept for rollback to a version without journal, it is ignored while the journal exists
+    LOG_DEBUG(sLogger,
+              ("dump checkpoint to journal, version", INT32_FLAG(check_point_version))(
+                  "file check point", checkPoints.size())("dir check point", mDirNameMap.size()));
+    return true;
+}
+
 bool CheckPointManager::DumpCheckPointToLocal() {
     mLastDumpTime = time(NULL);
     string checkPointFile = AppConfig::GetInstance()->GetCheckPointFilePath();
@@ -324,68 +553,35 @@ bool CheckPointManager::DumpCheckPointToLocal() {
         return false;
     }
 
-    Json::Value root;
     mReaderCount = mDevInodeCheckPointPtrMap.size();
-    if (mDevInodeCheckPointPtrMap.size() <= (size_t)INT32_FLAG(check_point_max_count)) {
-        CheckPointManager::DevInodeCheckPointHashMap::iterator it;
-        for (it = mDevInodeCheckPointPtrMap.begin(); it != mDevInodeCheckPointPtrMap.end(); ++it) {
-            CheckPoint* checkPointPtr = it->second.get();
-            Json::Value leaf;
-            leaf["file_name"] = Json::Value(checkPointPtr->mFileName);
-            leaf["real_file_name"] = Json::Value(checkPointPtr->mRealFileName);
-            leaf["offset"] = Json::Value(ToString(checkPointPtr->mOffset));
-            leaf["sig_size"] = Json::Value(Json::UInt(checkPointPtr->mSignatureSize));
-            leaf["sig_hash"] = Json::Value(Json::UInt64(checkPointPtr->mSignatureHash));
-            leaf["update_time"] = Json::Value(checkPointPtr->mLastUpdateTime);
-            leaf["inode"] = Json::Value(Json::UInt64(checkPointPtr->mDevInode.inode));
-            leaf["dev"] = Json::Value(Json::UInt64(checkPointPtr->mDevInode.dev));
-            leaf["file_open"] = Json::Value(checkPointPtr->mFileOpenFlag ? 1 : 0);
-            leaf["container_stopped"] = Json::Value(checkPointPtr->mContainerStopped ? 1 : 0);
-            leaf["last_force_read"] = Json::Value(checkPointPtr->mLastForceRead ? 1 : 0);
-            leaf["config_name"] = Json::Value(checkPointPtr->mConfigName);
-            // forward compatible
-            leaf["sig"] = Json::Value(string(""));
-            leaf["idx_in_reader_array"] = Json::Value(checkPointPtr->mIdxInReaderArray);
-            // use filename + dev + inode + configName to prevent same filename conflict
-            root[checkPointPtr->mFileName + "*" + ToString(checkPointPtr->mDevInode.dev) + "*"
-                 + ToString(checkPointPtr->mDevInode.inode) + "*" + checkPointPtr->mConfigName]
-                = leaf;
-        }
-    } else {
-        vector<CheckPoint*> sortedCheckPointVec;
-        CheckPointManager::DevInodeCheckPointHashMap::iterator it;
-        for (it = mDevInodeCheckPointPtrMap.begin(); it != mDevInodeCheckPointPtrMap.end(); ++it) {
-            sortedCheckPointVec.push_back(it->second.get());
-        }
-        sort(sortedCheckPointVec.begin(), sortedCheckPointVec.end(), CheckPointManager::CheckPointCmpByUpdateTime);
-        for (int32_t i = 0; i < INT32_FLAG(check_point_max_count); ++i) {
-            CheckPoint* checkPointPtr = sortedCheckPointVec[i];
-            Json::Value leaf;
-            leaf["file_name"] = Json::Value(checkPointPtr->mFileName);
-            leaf["real_file_name"] = Json::Value(checkPointPtr->mRealFileName);
-            leaf["offset"] = Json::Value(ToString(checkPointPtr->mOffset));
-            leaf["sig_size"] = Json::Value(Json::UInt(checkPointPtr->mSignatureSize));
-            leaf["sig_hash"] = Json::Value(Json::UInt64(checkPointPtr->mSignatureHash));
-            leaf["update_time"] = Json::Value(checkPointPtr->mLastUpdateTime);
-            leaf["inode"] = Json::Value(Json::UInt64(checkPointPtr->mDevInode.inode));
-            leaf["dev"] = Json::Value(Json::UInt64(checkPointPtr->mDevInode.dev));
-            leaf["file_open"] = Json::Value(checkPointPtr->mFileOpenFlag ? 1 : 0);
-            leaf["container_stopped"] = Json::Value(checkPointPtr->mContainerStopped ? 1 : 0);
-            leaf["last_force_read"] = Json::Value(checkPointPtr->mLastForceRead ? 1 : 0);
-            leaf["config_name"] = Json::Value(checkPointPtr->mConfigName);
-            // forward compatible
-            leaf["sig"] = Json::Value(string(""));
-            leaf["idx_in_reader_array"] = Json::Value(checkPointPtr->mIdxInReaderArray);
-            // use filename + dev + inode + configName to prevent same filename conflict
-            root[checkPointPtr->mFileName + "*" + ToString(checkPointPtr->mDevInode.dev) + "*"
-                 + ToString(checkPointPtr->mDevInode.inode) + "*" + checkPointPtr->mConfigName]
-                = leaf;
-        }
-        LOG_WARNING(sLogger, ("Too many check point", mDevInodeCheckPointPtrMap.size()));
-        LogtailAlarm::GetInstance()->SendAlarm(CHECKPOINT_ALARM,
-                                               "Too many check point:" + ToString(mDevInodeCheckPointPtrMap.size()));
+    vector<CheckPoint*> checkPoints = getCheckPointsToDump();
+    if (BOOL_FLAG(enable_checkpoint_journal)) {
+        return dumpCheckPointToJournal(checkPoints);
     }
 
+    Json::Value root;
+    for (const CheckPoint* checkPointPtr : checkPoints) {
+        Json::Value leaf;
+        leaf["file_name"] = Json::Value(checkPointPtr->mFileName);
+        leaf["real_file_name"] = Json::Value(checkPointPtr->mRealFileName);
+        leaf["offset"] = Json::Value(ToString(checkPointPtr->mOffset));
+        leaf["sig_size"] = Json::Value(Json::UInt(checkPointPtr->mSignatureSize));
+        leaf["sig_hash"] = Json::Value(Json::UInt64(checkPointPtr->mSignatureHash));
+        leaf["update_time"] = Json::Value(checkPointPtr->mLastUpdateTime);
+        leaf["inode"] = Json::Value(Json::UInt64(checkPointPtr->mDevInode.inode));
+        leaf["dev"] = Json::Value(Json::UInt64(checkPointPtr->mDevInode.dev));
+        leaf["file_open"] = Json::Value(checkPointPtr->mFileOpenFlag ? 1 : 0);
+        leaf["container_stopped"] = Json::Value(checkPointPtr->mContainerStopped ? 1 : 0);
+        leaf["last_force_read"] = Json::Value(checkPointPtr->mLastForceRead ? 1 : 0);
+        leaf["config_name"] = Json::Value(checkPointPtr->mConfigName);
+        // forward compatible
+        leaf["sig"] = Json::Value(string(""));
+        leaf["idx_in_reader_array"] = Json::Value(checkPointPtr->mIdxInReaderArray);
+        // use filename + dev + inode + configName to prevent same filename conflict
+        root[checkPointPtr->mFileName + "*" + ToString(checkPointPtr->mDevInode.dev) + "*"
+             + ToString(checkPointPtr->mDevInode.inode) + "*" + checkPointPtr->mConfigName]
+            = leaf;
+    }
 
     Json::Value dirJson;
     for (unordered_map<string, DirCheckPointPtr>::iterator it = mDirNameMap.begin(); it != mDirNameMap.end(); ++it) {
@@ -429,6 +625,12 @@ bool CheckPointManager::DumpCheckPointToLocal() {
                                                std::string("rename check point file fail, errno ") + ToString(errno));
         return false;
     }
+    // the journal would be loaded first otherwise
+    string journalFile = GetJournalFilePath();
+    if (CheckExistance(journalFile) && remove(journalFile.c_str()) == 0) {
+        LOG_INFO(sLogger, ("remove check point journal, which is replaced by json file", journalFile));
+    }
+    mJournal.Reset();
     LOG_DEBUG(sLogger,
               ("dump checkpoint, version", INT32_FLAG(check_point_version))(
                   "file check point", mDevInodeCheckPointPtrMap.size())("dir check point", mDirNameMap.size()));
@@ -23,7 +23,9 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "checkpoint/CheckPointJournal.h"
 #include "common/DevInode.h"
 #include "common/EncodingConverter.h"
 #include "common/SplitedFilePath.h"
@@ -118,6 +120,7 @@ private:
     int32_t mLastDumpTime;
     int32_t mLoadVersion;
     int32_t mReaderCount;
+    CheckPointJournal mJournal;
     CheckPointManager()
         : mLastCheckTime(time(NULL)), mLastDumpTime(time(NULL)), mLoadVersion(NO_CHECKPOINT_VERSION), mReaderCount(0) {}
 
@@ -139,6 +142,7 @@ public:
     bool NeedDump(int32_t curTime);
     void ResetLastDumpTime();
     DevInodeCheckPointHashMap& GetAllFileCheckPoint();
+    std::string GetJournalFilePath() const;
 
     static CheckPointManager* Instance() {
         static CheckPointManager checkPointManager;
@@ -149,7 +153,13 @@ public:
         return left->mLastUpdateTime > right->mLastUpdateTime;
     }
 
+private:
+    std::vector<CheckPoint*> getCheckPointsToDump();
+    bool loadCheckPointFromJournal();
+    bool dumpCheckPointToJournal(const std::vector<CheckPoint*>& checkPoints);
+
 #ifdef APSARA_UNIT_TEST_MAIN
+public:
     friend class ConfigUpdatorUnittest;
     void RemoveLocalCheckPoint();
     void PrintStatus();
@@ -22,12 +22,17 @@
 #include "monitor/LogtailAlarm.h"
 #include "app_config/AppConfig.h"
 #include "checkpoint/CheckPointManager.h"
+#include "pipeline/queue/SenderQueueManager.h"
 
 DEFINE_FLAG_INT32(logtail_checkpoint_check_gc_interval_sec, "60 seconds", 60);
 DEFINE_FLAG_INT32(logtail_checkpoint_gc_threshold_sec, "30 minutes", 30 * 60);
 DEFINE_FLAG_DOUBLE(logtail_checkpoint_max_gc_count_ratio_per_round, "10%", 0.1);
 DEFINE_FLAG_INT64(logtail_checkpoint_max_used_time_per_round_in_msec, "500ms", 500);
 DEFINE_FLAG_INT32(logtail_checkpoint_expired_threshold_sec, "6 hours", 6 * 60 * 60);
+DEFINE_FLAG_BOOL(enable_checkpoint_group_commit,
+                 "persist range checkpoints of exactly once in batches by a dedicated thread, rather than one write per "
+                 "checkpoint in the caller thread",
+                 false);
 
 DECLARE_FLAG_INT32(max_exactly_once_concurrency);
 
@@ -97,6 +102,9 @@ CheckpointManagerV2::CheckpointManagerV2() {
 
     if (open()) {
         mGCThreadPtr.reset(new std::thread([&]() { runGCLoop(); }));
+        if (BOOL_FLAG(enable_checkpoint_group_commit)) {
+            mWriteThreadPtr.reset(new std::thread([&]() { runWriteLoop(); }));
+        }
     }
 }
 
@@ -106,10 +114,29 @@ CheckpointManagerV2::~CheckpointManagerV2() {
         mGCThreadPtr->join();
         mGCThreadPtr.reset();
     }
+    StopAsyncWrites();
+    mWriteThreadPtr.reset();
 
     close();
 }
 
+void CheckpointManagerV2::StopAsyncWrites() {
+    if (!mWriteThreadPtr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mWriteMux);
+        if (mStopWriteThread) {
+            return;
+        }
+        mStopWriteThread = true;
+    }
+    mWriteCV.notify_one();
+    // pending writes are persisted before the thread exits
+    mWriteThreadPtr->join();
+    LOG_INFO(sLogger, ("checkpoint group commit", "stopped"));
+}
+
 void CheckpointManagerV2::AppendRangeKeys(const std::string& primaryKey,
                                           uint32_t rangeCptCount,
                                           std::vector<std::string>& keys) {
@@ -287,6 +314,7 @@ CheckpointManagerV2::ScanCheckpoints(const std::vector<std::string>& exactlyOnce
         return checkpoints;
     }
 
+    FlushAsyncWrites();
     std::vector<std::string> toDeleteKeys;
     auto scanUsedTimeInMs = scanCheckpoints(exactlyOnceConfigs, &checkpoints, toDeleteKeys);
     auto deleteUsedTimeInMs = DeleteCheckpoints(toDeleteKeys);
@@ -303,6 +331,8 @@ uint64_t CheckpointManagerV2::DeleteCheckpoints(const std::vector<std::string>&
     }
 
     auto const startTimeInMs = GetCurrentTimeInMilliSeconds();
+    // range checkpoints being deleted must not be written back by the pending batch
+    FlushAsyncWrites();
     leveldb::WriteBatch batch;
     for (auto& k : keys) {
         batch.Delete(k);
@@ -391,7 +421,7 @@ bool CheckpointManagerV2::readDatabase(const std::string& key, std::string& valu
 }
 
 bool CheckpointManagerV2::read(const std::string& key, std::string& value) {
-    if (!readDatabase(key, value)) {
+    if (!readAsyncWrites(key, value) && !readDatabase(key, value)) {
         return false;
     }
 
@@ -411,6 +441,14 @@ bool CheckpointManagerV2::read(const std::string& key, std::string& value) {
 bool CheckpointManagerV2::write(const std::string& key, const std::string& value) {
     ASSERT_LEVELDB_STATUS;
 
+    if (mWriteThreadPtr) {
+        // keep the order with writes of the same key which are not persisted yet
+        std::unique_lock<std::mutex> lock(mWriteMux);
+        if (mPendingWrites.find(key) != mPendingWrites.end() || mWritingWrites.find(key) != mWritingWrites.end()) {
+            lock.unlock();
+            FlushAsyncWrites();
+        }
+    }
     leveldb::Status s = mDatabase->Put(mDefaultWriteOption, key, value);
     if (s.ok()) {
         return true;
@@ -419,6 +457,94 @@ bool CheckpointManagerV2::write(const std::string& key, const std::string& value
     return false;
 }
 
+uint64_t CheckpointManagerV2::asyncWrite(const std::string& key, std::string&& value) {
+    if (!mWriteThreadPtr) {
+        write(key, value);
+        return 0;
+    }
+
+    uint64_t seq = 0;
+    {
+        std::unique_lock<std::mutex> lock(mWriteMux);
+        if (mStopWriteThread) {
+            // the write thread has exited, all writes before have been persisted
+            lock.unlock();
+            write(key, value);
+            return 0;
+        }
+        mPendingWrites[key] = std::move(value);
+        seq = ++mWriteSeq;
+    }
+    mWriteCV.notify_one();
+    return seq;
+}
+
+bool CheckpointManagerV2::readAsyncWrites(const std::string& key, std::string& value) {
+    if (!mWriteThreadPtr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mWriteMux);
+    auto iter = mPendingWrites.find(key);
+    if (iter != mPendingWrites.end()) {
+        value = iter->second;
+        return true;
+    }
+    iter = mWritingWrites.find(key);
+    if (iter != mWritingWrites.end()) {
+        value = iter->second;
+        return true;
+    }
+    return false;
+}
+
+void CheckpointManagerV2::FlushAsyncWrites() {
+    if (!mWriteThreadPtr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mWriteMux);
+    const uint64_t seq = mWriteSeq;
+    mPersistedCV.wait(lock, [&]() { return IsPersisted(seq); });
+}
+
+void CheckpointManagerV2::runWriteLoop() {
+    std::unique_lock<std::mutex> lock(mWriteMux);
+    while (true) {
+        mWriteCV.wait(lock, [&]() { return mStopWriteThread || !mPendingWrites.empty(); });
+        if (mPendingWrites.empty()) {
+            break;
+        }
+
+        // Writes submitted while this batch is being persisted wait for the next one, so the batch size grows with
+        //  the latency of the sync write rather than a fixed interval.
+        mWritingWrites.swap(mPendingWrites);
+        const uint64_t seq = mWriteSeq;
+        lock.unlock();
+
+        leveldb::WriteBatch batch;
+        for (auto& item : mWritingWrites) {
+            batch.Put(item.first, item.second);
+        }
+        auto status = mDatabase->Write(mDefaultWriteOption, &batch);
+        if (!status.ok()) {
+            detail::logDatabaseError("batch_write", std::to_string(mWritingWrites.size()), status);
+        }
+
+        lock.lock();
+        mWritingWrites.clear();
+        // Failed writes are regarded as persisted too, the same as SetPB, otherwise sending is blocked forever.
+        mPersistedWriteSeq.store(seq, std::memory_order_release);
+        mPersistedCV.notify_all();
+        if (!mStopWriteThread) {
+            lock.unlock();
+            // senders skip items whose checkpoints are not persisted, wake them up to send
+            SenderQueueManager::GetInstance()->Trigger();
+            lock.lock();
+        }
+        // otherwise senders have been stopped, and the sender queue manager may have been destructed
+    }
+    LOG_INFO(sLogger, ("runWriteLoop exit", "done"));
+}
+
 void CheckpointManagerV2::MarkGC(const std::string& primaryKey) {
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -15,6 +15,8 @@
  */
 
 #pragma once
+#include <atomic>
+#include <condition_variable>
 #include <string>
 #include <unordered_map>
 #include <thread>
@@ -22,9 +24,12 @@
 #include <mutex>
 #include <vector>
 #include <leveldb/db.h>
+#include "common/Flags.h"
 #include "protobuf/sls/checkpoint.pb.h"
 #include "plugin/input/InputFile.h"
 
+DECLARE_FLAG_BOOL(enable_checkpoint_group_commit);
+
 namespace logtail {
 
 // CheckpointManagerV2 for exactly once feature
@@ -94,6 +99,31 @@ public:
         return write(key, data);
     }
 
+    // Write the checkpoint without waiting for it to be persisted if group commit is enabled, otherwise the same as
+    //  SetPB. Writes submitted while the previous batch is being persisted are coalesced into the next batch, and
+    //  only the last value of each key is written.
+    //
+    // @return sequence of the write, which can be passed to IsPersisted, 0 if it has been written.
+    template <class PBType>
+    uint64_t AsyncSetPB(const std::string& key, const PBType& value) {
+        std::string data;
+        if (!value.SerializeToString(&data)) {
+            return 0;
+        }
+
+        return asyncWrite(key, std::move(data));
+    }
+
+    // @return true if the write of seq and writes before it have been persisted (or failed).
+    bool IsPersisted(uint64_t seq) const { return seq <= mPersistedWriteSeq.load(std::memory_order_acquire); }
+
+    // Wait until all writes submitted by AsyncSetPB are persisted.
+    void FlushAsyncWrites();
+
+    // Persist pending writes and stop the group commit thread, called when the process exits. Writes after it are
+    //  persisted synchronously.
+    void StopAsyncWrites();
+
     // Add primaryKey to GC list, called in destructor of LogFileReader.
     //
     // GetPB will remove primaryKey from GC list, so for config update case, primary
@@ -134,6 +164,13 @@ private:
     bool read(const std::string& key, std::string& value);
     bool write(const std::string& key, const std::string& value);
 
+    uint64_t asyncWrite(const std::string& key, std::string&& value);
+    // Find the value of key in writes not persisted yet.
+    bool readAsyncWrites(const std::string& key, std::string& value);
+
+    // Routine of group commit thread.
+    void runWriteLoop();
+
     // Routine of GC thread.
     void runGCLoop();
 
@@ -176,6 +213,17 @@ private:
                        time_t /* create time */>
         mGCItems;
 
+    std::unique_ptr<std::thread> mWriteThreadPtr;
+    std::mutex mWriteMux;
+    std::condition_variable mWriteCV;
+    std::condition_variable mPersistedCV;
+    bool mStopWriteThread = false;
+    // writes waiting for the next batch, and writes in the batch being persisted
+    std::unordered_map<std::string, std::string> mPendingWrites;
+    std::unordered_map<std::string, std::string> mWritingWrites;
+    uint64_t mWriteSeq = 0;
+    std::atomic<uint64_t> mPersistedWriteSeq{0};
+
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class CheckpointManagerV2Unittest;
     friend class ExactlyOnceReaderUnittest;
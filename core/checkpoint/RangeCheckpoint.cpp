@@ -20,7 +20,12 @@ namespace logtail {
 void RangeCheckpoint::save() {
     static auto sCptM = CheckpointManagerV2::GetInstance();
     data.set_update_time(time(NULL));
-    sCptM->SetPB(key, data);
+    writeSeq = sCptM->AsyncSetPB(key, data);
+}
+
+bool RangeCheckpoint::IsPersisted() const {
+    static auto sCptM = CheckpointManagerV2::GetInstance();
+    return sCptM->IsPersisted(writeSeq);
 }
 
 } // namespace logtail
\ No newline at end of file
@@ -30,6 +30,8 @@ public:
     QueueKey fbKey;
     RangeCheckpointPB data;
     std::vector<std::pair<uint64_t, size_t>> positions;
+    // sequence of the last write of data, see CheckpointManagerV2::AsyncSetPB
+    uint64_t writeSeq = 0;
 
     inline void Prepare() {
         positions.clear();
@@ -46,6 +48,9 @@ public:
 
     inline bool IsComplete() const { return data.has_hash_key(); }
 
+    // The range must not be sent until it is persisted as prepared, otherwise it can not be replayed after crash.
+    bool IsPersisted() const;
+
 private:
     void save();
 };
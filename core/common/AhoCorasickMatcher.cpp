@@ -0,0 +1,148 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/AhoCorasickMatcher.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <queue>
+
+using namespace std;
+
+namespace logtail {
+
+bool AhoCorasickMatcher::Build(const vector<string>& patterns) {
+    *this = AhoCorasickMatcher();
+    if (patterns.empty()) {
+        return false;
+    }
+    for (const auto& pattern : patterns) {
+        if (pattern.empty()) {
+            return false;
+        }
+    }
+
+    // class 0 is shared by all bytes not used by any literal
+    for (const auto& pattern : patterns) {
+        for (char c : pattern) {
+            auto& cls = mClasses[static_cast<uint8_t>(c)];
+            if (cls == 0) {
+                cls = ++mClassCnt;
+            }
+        }
+        mIsFirstByte[static_cast<uint8_t>(pattern[0])] = true;
+    }
+    ++mClassCnt;
+
+    // build the trie, where 0 means no edge since no edge points to the root
+    vector<uint32_t> transitions(mClassCnt, 0);
+    vector<bool> accepting(1, false);
+    for (const auto& pattern : patterns) {
+        uint32_t state = 0;
+        for (char c : pattern) {
+            size_t idx = state * mClassCnt + mClasses[static_cast<uint8_t>(c)];
+            if (transitions[idx] == 0) {
+                transitions[idx] = static_cast<uint32_t>(accepting.size());
+                transitions.resize(transitions.size() + mClassCnt, 0);
+                accepting.push_back(false);
+            }
+            state = transitions[idx];
+        }
+        accepting[state] = true;
+    }
+
+    // turn the trie into a dfa by resolving failure links in bfs order
+    vector<uint32_t> fail(accepting.size(), 0);
+    queue<uint32_t> states;
+    for (uint32_t cls = 0; cls < mClassCnt; ++cls) {
+        if (transitions[cls] != 0) {
+            states.push(transitions[cls]);
+        }
+    }
+    while (!states.empty()) {
+        uint32_t state = states.front();
+        states.pop();
+        for (uint32_t cls = 0; cls < mClassCnt; ++cls) {
+            uint32_t& next = transitions[state * mClassCnt + cls];
+            uint32_t failNext = transitions[fail[state] * mClassCnt + cls];
+            if (next == 0) {
+                next = failNext;
+                continue;
+            }
+            fail[next] = failNext;
+            if (accepting[failNext]) {
+                accepting[next] = true;
+            }
+            states.push(next);
+        }
+    }
+    mTransitions = std::move(transitions);
+    mAccepting = std::move(accepting);
+
+    for (size_t i = 0; i < mIsFirstByte.size(); ++i) {
+        if (mIsFirstByte[i]) {
+            mFirstBytes.push_back(static_cast<char>(i));
+        }
+    }
+    if (mFirstBytes.size() > kMaxSimdFirstBytes) {
+        mFirstBytes.clear();
+    }
+    return true;
+}
+
+size_t AhoCorasickMatcher::SkipToFirstByte(const char* data, size_t pos, size_t size) const {
+#if defined(__SSE2__)
+    if (!mFirstBytes.empty()) {
+        for (; pos + 16 <= size; pos += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i match = _mm_setzero_si128();
+            for (char c : mFirstBytes) {
+                match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(c)));
+            }
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+            if (mask != 0) {
+                return pos + __builtin_ctz(mask);
+            }
+        }
+    }
+#endif
+    while (pos < size && !mIsFirstByte[static_cast<uint8_t>(data[pos])]) {
+        ++pos;
+    }
+    return pos;
+}
+
+bool AhoCorasickMatcher::Contains(const char* data, size_t size) const {
+    if (!IsBuilt()) {
+        return false;
+    }
+    uint32_t state = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (state == 0) {
+            i = SkipToFirstByte(data, i, size);
+            if (i == size) {
+                break;
+            }
+        }
+        state = mTransitions[state * mClassCnt + mClasses[static_cast<uint8_t>(data[i])]];
+        if (mAccepting[state]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace logtail
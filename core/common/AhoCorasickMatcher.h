@@ -0,0 +1,61 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace logtail {
+
+/**
+ * AhoCorasickMatcher tells whether any of a set of literals occurs in a buffer, in a single pass over the buffer.
+ *
+ * The automaton is compiled into a dense transition table, where bytes not used by any literal share one column. While
+ * no literal is partially matched, the buffer is skipped 16 bytes at a time to the next possible first byte.
+ */
+class AhoCorasickMatcher {
+public:
+    // @return false if patterns is empty or contains an empty literal, in which case nothing is matched
+    bool Build(const std::vector<std::string>& patterns);
+    bool IsBuilt() const { return !mTransitions.empty(); }
+
+    // @return true if any of the literals occurs in data
+    bool Contains(const char* data, size_t size) const;
+
+private:
+    static constexpr size_t kMaxSimdFirstBytes = 4;
+
+    size_t SkipToFirstByte(const char* data, size_t pos, size_t size) const;
+
+    std::array<uint16_t, 256> mClasses{};
+    uint32_t mClassCnt = 0;
+    // next state of state s on byte class c is mTransitions[s * mClassCnt + c], state 0 is the root
+    std::vector<uint32_t> mTransitions;
+    std::vector<bool> mAccepting;
+    std::array<bool, 256> mIsFirstByte{};
+    // distinct first bytes of the literals, only set when there are at most kMaxSimdFirstBytes of them
+    std::string mFirstBytes;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class AhoCorasickMatcherUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -0,0 +1,288 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/CompiledTimeFormat.h"
+
+#include <cctype>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace logtail {
+
+static inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline int32_t ReadDigits(const char* buf, int32_t pos, int32_t width) {
+    int32_t res = 0;
+    for (int32_t i = 0; i < width; ++i) {
+        res = res * 10 + (buf[pos + i] - '0');
+    }
+    return res;
+}
+
+size_t CompiledTimeFormat::AppendPrefix(const string& fmt) {
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        char c = fmt[i];
+        if (c != '%') {
+            // white spaces in format match any number of white spaces in Strptime, only the most common case is kept
+            mTemplate.push_back(isspace(static_cast<unsigned char>(c)) ? ' ' : c);
+            mDigitMask.push_back(false);
+            continue;
+        }
+        if (i + 1 == fmt.size()) {
+            return string::npos;
+        }
+        int32_t* pos = nullptr;
+        int32_t width = 2;
+        switch (fmt[i + 1]) {
+            case 'f':
+            case 'z':
+                return i;
+            case 'Y':
+                pos = &mYearPos;
+                width = 4;
+                break;
+            case 'm':
+                pos = &mMonthPos;
+                break;
+            case 'd':
+                pos = &mDayPos;
+                break;
+            case 'H':
+                pos = &mHourPos;
+                break;
+            case 'M':
+                pos = &mMinutePos;
+                break;
+            case 'S':
+                pos = &mSecondPos;
+                break;
+            case '%':
+                mTemplate.push_back('%');
+                mDigitMask.push_back(false);
+                ++i;
+                continue;
+            default:
+                return string::npos;
+        }
+        ++i;
+        if (*pos != -1) {
+            return string::npos;
+        }
+        *pos = static_cast<int32_t>(mTemplate.size());
+        mTemplate.append(width, '0');
+        mDigitMask.insert(mDigitMask.end(), width, true);
+    }
+    return fmt.size();
+}
+
+bool CompiledTimeFormat::Compile(const string& fmt) {
+    *this = CompiledTimeFormat();
+
+    string expanded;
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] == '%' && i + 1 < fmt.size()) {
+            ++i;
+            if (fmt[i] == 'F') {
+                expanded.append("%Y-%m-%d");
+            } else if (fmt[i] == 'T') {
+                expanded.append("%H:%M:%S");
+            } else {
+                expanded.push_back('%');
+                expanded.push_back(fmt[i]);
+            }
+        } else {
+            expanded.push_back(fmt[i]);
+        }
+    }
+
+    size_t i = AppendPrefix(expanded);
+    if (i == string::npos || mYearPos < 0 || mMonthPos < 0 || mDayPos < 0 || mHourPos < 0 || mMinutePos < 0
+        || mTemplate.size() > kMaxPrefixLength) {
+        return false;
+    }
+    if (i + 1 < expanded.size() && expanded[i + 1] == 'f') {
+        mHasNanosecond = true;
+        i += 2;
+    }
+    for (; i < expanded.size(); ++i) {
+        char c = expanded[i];
+        if (c == '%') {
+            if (++i == expanded.size()) {
+                return false;
+            }
+            if (expanded[i] == 'z') {
+                mSuffix.emplace_back(SuffixStep::TimeZone, '\0');
+            } else if (expanded[i] == '%') {
+                mSuffix.emplace_back(SuffixStep::Literal, '%');
+            } else {
+                return false;
+            }
+        } else if (isspace(static_cast<unsigned char>(c))) {
+            mSuffix.emplace_back(SuffixStep::Space, c);
+        } else {
+            mSuffix.emplace_back(SuffixStep::Literal, c);
+        }
+    }
+
+    for (size_t i = 0; i < mTemplate.size() && i < 16; ++i) {
+        if (mDigitMask[i]) {
+            mDigitMask16 |= 1U << i;
+        } else {
+            mLiteralMask16 |= 1U << i;
+        }
+    }
+    mCompiled = true;
+    return true;
+}
+
+bool CompiledTimeFormat::MatchPrefix(const char* buf) const {
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (mTemplate.size() >= 16) {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+        __m128i tmpl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mTemplate.data()));
+        // unsigned (c - '0') <= 9
+        __m128i offset = _mm_sub_epi8(data, _mm_set1_epi8('0'));
+        __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(9)), offset);
+        uint32_t digitMatched = static_cast<uint32_t>(_mm_movemask_epi8(digits)) & mDigitMask16;
+        uint32_t literalMatched
+            = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, tmpl))) & mLiteralMask16;
+        if ((digitMatched | literalMatched) != 0xFFFF) {
+            return false;
+        }
+        i = 16;
+    }
+#endif
+    for (; i < mTemplate.size(); ++i) {
+        if (mDigitMask[i] ? !IsDigit(buf[i]) : buf[i] != mTemplate[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* CompiledTimeFormat::Parse(
+    const char* buf, size_t len, LogtailTime* ts, int& nanosecondLength, MinuteCache& cache) const {
+    if (!mCompiled || len < mTemplate.size() || !MatchPrefix(buf)) {
+        return nullptr;
+    }
+
+    // ranges checked by Strptime, since fields have 2 digits, Strptime consumes exactly these digits if valid
+    int32_t year = ReadDigits(buf, mYearPos, 4);
+    int32_t month = ReadDigits(buf, mMonthPos, 2);
+    int32_t day = ReadDigits(buf, mDayPos, 2);
+    int32_t hour = ReadDigits(buf, mHourPos, 2);
+    int32_t minute = ReadDigits(buf, mMinutePos, 2);
+    int32_t second = mSecondPos < 0 ? 0 : ReadDigits(buf, mSecondPos, 2);
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 61) {
+        return nullptr;
+    }
+
+    const char* p = buf + mTemplate.size();
+    const char* end = buf + len;
+    long nanosecond = 0;
+    int32_t digitCnt = 0;
+    if (mHasNanosecond) {
+        const char* begin = p;
+        while (p < end && IsDigit(*p)) {
+            nanosecond = nanosecond * 10 + (*p - '0');
+            ++p;
+        }
+        digitCnt = static_cast<int32_t>(p - begin);
+        // more than 9 digits overflow in Strptime
+        if (digitCnt == 0 || digitCnt > 9) {
+            return nullptr;
+        }
+        for (int32_t i = digitCnt; i < 9; ++i) {
+            nanosecond *= 10;
+        }
+    }
+
+    for (const auto& step : mSuffix) {
+        switch (step.first) {
+            case SuffixStep::Literal:
+                if (p >= end || *p != step.second) {
+                    return nullptr;
+                }
+                ++p;
+                break;
+            case SuffixStep::Space:
+                while (p < end && isspace(static_cast<unsigned char>(*p))) {
+                    ++p;
+                }
+                break;
+            case SuffixStep::TimeZone: {
+                // the offset is consumed but not applied by Strptime, only ISO 8601 forms are handled here
+                while (p < end && isspace(static_cast<unsigned char>(*p))) {
+                    ++p;
+                }
+                if (p >= end) {
+                    return nullptr;
+                }
+                char sign = *p++;
+                if (sign == 'Z') {
+                    break;
+                }
+                if (sign != '+' && sign != '-') {
+                    return nullptr;
+                }
+                int32_t offsetDigitCnt = 0, offset = 0;
+                while (offsetDigitCnt < 4) {
+                    if (p < end && IsDigit(*p)) {
+                        offset = offset * 10 + (*p++ - '0');
+                        ++offsetDigitCnt;
+                    } else if (offsetDigitCnt == 2 && p < end && *p == ':') {
+                        ++p;
+                    } else {
+                        break;
+                    }
+                }
+                if (!(offsetDigitCnt == 2 || (offsetDigitCnt == 4 && offset % 100 < 60))) {
+                    return nullptr;
+                }
+                break;
+            }
+        }
+    }
+
+    uint64_t key = ((((static_cast<uint64_t>(year) * 100 + month) * 100 + day) * 100 + hour) * 100) + minute;
+    if (key != cache.mKey) {
+        struct tm tm = {0};
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+        tm.tm_hour = hour;
+        tm.tm_min = minute;
+        time_t epoch = mktime(&tm);
+        if (epoch == -1) {
+            return nullptr;
+        }
+        cache.mKey = key;
+        cache.mEpoch = epoch;
+    }
+    ts->tv_sec = cache.mEpoch + second;
+    ts->tv_nsec = nanosecond;
+    if (mHasNanosecond) {
+        nanosecondLength = digitCnt;
+    }
+    return p;
+}
+
+} // namespace logtail
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "common/TimeUtil.h"
+
+namespace logtail {
+
+/**
+ * CompiledTimeFormat is a fast path of Strptime for time formats whose fields are at fixed offsets, e.g.
+ * "%Y-%m-%d %H:%M:%S", "%Y-%m-%dT%H:%M:%S.%f" and "%Y-%m-%dT%H:%M:%S.%f%z".
+ *
+ * The format is compiled once into a template of digits and literals. The fixed part of a time string is validated
+ * against the template 16 bytes at a time, and numbers are read at known offsets. A time string is only accepted when
+ * Strptime would parse it into the same result, otherwise Parse returns nullptr and Strptime should be used instead.
+ *
+ * Supported formats consist of %Y, %m, %d, %H, %M, %S (each at most once, %Y, %m, %d, %H and %M required), %F, %T, %%
+ * and literals, optionally followed by %f, and then by literals, white spaces and %z. A white space before %f or %z
+ * only matches exactly one space.
+ */
+class CompiledTimeFormat {
+public:
+    // epoch of the last minute seen, which is owned by the caller so that the compiled format can be shared
+    struct MinuteCache {
+        uint64_t mKey = 0;
+        time_t mEpoch = 0;
+    };
+
+    // @return false if fmt is not supported
+    bool Compile(const std::string& fmt);
+    bool IsCompiled() const { return mCompiled; }
+
+    // Same as Strptime(buf, fmt, ts, nanosecondLength), but buf is bounded by len.
+    // @return pointer to the first char not parsed, or nullptr if buf is not accepted by the fast path
+    const char* Parse(const char* buf, size_t len, LogtailTime* ts, int& nanosecondLength, MinuteCache& cache) const;
+
+private:
+    static constexpr size_t kMaxPrefixLength = 64;
+
+    enum class SuffixStep { Literal, Space, TimeZone };
+
+    // @return index of the first %f or %z in fmt, fmt.size() if not found, or npos if fmt is not supported
+    size_t AppendPrefix(const std::string& fmt);
+    bool MatchPrefix(const char* buf) const;
+
+    bool mCompiled = false;
+    // fixed part before %f or %z, digits are '0' in mTemplate and set in mDigitMask
+    std::string mTemplate;
+    std::vector<bool> mDigitMask;
+    uint32_t mDigitMask16 = 0;
+    uint32_t mLiteralMask16 = 0;
+    int32_t mYearPos = -1;
+    int32_t mMonthPos = -1;
+    int32_t mDayPos = -1;
+    int32_t mHourPos = -1;
+    int32_t mMinutePos = -1;
+    int32_t mSecondPos = -1;
+    bool mHasNanosecond = false;
+    // steps after the fixed part and %f
+    std::vector<std::pair<SuffixStep, char>> mSuffix;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class CompiledTimeFormatUnittest;
+#endif
+};
+
+} // namespace logtail
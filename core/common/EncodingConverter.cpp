@@ -13,10 +13,20 @@
 // limitations under the License.
 
 #include "EncodingConverter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 #include "LogtailAlarm.h"
 #include "logger/Logger.h"
 #if defined(__linux__)
 #include <iconv.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 #elif defined(_MSC_VER)
 #include <Windows.h>
 #endif
@@ -24,32 +34,148 @@
 namespace logtail {
 
 #if defined(__linux__)
-static iconv_t mGbk2Utf8Cd = (iconv_t)-1;
+namespace {
+
+// UTF-8 bytes of a GBK character, mLen is 0 if the character is invalid.
+struct Gbk2Utf8Entry {
+    char mUtf8[3] = {};
+    uint8_t mLen = 0;
+};
+
+const unsigned char kGbkLeadMin = 0x81;
+const unsigned char kGbkLeadMax = 0xFE;
+const unsigned char kGbkTrailMin = 0x40;
+const unsigned char kGbkTrailMax = 0xFE;
+const size_t kGbkTrailCount = kGbkTrailMax - kGbkTrailMin + 1;
+
+// double byte characters indexed by (lead - kGbkLeadMin) * kGbkTrailCount + (trail - kGbkTrailMin)
+std::vector<Gbk2Utf8Entry> sGbk2Utf8Table;
+// 0x80 is a single byte character (euro sign) in GBK
+Gbk2Utf8Entry sGbkEuro;
+
+bool ConvertByIconv(iconv_t cd, const char* src, size_t srcLen, Gbk2Utf8Entry& entry) {
+    char* in = const_cast<char*>(src);
+    char* out = entry.mUtf8;
+    size_t outLen = sizeof(entry.mUtf8);
+    size_t ret = iconv(cd, &in, &srcLen, &out, &outLen);
+    iconv(cd, NULL, NULL, NULL, NULL);
+    if (ret == (size_t)(-1) || srcLen != 0) {
+        return false;
+    }
+    entry.mLen = static_cast<uint8_t>(out - entry.mUtf8);
+    return true;
+}
+
+void BuildGbk2Utf8Table(iconv_t cd) {
+    sGbk2Utf8Table.resize((kGbkLeadMax - kGbkLeadMin + 1) * kGbkTrailCount);
+    for (unsigned int lead = kGbkLeadMin; lead <= kGbkLeadMax; ++lead) {
+        for (unsigned int trail = kGbkTrailMin; trail <= kGbkTrailMax; ++trail) {
+            char src[2] = {static_cast<char>(lead), static_cast<char>(trail)};
+            auto& entry = sGbk2Utf8Table[(lead - kGbkLeadMin) * kGbkTrailCount + (trail - kGbkTrailMin)];
+            if (!ConvertByIconv(cd, src, sizeof(src), entry)) {
+                entry = Gbk2Utf8Entry();
+            }
+        }
+    }
+    char euro = static_cast<char>(0x80);
+    if (!ConvertByIconv(cd, &euro, 1, sGbkEuro)) {
+        sGbkEuro = Gbk2Utf8Entry();
+    }
+}
+
+// length of the ascii prefix of src
+size_t GetAsciiPrefixLength(const char* src, size_t len) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= len; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__aarch64__)
+    for (; i + 16 <= len; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(src + i))) & 0x80) {
+            break;
+        }
+    }
+#endif
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+    while (i < len && !(static_cast<unsigned char>(src[i]) & 0x80)) {
+        ++i;
+    }
+    return i;
+}
+
+// @return the number of bytes written to des, or -1 if src contains invalid characters or des is too small.
+int64_t ConvertGbk2Utf8ByTable(const char* src, size_t srcLen, char* des, size_t desLen) {
+    size_t i = 0, o = 0;
+    while (i < srcLen) {
+        size_t asciiLen = GetAsciiPrefixLength(src + i, srcLen - i);
+        if (asciiLen > 0) {
+            if (o + asciiLen > desLen) {
+                return -1;
+            }
+            memcpy(des + o, src + i, asciiLen);
+            i += asciiLen;
+            o += asciiLen;
+            continue;
+        }
+        unsigned char lead = static_cast<unsigned char>(src[i]);
+        const Gbk2Utf8Entry* entry = nullptr;
+        if (lead == 0x80) {
+            entry = &sGbkEuro;
+            ++i;
+        } else if (lead <= kGbkLeadMax && i + 1 < srcLen) {
+            unsigned char trail = static_cast<unsigned char>(src[i + 1]);
+            if (trail < kGbkTrailMin || trail > kGbkTrailMax) {
+                return -1;
+            }
+            entry = &sGbk2Utf8Table[(lead - kGbkLeadMin) * kGbkTrailCount + (trail - kGbkTrailMin)];
+            i += 2;
+        } else {
+            return -1;
+        }
+        if (entry->mLen == 0 || o + entry->mLen > desLen) {
+            return -1;
+        }
+        memcpy(des + o, entry->mUtf8, entry->mLen);
+        o += entry->mLen;
+    }
+    return static_cast<int64_t>(o);
+}
+
+} // namespace
 #endif
 
 EncodingConverter::EncodingConverter() {
 #if defined(__linux__)
-    mGbk2Utf8Cd = iconv_open("UTF-8", "GBK");
-    if (mGbk2Utf8Cd == (iconv_t)(-1))
+    // iconv is only used to build the conversion table, which is much faster than converting through iconv
+    iconv_t cd = iconv_open("UTF-8", "GBK");
+    if (cd == (iconv_t)(-1)) {
         LOG_ERROR(sLogger, ("create Gbk2Utf8 iconv descriptor fail, errno", strerror(errno)));
-    else
-        iconv(mGbk2Utf8Cd, NULL, NULL, NULL, NULL);
+        return;
+    }
+    BuildGbk2Utf8Table(cd);
+    iconv_close(cd);
 #endif
 }
 
 EncodingConverter::~EncodingConverter() {
-#if defined(__linux__)
-    if (mGbk2Utf8Cd != (iconv_t)(-1))
-        iconv_close(mGbk2Utf8Cd);
-#endif
 }
 
-// TODO: Refactor it, do not use the output params to do calculations, set them before return.
 size_t EncodingConverter::ConvertGbk2Utf8(
     const char* src, size_t* srcLength, char* desOut, size_t desLength, const std::vector<long>& linePosVec) const {
 #if defined(__linux__)
-    if (src == NULL || *srcLength == 0 || mGbk2Utf8Cd == (iconv_t)(-1)) {
-        LOG_ERROR(sLogger, ("invalid iconv descriptor fail or invalid buffer pointer, cd", mGbk2Utf8Cd));
+    if (src == NULL || *srcLength == 0 || sGbk2Utf8Table.empty()) {
+        LOG_ERROR(sLogger,
+                  ("invalid GBK conversion table or invalid buffer pointer, table size", sGbk2Utf8Table.size()));
         return 0;
     }
     size_t maxRequire = *srcLength * 2;
@@ -59,33 +185,26 @@ size_t EncodingConverter::ConvertGbk2Utf8(
     if (desLength < maxRequire + 1) {
         return 0;
     }
-    char* des = desOut;
-    des[*srcLength * 2] = '\0';
-    const char* originSrc = src;
-    char* originDes = des;
+    desOut[maxRequire] = '\0';
     size_t beginIndex = 0;
-    size_t endIndex = *srcLength;
     size_t destIndex = 0;
-    size_t maxDestSize = desLength;
     for (size_t i = 0; i < linePosVec.size(); ++i) {
-        endIndex = linePosVec[i];
-        src = originSrc + beginIndex;
-        des = originDes + destIndex;
         // include '\n'
-        *srcLength = endIndex - beginIndex + 1;
-        desLength = maxDestSize - destIndex;
-        size_t ret = iconv(mGbk2Utf8Cd, const_cast<char**>(&src), srcLength, &des, &desLength);
-        if (ret == (size_t)(-1)) {
-            LOG_ERROR(sLogger, ("convert GBK to UTF8 fail, errno", strerror(errno)));
-            iconv(mGbk2Utf8Cd, NULL, NULL, NULL, NULL); // Clear status.
+        size_t lineLen = linePosVec[i] + 1 - beginIndex;
+        int64_t ret = ConvertGbk2Utf8ByTable(src + beginIndex, lineLen, desOut + destIndex, desLength - destIndex);
+        if (ret < 0) {
+            LOG_ERROR(sLogger,
+                      ("convert GBK to UTF8 fail, invalid GBK line",
+                       std::string(src + beginIndex, std::min(lineLen, static_cast<size_t>(1024)))));
             LogtailAlarm::GetInstance()->SendAlarm(ENCODING_CONVERT_ALARM, "convert GBK to UTF8 fail");
             // use memcpy
-            memcpy(originDes + destIndex, originSrc + beginIndex, endIndex - beginIndex + 1);
-            destIndex += endIndex - beginIndex + 1;
+            size_t copyLen = std::min(lineLen, desLength - destIndex);
+            memcpy(desOut + destIndex, src + beginIndex, copyLen);
+            destIndex += copyLen;
         } else {
-            destIndex = des - originDes;
+            destIndex += ret;
         }
-        beginIndex = endIndex + 1;
+        beginIndex += lineLen;
     }
     return destIndex;
 
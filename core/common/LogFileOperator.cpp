@@ -16,6 +16,8 @@
 #if defined(_MSC_VER)
 #include <fcntl.h>
 #include <io.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
 #endif
 #include "FileSystemUtil.h"
 
@@ -109,6 +111,27 @@ int LogFileOperator::Pread(void* ptr, size_t size, size_t count, int64_t offset)
 #endif
 }
 
+std::shared_ptr<char> LogFileOperator::Mmap(int64_t offset, size_t length) const {
+    if (!length || offset < 0 || !IsOpen()) {
+        return nullptr;
+    }
+
+#if defined(__linux__)
+    static const int64_t sPageSize = sysconf(_SC_PAGESIZE);
+    int64_t alignedOffset = offset / sPageSize * sPageSize;
+    size_t mapLength = length + static_cast<size_t>(offset - alignedOffset);
+    void* addr = mmap(nullptr, mapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, mFd, alignedOffset);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+    madvise(addr, mapLength, MADV_SEQUENTIAL);
+    return std::shared_ptr<char>(static_cast<char*>(addr) + (offset - alignedOffset),
+                                 [addr, mapLength](char*) { munmap(addr, mapLength); });
+#else
+    return nullptr;
+#endif
+}
+
 int64_t LogFileOperator::GetFileSize() const {
     if (!IsOpen()) {
         return -1;
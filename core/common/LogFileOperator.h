@@ -16,6 +16,7 @@
 
 #pragma once
 #include <cstdio>
+#include <memory>
 #include <string>
 #include <cstdint>
 #if defined(_MSC_VER)
@@ -48,6 +49,11 @@ public:
 
     int Pread(void* ptr, size_t size, size_t count, int64_t offset);
 
+    // Mmap maps [offset, offset + length) of the file privately, so the returned memory can be modified in place
+    // without touching the file. The range is unmapped when the last reference is released.
+    // @return nullptr if mapping is not supported on the platform or fails.
+    std::shared_ptr<char> Mmap(int64_t offset, size_t length) const;
+
     // GetFileSize gets the size of current file.
     int64_t GetFileSize() const;
 
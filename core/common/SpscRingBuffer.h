@@ -0,0 +1,92 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace logtail {
+
+// lock-free bounded queue for exactly one producer thread and one consumer thread. Capacity is rounded up to a power
+// of 2. Unlike CircularBuffer, items are moved in and out, so that move-only types (e.g. unique_ptr) can be used.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        mMask = cap - 1;
+        mData.reset(new T[cap]);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // called by the producer only
+    bool TryPush(T&& item) {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead == Capacity()) {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead == Capacity()) {
+                return false;
+            }
+        }
+        mData[tail & mMask] = std::move(item);
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // called by the consumer only
+    bool TryPop(T& item) {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail) {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail) {
+                return false;
+            }
+        }
+        item = std::move(mData[head & mMask]);
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate when called concurrently with push or pop
+    size_t Size() const {
+        return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    size_t Capacity() const { return mMask + 1; }
+
+private:
+    std::unique_ptr<T[]> mData;
+    size_t mMask = 0;
+
+    // head and tail are never wrapped, the slot used is obtained by masking
+    alignas(64) std::atomic_size_t mHead = 0;
+    // producer's snapshot of mHead, to avoid touching the consumer's cache line on every push
+    size_t mCachedHead = 0;
+    alignas(64) std::atomic_size_t mTail = 0;
+    // consumer's snapshot of mTail
+    size_t mCachedTail = 0;
+};
+
+} // namespace logtail
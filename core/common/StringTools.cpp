@@ -274,6 +274,37 @@ bool BoostRegexSearch(const char* buffer, const boost::regex& reg, string& excep
     }
 }
 
+bool IsRe2Compatible(const string& regex) {
+    // boost treats ^ and $ as line anchors and \v, \h as character classes, while RE2 does not. Case folding of
+    // non-ascii chars also differs in latin-1 mode. Such patterns are left to boost to keep the semantics unchanged.
+    if (regex.find("(?i") != string::npos) {
+        return false;
+    }
+    bool inClass = false;
+    for (size_t i = 0; i < regex.size(); ++i) {
+        char c = regex[i];
+        if (c == '\\') {
+            if (i + 1 < regex.size() && (regex[i + 1] == 'v' || regex[i + 1] == 'h')) {
+                return false;
+            }
+            ++i;
+        } else if (inClass) {
+            inClass = c != ']';
+        } else if (c == '[') {
+            inClass = true;
+            if (i + 1 < regex.size() && regex[i + 1] == '^') {
+                ++i;
+            }
+            if (i + 1 < regex.size() && regex[i + 1] == ']') {
+                ++i;
+            }
+        } else if (c == '$' || (c == '^' && i != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 uint32_t GetLittelEndianValue32(const uint8_t* buffer) {
     return buffer[3] << 24 | buffer[2] << 16 | buffer[1] << 8 | buffer[0];
 }
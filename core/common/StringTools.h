@@ -133,6 +133,9 @@ bool BoostRegexMatch(const char* buffer, size_t size, const boost::regex& reg, s
 bool BoostRegexMatch(const char* buffer, const boost::regex& reg, std::string& exception);
 bool BoostRegexSearch(const char* buffer, size_t size, const boost::regex& reg, std::string& exception);
 bool BoostRegexSearch(const char* buffer, const boost::regex& reg, std::string& exception);
+// @return true if the regex can be run by RE2 (in latin-1 mode, with dot matching newline) with the same semantics as
+// boost. RE2 may still fail to compile it, e.g. for back references, in which case boost should be used.
+bool IsRe2Compatible(const std::string& regex);
 
 // GetLittelEndianValue32 converts @buffer in little endian to uint32_t.
 uint32_t GetLittelEndianValue32(const uint8_t* buffer);
@@ -20,10 +20,16 @@
 #include <chrono>
 #include <cmath>
 #include <limits>
+#include <thread>
 #if defined(__linux__)
 #include <sys/sysinfo.h>
 #include <utmp.h>
 #endif
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#elif defined(_M_X64)
+#include <intrin.h>
+#endif
 #include "common/LogtailCommonFlags.h"
 #include "common/ParamExtractor.h"
 #include "common/StringTools.h"
@@ -367,6 +373,58 @@ uint64_t GetCurrentTimeInNanoSeconds() {
         .count();
 }
 
+static uint64_t GetSteadyTimeInNanoSeconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t GetCurrentCycles() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return GetSteadyTimeInNanoSeconds();
+#endif
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+// TSC frequency is not exposed portably, so it is measured against steady clock.
+static double CalibrateNanoSecondsPerCycle() {
+    uint64_t startNs = GetSteadyTimeInNanoSeconds();
+    uint64_t startCycles = GetCurrentCycles();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t endNs = GetSteadyTimeInNanoSeconds();
+    uint64_t endCycles = GetCurrentCycles();
+    if (endCycles <= startCycles || endNs <= startNs) {
+        return 1.0;
+    }
+    return static_cast<double>(endNs - startNs) / static_cast<double>(endCycles - startCycles);
+}
+
+// calibrated during static initialization, before any runner thread starts, so that the sleep above never stalls the
+// first caller on the processing or sending path
+static const double sNanoSecondsPerCycle = CalibrateNanoSecondsPerCycle();
+#endif
+
+uint64_t CyclesToNanoSeconds(uint64_t cycles) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return static_cast<uint64_t>(cycles * sNanoSecondsPerCycle);
+#else
+    return cycles;
+#endif
+}
+
+uint64_t GetCurrentThreadCpuTimeInNanoSeconds() {
+#if defined(__linux__)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
 bool ParseTimeZoneOffsetSecond(const std::string& logTZ, int& logTZSecond) {
     if (logTZ.size() != strlen("GMT+08:00") || logTZ[6] != ':' || (logTZ[3] != '+' && logTZ[3] != '-')) {
         return false;
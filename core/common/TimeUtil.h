@@ -48,6 +48,14 @@ uint64_t GetCurrentTimeInMicroSeconds();
 uint64_t GetCurrentTimeInMilliSeconds();
 uint64_t GetCurrentTimeInNanoSeconds();
 
+// Cheap monotonic cycle counter for hot path latency measurement, i.e., TSC on x86_64 and steady clock elsewhere.
+// Only the difference of two readings is meaningful, use CyclesToNanoSeconds to convert it.
+uint64_t GetCurrentCycles();
+uint64_t CyclesToNanoSeconds(uint64_t cycles);
+
+// Get CPU time consumed by the calling thread in ns, 0 if unsupported.
+uint64_t GetCurrentThreadCpuTimeInNanoSeconds();
+
 // Get offset between current time zone and UTC in seconds.
 // For example, for UTC+8, returns 8*60*60.
 int GetLocalTimeZoneOffsetSecond();
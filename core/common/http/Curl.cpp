@@ -74,12 +74,42 @@ CURL* CreateCurlHandler(const std::string& method,
                         uint32_t timeout,
                         bool replaceHostWithIp,
                         const std::string& intf) {
-    static DnsCache* dnsCache = DnsCache::GetInstance();
-
     CURL* curl = curl_easy_init();
     if (curl == nullptr) {
         return nullptr;
     }
+    SetCurlHandler(curl,
+                   method,
+                   httpsFlag,
+                   host,
+                   port,
+                   url,
+                   queryString,
+                   header,
+                   body,
+                   response,
+                   headers,
+                   timeout,
+                   replaceHostWithIp,
+                   intf);
+    return curl;
+}
+
+void SetCurlHandler(CURL* curl,
+                    const std::string& method,
+                    bool httpsFlag,
+                    const std::string& host,
+                    int32_t port,
+                    const std::string& url,
+                    const std::string& queryString,
+                    const std::map<std::string, std::string>& header,
+                    const std::string& body,
+                    HttpResponse& response,
+                    curl_slist*& headers,
+                    uint32_t timeout,
+                    bool replaceHostWithIp,
+                    const std::string& intf) {
+    static DnsCache* dnsCache = DnsCache::GetInstance();
 
     string totalUrl = httpsFlag ? "https://" : "http://";
     std::string hostIP;
@@ -125,7 +155,5 @@ CURL* CreateCurlHandler(const std::string& method,
     curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
     curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1);
     curl_easy_setopt(curl, CURLOPT_NETRC, CURL_NETRC_IGNORED);
-
-    return curl;
 }
 } // namespace logtail
@@ -40,4 +40,21 @@ CURL* CreateCurlHandler(const std::string& method,
                         bool replaceHostWithIp = true,
                         const std::string& intf = "");
 
+// Set the request on curl, which is either newly created or reset by curl_easy_reset, so that its connections and tls
+// sessions can be reused.
+void SetCurlHandler(CURL* curl,
+                    const std::string& method,
+                    bool httpsFlag,
+                    const std::string& host,
+                    int32_t port,
+                    const std::string& url,
+                    const std::string& queryString,
+                    const std::map<std::string, std::string>& header,
+                    const std::string& body,
+                    HttpResponse& response,
+                    curl_slist*& headers,
+                    uint32_t timeout,
+                    bool replaceHostWithIp = true,
+                    const std::string& intf = "");
+
 } // namespace logtail
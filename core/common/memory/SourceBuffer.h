@@ -18,6 +18,7 @@
 
 #include <list>
 #include <memory>
+#include <vector>
 
 #include "models/StringView.h"
 
@@ -167,12 +168,18 @@ public:
     StringBuffer CopyString(const std::string& s) { return CopyString(s.data(), s.length()); }
     StringBuffer CopyString(StringView s) { return CopyString(s.data(), s.length()); }
 
+    // Keep memory not owned by the allocator (e.g. a mapped file window) alive as long as the buffer, so that events
+    // can reference it directly.
+    void PinRegion(std::shared_ptr<void> region) { mPinnedRegions.emplace_back(std::move(region)); }
+
 private:
     BufferAllocator mAllocator;
+    std::vector<std::shared_ptr<void>> mPinnedRegions;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class LogEventUnittest;
     friend class PipelineEventGroupUnittest;
+    friend class LogFileReaderUnittest;
 #endif
 };
 
@@ -49,6 +49,11 @@ void eBPFServer::Init() {
     mNetworkSecureCB = std::make_unique<SecurityHandler>(nullptr, -1, 0);
     mProcessSecureCB = std::make_unique<SecurityHandler>(nullptr, -1, 0);
     mFileSecureCB = std::make_unique<SecurityHandler>(nullptr, -1, 0);
+    {
+        std::lock_guard<std::mutex> lock(mThreadRunningMux);
+        mIsThreadRunning = true;
+    }
+    mThreadRes = std::async(std::launch::async, &eBPFServer::Run, this);
     mInited = true;
 }
 
@@ -59,6 +64,17 @@ void eBPFServer::Stop() {
     mSourceManager->StopAll();
     // destroy source manager 
     mSourceManager.reset();
+    {
+        std::lock_guard<std::mutex> lock(mThreadRunningMux);
+        mIsThreadRunning = false;
+    }
+    mStopCV.notify_all();
+    std::future_status s = mThreadRes.wait_for(std::chrono::seconds(1));
+    if (s == std::future_status::ready) {
+        LOG_INFO(sLogger, ("ebpf server", "stopped successfully"));
+    } else {
+        LOG_WARNING(sLogger, ("ebpf server", "forced to stopped"));
+    }
     for (std::size_t i = 0; i < mLoadedPipeline.size(); i ++) {
         UpdatePipelineName(static_cast<nami::PluginType>(i), "");
     }
@@ -204,6 +220,22 @@ bool eBPFServer::SuspendPlugin(const std::string& pipeline_name, nami::PluginTyp
     return ret;
 }
 
+void eBPFServer::Run() {
+    LOG_INFO(sLogger, ("ebpf server", "started"));
+    std::unique_lock<std::mutex> lock(mThreadRunningMux);
+    while (mIsThreadRunning) {
+        lock.unlock();
+        bool busy = false;
+        busy |= mProcessSecureCB->Drain();
+        busy |= mNetworkSecureCB->Drain();
+        busy |= mFileSecureCB->Drain();
+        lock.lock();
+        if (!busy) {
+            mStopCV.wait_for(lock, std::chrono::milliseconds(10), [this]() { return !mIsThreadRunning; });
+        }
+    }
+}
+
 void eBPFServer::UpdateCBContext(nami::PluginType type, const logtail::PipelineContext* ctx, logtail::QueueKey key, int idx) {
     switch (type) {
     case nami::PluginType::PROCESS_SECURITY:{
@@ -16,6 +16,8 @@
 
 #include <variant>
 #include <atomic>
+#include <condition_variable>
+#include <future>
 #include <map>
 #include <array>
 #include <memory>
@@ -70,6 +72,8 @@ private:
     ~eBPFServer() = default;
 
     void UpdateCBContext(nami::PluginType type, const logtail::PipelineContext* ctx, logtail::QueueKey key, int idx);
+    // moves security events buffered by handlers to process queues
+    void Run();
 
     std::unique_ptr<SourceManager> mSourceManager;
     // source manager
@@ -86,6 +90,11 @@ private:
     eBPFAdminConfig mAdminConfig;
     volatile bool mInited = false;
 
+    std::future<void> mThreadRes;
+    mutable std::mutex mThreadRunningMux;
+    bool mIsThreadRunning = false;
+    mutable std::condition_variable mStopCV;
+
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class eBPFServerUnittest;
 #endif
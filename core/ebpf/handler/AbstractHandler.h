@@ -25,7 +25,8 @@ class AbstractHandler {
 public:
     AbstractHandler() {}
     AbstractHandler(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t idx) : mCtx(ctx), mQueueKey(key), mPluginIdx(idx) {}
-    void UpdateContext(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t index) { 
+    virtual ~AbstractHandler() = default;
+    virtual void UpdateContext(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t index) { 
         mCtx = ctx;
         mQueueKey = key;
         mPluginIdx = index;
@@ -15,23 +15,52 @@
 #include "ebpf/handler/SecurityHandler.h"
 #include "logger/Logger.h"
 #include "pipeline/PipelineContext.h"
+#include "common/Flags.h"
 #include "common/RuntimeUtil.h"
 #include "ebpf/SourceManager.h"
 #include "models/SpanEvent.h"
 #include "models/PipelineEventGroup.h"
 #include "models/PipelineEvent.h"
-#include "logger/Logger.h"
+#include "models/TagInterner.h"
 #include "pipeline/queue/ProcessQueueManager.h"
-#include "pipeline/queue/ProcessQueueItem.h"
 #include "common/MachineInfoUtil.h"
 
+DEFINE_FLAG_INT32(ebpf_security_event_ring_size, "max count of security events buffered for each ebpf plugin", 8192);
+DEFINE_FLAG_INT32(ebpf_security_event_group_size, "max count of security events in one event group", 1024);
+
 namespace logtail {
 namespace ebpf {
 
-SecurityHandler::SecurityHandler(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t idx) 
-    : AbstractHandler(ctx, key, idx) {
-    mHostName = GetHostName();
-    mHostIp = GetHostIp();
+static const size_t kMaxKeyCacheSize = 1024;
+static const uint32_t kMaxSampleLevel = 4;
+
+SecurityHandler::SecurityHandler(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t idx)
+    : AbstractHandler(ctx, key, idx), mRing(INT32_FLAG(ebpf_security_event_ring_size)) {
+    mHostName = TagInterner::GetInstance()->Intern(GetHostName());
+    mHostIp = TagInterner::GetInstance()->Intern(GetHostIp());
+}
+
+void SecurityHandler::UpdateContext(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t index) {
+    std::lock_guard<std::mutex> lock(mCtxMux);
+    AbstractHandler::UpdateContext(ctx, key, index);
+    ++mCtxVersion;
+}
+
+SecurityHandler::Context SecurityHandler::GetContext() const {
+    std::lock_guard<std::mutex> lock(mCtxMux);
+    return {mCtx, mQueueKey, mPluginIdx, mCtxVersion};
+}
+
+uint32_t SecurityHandler::GetSampleLevel() const {
+    // no sampling until half full, then halve the rate each time the free space halves
+    size_t free = mRing.Capacity() - mRing.Size();
+    size_t threshold = mRing.Capacity() / 2;
+    uint32_t level = 0;
+    while (free < threshold && level < kMaxSampleLevel) {
+        ++level;
+        threshold /= 2;
+    }
+    return level;
 }
 
 void SecurityHandler::handle(std::vector<std::unique_ptr<AbstractSecurityEvent>>&& events) {
@@ -39,32 +68,133 @@ void SecurityHandler::handle(std::vector<std::unique_ptr<AbstractSecurityEvent>>
         return ;
     }
 
-    std::shared_ptr<SourceBuffer> source_buffer = std::make_shared<SourceBuffer>();;
-    PipelineEventGroup event_group(source_buffer);
+    uint32_t level = GetSampleLevel();
+    uint64_t mask = (1ULL << level) - 1;
+    uint64_t discardCnt = 0;
+    for (auto& x : events) {
+        if (!x) {
+            continue;
+        }
+        if ((mSampleSeq++ & mask) != 0 || !mRing.TryPush(std::move(x))) {
+            ++discardCnt;
+            continue;
+        }
+        ++mProcessTotalCnt;
+    }
+    if (discardCnt == 0) {
+        return;
+    }
+    uint64_t total = mDiscardCnt.fetch_add(discardCnt, std::memory_order_relaxed) + discardCnt;
+    time_t now = time(nullptr);
+    if (now - mLastDiscardLogTime >= 10) {
+        Context ctx = GetContext();
+        LOG_WARNING(sLogger,
+                    ("security events discarded due to backpressure", total - mLastDiscardCnt)(
+                        "config", ctx.mCtx ? ctx.mCtx->GetConfigName() : "")("pluginIdx", ctx.mPluginIdx)(
+                        "sample level", level)("buffered events", mRing.Size()));
+        mLastDiscardLogTime = now;
+        mLastDiscardCnt = total;
+    }
+}
+
+StringView SecurityHandler::GetContentKey(PipelineEventGroup& group, const std::string& key) {
+    auto iter = mKeyCache.find(key);
+    if (iter != mKeyCache.end()) {
+        return iter->second;
+    }
+    if (mKeyCache.size() >= kMaxKeyCacheSize) {
+        // unexpectedly many distinct keys, stop interning to bound memory
+        StringBuffer sb = group.GetSourceBuffer()->CopyString(key);
+        return StringView(sb.data, sb.size);
+    }
+    StringView interned = TagInterner::GetInstance()->Intern(key);
+    mKeyCache.emplace(std::string_view(interned.data(), interned.size()), interned);
+    return interned;
+}
+
+std::unique_ptr<ProcessQueueItem> SecurityHandler::BuildItem(size_t maxCnt, uint32_t pluginIdx) {
+    std::unique_ptr<AbstractSecurityEvent> x;
+    if (!mRing.TryPop(x)) {
+        return nullptr;
+    }
+    PipelineEventGroup eventGroup(std::make_shared<SourceBuffer>());
     // aggregate to pipeline event group
     // set host ips
     // TODO 后续这两个 key 需要移到 group 的 metadata 里，在 processortagnative 中转成tag
-    const static std::string host_ip_key = "host.ip";
-    const static std::string host_name_key = "host.name";
-    event_group.SetTag(host_ip_key, mHostIp);
-    event_group.SetTag(host_name_key, mHostName);
-    for (auto& x : events) {
-        auto event = event_group.AddLogEvent();
-        for (auto& tag : x->GetAllTags()) {
-            event->SetContent(tag.first, tag.second);
+    const static StringView host_ip_key = "host.ip";
+    const static StringView host_name_key = "host.name";
+    eventGroup.SetTagNoCopy(host_ip_key, mHostIp);
+    eventGroup.SetTagNoCopy(host_name_key, mHostName);
+    eventGroup.MutableEvents().reserve(std::min(maxCnt, mRing.Size() + 1));
+    size_t cnt = 0;
+    do {
+        if (!x) {
+            continue;
+        }
+        auto event = eventGroup.AddLogEvent();
+        for (const auto& tag : x->GetAllTags()) {
+            StringBuffer val = eventGroup.GetSourceBuffer()->CopyString(tag.second);
+            event->SetContentNoCopy(GetContentKey(eventGroup, tag.first), StringView(val.data, val.size));
         }
         auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::nanoseconds(x->GetTimestamp()));
-        event->SetTimestamp(seconds.count(), x->GetTimestamp());
+        event->SetTimestamp(seconds.count(), x->GetTimestamp() - seconds.count() * 1000000000ULL);
+    } while (++cnt < maxCnt && mRing.TryPop(x));
+    return std::make_unique<ProcessQueueItem>(std::move(eventGroup), pluginIdx);
+}
+
+void SecurityHandler::DiscardAll() {
+    uint64_t cnt = 0;
+    if (mPendingItem) {
+        cnt += mPendingItem->mEventGroup.GetEvents().size();
+        mPendingItem.reset();
     }
-    mProcessTotalCnt+= events.size();
-#ifdef APSARA_UNIT_TEST_MAIN
-    return;
-#endif
-    std::unique_ptr<ProcessQueueItem> item = 
-            std::unique_ptr<ProcessQueueItem>(new ProcessQueueItem(std::move(event_group), mPluginIdx));
-    
-    if (ProcessQueueManager::GetInstance()->PushQueue(mQueueKey, std::move(item))) {
-        LOG_WARNING(sLogger, ("configName", mCtx->GetConfigName())("pluginIdx",mPluginIdx)("Push queue failed!", events.size()));
+    std::unique_ptr<AbstractSecurityEvent> x;
+    while (mRing.TryPop(x)) {
+        ++cnt;
+    }
+    if (cnt > 0) {
+        mDiscardCnt.fetch_add(cnt, std::memory_order_relaxed);
+        LOG_WARNING(sLogger, ("security events discarded since plugin is not running", cnt));
+    }
+}
+
+bool SecurityHandler::Drain() {
+    Context ctx = GetContext();
+    if (ctx.mCtx == nullptr) {
+        // plugin is stopped or suspended, events left belong to the old pipeline
+        bool hasData = mPendingItem || !mRing.Empty();
+        DiscardAll();
+        return hasData;
+    }
+    if (mPendingItem && mPendingItemCtxVersion != ctx.mVersion) {
+        // the pending item carries the plugin index of the old pipeline
+        size_t cnt = mPendingItem->mEventGroup.GetEvents().size();
+        mDiscardCnt.fetch_add(cnt, std::memory_order_relaxed);
+        LOG_WARNING(sLogger,
+                    ("security events discarded since pipeline is updated", cnt)("config", ctx.mCtx->GetConfigName()));
+        mPendingItem.reset();
+    }
+    bool consumed = false;
+    size_t maxCnt = INT32_FLAG(ebpf_security_event_group_size);
+    while (true) {
+        // events are left in the ring when the process queue is full, so that the pressure is propagated to handle()
+        if (!ProcessQueueManager::GetInstance()->IsValidToPush(ctx.mQueueKey)) {
+            return consumed;
+        }
+        if (!mPendingItem) {
+            mPendingItem = BuildItem(maxCnt, ctx.mPluginIdx);
+            if (!mPendingItem) {
+                return consumed;
+            }
+            mPendingItemCtxVersion = ctx.mVersion;
+        }
+        if (ProcessQueueManager::GetInstance()->PushQueue(ctx.mQueueKey, std::move(mPendingItem))) {
+            LOG_WARNING(sLogger,
+                        ("configName", ctx.mCtx->GetConfigName())("pluginIdx", ctx.mPluginIdx)(
+                            "Push queue failed!", "retry later"));
+            return consumed;
+        }
+        consumed = true;
     }
 }
 
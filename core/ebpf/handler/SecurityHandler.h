@@ -14,23 +14,81 @@
 
 #pragma once
 
-#include <vector>
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
+#include "common/SpscRingBuffer.h"
 #include "ebpf/handler/AbstractHandler.h"
 #include "ebpf/include/export.h"
+#include "models/StringView.h"
+#include "pipeline/queue/ProcessQueueItem.h"
 
 namespace logtail {
 namespace ebpf {
 
+// Events delivered by the ebpf source are put into a bounded ring by handle(), and taken out in batches by Drain() in
+// the ebpf server thread, so that the source thread never blocks on the process queue. When the process queue is
+// full, events are kept in the ring; when the ring is filling up, handle() samples incoming events more and more
+// aggressively before it has to drop them, and reports the discarded count.
 class SecurityHandler : public AbstractHandler {
 public:
     SecurityHandler(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t idx);
+    // called by the config thread, while the source and server threads keep running
+    void UpdateContext(const logtail::PipelineContext* ctx, logtail::QueueKey key, uint32_t index) override;
+    // called by the ebpf source thread only
     void handle(std::vector<std::unique_ptr<AbstractSecurityEvent>>&& events);
+    // called by the ebpf server thread only
+    // @return true if any event is consumed
+    bool Drain();
+
 private:
+    struct Context {
+        const logtail::PipelineContext* mCtx = nullptr;
+        logtail::QueueKey mQueueKey = 0;
+        uint32_t mPluginIdx = 0;
+        uint64_t mVersion = 0;
+    };
+
+    Context GetContext() const;
+    // events are kept with a probability of 1/2^level
+    uint32_t GetSampleLevel() const;
+    std::unique_ptr<ProcessQueueItem> BuildItem(size_t maxCnt, uint32_t pluginIdx);
+    StringView GetContentKey(PipelineEventGroup& group, const std::string& key);
+    void DiscardAll();
+
+    // guards mCtx, mQueueKey, mPluginIdx and mCtxVersion, which are read by both the source and the server thread
+    mutable std::mutex mCtxMux;
+    // bumped on each context update
+    uint64_t mCtxVersion = 0;
+
+    SpscRingBuffer<std::unique_ptr<AbstractSecurityEvent>> mRing;
+    // only accessed by the producer
+    uint64_t mSampleSeq = 0;
+    time_t mLastDiscardLogTime = 0;
+    std::atomic_uint64_t mDiscardCnt = 0;
+    uint64_t mLastDiscardCnt = 0;
+
+    // only accessed by the consumer
+    // item built but rejected by the process queue, which is retried before any new item is built
+    std::unique_ptr<ProcessQueueItem> mPendingItem;
+    // context version the pending item is built for, the item is discarded once the context changes
+    uint64_t mPendingItemCtxVersion = 0;
+    // content keys come from a small fixed set, so they are interned once and referenced without copy
+    std::unordered_map<std::string_view, StringView> mKeyCache;
+
     // TODO 后续这两个 key 需要移到 group 的 metadata 里，在 processortagnative 中转成tag
-    std::string mHostIp;
-    std::string mHostName;
+    StringView mHostIp;
+    StringView mHostName;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class eBPFServerUnittest;
+#endif
 };
 
 }
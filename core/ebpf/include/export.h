@@ -21,9 +21,9 @@ enum class SecureEventType {
 class AbstractSecurityEvent {
 public:
   AbstractSecurityEvent(std::vector<std::pair<std::string, std::string>>&& tags, SecureEventType type, uint64_t ts)
-    : tags_(tags), type_(type), timestamp_(ts) {}
+    : tags_(std::move(tags)), type_(type), timestamp_(ts) {}
   SecureEventType GetEventType() {return type_;}
-  std::vector<std::pair<std::string, std::string>> GetAllTags() { return tags_; }
+  const std::vector<std::pair<std::string, std::string>>& GetAllTags() const { return tags_; }
   uint64_t GetTimestamp() { return timestamp_; }
   void SetEventType(SecureEventType type) { type_ = type; }
   void SetTimestamp(uint64_t ts) { timestamp_ = ts; }
@@ -130,8 +130,8 @@ class SingleEvent {
 public:
   explicit __attribute__((visibility("default"))) SingleEvent(){}
   explicit __attribute__((visibility("default"))) SingleEvent(std::vector<std::pair<std::string, std::string>>&& tags, uint64_t ts)
-    : tags_(tags), timestamp_(ts) {}
-  std::vector<std::pair<std::string, std::string>> GetAllTags() { return tags_; }
+    : tags_(std::move(tags)), timestamp_(ts) {}
+  const std::vector<std::pair<std::string, std::string>>& GetAllTags() const { return tags_; }
   uint64_t GetTimestamp() { return timestamp_; }
   void SetTimestamp(uint64_t ts) { timestamp_ = ts; }
   void AppendTags(std::pair<std::string, std::string>&& tag) {
@@ -0,0 +1,341 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "file_server/MultilineMatcher.h"
+
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+#include "common/StringTools.h"
+
+using namespace std;
+
+namespace logtail {
+
+namespace {
+
+bool IsAlnum(char c) {
+    return isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+void SetRange(bitset<256>& bytes, unsigned char lo, unsigned char hi) {
+    for (unsigned int c = lo; c <= hi; ++c) {
+        bytes.set(c);
+    }
+}
+
+// add the bytes matched by escape \c to bytes, literal is set when \c stands for a single char
+bool ParseEscape(char c, bitset<256>& bytes, int& literal) {
+    switch (c) {
+        case 'd':
+            SetRange(bytes, '0', '9');
+            return true;
+        case 'w':
+            SetRange(bytes, '0', '9');
+            SetRange(bytes, 'a', 'z');
+            SetRange(bytes, 'A', 'Z');
+            bytes.set('_');
+            return true;
+        case 's':
+            for (char ch : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+                bytes.set(static_cast<unsigned char>(ch));
+            }
+            return true;
+        case 't':
+            literal = '\t';
+            bytes.set('\t');
+            return true;
+        default:
+            if (c == '\0' || IsAlnum(c)) {
+                return false;
+            }
+            literal = static_cast<unsigned char>(c);
+            bytes.set(static_cast<unsigned char>(c));
+            return true;
+    }
+}
+
+bool ParseClass(const string& regex, size_t& pos, bitset<256>& bytes) {
+    // regex[pos] == '['
+    ++pos;
+    if (pos >= regex.size() || regex[pos] == '^') {
+        return false;
+    }
+    bool first = true;
+    while (pos < regex.size()) {
+        char c = regex[pos];
+        if (c == ']' && !first) {
+            ++pos;
+            return true;
+        }
+        first = false;
+        if (c == '[') {
+            return false;
+        }
+        int lo = -1;
+        if (c == '\\') {
+            if (pos + 1 >= regex.size() || !ParseEscape(regex[pos + 1], bytes, lo)) {
+                return false;
+            }
+            pos += 2;
+        } else {
+            lo = static_cast<unsigned char>(c);
+            ++pos;
+        }
+        if (lo >= 0 && pos + 1 < regex.size() && regex[pos] == '-' && regex[pos + 1] != ']') {
+            char hi = regex[pos + 1];
+            if (hi == '\\' || hi == '[' || static_cast<unsigned char>(hi) < lo) {
+                return false;
+            }
+            SetRange(bytes, static_cast<unsigned char>(lo), static_cast<unsigned char>(hi));
+            pos += 2;
+        } else if (lo >= 0) {
+            bytes.set(lo);
+        }
+    }
+    return false;
+}
+
+// parse the atom at regex[pos], which must match exactly one byte
+bool ParseAtom(const string& regex, size_t& pos, bitset<256>& bytes, int& literal) {
+    literal = -1;
+    char c = regex[pos];
+    switch (c) {
+        case '\\':
+            if (pos + 1 >= regex.size() || !ParseEscape(regex[pos + 1], bytes, literal)) {
+                return false;
+            }
+            pos += 2;
+            return true;
+        case '[':
+            return ParseClass(regex, pos, bytes);
+        case '.':
+        case '(':
+        case ')':
+        case '|':
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+        case '}':
+        case ']':
+        case '^':
+        case '$':
+            return false;
+        default:
+            literal = static_cast<unsigned char>(c);
+            bytes.set(static_cast<unsigned char>(c));
+            ++pos;
+            return true;
+    }
+}
+
+bool HasAlternation(const string& regex) {
+    bool inClass = false;
+    for (size_t i = 0; i < regex.size(); ++i) {
+        if (regex[i] == '\\') {
+            ++i;
+        } else if (inClass) {
+            inClass = regex[i] != ']';
+        } else if (regex[i] == '[') {
+            inClass = true;
+            // a leading ']' or '^]' is a literal inside the class
+            if (i + 1 < regex.size() && regex[i + 1] == '^') {
+                ++i;
+            }
+            if (i + 1 < regex.size() && regex[i + 1] == ']') {
+                ++i;
+            }
+        } else if (regex[i] == '|') {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool MultilineMatcher::Prefilter::Accept(const char* data, size_t size) const {
+    if (!mLiteralPrefix.empty()) {
+        return size >= mLiteralPrefix.size() && memcmp(data, mLiteralPrefix.data(), mLiteralPrefix.size()) == 0;
+    }
+    if (mAnyFirstByte) {
+        return true;
+    }
+    return size > 0 && mFirstBytes.test(static_cast<unsigned char>(data[0]));
+}
+
+MultilineMatcher::Prefilter MultilineMatcher::ExtractPrefilter(const string& regex) {
+    Prefilter prefilter;
+    // alternation makes the first byte depend on all branches, which is not worth analyzing
+    if (HasAlternation(regex)) {
+        return prefilter;
+    }
+    size_t pos = !regex.empty() && regex[0] == '^' ? 1 : 0;
+    bool isFirstAtom = true;
+    while (pos < regex.size()) {
+        bitset<256> bytes;
+        int literal = -1;
+        if (!ParseAtom(regex, pos, bytes, literal)) {
+            break;
+        }
+        char quantifier = pos < regex.size() ? regex[pos] : '\0';
+        bool optional = quantifier == '?' || quantifier == '*'
+            || (quantifier == '{' && pos + 1 < regex.size() && (regex[pos + 1] == '0' || regex[pos + 1] == ','));
+        if (isFirstAtom) {
+            if (optional) {
+                break;
+            }
+            prefilter.mFirstBytes = bytes;
+            prefilter.mAnyFirstByte = false;
+            isFirstAtom = false;
+        }
+        if (literal < 0 || optional) {
+            break;
+        }
+        prefilter.mLiteralPrefix.push_back(static_cast<char>(literal));
+        if (quantifier == '+' || quantifier == '{') {
+            break;
+        }
+    }
+    return prefilter;
+}
+
+void MultilineMatcher::InitRe2Options(re2::RE2::Options& options) {
+    // boost::regex works on bytes and its dot matches newline by default
+    options.set_encoding(re2::RE2::Options::EncodingLatin1);
+    options.set_dot_nl(true);
+    options.set_never_capture(true);
+    options.set_log_errors(false);
+}
+
+size_t MultilineMatcher::GetIndex(Pattern pattern) {
+    switch (pattern) {
+        case START:
+            return 0;
+        case CONTINUE:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+void MultilineMatcher::SetPattern(Pattern pattern, const string& regex, const shared_ptr<boost::regex>& reg) {
+    Entry& entry = mEntries[GetIndex(pattern)];
+    entry = Entry();
+    if (!reg) {
+        mPatterns &= ~pattern;
+        return;
+    }
+    entry.mRegex = regex;
+    entry.mBoostReg = reg;
+    entry.mPrefilter = ExtractPrefilter(regex);
+    if (IsRe2Compatible(regex)) {
+        re2::RE2::Options options;
+        InitRe2Options(options);
+        entry.mRe2.reset(new re2::RE2(regex, options));
+        if (!entry.mRe2->ok()) {
+            entry.mRe2.reset();
+        }
+    }
+    mPatterns |= pattern;
+}
+
+void MultilineMatcher::Compile() {
+    mSet.reset();
+    mSetPatterns = 0;
+    size_t re2Cnt = 0;
+    for (const auto& entry : mEntries) {
+        if (entry.mRe2) {
+            ++re2Cnt;
+        }
+    }
+    if (re2Cnt < 2) {
+        return;
+    }
+
+    re2::RE2::Options options;
+    InitRe2Options(options);
+    shared_ptr<re2::RE2::Set> set(new re2::RE2::Set(options, re2::RE2::ANCHOR_START));
+    uint8_t setPatterns = 0;
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        if (!mEntries[i].mRe2) {
+            continue;
+        }
+        int idx = set->Add(mEntries[i].mRegex, nullptr);
+        if (idx < 0 || static_cast<size_t>(idx) >= mSetIndexToPattern.size()) {
+            return;
+        }
+        mSetIndexToPattern[idx] = static_cast<uint8_t>(1U << i);
+        setPatterns |= static_cast<uint8_t>(1U << i);
+    }
+    if (!set->Compile()) {
+        return;
+    }
+    mSet = std::move(set);
+    mSetPatterns = setPatterns;
+}
+
+bool MultilineMatcher::Match(const char* data, size_t size, Pattern pattern) const {
+    if (!(mPatterns & pattern)) {
+        return false;
+    }
+    const Entry& entry = mEntries[GetIndex(pattern)];
+    return entry.mPrefilter.Accept(data, size) && MatchEntry(entry, data, size);
+}
+
+uint8_t MultilineMatcher::Classify(const char* data, size_t size, uint8_t candidates) const {
+    uint8_t remaining = 0;
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        uint8_t bit = static_cast<uint8_t>(1U << i);
+        if ((candidates & mPatterns & bit) && mEntries[i].mPrefilter.Accept(data, size)) {
+            remaining |= bit;
+        }
+    }
+    uint8_t res = 0;
+    // the set only pays off when more than one of its patterns survives the prefilter
+    uint8_t inSet = remaining & mSetPatterns;
+    if (mSet && (inSet & (inSet - 1))) {
+        static thread_local vector<int> sMatched;
+        sMatched.clear();
+        re2::RE2::Set::ErrorInfo errorInfo{re2::RE2::Set::kNoError};
+        mSet->Match(re2::StringPiece(data, size), &sMatched, &errorInfo);
+        if (errorInfo.kind == re2::RE2::Set::kNoError) {
+            for (int idx : sMatched) {
+                res |= mSetIndexToPattern[idx];
+            }
+            res &= inSet;
+            remaining &= ~inSet;
+        }
+        // otherwise the DFA is out of budget, so match each pattern on its own
+    }
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        uint8_t bit = static_cast<uint8_t>(1U << i);
+        if ((remaining & bit) && MatchEntry(mEntries[i], data, size)) {
+            res |= bit;
+        }
+    }
+    return res;
+}
+
+bool MultilineMatcher::MatchEntry(const Entry& entry, const char* data, size_t size) const {
+    if (entry.mRe2) {
+        return entry.mRe2->Match(re2::StringPiece(data, size), 0, size, re2::RE2::ANCHOR_START, nullptr, 0);
+    }
+    string exception;
+    return BoostRegexSearch(data, size, *entry.mBoostReg, exception);
+}
+
+} // namespace logtail
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <re2/re2.h>
+#include <re2/set.h>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "boost/regex.hpp"
+
+namespace logtail {
+
+// MultilineMatcher classifies a log line against the start, continue and end patterns of a multiline config. All
+// patterns are anchored at the beginning of the line, the same as boost::match_continuous.
+//
+// Each pattern carries a prefilter (literal prefix and possible first bytes) extracted from the regex, so that most
+// lines are rejected without running any regex. Patterns which can be expressed in RE2 with the same semantics are
+// also compiled into a single RE2::Set, so that a line is classified against all of them in one pass. Patterns RE2
+// cannot handle fall back to boost.
+class MultilineMatcher {
+public:
+    enum Pattern : uint8_t { START = 1, CONTINUE = 2, END = 4, ALL = START | CONTINUE | END };
+
+    void SetPattern(Pattern pattern, const std::string& regex, const std::shared_ptr<boost::regex>& reg);
+    void Compile();
+
+    bool Match(const char* data, size_t size, Pattern pattern) const;
+    // return the bitmask of patterns within candidates that the line matches
+    uint8_t Classify(const char* data, size_t size, uint8_t candidates = ALL) const;
+
+private:
+    struct Prefilter {
+        std::string mLiteralPrefix;
+        std::bitset<256> mFirstBytes;
+        bool mAnyFirstByte = true;
+
+        bool Accept(const char* data, size_t size) const;
+    };
+
+    struct Entry {
+        std::string mRegex;
+        std::shared_ptr<boost::regex> mBoostReg;
+        std::shared_ptr<re2::RE2> mRe2;
+        Prefilter mPrefilter;
+    };
+
+    static size_t GetIndex(Pattern pattern);
+    static Prefilter ExtractPrefilter(const std::string& regex);
+    static void InitRe2Options(re2::RE2::Options& options);
+
+    bool MatchEntry(const Entry& entry, const char* data, size_t size) const;
+
+    std::array<Entry, 3> mEntries;
+    uint8_t mPatterns = 0;
+    std::shared_ptr<re2::RE2::Set> mSet;
+    uint8_t mSetPatterns = 0;
+    std::array<uint8_t, 3> mSetIndexToPattern{};
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class MultilineMatcherUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -51,7 +51,7 @@ bool MultilineOptions::Init(const Json::Value& config, const PipelineContext& ct
 
     if (mMode == Mode::CUSTOM) {
         // StartPattern
-        string pattern;
+        string pattern, startRegex, continueRegex, endRegex;
         if (!GetOptionalStringParam(config, "Multiline.StartPattern", pattern, errorMsg)) {
             PARAM_WARNING_IGNORE(ctx.GetLogger(),
                                  ctx.GetAlarm(),
@@ -61,7 +61,7 @@ bool MultilineOptions::Init(const Json::Value& config, const PipelineContext& ct
                                  ctx.GetProjectName(),
                                  ctx.GetLogstoreName(),
                                  ctx.GetRegion());
-        } else if (!ParseRegex(pattern, mStartPatternRegPtr)) {
+        } else if (!ParseRegex(pattern, mStartPatternRegPtr, startRegex)) {
             PARAM_WARNING_IGNORE(ctx.GetLogger(),
                                  ctx.GetAlarm(),
                                  "string param Multiline.StartPattern is not a valid regex",
@@ -85,7 +85,7 @@ bool MultilineOptions::Init(const Json::Value& config, const PipelineContext& ct
                                  ctx.GetProjectName(),
                                  ctx.GetLogstoreName(),
                                  ctx.GetRegion());
-        } else if (!ParseRegex(pattern, mContinuePatternRegPtr)) {
+        } else if (!ParseRegex(pattern, mContinuePatternRegPtr, continueRegex)) {
             PARAM_WARNING_IGNORE(ctx.GetLogger(),
                                  ctx.GetAlarm(),
                                  "string param Multiline.ContinuePattern is not a valid regex",
@@ -109,7 +109,7 @@ bool MultilineOptions::Init(const Json::Value& config, const PipelineContext& ct
                                  ctx.GetProjectName(),
                                  ctx.GetLogstoreName(),
                                  ctx.GetRegion());
-        } else if (!ParseRegex(pattern, mEndPatternRegPtr)) {
+        } else if (!ParseRegex(pattern, mEndPatternRegPtr, endRegex)) {
             PARAM_WARNING_IGNORE(ctx.GetLogger(),
                                  ctx.GetAlarm(),
                                  "string param Multiline.EndPattern is not a valid regex",
@@ -155,6 +155,10 @@ bool MultilineOptions::Init(const Json::Value& config, const PipelineContext& ct
         if (mStartPatternRegPtr || mEndPatternRegPtr) {
             mIsMultiline = true;
         }
+        mMatcher.SetPattern(MultilineMatcher::START, startRegex, mStartPatternRegPtr);
+        mMatcher.SetPattern(MultilineMatcher::CONTINUE, continueRegex, mContinuePatternRegPtr);
+        mMatcher.SetPattern(MultilineMatcher::END, endRegex, mEndPatternRegPtr);
+        mMatcher.Compile();
     }
 
     // UnmatchedContentTreatment
@@ -199,8 +203,31 @@ bool MultilineOptions::Init(const Json::Value& config, const PipelineContext& ct
     return true;
 }
 
-bool MultilineOptions::ParseRegex(const string& pattern, shared_ptr<boost::regex>& reg) {
-    string regexPattern = pattern;
+uint8_t MultilineOptions::GetCandidatePatterns(bool isPartialLog) const {
+    uint8_t res = 0;
+    if (!isPartialLog) {
+        // a new log begins with the start pattern, or with the continue pattern if no start pattern is given
+        res = mStartPatternRegPtr ? MultilineMatcher::START : MultilineMatcher::CONTINUE;
+        if (!mStartPatternRegPtr && mContinuePatternRegPtr && mEndPatternRegPtr) {
+            // case: continue + end, where a single line may be matched against the end pattern
+            res |= MultilineMatcher::END;
+        }
+        return res;
+    }
+    if (mContinuePatternRegPtr) {
+        res |= MultilineMatcher::CONTINUE;
+    }
+    if (mEndPatternRegPtr) {
+        res |= MultilineMatcher::END;
+    } else if (mStartPatternRegPtr) {
+        // case: start or start + continue, where the next start line ends the current log
+        res |= MultilineMatcher::START;
+    }
+    return res;
+}
+
+bool MultilineOptions::ParseRegex(const string& pattern, shared_ptr<boost::regex>& reg, string& regexPattern) {
+    regexPattern = pattern;
     if (!regexPattern.empty() && EndWith(regexPattern, "$")) {
         regexPattern = regexPattern.substr(0, regexPattern.size() - 1);
     }
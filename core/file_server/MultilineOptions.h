@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "boost/regex.hpp"
+#include "file_server/MultilineMatcher.h"
 #include "pipeline/PipelineContext.h"
 
 namespace logtail {
@@ -35,6 +36,9 @@ public:
     const std::shared_ptr<boost::regex>& GetStartPatternReg() const { return mStartPatternRegPtr; }
     const std::shared_ptr<boost::regex>& GetContinuePatternReg() const { return mContinuePatternRegPtr; }
     const std::shared_ptr<boost::regex>& GetEndPatternReg() const { return mEndPatternRegPtr; }
+    const MultilineMatcher& GetMatcher() const { return mMatcher; }
+    // the patterns which can change the split state of a line, depending on whether a log is partially read
+    uint8_t GetCandidatePatterns(bool isPartialLog) const;
     bool IsMultiline() const { return mIsMultiline; }
 
     Mode mMode = Mode::CUSTOM;
@@ -45,11 +49,12 @@ public:
     bool mIgnoringUnmatchWarning = false;
 
 private:
-    bool ParseRegex(const std::string& pattern, std::shared_ptr<boost::regex>& reg);
+    bool ParseRegex(const std::string& pattern, std::shared_ptr<boost::regex>& reg, std::string& regexPattern);
 
     std::shared_ptr<boost::regex> mStartPatternRegPtr;
     std::shared_ptr<boost::regex> mContinuePatternRegPtr;
     std::shared_ptr<boost::regex> mEndPatternRegPtr;
+    MultilineMatcher mMatcher;
     bool mIsMultiline = false;
 };
 
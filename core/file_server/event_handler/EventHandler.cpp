@@ -775,7 +775,14 @@ void ModifyHandler::Handle(const Event& event) {
                 return;
             }
             unique_ptr<LogBuffer> logBuffer(new LogBuffer);
-            hasMoreData = reader->ReadLog(*logBuffer, &event);
+            hasMoreData = reader->ReadLog(*logBuffer, &event, BOOL_FLAG(enable_async_file_read));
+            if (reader->IsReadPending()) {
+                // handle the event again once the read completes, rather than wait for the file here
+                Event* ev = new Event(event);
+                ev->SetConfigName(mConfigName);
+                AsyncFileReader::GetInstance()->WaitFor(reader->GetPendingRead(), ev);
+                break;
+            }
             int32_t pushRetry = PushLogToProcessor(reader, logBuffer.get());
             if (!hasMoreData) {
                 if (reader->IsFileDeleted()) {
@@ -37,6 +37,7 @@
 #include "file_server/polling/PollingDirFile.h"
 #include "file_server/polling/PollingEventQueue.h"
 #include "file_server/polling/PollingModify.h"
+#include "file_server/reader/AsyncFileReader.h"
 #include "file_server/reader/GloablFileDescriptorManager.h"
 #include "file_server/reader/LogFileReader.h"
 #ifdef __ENTERPRISE__
@@ -380,6 +381,11 @@ void* LogInput::ProcessLoop() {
     while (true) {
         ReadLock lock(mAccessMainThreadRWL);
         TryReadEvents(false);
+        std::vector<Event*> asyncReadEvents;
+        AsyncFileReader::GetInstance()->Reap(asyncReadEvents);
+        if (!asyncReadEvents.empty()) {
+            PushEventQueue(asyncReadEvents);
+        }
         Event* ev = PopEventQueue();
         if (ev != NULL) {
             ++mEventProcessCount;
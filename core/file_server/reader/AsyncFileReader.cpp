@@ -0,0 +1,242 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "file_server/reader/AsyncFileReader.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#define LOGTAIL_IO_URING_SUPPORTED
+#endif
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "logger/Logger.h"
+
+DEFINE_FLAG_BOOL(enable_async_file_read,
+                 "read files with io_uring in the log input thread if supported, so that a slow file does not block "
+                 "reading of others",
+                 false);
+DEFINE_FLAG_INT32(async_file_read_queue_depth, "max count of file reads in flight", 256);
+
+using namespace std;
+
+namespace logtail {
+
+#ifdef LOGTAIL_IO_URING_SUPPORTED
+
+namespace {
+
+int IoUringSetup(uint32_t entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int fd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+void* Offset(void* base, uint32_t offset) {
+    return static_cast<char*>(base) + offset;
+}
+
+} // namespace
+
+AsyncFileReader::AsyncFileReader() {
+    if (!BOOL_FLAG(enable_async_file_read)) {
+        return;
+    }
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = IoUringSetup(static_cast<uint32_t>(INT32_FLAG(async_file_read_queue_depth)), &params);
+    if (fd < 0) {
+        LOG_WARNING(sLogger, ("io_uring is not available, use pread instead", strerror(errno)));
+        return;
+    }
+
+    mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        mSqRingSize = mCqRingSize = max(mSqRingSize, mCqRingSize);
+    }
+    mSqRing = mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (mSqRing == MAP_FAILED) {
+        mSqRing = nullptr;
+    } else if (singleMmap) {
+        mCqRing = mSqRing;
+    } else {
+        mCqRing
+            = mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (mCqRing == MAP_FAILED) {
+            mCqRing = nullptr;
+        }
+    }
+    mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    mSqes = mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (mSqes == MAP_FAILED) {
+        mSqes = nullptr;
+    }
+    if (mSqRing == nullptr || mCqRing == nullptr || mSqes == nullptr) {
+        LOG_WARNING(sLogger, ("failed to map io_uring, use pread instead", strerror(errno)));
+        UnmapRing();
+        close(fd);
+        return;
+    }
+
+    mEntries = params.sq_entries;
+    mSqHead = static_cast<uint32_t*>(Offset(mSqRing, params.sq_off.head));
+    mSqTail = static_cast<uint32_t*>(Offset(mSqRing, params.sq_off.tail));
+    mSqMask = static_cast<uint32_t*>(Offset(mSqRing, params.sq_off.ring_mask));
+    mSqArray = static_cast<uint32_t*>(Offset(mSqRing, params.sq_off.array));
+    mCqHead = static_cast<uint32_t*>(Offset(mCqRing, params.cq_off.head));
+    mCqTail = static_cast<uint32_t*>(Offset(mCqRing, params.cq_off.tail));
+    mCqMask = static_cast<uint32_t*>(Offset(mCqRing, params.cq_off.ring_mask));
+    mCqes = Offset(mCqRing, params.cq_off.cqes);
+    mRingFd = fd;
+    LOG_INFO(sLogger, ("io_uring file read enabled, queue depth", mEntries));
+}
+
+AsyncFileReader::~AsyncFileReader() {
+    UnmapRing();
+    if (mRingFd >= 0) {
+        close(mRingFd);
+    }
+}
+
+void AsyncFileReader::UnmapRing() {
+    if (mSqes != nullptr) {
+        munmap(mSqes, mSqesSize);
+        mSqes = nullptr;
+    }
+    if (mCqRing != nullptr && mCqRing != mSqRing) {
+        munmap(mCqRing, mCqRingSize);
+    }
+    mCqRing = nullptr;
+    if (mSqRing != nullptr) {
+        munmap(mSqRing, mSqRingSize);
+        mSqRing = nullptr;
+    }
+}
+
+shared_ptr<AsyncReadRequest> AsyncFileReader::Submit(int fd, int64_t offset, size_t reserved, size_t size) {
+    if (!IsAvailable() || size == 0) {
+        return nullptr;
+    }
+    // completions are only reaped by the log input thread, so in flight requests are bounded by the ring size to
+    // prevent the completion queue from overflowing
+    if (mInflightRequests.size() >= mEntries) {
+        return nullptr;
+    }
+    uint32_t tail = *mSqTail;
+    if (tail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) >= mEntries) {
+        return nullptr;
+    }
+
+    auto request = make_shared<AsyncReadRequest>();
+    request->mOffset = offset;
+    request->mReserved = reserved;
+    request->mSize = size;
+    request->mSourceBuffer.reset(new SourceBuffer());
+    request->mData = request->mSourceBuffer->AllocateStringBuffer(reserved + size).data;
+    request->mIov.iov_base = request->mData + reserved;
+    request->mIov.iov_len = size;
+
+    uint32_t idx = tail & *mSqMask;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(mSqes) + idx;
+    memset(sqe, 0, sizeof(*sqe));
+    // readv is used rather than read to support kernels since 5.1
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->mIov);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->user_data = reinterpret_cast<uint64_t>(request.get());
+    mSqArray[idx] = idx;
+    __atomic_store_n(mSqTail, tail + 1, __ATOMIC_RELEASE);
+
+    int res = IoUringEnter(mRingFd, 1, 0, 0);
+    if (res != 1) {
+        // the entry is not consumed by the kernel, take it back
+        __atomic_store_n(mSqTail, tail, __ATOMIC_RELEASE);
+        LOG_WARNING(sLogger, ("failed to submit io_uring read", strerror(errno))("fd", fd)("offset", offset));
+        return nullptr;
+    }
+    mInflightRequests.emplace(request.get(), request);
+    // reads hitting page cache are completed during submission
+    ReapCompletions();
+    return request;
+}
+
+void AsyncFileReader::ReapCompletions() {
+    uint32_t head = *mCqHead;
+    uint32_t tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        io_uring_cqe* cqe = static_cast<io_uring_cqe*>(mCqes) + (head & *mCqMask);
+        auto iter = mInflightRequests.find(reinterpret_cast<AsyncReadRequest*>(cqe->user_data));
+        if (iter == mInflightRequests.end()) {
+            continue;
+        }
+        auto& request = iter->second;
+        request->mResult = cqe->res;
+        request->mDone = true;
+        if (request->mWakeupEvent != nullptr) {
+            mWakeupEvents.push_back(request->mWakeupEvent);
+            request->mWakeupEvent = nullptr;
+        }
+        mInflightRequests.erase(iter);
+    }
+    __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+}
+
+#else
+
+AsyncFileReader::AsyncFileReader() {
+}
+
+AsyncFileReader::~AsyncFileReader() {
+}
+
+shared_ptr<AsyncReadRequest> AsyncFileReader::Submit(int fd, int64_t offset, size_t reserved, size_t size) {
+    return nullptr;
+}
+
+void AsyncFileReader::ReapCompletions() {
+}
+
+#endif
+
+void AsyncFileReader::WaitFor(const shared_ptr<AsyncReadRequest>& request, Event* event) {
+    if (request->mDone) {
+        mWakeupEvents.push_back(event);
+        return;
+    }
+    delete request->mWakeupEvent;
+    request->mWakeupEvent = event;
+}
+
+void AsyncFileReader::Reap(vector<Event*>& wakeupEvents) {
+    if (!IsAvailable()) {
+        return;
+    }
+    ReapCompletions();
+    wakeupEvents.insert(wakeupEvents.end(), mWakeupEvents.begin(), mWakeupEvents.end());
+    mWakeupEvents.clear();
+}
+
+} // namespace logtail
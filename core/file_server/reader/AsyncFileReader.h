@@ -0,0 +1,124 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#if defined(__linux__)
+#include <sys/uio.h>
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/Flags.h"
+#include "common/memory/SourceBuffer.h"
+#include "file_server/event/Event.h"
+
+DECLARE_FLAG_BOOL(enable_async_file_read);
+
+namespace logtail {
+
+struct AsyncReadRequest {
+    AsyncReadRequest() = default;
+    AsyncReadRequest(const AsyncReadRequest&) = delete;
+    AsyncReadRequest& operator=(const AsyncReadRequest&) = delete;
+    ~AsyncReadRequest() { delete mWakeupEvent; }
+
+    int64_t mOffset = 0;
+    // bytes reserved at the beginning of the buffer for the content cached by the reader
+    size_t mReserved = 0;
+    size_t mSize = 0;
+    std::unique_ptr<SourceBuffer> mSourceBuffer;
+    // mReserved + mSize + 1 bytes allocated from mSourceBuffer
+    char* mData = nullptr;
+    // bytes read, or -errno on failure
+    int64_t mResult = 0;
+    bool mDone = false;
+    // event to be pushed back to the event queue when the read completes
+    Event* mWakeupEvent = nullptr;
+#if defined(__linux__)
+    struct iovec mIov;
+#endif
+};
+
+// AsyncFileReader reads files with io_uring, so that a read stuck on a slow volume (e.g. NFS) does not block the log
+// input thread from reading other files. Reads are submitted without waiting, and the modify event of a reader whose
+// read is in flight is pushed back to the event queue once the read completes.
+//
+// It is not available if io_uring is not supported by the kernel or forbidden by seccomp, and readers should fall back
+// to pread.
+//
+// Not thread-safe, only used by the log input thread.
+class AsyncFileReader {
+public:
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    static AsyncFileReader* GetInstance() {
+        static AsyncFileReader instance;
+        return &instance;
+    }
+
+    bool IsAvailable() const { return mRingFd >= 0; }
+
+    // @return nullptr if the request cannot be submitted, e.g. too many reads are in flight.
+    std::shared_ptr<AsyncReadRequest> Submit(int fd, int64_t offset, size_t reserved, size_t size);
+    // Push event back to the event queue once request completes. Ownership of event is taken.
+    void WaitFor(const std::shared_ptr<AsyncReadRequest>& request, Event* event);
+    // Collect completed reads without blocking, and return the events waiting for them.
+    void Reap(std::vector<Event*>& wakeupEvents);
+
+private:
+    AsyncFileReader();
+    ~AsyncFileReader();
+
+    void ReapCompletions();
+#if defined(__linux__)
+    void UnmapRing();
+#endif
+
+    int mRingFd = -1;
+#if defined(__linux__)
+    uint32_t mEntries = 0;
+    void* mSqRing = nullptr;
+    size_t mSqRingSize = 0;
+    void* mCqRing = nullptr;
+    size_t mCqRingSize = 0;
+    void* mSqes = nullptr;
+    size_t mSqesSize = 0;
+
+    uint32_t* mSqHead = nullptr;
+    uint32_t* mSqTail = nullptr;
+    uint32_t* mSqMask = nullptr;
+    uint32_t* mSqArray = nullptr;
+    uint32_t* mCqHead = nullptr;
+    uint32_t* mCqTail = nullptr;
+    uint32_t* mCqMask = nullptr;
+    void* mCqes = nullptr;
+#endif
+
+    // requests are kept alive until completed, since the kernel writes to their buffers
+    std::unordered_map<AsyncReadRequest*, std::shared_ptr<AsyncReadRequest>> mInflightRequests;
+    std::vector<Event*> mWakeupEvents;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class AsyncFileReaderUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -195,6 +195,19 @@ bool FileReaderOptions::Init(const Json::Value& config, const PipelineContext& c
                               ctx.GetRegion());
     }
 
+    // EnableMmapRead
+    if (!GetOptionalBoolParam(config, "EnableMmapRead", mEnableMmapRead, errorMsg)) {
+        PARAM_WARNING_DEFAULT(ctx.GetLogger(),
+                              ctx.GetAlarm(),
+                              errorMsg,
+                              mEnableMmapRead,
+                              pluginType,
+                              ctx.GetConfigName(),
+                              ctx.GetProjectName(),
+                              ctx.GetLogstoreName(),
+                              ctx.GetRegion());
+    }
+
     return true;
 }
 
@@ -42,6 +42,9 @@ struct FileReaderOptions {
     // reader option. If option controlling parser is separated from this, the separated option should be placed in
     // input.
     bool mAppendingLogPositionMeta = false;
+    // Map the file instead of copying it when reading. Only suitable for append-only files, since accessing a mapped
+    // page of a truncated file raises SIGBUS.
+    bool mEnableMmapRead = false;
 
     FileReaderOptions();
 
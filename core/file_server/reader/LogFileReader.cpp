@@ -195,6 +195,7 @@ LogFileReader::LogFileReader(const std::string& hostLogPathDir,
     mConfigName = readerConfig.second->GetConfigName();
     mRegion = readerConfig.second->GetRegion();
     mMetricInited = false;
+    mMmapRead = readerConfig.first->mEnableMmapRead;
 
     BaseLineParse* baseLineParsePtr = nullptr;
     baseLineParsePtr = GetParser<RawTextParser>(0);
@@ -726,12 +727,11 @@ void LogFileReader::FixLastFilePos(LogFileOperator& op, int64_t endOffset) {
             }
         }
     } else {
-        string exception;
+        const MultilineMatcher& matcher = mMultilineConfig.first->GetMatcher();
         for (size_t endPs = 0; endPs < readSizeReal - 1; ++endPs) {
             if (readBuf[endPs] == '\n') {
                 LineInfo line = GetLastLine(StringView(readBuf, readSizeReal - 1), endPs, true);
-                if (BoostRegexSearch(
-                        line.data.data(), line.data.size(), *mMultilineConfig.first->GetStartPatternReg(), exception)) {
+                if (matcher.Match(line.data.data(), line.data.size(), MultilineMatcher::START)) {
                     mLastFilePos += line.lineBegin;
                     mCache.clear();
                     free(readBuf);
@@ -902,7 +902,7 @@ void LogFileReader::skipCheckpointRelayHole() {
     mLastFilePos = readOffset;
 }
 
-bool LogFileReader::ReadLog(LogBuffer& logBuffer, const Event* event) {
+bool LogFileReader::ReadLog(LogBuffer& logBuffer, const Event* event, bool allowAsync) {
     // when event is read timeout and the file cannot be opened, simply flush the cache.
     if (!mLogFileOp.IsOpen() && (event == nullptr || !event->IsReaderFlushTimeout())) {
         if (!ShouldForceReleaseDeletedFileFd()) {
@@ -937,7 +937,8 @@ bool LogFileReader::ReadLog(LogBuffer& logBuffer, const Event* event) {
             return false;
         }
     }
-    bool moreData = GetRawData(logBuffer, mLastFileSize, tryRollback);
+    // force read on flush timeout only consumes the cache, which does not worth an async read
+    bool moreData = GetRawData(logBuffer, mLastFileSize, tryRollback, allowAsync && tryRollback);
     if (!logBuffer.rawBuffer.empty() > 0) {
         if (mEOOption) {
             // This read was replayed by checkpoint, adjust mLastFilePos to skip hole.
@@ -1453,7 +1454,7 @@ bool LogFileReader::GetLogTimeByOffset(const char* buffer,
  * "SingleLineLog_1\nSingleLineLog_2\nSingleLineLog_3\n" -> "SingleLineLog_1\nSingleLineLog_2\nSingleLineLog_3\0"
  * "SingleLineLog_1\nSingleLineLog_2\nxxx" -> "SingleLineLog_1\nSingleLineLog_2\0"
  */
-bool LogFileReader::GetRawData(LogBuffer& logBuffer, int64_t fileSize, bool tryRollback) {
+bool LogFileReader::GetRawData(LogBuffer& logBuffer, int64_t fileSize, bool tryRollback, bool allowAsync) {
     // Truncate, return false to indicate no more data.
     if (fileSize == mLastFilePos) {
         return false;
@@ -1461,9 +1462,9 @@ bool LogFileReader::GetRawData(LogBuffer& logBuffer, int64_t fileSize, bool tryR
 
     bool moreData = false;
     if (mReaderConfig.first->mFileEncoding == FileReaderOptions::Encoding::GBK)
-        ReadGBK(logBuffer, fileSize, moreData, tryRollback);
+        ReadGBK(logBuffer, fileSize, moreData, tryRollback, allowAsync);
     else
-        ReadUTF8(logBuffer, fileSize, moreData, tryRollback);
+        ReadUTF8(logBuffer, fileSize, moreData, tryRollback, allowAsync);
 
     int64_t delta = fileSize - mLastFilePos;
     if (delta > mReaderConfig.first->mReadDelayAlertThresholdBytes && !logBuffer.rawBuffer.empty()) {
@@ -1558,6 +1559,54 @@ size_t LogFileReader::getNextReadSize(int64_t fileEnd, bool& fromCpt) {
     return readSize;
 }
 
+std::shared_ptr<char> LogFileReader::mapNextWindow(size_t size, bool fromCpt) {
+    // exactly once replay reads the length recorded in checkpoint, which may not be backed by the current file
+    if (!mMmapRead || fromCpt || size == 0) {
+        return nullptr;
+    }
+    // touching a mapped page beyond the end of file raises SIGBUS, so the window must lie within the file
+    if (mLogFileOp.GetFileSize() < mLastFilePos + static_cast<int64_t>(size)) {
+        return nullptr;
+    }
+    return mLogFileOp.Mmap(mLastFilePos, size);
+}
+
+bool LogFileReader::readAsync(
+    LogBuffer& logBuffer, int64_t offset, size_t reserved, size_t size, char*& buffer, size_t& nbytes) {
+    AsyncFileReader* asyncReader = AsyncFileReader::GetInstance();
+    if (!asyncReader->IsAvailable()) {
+        return true;
+    }
+    // the request is stale if the reader has moved since submission, e.g. skipped for read delay
+    if (mPendingRead && (mPendingRead->mOffset != offset || mPendingRead->mReserved != reserved)) {
+        mPendingRead.reset();
+    }
+    if (!mPendingRead) {
+        mPendingRead = asyncReader->Submit(mLogFileOp.GetFd(), offset, reserved, size);
+        if (!mPendingRead) {
+            return true;
+        }
+    }
+    if (!mPendingRead->mDone) {
+        return false;
+    }
+
+    std::shared_ptr<AsyncReadRequest> request = std::move(mPendingRead);
+    if (request->mResult < 0) {
+        LOG_ERROR(sLogger,
+                  ("async read fail to read log file", mHostLogPath)("mLastFilePos", mLastFilePos)("size", size)(
+                      "offset", offset)("error", strerror(static_cast<int>(-request->mResult))));
+        nbytes = 0;
+    } else {
+        nbytes = static_cast<size_t>(request->mResult);
+    }
+    // events reference the buffer, so it is handed over to the log buffer
+    logBuffer.sourcebuffer = std::move(request->mSourceBuffer);
+    buffer = request->mData;
+    buffer[reserved + nbytes] = '\0';
+    return true;
+}
+
 void LogFileReader::setExactlyOnceCheckpointAfterRead(size_t readSize) {
     if (!mEOOption || readSize == 0) {
         return;
@@ -1568,9 +1617,11 @@ void LogFileReader::setExactlyOnceCheckpointAfterRead(size_t readSize) {
     cpt.set_read_length(readSize);
 }
 
-void LogFileReader::ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback) {
+void LogFileReader::ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback, bool allowAsync) {
     char* stringBuffer = nullptr;
     size_t nbytes = 0;
+    std::shared_ptr<char> mappedWindow;
+    const char* mappedEnd = nullptr;
 
     logBuffer.readOffset = mLastFilePos;
     if (!mLogFileOp.IsOpen()) {
@@ -1603,17 +1654,32 @@ void LogFileReader::ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData,
         if (READ_BYTE < lastCacheSize) {
             READ_BYTE = lastCacheSize; // this should not happen, just avoid READ_BYTE >= 0 theoratically
         }
-        StringBuffer stringMemory
-            = logBuffer.sourcebuffer->AllocateStringBuffer(READ_BYTE); // allocate modifiable buffer
-        if (lastCacheSize) {
-            READ_BYTE -= lastCacheSize; // reserve space to copy from cache if needed
-        }
         TruncateInfo* truncateInfo = nullptr;
         int64_t lastReadPos = GetLastReadPos();
-        nbytes = READ_BYTE
-            ? ReadFile(mLogFileOp, stringMemory.data + lastCacheSize, READ_BYTE, lastReadPos, &truncateInfo)
-            : 0UL;
-        stringBuffer = stringMemory.data;
+        mappedWindow = mapNextWindow(READ_BYTE, fromCpt);
+        if (mappedWindow) {
+            stringBuffer = mappedWindow.get();
+            mappedEnd = stringBuffer + READ_BYTE;
+            nbytes = READ_BYTE - lastCacheSize;
+        } else {
+            if (allowAsync && !fromCpt && READ_BYTE > lastCacheSize
+                && !readAsync(
+                    logBuffer, lastReadPos, lastCacheSize, READ_BYTE - lastCacheSize, stringBuffer, nbytes)) {
+                moreData = true;
+                return;
+            }
+            if (stringBuffer == nullptr) {
+                StringBuffer stringMemory
+                    = logBuffer.sourcebuffer->AllocateStringBuffer(READ_BYTE); // allocate modifiable buffer
+                if (lastCacheSize) {
+                    READ_BYTE -= lastCacheSize; // reserve space to copy from cache if needed
+                }
+                nbytes = READ_BYTE
+                    ? ReadFile(mLogFileOp, stringMemory.data + lastCacheSize, READ_BYTE, lastReadPos, &truncateInfo)
+                    : 0UL;
+                stringBuffer = stringMemory.data;
+            }
+        }
         bool allowRollback = true;
         // Only when there is no new log and not try rollback, then force read
         if (!tryRollback && nbytes == 0) {
@@ -1624,7 +1690,9 @@ void LogFileReader::ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData,
             return;
         }
         if (lastCacheSize) {
-            memcpy(stringBuffer, mCache.data(), lastCacheSize); // copy from cache
+            if (!mappedWindow) {
+                memcpy(stringBuffer, mCache.data(), lastCacheSize); // copy from cache
+            }
             nbytes += lastCacheSize;
         }
         // Ignore \n if last is force read
@@ -1691,6 +1759,15 @@ void LogFileReader::ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData,
                 == '\0')) { // \0 is for json, such behavior make ilogtail not able to collect binary log
         --stringLen;
     }
+    if (mappedWindow) {
+        if (stringBuffer + stringLen < mappedEnd) {
+            // the mapping is private, so terminating the string in place does not modify the file
+            logBuffer.sourcebuffer->PinRegion(std::move(mappedWindow));
+        } else {
+            // no room left in the window for the terminator, which only happens when the whole window is forced out
+            stringBuffer = logBuffer.sourcebuffer->CopyString(stringBuffer, stringLen).data;
+        }
+    }
     stringBuffer[stringLen] = '\0';
 
     logBuffer.rawBuffer = StringView(stringBuffer, stringLen); // set readable buffer
@@ -1701,7 +1778,7 @@ void LogFileReader::ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData,
     LOG_DEBUG(sLogger, ("read size", nbytes)("last file pos", mLastFilePos));
 }
 
-void LogFileReader::ReadGBK(LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback) {
+void LogFileReader::ReadGBK(LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback, bool allowAsync) {
     std::unique_ptr<char[]> gbkMemory;
     char* gbkBuffer = nullptr;
     size_t readCharCount = 0, originReadCount = 0;
@@ -1734,15 +1811,24 @@ void LogFileReader::ReadGBK(LogBuffer& logBuffer, int64_t end, bool& moreData, b
         if (READ_BYTE < lastCacheSize) {
             READ_BYTE = lastCacheSize; // this should not happen, just avoid READ_BYTE >= 0 theoratically
         }
-        gbkMemory.reset(new char[READ_BYTE + 1]);
-        gbkBuffer = gbkMemory.get();
-        if (lastCacheSize) {
-            READ_BYTE -= lastCacheSize; // reserve space to copy from cache if needed
-        }
         TruncateInfo* truncateInfo = nullptr;
         lastReadPos = GetLastReadPos();
-        readCharCount
-            = READ_BYTE ? ReadFile(mLogFileOp, gbkBuffer + lastCacheSize, READ_BYTE, lastReadPos, &truncateInfo) : 0UL;
+        if (allowAsync && !fromCpt && READ_BYTE > lastCacheSize
+            && !readAsync(
+                logBuffer, lastReadPos, lastCacheSize, READ_BYTE - lastCacheSize, gbkBuffer, readCharCount)) {
+            moreData = true;
+            return;
+        }
+        if (gbkBuffer == nullptr) {
+            gbkMemory.reset(new char[READ_BYTE + 1]);
+            gbkBuffer = gbkMemory.get();
+            if (lastCacheSize) {
+                READ_BYTE -= lastCacheSize; // reserve space to copy from cache if needed
+            }
+            readCharCount = READ_BYTE
+                ? ReadFile(mLogFileOp, gbkBuffer + lastCacheSize, READ_BYTE, lastReadPos, &truncateInfo)
+                : 0UL;
+        }
         // Only when there is no new log and not try rollback, then force read
         if (!tryRollback && readCharCount == 0) {
             allowRollback = false;
@@ -1789,9 +1875,12 @@ void LogFileReader::ReadGBK(LogBuffer& logBuffer, int64_t end, bool& moreData, b
     gbkBuffer[readCharCount] = '\0';
 
     vector<long> lineFeedPos = {-1}; // elements point to the last char of each line
-    for (long idx = 0; idx < long(readCharCount - 1); ++idx) {
-        if (gbkBuffer[idx] == '\n')
-            lineFeedPos.push_back(idx);
+    const char* lineEnd = gbkBuffer;
+    const char* searchEnd = gbkBuffer + readCharCount - 1;
+    while (lineEnd < searchEnd
+           && (lineEnd = static_cast<const char*>(memchr(lineEnd, '\n', searchEnd - lineEnd))) != nullptr) {
+        lineFeedPos.push_back(lineEnd - gbkBuffer);
+        ++lineEnd;
     }
     lineFeedPos.push_back(readCharCount - 1);
 
@@ -2004,25 +2093,18 @@ LogFileReader::RemoveLastIncompleteLog(char* buffer, int32_t size, int32_t& roll
     rollbackLineFeedCount = 0;
     // Multiline rollback
     if (mMultilineConfig.first->IsMultiline()) {
-        std::string exception;
+        const MultilineMatcher& matcher = mMultilineConfig.first->GetMatcher();
         while (endPs >= 0) {
             LineInfo content = GetLastLine(StringView(buffer, size), endPs, false);
             if (mMultilineConfig.first->GetEndPatternReg()) {
                 // start + end, continue + end, end
-                if (BoostRegexSearch(content.data.data(),
-                                     content.data.size(),
-                                     *mMultilineConfig.first->GetEndPatternReg(),
-                                     exception)) {
+                if (matcher.Match(content.data.data(), content.data.size(), MultilineMatcher::END)) {
                     // Ensure the end line is complete
                     if (buffer[content.lineEnd] == '\n') {
                         return content.lineEnd + 1;
                     }
                 }
-            } else if (mMultilineConfig.first->GetStartPatternReg()
-                       && BoostRegexSearch(content.data.data(),
-                                           content.data.size(),
-                                           *mMultilineConfig.first->GetStartPatternReg(),
-                                           exception)) {
+            } else if (matcher.Match(content.data.data(), content.data.size(), MultilineMatcher::START)) {
                 // start + continue, start
                 rollbackLineFeedCount += content.rollbackLineFeedCount;
                 // Keep all the buffer if rollback all
@@ -40,6 +40,7 @@
 #include "models/StringView.h"
 #include "pipeline/queue/QueueKey.h"
 #include "rapidjson/allocators.h"
+#include "file_server/reader/AsyncFileReader.h"
 #include "file_server/reader/FileReaderOptions.h"
 
 namespace logtail {
@@ -187,7 +188,9 @@ public:
                   const FileReaderConfig& readerConfig,
                   const MultilineConfig& multilineConfig);
 
-    bool ReadLog(LogBuffer& logBuffer, const Event* event);
+    // @param allowAsync: read with AsyncFileReader if available, in which case nothing is read if the read is still in
+    //   flight, and IsReadPending() returns true.
+    bool ReadLog(LogBuffer& logBuffer, const Event* event, bool allowAsync = false);
     time_t GetLastUpdateTime() const // actually it's the time whenever ReadLogs is called
     {
         return mLastUpdateTime;
@@ -261,6 +264,8 @@ public:
             mFirstWatched = false;
         mLastFilePos = pos;
     }
+    bool IsReadPending() const { return mPendingRead && !mPendingRead->mDone; }
+    const std::shared_ptr<AsyncReadRequest>& GetPendingRead() const { return mPendingRead; }
     void
     InitReader(bool tailExisted = false, FileReadPolicy policy = BACKWARD_TO_FIXED_POS, uint32_t eoConcurrency = 0);
 
@@ -445,9 +450,11 @@ public:
     void ReportMetrics(uint64_t readSize);
 
 protected:
-    bool GetRawData(LogBuffer& logBuffer, int64_t fileSize, bool tryRollback = true);
-    void ReadUTF8(LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback = true);
-    void ReadGBK(LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback = true);
+    bool GetRawData(LogBuffer& logBuffer, int64_t fileSize, bool tryRollback = true, bool allowAsync = false);
+    void ReadUTF8(
+        LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback = true, bool allowAsync = false);
+    void ReadGBK(
+        LogBuffer& logBuffer, int64_t end, bool& moreData, bool tryRollback = true, bool allowAsync = false);
 
     size_t
     ReadFile(LogFileOperator& logFileOp, void* buf, size_t size, int64_t& offset, TruncateInfo** truncateInfo = NULL);
@@ -486,6 +493,8 @@ protected:
     // boost::regex* mLogEndRegPtr;
     // int mReaderFlushTimeout;
     bool mLastForceRead = false;
+    bool mMmapRead = false;
+    std::shared_ptr<AsyncReadRequest> mPendingRead;
     // FileEncoding mFileEncoding;
     // bool mDiscardUnmatch;
     // LogType mLogType;
@@ -601,6 +610,19 @@ private:
     // Update current checkpoint's read offset and length after success read.
     void setExactlyOnceCheckpointAfterRead(size_t readSize);
 
+    // Map the next size bytes of the file starting from mLastFilePos when mmap read is enabled.
+    //
+    // The content cached in mCache always equals to the file content at mLastFilePos, so the window covers the cache
+    // as well and no copy is needed.
+    // @return nullptr if mmap read is disabled or the window cannot be mapped safely, in which case pread is used.
+    std::shared_ptr<char> mapNextWindow(size_t size, bool fromCpt);
+
+    // Read size bytes at offset with AsyncFileReader, into a buffer with reserved bytes ahead for the cache.
+    //
+    // @return false if the read is still in flight. Otherwise, buffer points to the data read, or is left nullptr if
+    //   the read cannot be submitted, in which case pread should be used instead.
+    bool readAsync(LogBuffer& logBuffer, int64_t offset, size_t reserved, size_t size, char*& buffer, size_t& nbytes);
+
     // Return primary key of current reader by combining meta.
     //
     // Conflict resolve: file signature will be stored in primary checkpoint.
@@ -68,6 +68,22 @@ void LogEvent::SetContentNoCopy(StringView key, StringView val) {
     }
 }
 
+void LogEvent::SetContentsNoCopy(const vector<LogContent>& contents) {
+    mContents.reserve(mContents.size() + contents.size());
+    for (const auto& content : contents) {
+        auto res = mIndex.try_emplace(content.first, mContents.size());
+        if (res.second) {
+            mAllocatedContentSize += content.first.size() + content.second.size();
+            mContents.emplace_back(content, true);
+        } else {
+            auto& field = mContents[res.first->second].first;
+            mAllocatedContentSize += content.first.size() + content.second.size() - field.first.size()
+                - field.second.size();
+            field = content;
+        }
+    }
+}
+
 void LogEvent::DelContent(StringView key) {
     auto it = mIndex.find(key);
     if (it != mIndex.end()) {
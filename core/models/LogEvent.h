@@ -79,6 +79,8 @@ public:
     void SetContent(const StringBuffer& key, StringView val);
     void SetContentNoCopy(const StringBuffer& key, const StringBuffer& val);
     void SetContentNoCopy(StringView key, StringView val);
+    // same as calling SetContentNoCopy for each content in order, with one index lookup per content
+    void SetContentsNoCopy(const std::vector<LogContent>& contents);
     void DelContent(StringView key);
 
     void SetPosition(uint32_t offset, uint32_t size) {
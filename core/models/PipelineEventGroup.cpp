@@ -17,6 +17,7 @@
 #include "models/PipelineEventGroup.h"
 
 #include <sstream>
+#include <string_view>
 
 #include "common/HashUtil.h"
 #include "logger/Logger.h"
@@ -30,7 +31,11 @@ PipelineEventGroup::PipelineEventGroup(PipelineEventGroup&& rhs) noexcept
     : mMetadata(std::move(rhs.mMetadata)),
       mTags(std::move(rhs.mTags)),
       mEvents(std::move(rhs.mEvents)),
-      mSourceBuffer(std::move(rhs.mSourceBuffer)) {
+      mSourceBuffer(std::move(rhs.mSourceBuffer)),
+      mTagsHash(rhs.mTagsHash),
+      mTagsHashValid(rhs.mTagsHashValid) {
+    rhs.mTagsHash = 0;
+    rhs.mTagsHashValid = false;
     for (auto& item : mEvents) {
         item->ResetPipelineEventGroup(this);
     }
@@ -42,6 +47,10 @@ PipelineEventGroup& PipelineEventGroup::operator=(PipelineEventGroup&& rhs) noex
         mTags = std::move(rhs.mTags);
         mEvents = std::move(rhs.mEvents);
         mSourceBuffer = std::move(rhs.mSourceBuffer);
+        mTagsHash = rhs.mTagsHash;
+        mTagsHashValid = rhs.mTagsHashValid;
+        rhs.mTagsHash = 0;
+        rhs.mTagsHashValid = false;
         for (auto& item : mEvents) {
             item->ResetPipelineEventGroup(this);
         }
@@ -54,6 +63,8 @@ PipelineEventGroup PipelineEventGroup::Copy() const {
     res.mMetadata = mMetadata;
     res.mTags = mTags;
     res.mExactlyOnceCheckpoint = mExactlyOnceCheckpoint;
+    res.mTagsHash = mTagsHash;
+    res.mTagsHashValid = mTagsHashValid;
     for (auto& event : mEvents) {
         res.mEvents.emplace_back(event.Copy());
         res.mEvents.back()->ResetPipelineEventGroup(&res);
@@ -146,9 +157,31 @@ bool PipelineEventGroup::HasTag(StringView key) const {
 }
 
 void PipelineEventGroup::SetTagNoCopy(StringView key, StringView val) {
+    if (mTagsHashValid) {
+        auto it = mTags.mInner.find(key);
+        if (it != mTags.mInner.end()) {
+            mTagsHash -= HashTag(it->first, it->second);
+        }
+        mTagsHash += HashTag(key, val);
+    }
     mTags.Insert(key, val);
 }
 
+void PipelineEventGroup::SetTagsNoCopy(const TagSet& tags) {
+    for (const auto& tag : tags.GetTags()) {
+        if (mTagsHashValid) {
+            auto it = mTags.mInner.find(tag.first);
+            if (it != mTags.mInner.end()) {
+                mTagsHash -= HashTag(it->first, it->second);
+            }
+        }
+        mTags.Insert(tag.first, tag.second);
+    }
+    if (mTagsHashValid) {
+        mTagsHash += tags.GetHash();
+    }
+}
+
 StringView PipelineEventGroup::GetTag(StringView key) const {
     auto it = mTags.mInner.find(key);
     if (it != mTags.mInner.end()) {
@@ -158,16 +191,27 @@ StringView PipelineEventGroup::GetTag(StringView key) const {
 }
 
 void PipelineEventGroup::DelTag(StringView key) {
+    auto it = mTags.mInner.find(key);
+    if (it == mTags.mInner.end()) {
+        return;
+    }
+    if (mTagsHashValid) {
+        mTagsHash -= HashTag(it->first, it->second);
+    }
     mTags.Erase(key);
 }
 
 size_t PipelineEventGroup::GetTagsHash() const {
-    size_t seed = 0;
-    for (const auto& item : mTags.mInner) {
-        HashCombine(seed, hash<string>{}(item.first.to_string()));
-        HashCombine(seed, hash<string>{}(item.second.to_string()));
+    if (!mTagsHashValid) {
+        mTagsHash = 0;
+        for (const auto& item : mTags.mInner) {
+            mTagsHash += HashTag(item.first, item.second);
+        }
+        mTagsHashValid = true;
     }
-    HashCombine(seed, hash<string>{}(GetMetadata(EventGroupMetaKey::SOURCE_ID).to_string()));
+    StringView sourceId = GetMetadata(EventGroupMetaKey::SOURCE_ID);
+    size_t seed = mTagsHash;
+    HashCombine(seed, hash<string_view>{}(string_view(sourceId.data(), sourceId.size())));
     return seed;
 }
 
@@ -23,6 +23,7 @@
 #include "common/Constants.h"
 #include "common/memory/SourceBuffer.h"
 #include "models/PipelineEventPtr.h"
+#include "models/TagInterner.h"
 
 namespace logtail {
 
@@ -105,11 +106,18 @@ public:
     void SetTagNoCopy(const StringBuffer& key, const StringBuffer& val);
     StringView GetTag(StringView key) const;
     const GroupTags& GetTags() const { return mTags.mInner; };
-    SizedMap& GetSizedTags() { return mTags; };
+    // tags may be changed through the returned map, so the tags hash is recomputed on next GetTagsHash
+    SizedMap& GetSizedTags() {
+        mTagsHashValid = false;
+        return mTags;
+    };
     bool HasTag(StringView key) const;
     void SetTagNoCopy(StringView key, StringView val);
+    // add tags of the set without copying them, and add its precomputed hash to the tags hash
+    void SetTagsNoCopy(const TagSet& tags);
     void DelTag(StringView key);
 
+    // hash of tags and source id, tags hash is kept up to date as tags change so that only source id is hashed here
     size_t GetTagsHash() const;
 
     void SetExactlyOnceCheckpoint(const RangeCheckpointPtr& checkpoint) { mExactlyOnceCheckpoint = checkpoint; }
@@ -132,6 +140,13 @@ private:
     EventsContainer mEvents;
     std::shared_ptr<SourceBuffer> mSourceBuffer;
     RangeCheckpointPtr mExactlyOnceCheckpoint;
+    // sum of HashTag of all tags, valid unless the tags are changed through GetSizedTags
+    mutable size_t mTagsHash = 0;
+    mutable bool mTagsHashValid = true;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class PipelineEventGroupUnittest;
+#endif
 };
 
 } // namespace logtail
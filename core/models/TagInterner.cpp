@@ -0,0 +1,65 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "models/TagInterner.h"
+
+#include "common/HashUtil.h"
+
+using namespace std;
+
+namespace logtail {
+
+StringView TagInterner::Intern(StringView str) {
+    lock_guard<mutex> lock(mMux);
+    auto iter = mStrings.find(string_view(str.data(), str.size()));
+    if (iter == mStrings.end()) {
+        auto copy = make_unique<string>(str.data(), str.size());
+        string_view key(*copy);
+        iter = mStrings.emplace(key, std::move(copy)).first;
+    }
+    return StringView(iter->second->data(), iter->second->size());
+}
+
+size_t TagInterner::Size() const {
+    lock_guard<mutex> lock(mMux);
+    return mStrings.size();
+}
+
+size_t HashTag(StringView key, StringView val) {
+    // string_view hashes the same as string, without copying
+    size_t seed = hash<string_view>{}(string_view(key.data(), key.size()));
+    HashCombine(seed, hash<string_view>{}(string_view(val.data(), val.size())));
+    return seed;
+}
+
+void TagSet::Add(StringView key, StringView val) {
+    StringView internedVal = TagInterner::GetInstance()->Intern(val);
+    for (auto& tag : mTags) {
+        if (tag.first == key) {
+            mHash -= HashTag(tag.first, tag.second);
+            tag.second = internedVal;
+            mHash += HashTag(tag.first, tag.second);
+            return;
+        }
+    }
+    mTags.emplace_back(TagInterner::GetInstance()->Intern(key), internedVal);
+    mHash += HashTag(mTags.back().first, mTags.back().second);
+}
+
+void TagSet::Clear() {
+    mTags.clear();
+    mHash = 0;
+}
+
+} // namespace logtail
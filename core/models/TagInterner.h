@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "models/StringView.h"
+
+namespace logtail {
+
+// TagInterner keeps one process-wide copy of each distinct tag key or value added to groups by the agent itself (e.g.
+// hostname, machine uuid and file tags), so that groups can refer to them with SetTagNoCopy instead of copying them
+// into their own source buffers. Interned strings are never released, so only values from a small set should be
+// interned.
+class TagInterner {
+public:
+    TagInterner(const TagInterner&) = delete;
+    TagInterner& operator=(const TagInterner&) = delete;
+
+    static TagInterner* GetInstance() {
+        static TagInterner instance;
+        return &instance;
+    }
+
+    // @return view of the interned copy of str, which is valid until exit.
+    StringView Intern(StringView str);
+
+    size_t Size() const;
+
+private:
+    TagInterner() = default;
+    ~TagInterner() = default;
+
+    mutable std::mutex mMux;
+    // keys are views of the strings owned by values
+    std::unordered_map<std::string_view, std::unique_ptr<std::string>> mStrings;
+};
+
+// hash of one tag. The tags hash of a group is the sum of the hashes of its tags, so that it can be kept up to date as
+// tags are set or deleted, whatever the order.
+size_t HashTag(StringView key, StringView val);
+
+// TagSet is a set of interned tags shared by many groups, e.g. the agent level tags added by ProcessorTagNative. Its
+// hash is computed once when the set is built, so that groups add it to their tags hash without hashing each tag.
+class TagSet {
+public:
+    // the tag is interned, and replaces the former tag with the same key if any
+    void Add(StringView key, StringView val);
+    void Clear();
+
+    const std::vector<std::pair<StringView, StringView>>& GetTags() const { return mTags; }
+    size_t GetHash() const { return mHash; }
+
+private:
+    std::vector<std::pair<StringView, StringView>> mTags;
+    size_t mHash = 0;
+};
+
+} // namespace logtail
@@ -14,8 +14,11 @@
 
 #include "LogtailMetric.h"
 
+#include <array>
+
 #include "MetricConstants.h"
 #include "app_config/AppConfig.h"
+#include "common/Flags.h"
 #include "common/StringTools.h"
 #include "common/TimeUtil.h"
 #include "logger/Logger.h"
@@ -23,8 +26,42 @@
 
 using namespace sls_logs;
 
+DEFINE_FLAG_INT32(stage_latency_sample_interval,
+                  "time one out of every n event groups for stage latency histograms, 0 means disabled",
+                  8);
+
 namespace logtail {
 
+namespace {
+// histograms are exported as flat key-value pairs: count, sum and one entry for each non-empty bucket
+void FlattenHistogram(const HistogramPtr& histogram, std::vector<std::pair<std::string, std::string>>& res) {
+    res.emplace_back(VALUE_PREFIX + histogram->GetName() + "_count", ToString(histogram->GetCount()));
+    res.emplace_back(VALUE_PREFIX + histogram->GetName() + "_sum", ToString(histogram->GetSum()));
+    for (size_t i = 0; i < Histogram::sBucketCnt; ++i) {
+        uint64_t cnt = histogram->GetBucketCount(i);
+        if (cnt == 0) {
+            continue;
+        }
+        std::string bound = i + 1 == Histogram::sBucketCnt ? "inf" : ToString(Histogram::GetBucketUpperBound(i));
+        res.emplace_back(VALUE_PREFIX + histogram->GetName() + "_bucket_lt_" + bound, ToString(cnt));
+    }
+}
+} // namespace
+
+bool ShouldSampleStageLatency(LatencyStage stage) {
+    static thread_local std::array<uint32_t, static_cast<size_t>(LatencyStage::COUNT)> sCnts{};
+    int32_t interval = INT32_FLAG(stage_latency_sample_interval);
+    if (interval <= 0) {
+        return false;
+    }
+    uint32_t& cnt = sCnts[static_cast<size_t>(stage)];
+    if (++cnt >= static_cast<uint32_t>(interval)) {
+        cnt = 0;
+        return true;
+    }
+    return false;
+}
+
 MetricsRecord::MetricsRecord(MetricLabelsPtr labels, DynamicMetricLabelsPtr dynamicLabels)
     : mLabels(labels), mDynamicLabels(dynamicLabels), mDeleted(false) {
 }
@@ -47,6 +84,12 @@ DoubleGaugePtr MetricsRecord::CreateDoubleGauge(const std::string& name) {
     return gaugePtr;
 }
 
+HistogramPtr MetricsRecord::CreateHistogram(const std::string& name) {
+    HistogramPtr histogramPtr = std::make_shared<Histogram>(name);
+    mHistograms.emplace_back(histogramPtr);
+    return histogramPtr;
+}
+
 void MetricsRecord::MarkDeleted() {
     mDeleted = true;
 }
@@ -75,6 +118,10 @@ const std::vector<DoubleGaugePtr>& MetricsRecord::GetDoubleGauges() const {
     return mDoubleGauges;
 }
 
+const std::vector<HistogramPtr>& MetricsRecord::GetHistograms() const {
+    return mHistograms;
+}
+
 MetricsRecord* MetricsRecord::Collect() {
     MetricsRecord* metrics = new MetricsRecord(mLabels, mDynamicLabels);
     for (auto& item : mCounters) {
@@ -89,6 +136,10 @@ MetricsRecord* MetricsRecord::Collect() {
         DoubleGaugePtr newPtr(item->Collect());
         metrics->mDoubleGauges.emplace_back(newPtr);
     }
+    for (auto& item : mHistograms) {
+        HistogramPtr newPtr(item->Collect());
+        metrics->mHistograms.emplace_back(newPtr);
+    }
     return metrics;
 }
 
@@ -130,6 +181,10 @@ DoubleGaugePtr MetricsRecordRef::CreateDoubleGauge(const std::string& name) {
     return mMetrics->CreateDoubleGauge(name);
 }
 
+HistogramPtr MetricsRecordRef::CreateHistogram(const std::string& name) {
+    return mMetrics->CreateHistogram(name);
+}
+
 const MetricsRecord* MetricsRecordRef::operator->() const {
     return mMetrics;
 }
@@ -148,6 +203,9 @@ void ReentrantMetricsRecord::Init(MetricLabels& labels, std::unordered_map<std::
             case MetricType::METRIC_TYPE_DOUBLE_GAUGE:
                 mDoubleGauges[metric.first] = mMetricsRecordRef.CreateDoubleGauge(metric.first);
                 break;
+            case MetricType::METRIC_TYPE_HISTOGRAM:
+                mHistograms[metric.first] = mMetricsRecordRef.CreateHistogram(metric.first);
+                break;
             default:
                 break;
         }
@@ -186,6 +244,14 @@ DoubleGaugePtr ReentrantMetricsRecord::GetDoubleGauge(const std::string& name) {
     return nullptr;
 }
 
+HistogramPtr ReentrantMetricsRecord::GetHistogram(const std::string& name) {
+    auto it = mHistograms.find(name);
+    if (it != mHistograms.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
 WriteMetrics::~WriteMetrics() {
     Clear();
 }
@@ -387,6 +453,15 @@ void ReadMetrics::ReadAsLogGroup(std::map<std::string, sls_logs::LogGroup*>& log
             contentPtr->set_key(VALUE_PREFIX + gauge->GetName());
             contentPtr->set_value(ToString(gauge->GetValue()));
         }
+        for (auto& item : tmp->GetHistograms()) {
+            std::vector<std::pair<std::string, std::string>> pairs;
+            FlattenHistogram(item, pairs);
+            for (auto& pair : pairs) {
+                Log_Content* contentPtr = logPtr->add_contents();
+                contentPtr->set_key(pair.first);
+                contentPtr->set_value(pair.second);
+            }
+        }
         tmp = tmp->GetNext();
     }
 }
@@ -427,6 +502,14 @@ void ReadMetrics::ReadAsFileBuffer(std::string& metricsContent) const {
             metricsRecordValue[VALUE_PREFIX + gauge->GetName()] = ToString(gauge->GetValue());
         }
 
+        for (auto& item : tmp->GetHistograms()) {
+            std::vector<std::pair<std::string, std::string>> pairs;
+            FlattenHistogram(item, pairs);
+            for (auto& pair : pairs) {
+                metricsRecordValue[pair.first] = pair.second;
+            }
+        }
+
         Json::StreamWriterBuilder writer;
         writer["indentation"] = "";
         std::string jsonString = Json::writeString(writer, metricsRecordValue);
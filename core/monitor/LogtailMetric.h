@@ -32,6 +32,7 @@ private:
     std::vector<CounterPtr> mCounters;
     std::vector<IntGaugePtr> mIntGauges;
     std::vector<DoubleGaugePtr> mDoubleGauges;
+    std::vector<HistogramPtr> mHistograms;
     MetricsRecord* mNext = nullptr;
 
 public:
@@ -44,9 +45,11 @@ public:
     const std::vector<CounterPtr>& GetCounters() const;
     const std::vector<IntGaugePtr>& GetIntGauges() const;
     const std::vector<DoubleGaugePtr>& GetDoubleGauges() const;
+    const std::vector<HistogramPtr>& GetHistograms() const;
     CounterPtr CreateCounter(const std::string& name);
     IntGaugePtr CreateIntGauge(const std::string& name);
     DoubleGaugePtr CreateDoubleGauge(const std::string& name);
+    HistogramPtr CreateHistogram(const std::string& name);
     MetricsRecord* Collect();
     void SetNext(MetricsRecord* next);
     MetricsRecord* GetNext() const;
@@ -69,6 +72,7 @@ public:
     CounterPtr CreateCounter(const std::string& name);
     IntGaugePtr CreateIntGauge(const std::string& name);
     DoubleGaugePtr CreateDoubleGauge(const std::string& name);
+    HistogramPtr CreateHistogram(const std::string& name);
     const MetricsRecord* operator->() const;
 };
 
@@ -78,6 +82,7 @@ private:
     std::unordered_map<std::string, CounterPtr> mCounters;
     std::unordered_map<std::string, IntGaugePtr> mIntGauges;
     std::unordered_map<std::string, DoubleGaugePtr> mDoubleGauges;
+    std::unordered_map<std::string, HistogramPtr> mHistograms;
 
 public:
     void Init(MetricLabels& labels, std::unordered_map<std::string, MetricType>& metricKeys);
@@ -86,6 +91,7 @@ public:
     CounterPtr GetCounter(const std::string& name);
     IntGaugePtr GetIntGauge(const std::string& name);
     DoubleGaugePtr GetDoubleGauge(const std::string& name);
+    HistogramPtr GetHistogram(const std::string& name);
 };
 using ReentrantMetricsRecordRef = std::shared_ptr<ReentrantMetricsRecord>;
 
@@ -144,4 +150,11 @@ public:
     friend class ILogtailMetricUnittest;
 #endif
 };
+enum class LatencyStage { PROCESS, PROCESS_QUEUE, SENDER_QUEUE, COUNT };
+
+// Returns true once every stage_latency_sample_interval calls for the given stage on the calling thread. Used to decide
+// whether the current event group should be timed for stage latency histograms without touching any shared state. Each
+// stage has its own counter, so that a fixed call pattern across stages cannot keep one of them from being sampled.
+bool ShouldSampleStageLatency(LatencyStage stage);
+
 } // namespace logtail
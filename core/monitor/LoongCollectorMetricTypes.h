@@ -15,8 +15,18 @@
  */
 
 #pragma once
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <thread>
 
 #include "common/Lock.h"
 #include "protobuf/sls/sls_logs.pb.h"
@@ -28,19 +38,70 @@ enum class MetricType {
     METRIC_TYPE_COUNTER,
     METRIC_TYPE_INT_GAUGE,
     METRIC_TYPE_DOUBLE_GAUGE,
+    METRIC_TYPE_HISTOGRAM,
 };
 
+// Index of the metric shard used by the current thread. Threads are assigned to shards round-robin on first use.
+inline size_t GetMetricShardIndex() {
+    static std::atomic_size_t sNextIdx{0};
+    static thread_local size_t sIdx = sNextIdx.fetch_add(1, std::memory_order_relaxed);
+    return sIdx;
+}
+
+// Counter is updated by many threads per event, so its value is sharded by thread with each shard on its own cache
+// line, and shards are only summed up on collection. Updates are relaxed since counters order nothing.
+// Shards are sized from the hardware concurrency, up to sMaxShardCnt, while counters collected have a single shard.
 class Counter {
+public:
+    static constexpr size_t sMaxShardCnt = 16;
+
+    // power of two not less than the hardware concurrency, capped by sMaxShardCnt
+    static size_t GetDefaultShardCnt() {
+        static const size_t sCnt = []() {
+            size_t threadCnt = std::max(1U, std::thread::hardware_concurrency());
+            size_t cnt = 1;
+            while (cnt < threadCnt && cnt < sMaxShardCnt) {
+                cnt <<= 1;
+            }
+            return cnt;
+        }();
+        return sCnt;
+    }
+
 private:
+    struct alignas(64) Shard {
+        std::atomic_uint64_t mVal{0};
+    };
+
     std::string mName;
-    std::atomic_uint64_t mVal;
+    size_t mShardMask;
+    std::unique_ptr<Shard[]> mShards;
 
 public:
-    Counter(const std::string& name, uint64_t val = 0) : mName(name), mVal(val) {}
-    uint64_t GetValue() const { return mVal.load(); }
+    Counter(const std::string& name, uint64_t val = 0, size_t shardCnt = GetDefaultShardCnt())
+        : mName(name), mShardMask(shardCnt - 1), mShards(new Shard[shardCnt]) {
+        mShards[0].mVal.store(val, std::memory_order_relaxed);
+    }
+    uint64_t GetValue() const {
+        uint64_t res = 0;
+        for (size_t i = 0; i <= mShardMask; ++i) {
+            res += mShards[i].mVal.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
     const std::string& GetName() const { return mName; }
-    void Add(uint64_t val) { mVal.fetch_add(val); }
-    Counter* Collect() { return new Counter(mName, mVal.exchange(0)); }
+    size_t GetShardCnt() const { return mShardMask + 1; }
+    void Add(uint64_t val) {
+        mShards[GetMetricShardIndex() & mShardMask].mVal.fetch_add(val, std::memory_order_relaxed);
+    }
+    Counter* Collect() {
+        uint64_t res = 0;
+        for (size_t i = 0; i <= mShardMask; ++i) {
+            res += mShards[i].mVal.exchange(0, std::memory_order_relaxed);
+        }
+        // the snapshot is only read, so it needs no more than one shard
+        return new Counter(mName, res, 1);
+    }
 };
 
 template <typename T>
@@ -57,9 +118,83 @@ public:
     Gauge* Collect() { return new Gauge<T>(mName, mVal.load()); }
 };
 
+// Histogram with log-linear buckets: each power-of-two range [2^k, 2^(k+1)) is split into sSubBucketCnt buckets of
+// equal width, so that the relative error of a bucket is bounded by 1 / sSubBucketCnt, while values less than
+// sSubBucketCnt have their own buckets. Updates are lock-free and relaxed.
+// Like Counter, Collect() returns the delta since the last collection.
+class Histogram {
+public:
+    static constexpr size_t sSubBucketBits = 2;
+    static constexpr size_t sSubBucketCnt = static_cast<size_t>(1) << sSubBucketBits;
+    static constexpr size_t sBucketCnt = (64 - sSubBucketBits + 1) * sSubBucketCnt;
+
+private:
+    std::string mName;
+    std::atomic_uint64_t mCount;
+    std::atomic_uint64_t mSum;
+    std::array<std::atomic_uint64_t, sBucketCnt> mBuckets;
+
+public:
+    Histogram(const std::string& name) : mName(name), mCount(0), mSum(0) {
+        for (auto& bucket : mBuckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+    const std::string& GetName() const { return mName; }
+    uint64_t GetCount() const { return mCount.load(std::memory_order_relaxed); }
+    uint64_t GetSum() const { return mSum.load(std::memory_order_relaxed); }
+    uint64_t GetBucketCount(size_t idx) const { return mBuckets[idx].load(std::memory_order_relaxed); }
+    void Observe(uint64_t val) {
+        mBuckets[GetBucketIndex(val)].fetch_add(1, std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+        mSum.fetch_add(val, std::memory_order_relaxed);
+    }
+    Histogram* Collect() {
+        Histogram* res = new Histogram(mName);
+        for (size_t i = 0; i < sBucketCnt; ++i) {
+            res->mBuckets[i].store(mBuckets[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        res->mCount.store(mCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        res->mSum.store(mSum.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        return res;
+    }
+
+    static size_t GetBucketIndex(uint64_t val) {
+        if (val < sSubBucketCnt) {
+            return static_cast<size_t>(val);
+        }
+        // the top sSubBucketBits bits below the most significant bit select the sub bucket
+        size_t shift = GetMostSignificantBit(val) - sSubBucketBits;
+        return ((shift + 1) << sSubBucketBits) + static_cast<size_t>((val >> shift) & (sSubBucketCnt - 1));
+    }
+    // exclusive upper bound of the bucket, the last bucket is unbounded
+    static uint64_t GetBucketUpperBound(size_t idx) {
+        if (idx + 1 >= sBucketCnt) {
+            return UINT64_MAX;
+        }
+        if (idx < sSubBucketCnt) {
+            return idx + 1;
+        }
+        size_t shift = (idx >> sSubBucketBits) - 1;
+        return (sSubBucketCnt + (idx & (sSubBucketCnt - 1)) + 1) << shift;
+    }
+
+private:
+    static size_t GetMostSignificantBit(uint64_t val) {
+#if defined(_MSC_VER)
+        unsigned long idx = 0;
+        _BitScanReverse64(&idx, val);
+        return idx;
+#else
+        return 63 - __builtin_clzll(val);
+#endif
+    }
+};
+
 using CounterPtr = std::shared_ptr<Counter>;
 using IntGaugePtr = std::shared_ptr<Gauge<uint64_t>>;
 using DoubleGaugePtr = std::shared_ptr<Gauge<double>>;
+using HistogramPtr = std::shared_ptr<Histogram>;
 
 using MetricLabels = std::vector<std::pair<std::string, std::string>>;
 using MetricLabelsPtr = std::shared_ptr<MetricLabels>;
@@ -93,6 +93,8 @@ const std::string METRIC_PROC_OUT_RECORDS_TOTAL = "proc_out_records_total";
 const std::string METRIC_PROC_OUT_RECORDS_SIZE_BYTES = "proc_out_records_size_bytes";
 const std::string METRIC_PROC_DISCARD_RECORDS_TOTAL = "proc_discard_records_total";
 const std::string METRIC_PROC_TIME_MS = "proc_time_ms";
+const std::string METRIC_PROC_LATENCY_NS = "proc_latency_ns";
+const std::string METRIC_PROC_CPU_TIME_NS = "proc_cpu_time_ns";
 
 // processor cunstom metrics
 const std::string METRIC_PROC_PARSE_IN_SIZE_BYTES = "proc_parse_in_size_bytes";
@@ -131,6 +133,21 @@ const std::string METRIC_PROC_MERGE_MULTILINE_LOG_UNMATCHED_RECORDS_TOTAL
 const std::string METRIC_PROC_PARSE_STDOUT_TOTAL = "proc_parse_stdout_total";
 const std::string METRIC_PROC_PARSE_STDERR_TOTAL = "proc_parse_stderr_total";
 
+// queue labels
+const std::string METRIC_LABEL_COMPONENT_NAME = "component_name";
+const std::string METRIC_LABEL_QUEUE_NAME = "queue_name";
+
+// queue metrics
+const std::string METRIC_QUEUE_DWELL_TIME_NS = "queue_dwell_time_ns";
+
+// flusher runner labels
+const std::string METRIC_LABEL_FLUSHER_RUNNER_SHARD = "shard";
+
+// flusher runner metrics
+const std::string METRIC_RUNNER_FLUSHER_OUT_ITEMS_TOTAL = "runner_flusher_out_items_total";
+const std::string METRIC_RUNNER_FLUSHER_BLOCKED_ITEMS_TOTAL = "runner_flusher_blocked_items_total";
+const std::string METRIC_RUNNER_FLUSHER_SENDING_ITEMS_CNT = "runner_flusher_sending_items_cnt";
+
 // flusher common metrics
 const std::string METRIC_FLUSHER_IN_RECORDS_TOTAL = "flusher_in_records_total";
 const std::string METRIC_FLUSHER_IN_RECORDS_SIZE_BYTES = "flusher_in_records_size_bytes";
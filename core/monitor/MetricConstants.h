@@ -95,6 +95,8 @@ extern const std::string METRIC_PROC_OUT_RECORDS_TOTAL;
 extern const std::string METRIC_PROC_OUT_RECORDS_SIZE_BYTES;
 extern const std::string METRIC_PROC_DISCARD_RECORDS_TOTAL;
 extern const std::string METRIC_PROC_TIME_MS;
+extern const std::string METRIC_PROC_LATENCY_NS;
+extern const std::string METRIC_PROC_CPU_TIME_NS;
 
 // processor custom metrics
 extern const std::string METRIC_PROC_PARSE_IN_SIZE_BYTES;
@@ -124,6 +126,21 @@ extern const std::string METRIC_PROC_MERGE_MULTILINE_LOG_UNMATCHED_RECORDS_TOTAL
 extern const std::string METRIC_PROC_PARSE_STDOUT_TOTAL;
 extern const std::string METRIC_PROC_PARSE_STDERR_TOTAL;
 
+// queue labels
+extern const std::string METRIC_LABEL_COMPONENT_NAME;
+extern const std::string METRIC_LABEL_QUEUE_NAME;
+
+// queue metrics
+extern const std::string METRIC_QUEUE_DWELL_TIME_NS;
+
+// flusher runner labels
+extern const std::string METRIC_LABEL_FLUSHER_RUNNER_SHARD;
+
+// flusher runner metrics
+extern const std::string METRIC_RUNNER_FLUSHER_OUT_ITEMS_TOTAL;
+extern const std::string METRIC_RUNNER_FLUSHER_BLOCKED_ITEMS_TOTAL;
+extern const std::string METRIC_RUNNER_FLUSHER_SENDING_ITEMS_CNT;
+
 // flusher common metrics
 extern const std::string METRIC_FLUSHER_IN_RECORDS_TOTAL;
 extern const std::string METRIC_FLUSHER_IN_RECORDS_SIZE_BYTES;
@@ -51,6 +51,8 @@ namespace observer {
     std::string kVersion = "version";
     std::string kTdigestLatency = "tdigest_latency";
 
+    std::string kOverflowValue = "__other__";
+
 } // namespace observer
 
 
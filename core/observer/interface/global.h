@@ -57,5 +57,8 @@ namespace observer {
     extern std::string kVersion;
     extern std::string kTdigestLatency;
 
+    // label value of the bucket aggregating events evicted from a full aggregator
+    extern std::string kOverflowValue;
+
 } // namespace observer
 } // namespace logtail
@@ -20,15 +20,20 @@
 #include <arpa/inet.h>
 #include <json/value.h>
 #include <protobuf/sls/sls_logs.pb.h>
+#include <charconv>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "metas/ServiceMetaCache.h"
 #include "common/xxhash/xxhash.h"
 #include "layerfour.h"
 #include "MachineInfoUtil.h"
 #include "global.h"
+#include "common/memory/SourceBuffer.h"
+#include "models/PipelineEventGroup.h"
 
 
 namespace logtail {
@@ -50,6 +55,55 @@ inline void AddAnyLogContent(sls_logs::Log* log, const std::string& key, std::st
     content->set_value(std::move(value));
 }
 
+/**
+ * Labels shared by all metric events generated from one observer record. Each key and value is copied into the source
+ * buffer of the event group once, and referenced by the events without copy, so tags stay valid as long as the group
+ * even if they come from a config released meanwhile.
+ */
+class ObserverMetricTags {
+public:
+    explicit ObserverMetricTags(SourceBuffer& sourceBuffer) : mSourceBuffer(sourceBuffer) {}
+
+    void Add(StringView key, StringView value) {
+        StringBuffer keyBuffer = mSourceBuffer.CopyString(key);
+        StringBuffer valueBuffer = mSourceBuffer.CopyString(value);
+        mTags.emplace_back(StringView(keyBuffer.data, keyBuffer.size), StringView(valueBuffer.data, valueBuffer.size));
+    }
+
+    // used to drop tags added after a shared prefix
+    size_t Size() const { return mTags.size(); }
+    void Resize(size_t size) { mTags.resize(size); }
+
+    void SetTo(MetricEvent* event) const {
+        for (const auto& tag : mTags) {
+            event->SetTagNoCopy(tag.first, tag.second);
+        }
+    }
+
+private:
+    SourceBuffer& mSourceBuffer;
+    std::vector<std::pair<StringView, StringView>> mTags;
+};
+
+template <typename T>
+inline void AddAnyMetricTag(ObserverMetricTags& tags, const std::string& key, const T& value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    tags.Add(key, StringView(buf, res.ptr - buf));
+}
+inline void AddAnyMetricTag(ObserverMetricTags& tags, const std::string& key, const std::string& value) {
+    tags.Add(key, StringView(value));
+}
+
+inline void AddObserverMetric(
+    PipelineEventGroup& group, const ObserverMetricTags& tags, const std::string& name, double value, time_t time) {
+    auto event = group.AddMetricEvent();
+    event->SetNameNoCopy(StringView(name));
+    event->SetTimestamp(time);
+    event->SetValue(UntypedSingleValue{value});
+    tags.SetTo(event);
+}
+
 // GenUniqueConnectionID use connid,add and pid to generate a mostly unique id.
 inline uint64_t GenConnectionID(uint32_t pid, uint32_t connid) {
     static std::string sHostname = GetHostName();
@@ -223,3 +277,10 @@ inline void ConnectionAddrInfoToPB(const ConnectionAddrInfo& info, sls_logs::Log
     logtail::AddAnyLogContent(log, logtail::observer::kRemoteAddr, SockAddressToString(info.RemoteAddr));
     logtail::AddAnyLogContent(log, logtail::observer::kRemotePort, info.RemotePort);
 }
+
+inline void ConnectionAddrInfoToTags(const ConnectionAddrInfo& info, logtail::ObserverMetricTags& tags) {
+    logtail::AddAnyMetricTag(tags, logtail::observer::kLocalAddr, SockAddressToString(info.LocalAddr));
+    logtail::AddAnyMetricTag(tags, logtail::observer::kLocalPort, info.LocalPort);
+    logtail::AddAnyMetricTag(tags, logtail::observer::kRemoteAddr, SockAddressToString(info.RemoteAddr));
+    logtail::AddAnyMetricTag(tags, logtail::observer::kRemotePort, info.RemotePort);
+}
@@ -26,6 +26,10 @@ void NetStatisticsTCP::ToPB(sls_logs::Log* log) const {
     this->Base.ToPB(log);
 }
 
+void NetStatisticsTCP::ToMetricEvents(PipelineEventGroup& group, const ObserverMetricTags& tags, time_t time) const {
+    this->Base.ToMetricEvents(group, tags, time);
+}
+
 void NetStatisticsBase::ToPB(sls_logs::Log* log) const {
     AddAnyLogContent(log, logtail::observer::kSendBytes, this->SendBytes);
     AddAnyLogContent(log, logtail::observer::kRecvBytes, this->RecvBytes);
@@ -33,6 +37,13 @@ void NetStatisticsBase::ToPB(sls_logs::Log* log) const {
     AddAnyLogContent(log, logtail::observer::kRecvPackets, this->RecvPackets);
 }
 
+void NetStatisticsBase::ToMetricEvents(PipelineEventGroup& group, const ObserverMetricTags& tags, time_t time) const {
+    AddObserverMetric(group, tags, logtail::observer::kSendBytes, this->SendBytes, time);
+    AddObserverMetric(group, tags, logtail::observer::kRecvBytes, this->RecvBytes, time);
+    AddObserverMetric(group, tags, logtail::observer::kSendpackets, this->SendPackets, time);
+    AddObserverMetric(group, tags, logtail::observer::kRecvPackets, this->RecvPackets, time);
+}
+
 
 void NetStatisticsKey::ToPB(sls_logs::Log* log) const {
     static ServiceMetaManager* sHostnameManager = logtail::ServiceMetaManager::GetInstance();
@@ -48,6 +59,20 @@ void NetStatisticsKey::ToPB(sls_logs::Log* log) const {
     AddAnyLogContent(log, observer::kType, ObserverMetricsTypeToString(ObserverMetricsType::L4_METRICS));
 }
 
+void NetStatisticsKey::ToTags(ObserverMetricTags& tags) const {
+    static ServiceMetaManager* sHostnameManager = logtail::ServiceMetaManager::GetInstance();
+    ConnectionAddrInfoToTags(this->AddrInfo, tags);
+    const std::string& remoteAddr = SockAddressToString(this->AddrInfo.RemoteAddr);
+    const ServiceMeta& meta = sHostnameManager->GetServiceMeta(this->PID, remoteAddr);
+    auto remoteInfo
+        = std::string(kRemoteInfoPrefix).append(meta.Empty() ? remoteAddr : meta.Host).append(kRemoteInfoSuffix);
+    AddAnyMetricTag(tags, logtail::observer::kRemoteInfo, remoteInfo);
+    AddAnyMetricTag(tags, logtail::observer::kRole, PacketRoleTypeToString(this->RoleType));
+    AddAnyMetricTag(tags, logtail::observer::kConnId, GenConnectionID(this->PID, this->SockHash));
+    AddAnyMetricTag(tags, logtail::observer::kConnType, std::string("tcp")); // todo replace with real type
+    AddAnyMetricTag(tags, observer::kType, ObserverMetricsTypeToString(ObserverMetricsType::L4_METRICS));
+}
+
 logtail::NetStatisticsTCP& NetStaticticsMap::GetStatisticsItem(const logtail::NetStatisticsKey& key) {
     auto findRst = mHashMap.find(key);
     if (findRst != mHashMap.end()) {
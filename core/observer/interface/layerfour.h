@@ -17,11 +17,16 @@
 #pragma once
 
 #include <cstdint>
+#include <ctime>
 #include "network.h"
 #include "xxhash/xxhash.h"
 #include "metas/ServiceMetaCache.h"
 #include "helper.h"
 namespace logtail {
+
+class ObserverMetricTags;
+class PipelineEventGroup;
+
 struct NetStatisticsKey {
     uint32_t PID;
     uint32_t SockHash;
@@ -30,6 +35,7 @@ struct NetStatisticsKey {
     PacketRoleType RoleType;
 
     void ToPB(sls_logs::Log* log) const;
+    void ToTags(ObserverMetricTags& tags) const;
 };
 
 struct NetStatisticsBase {
@@ -45,6 +51,7 @@ struct NetStatisticsBase {
         RecvPackets += o.RecvPackets;
     }
     void ToPB(sls_logs::Log* log) const;
+    void ToMetricEvents(PipelineEventGroup& group, const ObserverMetricTags& tags, time_t time) const;
 };
 
 struct NetStatisticsTCP {
@@ -66,6 +73,7 @@ struct NetStatisticsTCP {
         RecvZeroWinCount += o.RecvZeroWinCount;
     }
     void ToPB(sls_logs::Log* log) const;
+    void ToMetricEvents(PipelineEventGroup& group, const ObserverMetricTags& tags, time_t time) const;
 };
 
 
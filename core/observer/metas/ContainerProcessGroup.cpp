@@ -36,6 +36,14 @@ void ContainerProcessGroup::FlushOutMetrics(uint64_t timeNano,
     mAggregator.FlushOutMetrics(timeNano, allData, metaTags, tags, interval);
 }
 
+void ContainerProcessGroup::FlushOutMetrics(uint64_t timeNano,
+                                            PipelineEventGroup& group,
+                                            std::vector<std::pair<std::string, std::string>>& tags,
+                                            uint64_t interval) {
+    auto& metaTags = mMetaPtr->GetFormattedMeta();
+    mAggregator.FlushOutMetrics(timeNano, group, metaTags, tags, interval);
+}
+
 void ContainerProcessGroupManager::FlushOutMetrics(std::vector<sls_logs::Log>& allData,
                                                    std::vector<std::pair<std::string, std::string>>& tags,
                                                    uint64_t interval) {
@@ -48,6 +56,18 @@ void ContainerProcessGroupManager::FlushOutMetrics(std::vector<sls_logs::Log>& a
     }
 }
 
+void ContainerProcessGroupManager::FlushOutMetrics(PipelineEventGroup& group,
+                                                   std::vector<std::pair<std::string, std::string>>& tags,
+                                                   uint64_t interval) {
+    uint64_t timeNano = GetCurrentTimeInNanoSeconds();
+    for (auto& iter : mPureProcessGroupMap) {
+        iter.second->FlushOutMetrics(timeNano, group, tags, interval);
+    }
+    for (auto& iter : mContainerProcessGroupMap) {
+        iter.second->FlushOutMetrics(timeNano, group, tags, interval);
+    }
+}
+
 
 bool ContainerProcessGroupManager::Init(const std::string& cgroupPath) {
     if (!this->mGgoupBasePath.empty()) {
@@ -52,6 +52,10 @@ struct ContainerProcessGroup {
                          std::vector<sls_logs::Log>& allData,
                          std::vector<std::pair<std::string, std::string>>& tags,
                          uint64_t interval);
+    void FlushOutMetrics(uint64_t timeNano,
+                         PipelineEventGroup& group,
+                         std::vector<std::pair<std::string, std::string>>& tags,
+                         uint64_t interval);
 
     std::unordered_set<uint32_t> mAllProcesses;
     ProcessMetaPtr mMetaPtr;
@@ -144,6 +148,9 @@ public:
     void FlushOutMetrics(std::vector<sls_logs::Log>& allData,
                          std::vector<std::pair<std::string, std::string>>& tags,
                          uint64_t interval);
+    void FlushOutMetrics(PipelineEventGroup& group,
+                         std::vector<std::pair<std::string, std::string>>& tags,
+                         uint64_t interval);
 
 
     void FlushMetas();
@@ -32,6 +32,8 @@
 #include "config/provider/EnterpriseConfigProvider.h"
 #endif
 #include "common/HashUtil.h"
+#include "pipeline/queue/ProcessQueueItem.h"
+#include "pipeline/queue/ProcessQueueManager.h"
 #include "plugin/flusher/sls/FlusherSLS.h"
 
 DEFINE_FLAG_INT64(sls_observer_network_ebpf_connection_gc_interval,
@@ -141,7 +143,14 @@ void NetworkObserver::FlushOutMetrics(std::vector<sls_logs::Log>& allData) {
     containerProcessGroupManager->FlushOutMetrics(allData, mConfig->mTags, mConfig->mFlushOutL7Interval);
 }
 
-void NetworkObserver::FlushStatistics(logtail::NetStaticticsMap& statisticsMap, std::vector<sls_logs::Log>& allData) {
+void NetworkObserver::FlushOutMetrics(PipelineEventGroup& group) {
+    static ContainerProcessGroupManager* containerProcessGroupManager = ContainerProcessGroupManager::GetInstance();
+    containerProcessGroupManager->FlushOutMetrics(group, mConfig->mTags, mConfig->mFlushOutL7Interval);
+}
+
+void NetworkObserver::ForEachMergedStatistics(
+    logtail::NetStaticticsMap& statisticsMap,
+    const std::function<void(const NetStatisticsKey&, const NetStatisticsTCP&, std::string&&)>& func) {
     static ContainerProcessGroupManager* cpgManager = ContainerProcessGroupManager::GetInstance();
     MergedNetStatisticsHashMap mergedMap;
     for (auto& item : statisticsMap.mHashMap) {
@@ -152,21 +161,8 @@ void NetworkObserver::FlushStatistics(logtail::NetStaticticsMap& statisticsMap,
             iter->second.Merge(item.second);
         }
     }
-    size_t lastSize = allData.size();
-    allData.resize(mergedMap.size() + lastSize);
 
-    ::google::protobuf::RepeatedPtrField<sls_logs::Log_Content> gTags;
-    gTags.Reserve(mConfig->mTags.size());
-    for (const auto& tag : mConfig->mTags) {
-        sls_logs::Log_Content* content = gTags.Add();
-        content->set_key(tag.first);
-        content->set_value(tag.second);
-    }
-
-    for (auto iter = mergedMap.begin(); iter != mergedMap.end() && lastSize < allData.size(); ++iter) {
-        sls_logs::Log* log = &allData[lastSize];
-        log->mutable_contents()->Reserve(16);
-        log->mutable_contents()->CopyFrom(gTags);
+    for (auto iter = mergedMap.begin(); iter != mergedMap.end(); ++iter) {
         Json::Value root;
         Json::StreamWriterBuilder builder;
         builder["indentation"] = ""; // If you want whitespace-less output
@@ -184,15 +180,66 @@ void NetworkObserver::FlushStatistics(logtail::NetStaticticsMap& statisticsMap,
                 root[item.first] = item.second;
             }
         }
-        AddAnyLogContent(log, observer::kLocalInfo, Json::writeString(builder, root));
-        AddAnyLogContent(log, observer::kInterval, this->mConfig->mFlushOutL4Interval);
-        iter->first.ToPB(log);
-        iter->second.ToPB(log);
+        func(iter->first, iter->second, Json::writeString(builder, root));
         mNetworkStatistic->mInputBytes += iter->second.Base.RecvBytes;
         mNetworkStatistic->mInputBytes += iter->second.Base.SendBytes;
         mNetworkStatistic->mInputEvents += iter->second.Base.RecvPackets;
         mNetworkStatistic->mInputEvents += iter->second.Base.SendPackets;
-        ++lastSize;
+    }
+}
+
+void NetworkObserver::FlushStatistics(logtail::NetStaticticsMap& statisticsMap, std::vector<sls_logs::Log>& allData) {
+    ::google::protobuf::RepeatedPtrField<sls_logs::Log_Content> gTags;
+    gTags.Reserve(mConfig->mTags.size());
+    for (const auto& tag : mConfig->mTags) {
+        sls_logs::Log_Content* content = gTags.Add();
+        content->set_key(tag.first);
+        content->set_value(tag.second);
+    }
+
+    ForEachMergedStatistics(
+        statisticsMap, [&](const NetStatisticsKey& key, const NetStatisticsTCP& statistics, std::string&& localInfo) {
+            allData.emplace_back();
+            sls_logs::Log* log = &allData.back();
+            log->mutable_contents()->Reserve(16);
+            log->mutable_contents()->CopyFrom(gTags);
+            AddAnyLogContent(log, observer::kLocalInfo, std::move(localInfo));
+            AddAnyLogContent(log, observer::kInterval, this->mConfig->mFlushOutL4Interval);
+            key.ToPB(log);
+            statistics.ToPB(log);
+        });
+}
+
+void NetworkObserver::FlushStatistics(logtail::NetStaticticsMap& statisticsMap, PipelineEventGroup& group) {
+    ObserverMetricTags tags(*group.GetSourceBuffer());
+    for (const auto& tag : mConfig->mTags) {
+        tags.Add(tag.first, StringView(tag.second));
+    }
+    AddAnyMetricTag(tags, observer::kInterval, this->mConfig->mFlushOutL4Interval);
+    size_t commonTagCnt = tags.Size();
+    time_t now = time(nullptr);
+
+    ForEachMergedStatistics(
+        statisticsMap, [&](const NetStatisticsKey& key, const NetStatisticsTCP& statistics, std::string&& localInfo) {
+            AddAnyMetricTag(tags, observer::kLocalInfo, localInfo);
+            key.ToTags(tags);
+            statistics.ToMetricEvents(group, tags, now);
+            tags.Resize(commonTagCnt);
+        });
+}
+
+void NetworkObserver::FlushOutStatistics(PipelineEventGroup& group) {
+    // pcap wrapper, do not need to add meta
+    if (mPCAPWrapper != nullptr) {
+        NetStaticticsMap& statisticsMap = mPCAPWrapper->GetStatistics();
+        FlushStatistics(statisticsMap, group);
+        statisticsMap.Clear();
+    }
+
+    if (mEBPFWrapper != nullptr) {
+        NetStaticticsMap& statisticsMap = mEBPFWrapper->GetStatistics();
+        FlushStatistics(statisticsMap, group);
+        statisticsMap.Clear();
     }
 }
 
@@ -459,28 +506,40 @@ void NetworkObserver::EventLoop() {
         // flush observer metrics
         if (nowTimeNs - mLastL4FlushTimeNs >= mConfig->mFlushOutL4Interval * 1000ULL * 1000ULL * 1000ULL) {
             mLastL4FlushTimeNs = nowTimeNs;
-            std::vector<sls_logs::Log> allLogs;
-            FlushOutStatistics(allLogs);
-            if (mSenderFunc) {
-                mSenderFunc(allLogs, mConfig->mLastApplyedConfig);
-            }
-            mNetworkStatistic->mOutputEvents += allLogs.size();
-            for (const auto& item : allLogs) {
-                mNetworkStatistic->mOutputBytes += item.GetCachedSize();
+            if (mGroupSenderFunc) {
+                PipelineEventGroup group(std::make_shared<SourceBuffer>());
+                FlushOutStatistics(group);
+                SendEventGroup(std::move(group));
+            } else {
+                std::vector<sls_logs::Log> allLogs;
+                FlushOutStatistics(allLogs);
+                if (mSenderFunc) {
+                    mSenderFunc(allLogs, mConfig->mLastApplyedConfig);
+                }
+                mNetworkStatistic->mOutputEvents += allLogs.size();
+                for (const auto& item : allLogs) {
+                    mNetworkStatistic->mOutputBytes += item.GetCachedSize();
+                }
             }
         }
 
         // flush observer metrics
         if (nowTimeNs - mLastL7FlushTimeNs >= mConfig->mFlushOutL7Interval * 1000ULL * 1000ULL * 1000ULL) {
             mLastL7FlushTimeNs = nowTimeNs;
-            std::vector<sls_logs::Log> allLogs;
-            FlushOutMetrics(allLogs);
-            if (mSenderFunc) {
-                mSenderFunc(allLogs, mConfig->mLastApplyedConfig);
-            }
-            mNetworkStatistic->mOutputEvents += allLogs.size();
-            for (const auto& item : allLogs) {
-                mNetworkStatistic->mOutputBytes += item.GetCachedSize();
+            if (mGroupSenderFunc) {
+                PipelineEventGroup group(std::make_shared<SourceBuffer>());
+                FlushOutMetrics(group);
+                SendEventGroup(std::move(group));
+            } else {
+                std::vector<sls_logs::Log> allLogs;
+                FlushOutMetrics(allLogs);
+                if (mSenderFunc) {
+                    mSenderFunc(allLogs, mConfig->mLastApplyedConfig);
+                }
+                mNetworkStatistic->mOutputEvents += allLogs.size();
+                for (const auto& item : allLogs) {
+                    mNetworkStatistic->mOutputBytes += item.GetCachedSize();
+                }
             }
         }
         // flush profile metrics
@@ -511,8 +570,22 @@ void NetworkObserver::EventLoop() {
 }
 
 void NetworkObserver::BindSender() {
-    mSenderFunc
-        = this->mConfig->mLastApplyedConfig->IsFlushingThroughGoPipeline() ? OutputPluginProcess : OutputDirectly;
+    if (this->mConfig->mLastApplyedConfig->IsFlushingThroughGoPipeline()) {
+        mSenderFunc = OutputPluginProcess;
+        mGroupSenderFunc = nullptr;
+    } else {
+        mSenderFunc = OutputDirectly;
+        mGroupSenderFunc = OutputToProcessQueue;
+    }
+}
+
+void NetworkObserver::SendEventGroup(PipelineEventGroup&& group) {
+    if (group.GetEvents().empty()) {
+        return;
+    }
+    mNetworkStatistic->mOutputEvents += group.GetEvents().size();
+    mNetworkStatistic->mOutputBytes += group.DataSize();
+    mGroupSenderFunc(std::move(group), mConfig->mLastApplyedConfig);
 }
 
 inline void NetworkObserver::StartEventLoop() {
@@ -535,6 +608,16 @@ int NetworkObserver::OutputPluginProcess(std::vector<sls_logs::Log>& logs, const
     return 0;
 }
 
+int NetworkObserver::OutputToProcessQueue(PipelineEventGroup&& group, const Pipeline* config) {
+    // input_observer_network is the only input of the pipeline
+    auto item = std::make_unique<ProcessQueueItem>(std::move(group), 0);
+    if (ProcessQueueManager::GetInstance()->PushQueue(config->GetContext().GetProcessQueueKey(), std::move(item))) {
+        LOG_WARNING(sLogger, ("push observer metrics to process queue failed", config->Name()));
+        return -1;
+    }
+    return 0;
+}
+
 int NetworkObserver::OutputDirectly(std::vector<sls_logs::Log>& logs, const Pipeline* config) {
     const FlusherSLS* plugin = static_cast<const FlusherSLS*>(config->GetFlushers()[0]->GetPlugin());
     const size_t maxCount = INT32_FLAG(merge_log_count_limit) / 4;
@@ -88,6 +88,8 @@ private:
     void BindSender();
     static int OutputPluginProcess(std::vector<sls_logs::Log>& logs, const Pipeline* cfg);
     static int OutputDirectly(std::vector<sls_logs::Log>& logs, const Pipeline* cfg);
+    // push metric events to the process queue of the pipeline, so that they are processed and flushed natively
+    static int OutputToProcessQueue(PipelineEventGroup&& group, const Pipeline* cfg);
 
     /**
      * @brief Process bytes by different protocol processors.
@@ -113,6 +115,22 @@ private:
 
     void FlushStatistics(logtail::NetStaticticsMap& map, std::vector<sls_logs::Log>& logs);
 
+    /**
+     * @brief Same as above, but generate metric events instead of logs, which is used by native pipelines.
+     */
+    void FlushOutStatistics(PipelineEventGroup& group);
+    void FlushOutMetrics(PipelineEventGroup& group);
+    void FlushStatistics(logtail::NetStaticticsMap& map, PipelineEventGroup& group);
+
+    /**
+     * @brief Merge statistics by process and remote addr, and call func for each one passing filter rules.
+     */
+    void ForEachMergedStatistics(
+        logtail::NetStaticticsMap& map,
+        const std::function<void(const NetStatisticsKey&, const NetStatisticsTCP&, std::string&&)>& func);
+
+    void SendEventGroup(PipelineEventGroup&& group);
+
     void ReloadSource();
 
     // create a still running thread to process observer data.
@@ -120,6 +138,8 @@ private:
 
     std::unordered_map<uint32_t, ProcessObserver*> mAllProcesses;
     std::function<int(std::vector<sls_logs::Log>&, const Pipeline*)> mSenderFunc;
+    // set only when the pipeline is not flushing through go pipeline
+    std::function<int(PipelineEventGroup&&, const Pipeline*)> mGroupSenderFunc;
     ThreadPtr mEventLoopThread;
     ReadWriteLock mEventLoopThreadRWL;
     uint64_t mLastGCTimeNs = 0;
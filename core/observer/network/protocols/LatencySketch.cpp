@@ -0,0 +1,146 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "network/protocols/LatencySketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace logtail {
+
+static const double kGamma = (1 + LatencySketch::kRelativeAccuracy) / (1 - LatencySketch::kRelativeAccuracy);
+static const double kLogGamma = log(kGamma);
+
+int32_t LatencySketch::GetIndex(double value) {
+    return static_cast<int32_t>(ceil(log(value) / kLogGamma));
+}
+
+double LatencySketch::GetValue(int32_t index) {
+    // the point within the bucket with the same relative error to both bounds
+    return 2 * pow(kGamma, index) / (kGamma + 1);
+}
+
+void LatencySketch::Extend(int32_t index) {
+    if (mCounts.empty()) {
+        mCounts.resize(1);
+        mOffset = index;
+        return;
+    }
+    if (index < mOffset) {
+        int32_t maxIndex = mOffset + static_cast<int32_t>(mCounts.size()) - 1;
+        if (maxIndex - index + 1 > static_cast<int32_t>(kMaxBucketCnt)) {
+            // the new value falls into the lowest bucket kept
+            return;
+        }
+        mCounts.insert(mCounts.begin(), mOffset - index, 0);
+        mOffset = index;
+    } else if (index >= mOffset + static_cast<int32_t>(mCounts.size())) {
+        mCounts.resize(index - mOffset + 1);
+        if (mCounts.size() > kMaxBucketCnt) {
+            // collapse lowest buckets into the lowest one kept
+            size_t cut = mCounts.size() - kMaxBucketCnt;
+            uint32_t collapsed = 0;
+            for (size_t i = 0; i <= cut; ++i) {
+                collapsed += mCounts[i];
+            }
+            mCounts.erase(mCounts.begin(), mCounts.begin() + cut);
+            mCounts[0] = collapsed;
+            mOffset += static_cast<int32_t>(cut);
+        }
+    }
+}
+
+void LatencySketch::Add(int64_t value, uint32_t cnt) {
+    mCount += cnt;
+    if (value <= 1) {
+        mZeroCount += cnt;
+        return;
+    }
+    int32_t index = GetIndex(static_cast<double>(value));
+    Extend(index);
+    mCounts[max(index, mOffset) - mOffset] += cnt;
+}
+
+void LatencySketch::Merge(const LatencySketch& other) {
+    if (other.IsEmpty()) {
+        return;
+    }
+    mCount += other.mCount;
+    mZeroCount += other.mZeroCount;
+    if (other.mCounts.empty()) {
+        return;
+    }
+    Extend(other.mOffset);
+    Extend(other.mOffset + static_cast<int32_t>(other.mCounts.size()) - 1);
+    for (size_t i = 0; i < other.mCounts.size(); ++i) {
+        int32_t index = other.mOffset + static_cast<int32_t>(i);
+        mCounts[max(index, mOffset) - mOffset] += other.mCounts[i];
+    }
+}
+
+void LatencySketch::Clear() {
+    fill(mCounts.begin(), mCounts.end(), 0);
+    mZeroCount = 0;
+    mCount = 0;
+}
+
+double LatencySketch::GetQuantile(double q) const {
+    if (mCount == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * (mCount - 1));
+    if (rank < mZeroCount) {
+        return 0;
+    }
+    uint64_t seen = mZeroCount;
+    for (size_t i = 0; i < mCounts.size(); ++i) {
+        seen += mCounts[i];
+        if (seen > rank) {
+            return GetValue(mOffset + static_cast<int32_t>(i));
+        }
+    }
+    return GetValue(mOffset + static_cast<int32_t>(mCounts.size()) - 1);
+}
+
+string LatencySketch::ToString() const {
+    // skip buckets emptied by Clear at both ends
+    size_t begin = 0, end = mCounts.size();
+    while (begin < end && mCounts[begin] == 0) {
+        ++begin;
+    }
+    while (end > begin && mCounts[end - 1] == 0) {
+        --end;
+    }
+    string res;
+    res.reserve(64 + (end - begin) * 4);
+    res.append("{\"gamma\":")
+        .append(to_string(kGamma))
+        .append(",\"zero\":")
+        .append(to_string(mZeroCount))
+        .append(",\"offset\":")
+        .append(to_string(mOffset + static_cast<int32_t>(begin)))
+        .append(",\"counts\":[");
+    for (size_t i = begin; i < end; ++i) {
+        if (i != begin) {
+            res.push_back(',');
+        }
+        res.append(to_string(mCounts[i]));
+    }
+    res.append("]}");
+    return res;
+}
+
+} // namespace logtail
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace logtail {
+
+/**
+ * DDSketch-style latency distribution. Values are mapped to logarithmic buckets, so that any quantile is returned
+ * with a relative error no more than kRelativeAccuracy. Sketches built on different nodes or windows can be merged
+ * losslessly by adding up bucket counts.
+ *
+ * Buckets are kept in a dense array covering only the index range seen. When the range exceeds kMaxBucketCnt, the
+ * lowest buckets are collapsed, which only affects the accuracy of the lowest quantiles.
+ */
+class LatencySketch {
+public:
+    static constexpr double kRelativeAccuracy = 0.01;
+    static constexpr size_t kMaxBucketCnt = 2048;
+
+    void Add(int64_t value, uint32_t cnt = 1);
+    void Merge(const LatencySketch& other);
+    // buckets memory is kept for the next window
+    void Clear();
+
+    bool IsEmpty() const { return mCount == 0; }
+    uint64_t GetCount() const { return mCount; }
+    // @param q in [0, 1]
+    // @return 0 if empty
+    double GetQuantile(double q) const;
+
+    // {"gamma":<gamma>,"zero":<count of values <= 1>,"offset":<index of first bucket>,"counts":[...]}
+    // bucket i holds values in (gamma^(offset+i-1), gamma^(offset+i)]
+    std::string ToString() const;
+
+private:
+    static int32_t GetIndex(double value);
+    static double GetValue(int32_t index);
+    void Extend(int32_t index);
+
+    // counts of one window per key, which fit in 32 bits
+    std::vector<uint32_t> mCounts;
+    int32_t mOffset = 0;
+    uint64_t mZeroCount = 0;
+    uint64_t mCount = 0;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class LatencySketchUnittest;
+#endif
+};
+
+} // namespace logtail
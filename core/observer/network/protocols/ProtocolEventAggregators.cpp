@@ -60,4 +60,46 @@ void ProtocolEventAggregators::FlushOutMetrics(uint64_t timeNano,
     }
 }
 
+void ProtocolEventAggregators::FlushOutMetrics(uint64_t timeNano,
+                                               PipelineEventGroup& group,
+                                               std::vector<std::pair<std::string, std::string>>& processTags,
+                                               std::vector<std::pair<std::string, std::string>>& globalTags,
+                                               uint64_t interval) {
+    Json::Value root;
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = ""; // If you want whitespace-less output
+    for (auto& tag : processTags) {
+        root[tag.first] = tag.second;
+    }
+
+    // tags shared by all items are copied into the group only once
+    ObserverMetricTags tags(*group.GetSourceBuffer());
+    for (const auto& tag : globalTags) {
+        tags.Add(tag.first, StringView(tag.second));
+    }
+    AddAnyMetricTag(tags, observer::kLocalInfo, Json::writeString(builder, root));
+    AddAnyMetricTag(tags, observer::kInterval, interval);
+
+    time_t time = timeNano / 1000000000ULL;
+    if (mDNSAggregators != nullptr) {
+        mDNSAggregators->FlushMetrics(group, tags, time);
+    }
+
+    if (mHTTPAggregators != nullptr) {
+        mHTTPAggregators->FlushMetrics(group, tags, time);
+    }
+
+    if (mMySQLAggregators != nullptr) {
+        mMySQLAggregators->FlushMetrics(group, tags, time);
+    }
+
+    if (mRedisAggregators != nullptr) {
+        mRedisAggregators->FlushMetrics(group, tags, time);
+    }
+
+    if (mPgSQLAggregators != nullptr) {
+        mPgSQLAggregators->FlushMetrics(group, tags, time);
+    }
+}
+
 } // namespace logtail
@@ -111,6 +111,12 @@ public:
                          std::vector<std::pair<std::string, std::string>>& globalTags,
                          uint64_t interval);
 
+    void FlushOutMetrics(uint64_t timeNano,
+                         PipelineEventGroup& group,
+                         std::vector<std::pair<std::string, std::string>>& processTags,
+                         std::vector<std::pair<std::string, std::string>>& globalTags,
+                         uint64_t interval);
+
 protected:
     DNSProtocolEventAggregator* mDNSAggregators = NULL;
     HTTPProtocolEventAggregator* mHTTPAggregators = NULL;
@@ -76,6 +76,13 @@ struct CommonAggKey {
         return ss.str();
     }
 
+    // Pid is not compared, since it is not kept by move and the connection is identified by the others
+    bool operator==(const CommonAggKey& other) const {
+        return HashVal == other.HashVal && ConnId == other.ConnId && RemotePort == other.RemotePort
+            && LocalPort == other.LocalPort && Role == other.Role && RemoteIp == other.RemoteIp
+            && LocalIp == other.LocalIp;
+    }
+
     void ToPB(sls_logs::Log* log) const {
         static ServiceMetaManager* sHostnameManager = logtail::ServiceMetaManager::GetInstance();
         AddAnyLogContent(log, observer::kRole, PacketRoleTypeToString(this->Role));
@@ -91,6 +98,28 @@ struct CommonAggKey {
         AddAnyLogContent(log, observer::kRemoteInfo, std::move(remoteInfo));
     }
 
+    void ToTags(ObserverMetricTags& tags) const {
+        static ServiceMetaManager* sHostnameManager = logtail::ServiceMetaManager::GetInstance();
+        AddAnyMetricTag(tags, observer::kRole, PacketRoleTypeToString(this->Role));
+        AddAnyMetricTag(tags, observer::kRemoteAddr, RemoteIp);
+        AddAnyMetricTag(tags, observer::kRemotePort, RemotePort);
+        AddAnyMetricTag(tags, observer::kLocalPort, LocalPort);
+        AddAnyMetricTag(tags, observer::kLocalAddr, LocalIp);
+        AddAnyMetricTag(tags, observer::kConnId, ConnId);
+        const ServiceMeta& meta = sHostnameManager->GetServiceMeta(this->Pid, this->RemoteIp);
+        auto remoteInfo = std::string(kRemoteInfoPrefix)
+                              .append(meta.Empty() ? this->RemoteIp : meta.Host)
+                              .append(kRemoteInfoSuffix);
+        AddAnyMetricTag(tags, observer::kRemoteInfo, remoteInfo);
+    }
+
+    // keep labels of the local side only, so that evicted keys of all remote peers fall into one bucket
+    void SetOverflow() {
+        ConnId = 0;
+        RemotePort = 0;
+        RemoteIp = observer::kOverflowValue;
+    }
+
     uint64_t HashVal{0};
     uint64_t ConnId{0};
     uint16_t RemotePort{0};
@@ -124,12 +153,16 @@ struct DBAggKey {
 
     uint64_t Hash() const {
         uint64_t hashValue = ConnKey.HashVal;
-        hashValue = XXH32(this->QueryCmd.c_str(), this->QueryCmd.size(), hashValue);
-        hashValue = XXH32(this->Query.c_str(), this->Query.size(), hashValue);
-        hashValue = XXH32(this->Version.c_str(), this->Version.size(), hashValue);
-        hashValue = XXH32(&this->Status, sizeof(this->Status), hashValue);
+        hashValue = XXH64(this->QueryCmd.c_str(), this->QueryCmd.size(), hashValue);
+        hashValue = XXH64(this->Query.c_str(), this->Query.size(), hashValue);
+        hashValue = XXH64(this->Version.c_str(), this->Version.size(), hashValue);
+        hashValue = XXH64(&this->Status, sizeof(this->Status), hashValue);
         return hashValue;
     }
+    bool operator==(const DBAggKey& other) const {
+        return ConnKey == other.ConnKey && QueryCmd == other.QueryCmd && Query == other.Query
+            && Version == other.Version && Status == other.Status;
+    }
     void ToPB(sls_logs::Log* log) const {
         AddAnyLogContent(log, observer::kVersion, Version);
         AddAnyLogContent(log, observer::kQueryCmd, QueryCmd);
@@ -139,6 +172,23 @@ struct DBAggKey {
         AddAnyLogContent(log, observer::kType, ObserverMetricsTypeToString(ObserverMetricsType::L7_DB_METRICS));
         ConnKey.ToPB(log);
     }
+    void ToTags(ObserverMetricTags& tags) const {
+        AddAnyMetricTag(tags, observer::kVersion, Version);
+        AddAnyMetricTag(tags, observer::kQueryCmd, QueryCmd);
+        AddAnyMetricTag(tags, observer::kQuery, Query);
+        AddAnyMetricTag(tags, observer::kStatus, Status);
+        AddAnyMetricTag(tags, observer::kProtocol, ProtocolTypeToString(PT));
+        AddAnyMetricTag(tags, observer::kType, ObserverMetricsTypeToString(ObserverMetricsType::L7_DB_METRICS));
+        ConnKey.ToTags(tags);
+    }
+
+    void SetOverflow() {
+        ConnKey.SetOverflow();
+        QueryCmd = observer::kOverflowValue;
+        Query = observer::kOverflowValue;
+        Version = observer::kOverflowValue;
+        Status = -1;
+    }
 
     std::string ProtocolType() { return ProtocolTypeToString(PT); }
 
@@ -186,14 +236,19 @@ struct RequestAggKey {
 
     uint64_t Hash() const {
         uint64_t hashValue = ConnKey.HashVal;
-        hashValue = XXH32(this->ReqType.c_str(), this->ReqType.size(), hashValue);
-        hashValue = XXH32(this->ReqDomain.c_str(), this->ReqDomain.size(), hashValue);
-        hashValue = XXH32(this->ReqResource.c_str(), this->ReqResource.size(), hashValue);
-        hashValue = XXH32(this->Version.c_str(), this->Version.size(), hashValue);
-        hashValue = XXH32(&this->RespCode, sizeof(this->RespCode), hashValue);
-        hashValue = XXH32(&this->RespStatus, sizeof(this->RespStatus), hashValue);
+        hashValue = XXH64(this->ReqType.c_str(), this->ReqType.size(), hashValue);
+        hashValue = XXH64(this->ReqDomain.c_str(), this->ReqDomain.size(), hashValue);
+        hashValue = XXH64(this->ReqResource.c_str(), this->ReqResource.size(), hashValue);
+        hashValue = XXH64(this->Version.c_str(), this->Version.size(), hashValue);
+        hashValue = XXH64(&this->RespCode, sizeof(this->RespCode), hashValue);
+        hashValue = XXH64(&this->RespStatus, sizeof(this->RespStatus), hashValue);
         return hashValue;
     }
+    bool operator==(const RequestAggKey& other) const {
+        return ConnKey == other.ConnKey && ReqType == other.ReqType && ReqDomain == other.ReqDomain
+            && ReqResource == other.ReqResource && Version == other.Version && RespCode == other.RespCode
+            && RespStatus == other.RespStatus;
+    }
     void ToPB(sls_logs::Log* log) const {
         AddAnyLogContent(log, observer::kReqType, ReqType);
         AddAnyLogContent(log, observer::kReqDomain, ReqDomain);
@@ -205,6 +260,27 @@ struct RequestAggKey {
         AddAnyLogContent(log, observer::kType, ObserverMetricsTypeToString(ObserverMetricsType::L7_REQ_METRICS));
         ConnKey.ToPB(log);
     }
+    void ToTags(ObserverMetricTags& tags) const {
+        AddAnyMetricTag(tags, observer::kReqType, ReqType);
+        AddAnyMetricTag(tags, observer::kReqDomain, ReqDomain);
+        AddAnyMetricTag(tags, observer::kReqResource, ReqResource);
+        AddAnyMetricTag(tags, observer::kVersion, Version);
+        AddAnyMetricTag(tags, observer::kRespStatus, RespStatus);
+        AddAnyMetricTag(tags, observer::kRespCode, RespCode);
+        AddAnyMetricTag(tags, observer::kProtocol, ProtocolTypeToString(PT));
+        AddAnyMetricTag(tags, observer::kType, ObserverMetricsTypeToString(ObserverMetricsType::L7_REQ_METRICS));
+        ConnKey.ToTags(tags);
+    }
+
+    void SetOverflow() {
+        ConnKey.SetOverflow();
+        ReqType = observer::kOverflowValue;
+        ReqDomain = observer::kOverflowValue;
+        ReqResource = observer::kOverflowValue;
+        Version = observer::kOverflowValue;
+        RespCode = -1;
+        RespStatus = -1;
+    }
 
     std::string ProtocolType() { return ProtocolTypeToString(PT); }
 
@@ -17,12 +17,17 @@
 #pragma once
 
 #include "interface/protocol.h"
-#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include "protobuf/sls/sls_logs.pb.h"
 #include "interface/helper.h"
 #include "LogtailAlarm.h"
 #include "metas/ServiceMetaCache.h"
 #include "Logger.h"
+#include "models/PipelineEventGroup.h"
+#include "network/protocols/LatencySketch.h"
 #include <unordered_map>
 #include <ostream>
 
@@ -82,6 +87,7 @@ struct CommonProtocolAggResult {
         TotalLatencyNs = 0;
         TotalReqBytes = 0;
         TotalRespBytes = 0;
+        Latency.Clear();
     }
 
     bool IsEmpty() const { return TotalCount == 0; }
@@ -91,6 +97,7 @@ struct CommonProtocolAggResult {
         TotalLatencyNs += info.LatencyNs;
         TotalReqBytes += info.ReqBytes;
         TotalRespBytes += info.RespBytes;
+        Latency.Add(info.LatencyNs);
     }
 
     void Merge(CommonProtocolAggResult& aggResult) {
@@ -98,6 +105,7 @@ struct CommonProtocolAggResult {
         TotalLatencyNs += aggResult.TotalLatencyNs;
         TotalReqBytes += aggResult.TotalReqBytes;
         TotalRespBytes += aggResult.TotalRespBytes;
+        Latency.Merge(aggResult.Latency);
     }
 
     void ToPB(sls_logs::Log* log) const {
@@ -105,13 +113,28 @@ struct CommonProtocolAggResult {
         AddAnyLogContent(log, observer::kLatencyNs, TotalLatencyNs);
         AddAnyLogContent(log, observer::kReqBytes, TotalReqBytes);
         AddAnyLogContent(log, observer::kRespBytes, TotalRespBytes);
-        AddAnyLogContent(log, observer::kTdigestLatency, std::string("xxxxx"));
+        AddAnyLogContent(log, observer::kTdigestLatency, Latency.ToString());
+    }
+
+    // latency quantiles are emitted as separate gauges, since metric events only carry single values
+    void ToMetricEvents(PipelineEventGroup& group, const ObserverMetricTags& tags, time_t time) const {
+        static const std::string sLatencyP50 = observer::kLatencyNs + "_p50";
+        static const std::string sLatencyP90 = observer::kLatencyNs + "_p90";
+        static const std::string sLatencyP99 = observer::kLatencyNs + "_p99";
+        AddObserverMetric(group, tags, observer::kCount, TotalCount, time);
+        AddObserverMetric(group, tags, observer::kLatencyNs, TotalLatencyNs, time);
+        AddObserverMetric(group, tags, observer::kReqBytes, TotalReqBytes, time);
+        AddObserverMetric(group, tags, observer::kRespBytes, TotalRespBytes, time);
+        AddObserverMetric(group, tags, sLatencyP50, Latency.GetQuantile(0.5), time);
+        AddObserverMetric(group, tags, sLatencyP90, Latency.GetQuantile(0.9), time);
+        AddObserverMetric(group, tags, sLatencyP99, Latency.GetQuantile(0.99), time);
     }
 
     int64_t TotalCount{0};
     int64_t TotalLatencyNs{0};
     int64_t TotalReqBytes{0};
     int64_t TotalRespBytes{0};
+    LatencySketch Latency;
 };
 
 
@@ -127,6 +150,12 @@ struct CommonProtocolEventAggItem {
         Key.ToPB(log);
         AggResult.ToPB(log);
     }
+    void ToMetricEvents(PipelineEventGroup& group, ObserverMetricTags& tags, time_t time) {
+        size_t commonTagCnt = tags.Size();
+        Key.ToTags(tags);
+        AggResult.ToMetricEvents(group, tags, time);
+        tags.Resize(commonTagCnt);
+    }
     void Merge(CommonProtocolEventAggItem<ProtocolEventKey, ProtocolEventAggResult>& aggItem) {
         AggResult.Merge(aggItem.AggResult);
     }
@@ -135,90 +164,127 @@ struct CommonProtocolEventAggItem {
 
     ProtocolEventKey Key;
     ProtocolEventAggResult AggResult;
+    // estimated event count used for eviction, which is not reset by Clear, see CommonProtocolEventAggregator
+    uint64_t Weight{0};
 };
 
 /**
- * Cache pool
+ * Fixed capacity pool of aggregation items, which are referred to by index.
+ * Items are allocated by chunks on demand and never released until the pool is destroyed.
  * @tparam ProtocolEventAggItem reused object.
  */
 template <typename ProtocolEventAggItem>
 class CommonProtocolEventAggItemManager {
 public:
-    explicit CommonProtocolEventAggItemManager(size_t maxCount = 128) : mMaxCount(maxCount) {}
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
 
-    ~CommonProtocolEventAggItemManager() {
-        for (auto iter = mUnUsed.begin(); iter != mUnUsed.end(); ++iter) {
-            delete *iter;
-        }
-    }
+    explicit CommonProtocolEventAggItemManager(uint32_t capacity) : mCapacity(capacity) {}
 
     /**
      * Create an new object or reuse the cached object.
-     * @return an protocol metrics event aggregate node.
+     * @return index of the protocol metrics event aggregate node, or kInvalidIndex when all nodes are in use.
      */
     template <typename ProtocolEventKey>
-    ProtocolEventAggItem* Create(ProtocolEventKey&& event) {
-        ProtocolEventAggItem* item;
-        if (mUnUsed.empty()) {
-            item = new ProtocolEventAggItem();
-            item->Key = std::move(event);
-            return item;
+    uint32_t Create(ProtocolEventKey&& event) {
+        uint32_t index;
+        if (!mUnUsed.empty()) {
+            index = mUnUsed.back();
+            mUnUsed.pop_back();
+        } else if (mAllocated < mCapacity) {
+            if (mAllocated % kChunkSize == 0) {
+                mChunks.emplace_back(new ProtocolEventAggItem[kChunkSize]);
+            }
+            index = mAllocated++;
+        } else {
+            return kInvalidIndex;
         }
-        item = mUnUsed.back();
-        item->Clear();
-        item->Key = std::move(event);
-        mUnUsed.pop_back();
-        return item;
+        ProtocolEventAggItem& item = Get(index);
+        item.Clear();
+        item.Weight = 0;
+        item.Key = std::move(event);
+        return index;
     }
 
     /**
-     * Delete object when cache is full, or else would cache it.
-     * @param item deleting object.
+     * Return the object to the pool.
+     * @param index index of the deleting object.
      */
-    void Delete(ProtocolEventAggItem* item) {
-        if (mUnUsed.size() < mMaxCount) {
-            mUnUsed.push_back(item);
-            return;
-        }
-        delete item;
-    }
+    void Delete(uint32_t index) { mUnUsed.push_back(index); }
+
+    ProtocolEventAggItem& Get(uint32_t index) { return mChunks[index / kChunkSize][index % kChunkSize]; }
 
 private:
-    size_t mMaxCount;
-    std::deque<ProtocolEventAggItem*> mUnUsed;
+    static constexpr uint32_t kChunkSize = 64;
+
+    uint32_t mCapacity;
+    uint32_t mAllocated = 0;
+    std::vector<std::unique_ptr<ProtocolEventAggItem[]>> mChunks;
+    std::vector<uint32_t> mUnUsed;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProtocolUtilUnittest;
+#endif
 };
 
-// 通用的协议的聚类器实现
+/**
+ * 通用的协议的聚类器实现
+ *
+ * Keys are indexed by a fixed size open addressing table, so that memory is bounded whatever the cardinality is.
+ * When the aggregator is full, the key with the lowest weight among a few sampled ones is evicted in space-saving
+ * style: its result is merged into the overflow item of its role, and the new key inherits its weight, so that keys
+ * with high traffic are kept while keys seen only once replace each other.
+ */
 template <typename ProtocolEvent, typename ProtocolEventAggItem, typename ProtocolEventAggItemManager>
 class CommonProtocolEventAggregator {
 public:
     CommonProtocolEventAggregator(uint32_t maxClientAggSize, uint32_t maxServerAggSize)
-        : mClientAggMaxSize(maxClientAggSize), mServerAggMaxSize(maxServerAggSize) {}
-
-    ~CommonProtocolEventAggregator() {
-        for (auto iter = mProtocolEventAggMap.begin(); iter != mProtocolEventAggMap.end(); ++iter) {
-            mAggItemManager.Delete(iter->second);
+        : mAggItemManager(std::max(maxClientAggSize, maxServerAggSize)),
+          mClientAggMaxSize(maxClientAggSize),
+          mServerAggMaxSize(maxServerAggSize) {
+        // keep load factor no more than 0.75
+        size_t slotCnt = 4;
+        while (slotCnt * 3 < static_cast<size_t>(std::max(maxClientAggSize, maxServerAggSize)) * 4) {
+            slotCnt <<= 1;
         }
+        mSlots.resize(slotCnt);
+        mMask = slotCnt - 1;
     }
+
     bool AddEvent(ProtocolEvent&& event) {
-        auto key = event.Key;
-        auto hashVal = key.Hash();
-        auto findRst = mProtocolEventAggMap.find(hashVal);
-        if (findRst == mProtocolEventAggMap.end()) {
-            if (isFull(event.Key.ConnKey.Role)) {
-                static uint32_t sLastDropTime{0};
-                auto now = time(nullptr);
-                LOG_DEBUG(sLogger, ("aggregator is full, some events would be dropped", event.Key.ToString()));
-                if (now - sLastDropTime > 60) {
-                    sLastDropTime = now;
-                    LOG_ERROR(sLogger, ("aggregator is full, some events would be dropped", event.Key.ProtocolType()));
+        auto role = event.Key.ConnKey.Role;
+        if (role != PacketRoleType::Client && role != PacketRoleType::Server) {
+            logDrop(event.Key);
+            return false;
+        }
+        uint64_t hashVal = event.Key.Hash();
+        size_t pos = findSlot(hashVal, event.Key);
+        if (mSlots[pos].Index == kEmptySlot) {
+            uint32_t index;
+            if (isFull(role)) {
+                index = evict();
+                if (index == kEmptySlot) {
+                    logDrop(event.Key);
+                    return false;
+                }
+                ProtocolEventAggItem& item = mAggItemManager.Get(index);
+                item.Clear();
+                item.Key = std::move(event.Key);
+                // slots may be shifted by eviction
+                pos = findSlot(hashVal, item.Key);
+            } else {
+                index = mAggItemManager.Create(std::move(event.Key));
+                if (index == kEmptySlot) {
+                    logDrop(event.Key);
+                    return false;
                 }
-                return false;
             }
-            auto item = mAggItemManager.Create(std::move(event.Key));
-            findRst = mProtocolEventAggMap.insert(std::make_pair(hashVal, item)).first;
+            mSlots[pos].Hash = hashVal;
+            mSlots[pos].Index = index;
+            ++mSize;
         }
-        findRst->second->AddEventInfo(event.Info);
+        ProtocolEventAggItem& item = mAggItemManager.Get(mSlots[pos].Index);
+        ++item.Weight;
+        item.AddEventInfo(event.Info);
         return true;
     }
 
@@ -226,38 +292,161 @@ public:
                    const std::string& tags,
                    google::protobuf::RepeatedPtrField<sls_logs::Log_Content>& globalTags,
                    uint64_t interval) {
-        for (auto iter = mProtocolEventAggMap.begin(); iter != mProtocolEventAggMap.end();) {
-            if (iter->second->AggResult.IsEmpty()) {
-                mAggItemManager.Delete(iter->second);
-                iter = mProtocolEventAggMap.erase(iter);
-            } else {
-                sls_logs::Log newLog;
-                newLog.mutable_contents()->CopyFrom(globalTags);
-                AddAnyLogContent(&newLog, observer::kLocalInfo, tags);
-                AddAnyLogContent(&newLog, observer::kInterval, interval);
-                iter->second->ToPB(&newLog);
-                iter->second->Clear(); // wait for next clear
-                allData.push_back(std::move(newLog));
-                ++iter;
-            }
-        }
+        flush([&](ProtocolEventAggItem& item) {
+            sls_logs::Log newLog;
+            newLog.mutable_contents()->CopyFrom(globalTags);
+            AddAnyLogContent(&newLog, observer::kLocalInfo, tags);
+            AddAnyLogContent(&newLog, observer::kInterval, interval);
+            item.ToPB(&newLog);
+            allData.push_back(std::move(newLog));
+        });
     }
 
+    // @param tags labels shared by all items, i.e. global tags, local info and interval
+    void FlushMetrics(PipelineEventGroup& group, ObserverMetricTags& tags, time_t time) {
+        flush([&](ProtocolEventAggItem& item) { item.ToMetricEvents(group, tags, time); });
+    }
 
 private:
+    static constexpr uint32_t kEmptySlot = ProtocolEventAggItemManager::kInvalidIndex;
+    static constexpr size_t kEvictSampleCnt = 8;
+
+    struct Slot {
+        uint64_t Hash = 0;
+        uint32_t Index = kEmptySlot;
+    };
+
     bool isFull(PacketRoleType role) {
         if (role == PacketRoleType::Client) {
-            return this->mProtocolEventAggMap.size() >= mClientAggMaxSize;
+            return mSize >= mClientAggMaxSize;
         }
         if (role == PacketRoleType::Server) {
-            return this->mProtocolEventAggMap.size() >= mServerAggMaxSize;
+            return mSize >= mServerAggMaxSize;
         }
         return true;
     }
+
+    template <typename ProtocolEventKey>
+    void logDrop(ProtocolEventKey& key) {
+        static uint32_t sLastDropTime{0};
+        auto now = time(nullptr);
+        LOG_DEBUG(sLogger, ("aggregator is full, some events would be dropped", key.ToString()));
+        if (now - sLastDropTime > 60) {
+            sLastDropTime = now;
+            LOG_ERROR(sLogger, ("aggregator is full, some events would be dropped", key.ProtocolType()));
+        }
+    }
+
+    // @return the slot holding key, or the empty slot to insert it
+    template <typename ProtocolEventKey>
+    size_t findSlot(uint64_t hashVal, const ProtocolEventKey& key) {
+        size_t pos = hashVal & mMask;
+        while (mSlots[pos].Index != kEmptySlot
+               && (mSlots[pos].Hash != hashVal || !(mAggItemManager.Get(mSlots[pos].Index).Key == key))) {
+            pos = (pos + 1) & mMask;
+        }
+        return pos;
+    }
+
+    // backward shift deletion, which keeps probe sequences valid without tombstones
+    void eraseSlot(size_t pos) {
+        size_t next = (pos + 1) & mMask;
+        while (mSlots[next].Index != kEmptySlot) {
+            size_t home = mSlots[next].Hash & mMask;
+            if (((next - home) & mMask) >= ((next - pos) & mMask)) {
+                mSlots[pos] = mSlots[next];
+                pos = next;
+            }
+            next = (next + 1) & mMask;
+        }
+        mSlots[pos] = Slot();
+        --mSize;
+    }
+
+    ProtocolEventAggItem& getOverflowItem(PacketRoleType role) {
+        return mOverflowItems[role == PacketRoleType::Client ? 0 : 1];
+    }
+
+    // @return index of the evicted item to be reused, whose weight is kept, or kEmptySlot if there is no item
+    uint32_t evict() {
+        size_t victimPos = mSlots.size();
+        size_t sampled = 0;
+        for (size_t i = 0; i < mSlots.size() && sampled < kEvictSampleCnt; ++i) {
+            size_t pos = (mEvictCursor + i) & mMask;
+            if (mSlots[pos].Index == kEmptySlot) {
+                continue;
+            }
+            ++sampled;
+            if (victimPos == mSlots.size()
+                || mAggItemManager.Get(mSlots[pos].Index).Weight
+                    < mAggItemManager.Get(mSlots[victimPos].Index).Weight) {
+                victimPos = pos;
+            }
+        }
+        if (victimPos == mSlots.size()) {
+            return kEmptySlot;
+        }
+        mEvictCursor = (victimPos + 1) & mMask;
+
+        uint32_t index = mSlots[victimPos].Index;
+        eraseSlot(victimPos);
+        ProtocolEventAggItem& victim = mAggItemManager.Get(index);
+        ProtocolEventAggItem& overflow = getOverflowItem(victim.Key.ConnKey.Role);
+        if (overflow.AggResult.IsEmpty()) {
+            overflow.Key = victim.Key;
+            overflow.Key.SetOverflow();
+        }
+        overflow.Merge(victim);
+        return index;
+    }
+
+    // call func for each non-empty item and clear it, items staying empty for a whole interval are removed
+    template <typename Func>
+    void flush(Func&& func) {
+        for (auto& overflow : mOverflowItems) {
+            if (!overflow.AggResult.IsEmpty()) {
+                func(overflow);
+                overflow.Clear();
+            }
+        }
+        if (mSize == 0) {
+            return;
+        }
+        // start from an empty slot, so that slots shifted back by deletion are never visited twice
+        size_t start = 0;
+        while (mSlots[start].Index != kEmptySlot) {
+            ++start;
+        }
+        for (size_t i = 1; i < mSlots.size(); ++i) {
+            size_t pos = (start + i) & mMask;
+            while (mSlots[pos].Index != kEmptySlot) {
+                ProtocolEventAggItem& item = mAggItemManager.Get(mSlots[pos].Index);
+                if (!item.AggResult.IsEmpty()) {
+                    func(item);
+                    item.Clear(); // wait for next clear
+                    // decay, so that keys hot in the past give way to keys hot now
+                    item.Weight >>= 1;
+                    break;
+                }
+                mAggItemManager.Delete(mSlots[pos].Index);
+                eraseSlot(pos);
+            }
+        }
+    }
+
     ProtocolEventAggItemManager mAggItemManager;
-    std::unordered_map<uint64_t, ProtocolEventAggItem*> mProtocolEventAggMap;
+    std::vector<Slot> mSlots;
+    size_t mMask = 0;
+    uint32_t mSize = 0;
+    size_t mEvictCursor = 0;
+    // results of evicted keys of client and server role
+    ProtocolEventAggItem mOverflowItems[2];
     uint32_t mClientAggMaxSize;
     uint32_t mServerAggMaxSize;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProtocolUtilUnittest;
+#endif
 };
 
 /**
@@ -0,0 +1,225 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "parser/DelimiterSplitter.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <cstring>
+
+#include "parser/DelimiterModeFsmParser.h"
+
+using namespace std;
+
+namespace logtail {
+
+#if defined(__aarch64__) && !defined(__SSE2__)
+static constexpr uint32_t kBitsPerChar = 4;
+#else
+static constexpr uint32_t kBitsPerChar = 1;
+#endif
+
+// @return mask of chars in the 16-byte block equal to a or b, each char takes kBitsPerChar bits and only the highest
+// one is set
+static inline uint64_t MatchBlock(const char* block, char a, char b) {
+#if defined(__SSE2__)
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i match = _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8(a)), _mm_cmpeq_epi8(data, _mm_set1_epi8(b)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(match));
+#elif defined(__aarch64__)
+    uint8x16_t data = vld1q_u8(reinterpret_cast<const uint8_t*>(block));
+    uint8x16_t match = vorrq_u8(vceqq_u8(data, vdupq_n_u8(a)), vceqq_u8(data, vdupq_n_u8(b)));
+    // narrow each byte to a nibble, since there is no movemask on neon
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+    return mask & 0x8888888888888888ULL;
+#else
+    uint64_t mask = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (block[i] == a || block[i] == b) {
+            mask |= 1ULL << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+// call f with positions of a or b in data in order, until f returns false
+// @return false if f returns false
+template <typename F>
+static inline bool ForEachMatch(const char* data, size_t size, char a, char b, F&& f) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint64_t mask = MatchBlock(data + i, a, b);
+        while (mask != 0) {
+            if (!f(i + __builtin_ctzll(mask) / kBitsPerChar)) {
+                return false;
+            }
+            mask &= mask - 1;
+        }
+    }
+    if (i < size) {
+        char block[16] = {0};
+        memcpy(block, data + i, size - i);
+        uint64_t mask = MatchBlock(block, a, b) & ((1ULL << ((size - i) * kBitsPerChar)) - 1);
+        while (mask != 0) {
+            if (!f(i + __builtin_ctzll(mask) / kBitsPerChar)) {
+                return false;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return true;
+}
+
+DelimiterSplitter::DelimiterSplitter(const string& separator, char quote, bool useQuote)
+    : mSeparator(separator), mQuote(quote), mUseQuote(useQuote && separator.size() == 1 && separator[0] != quote) {
+}
+
+void DelimiterSplitter::Split(const vector<StringView>& lines,
+                              vector<DelimiterField>& fields,
+                              vector<DelimiterLine>& res) const {
+    res.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        auto& line = res[i];
+        line.mFieldBegin = static_cast<uint32_t>(fields.size());
+        line.mSuccess = !lines[i].empty() && SplitLine(lines[i], fields);
+        line.mFieldEnd = static_cast<uint32_t>(fields.size());
+    }
+}
+
+bool DelimiterSplitter::SplitLine(StringView line, vector<DelimiterField>& fields) const {
+    size_t fieldCnt = fields.size();
+    bool res = mUseQuote ? SplitQuoted(line, fields) : SplitPlain(line, fields);
+    if (!res) {
+        fields.resize(fieldCnt);
+    }
+    return res;
+}
+
+bool DelimiterSplitter::SplitPlain(StringView line, vector<DelimiterField>& fields) const {
+    if (mSeparator.empty()) {
+        return false;
+    }
+    const char* data = line.data();
+    size_t size = line.size();
+    size_t sepSize = mSeparator.size();
+    const char* sepRest = mSeparator.data() + 1;
+    size_t fieldStart = 0;
+    ForEachMatch(data, size, mSeparator[0], mSeparator[0], [&](size_t pos) {
+        // separators do not overlap
+        if (pos < fieldStart || pos + sepSize > size || memcmp(data + pos + 1, sepRest, sepSize - 1) != 0) {
+            return true;
+        }
+        fields.push_back({static_cast<uint32_t>(fieldStart), static_cast<uint32_t>(pos - fieldStart), false, false});
+        fieldStart = pos + sepSize;
+        return true;
+    });
+    fields.push_back({static_cast<uint32_t>(fieldStart), static_cast<uint32_t>(size - fieldStart), false, false});
+    return true;
+}
+
+bool DelimiterSplitter::SplitQuoted(StringView line, vector<DelimiterField>& fields) const {
+    const char* data = line.data();
+    char separator = mSeparator[0];
+    // same transitions as DelimiterModeFsmParser, chars between two matches are data
+    DelimiterModeState state = STATE_INITIAL;
+    size_t fieldStart = 0;
+    size_t doubleQuoteNum = 0;
+    size_t next = 0;
+    auto handleData = [&](size_t pos) {
+        if (pos == next) {
+            return true;
+        }
+        if (state == STATE_INITIAL) {
+            state = STATE_DATA;
+        } else if (state == STATE_DOUBLE_QUOTE) {
+            return false;
+        }
+        return true;
+    };
+    auto addField = [&](size_t end, bool quoted) {
+        fields.push_back(
+            {static_cast<uint32_t>(fieldStart), static_cast<uint32_t>(end - fieldStart), quoted, doubleQuoteNum > 0});
+        doubleQuoteNum = 0;
+    };
+    bool res = ForEachMatch(data, line.size(), separator, mQuote, [&](size_t pos) {
+        if (!handleData(pos)) {
+            return false;
+        }
+        next = pos + 1;
+        if (data[pos] == separator) {
+            switch (state) {
+                case STATE_QUOTE:
+                    return true;
+                case STATE_DOUBLE_QUOTE:
+                    // the closing quote is not a part of the field
+                    --doubleQuoteNum;
+                    addField(pos - 1, true);
+                    break;
+                default:
+                    addField(pos, false);
+                    break;
+            }
+            state = STATE_INITIAL;
+            fieldStart = pos + 1;
+            return true;
+        }
+        switch (state) {
+            case STATE_INITIAL:
+                state = STATE_QUOTE;
+                fieldStart = pos + 1;
+                return true;
+            case STATE_QUOTE:
+                state = STATE_DOUBLE_QUOTE;
+                ++doubleQuoteNum;
+                return true;
+            case STATE_DOUBLE_QUOTE:
+                state = STATE_QUOTE;
+                return true;
+            default:
+                return false;
+        }
+    });
+    if (!res || !handleData(line.size())) {
+        return false;
+    }
+    switch (state) {
+        case STATE_QUOTE:
+            return false;
+        case STATE_DOUBLE_QUOTE:
+            --doubleQuoteNum;
+            addField(line.size() - 1, true);
+            return true;
+        default:
+            addField(line.size(), false);
+            return true;
+    }
+}
+
+size_t DelimiterSplitter::Unescape(StringView field, char* dst) const {
+    size_t j = 0;
+    for (size_t i = 0; i < field.size(); ++i) {
+        dst[j++] = field[i];
+        if (field[i] == mQuote && i + 1 < field.size() && field[i + 1] == mQuote) {
+            ++i;
+        }
+    }
+    return j;
+}
+
+} // namespace logtail
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "models/StringView.h"
+
+namespace logtail {
+
+struct DelimiterField {
+    // relative to the beginning of the line, quotes around a quoted field are excluded
+    uint32_t mOffset = 0;
+    uint32_t mLength = 0;
+    bool mQuoted = false;
+    // the field contains doubled quotes, which should be unescaped by DelimiterSplitter::Unescape
+    bool mEscaped = false;
+};
+
+struct DelimiterLine {
+    // fields of the line are [mFieldBegin, mFieldEnd) in the field array
+    uint32_t mFieldBegin = 0;
+    uint32_t mFieldEnd = 0;
+    bool mSuccess = false;
+};
+
+/*
+ * Splits delimited lines into field offsets. Lines are scanned 16 bytes at a time for separators and quotes, and only
+ * these chars are fed to the state machine of DelimiterModeFsmParser, so that the result is the same as before.
+ *
+ * When quote is used, the separator must be a single char different from the quote. Otherwise the separator can have
+ * multiple chars and fields are split as is.
+ */
+class DelimiterSplitter {
+public:
+    DelimiterSplitter() = default;
+    DelimiterSplitter(const std::string& separator, char quote, bool useQuote);
+
+    // split all lines at once, fields of all lines are appended to fields, and lines[i] is described by res[i]
+    void Split(const std::vector<StringView>& lines,
+               std::vector<DelimiterField>& fields,
+               std::vector<DelimiterLine>& res) const;
+    // @return false if the line is not valid, in which case nothing is appended to fields
+    bool SplitLine(StringView line, std::vector<DelimiterField>& fields) const;
+
+    // @return length of the unescaped field written to dst, which should have at least field.size() bytes
+    size_t Unescape(StringView field, char* dst) const;
+
+private:
+    bool SplitQuoted(StringView line, std::vector<DelimiterField>& fields) const;
+    bool SplitPlain(StringView line, std::vector<DelimiterField>& fields) const;
+
+    std::string mSeparator;
+    char mQuote = '"';
+    bool mUseQuote = false;
+};
+
+} // namespace logtail
@@ -24,12 +24,14 @@
 #include "common/ParamExtractor.h"
 #include "plugin/flusher/sls/FlusherSLS.h"
 #include "go_pipeline/LogtailPlugin.h"
+#include "monitor/LogtailMetric.h"
 #include "plugin/input/InputFeedbackInterfaceRegistry.h"
 #include "pipeline/plugin/PluginRegistry.h"
 #include "plugin/processor/ProcessorParseApsaraNative.h"
 #include "pipeline/queue/ProcessQueueManager.h"
 #include "pipeline/queue/QueueKeyManager.h"
 #include "pipeline/queue/SenderQueueManager.h"
+#include "runner/LogProcess.h"
 
 DECLARE_FLAG_INT32(default_plugin_log_queue_size);
 
@@ -326,7 +328,8 @@ void Pipeline::Start() {
         // TODO: 加载该Go流水线
     }
 
-    // TODO: 启用Process中改流水线对应的输入队列
+    ProcessQueueManager::GetInstance()->ValidatePop(mName);
+    ProcessQueueManager::GetInstance()->Trigger();
 
     if (!mGoPipelineWithInput.isNull()) {
         // TODO: 加载该Go流水线
@@ -340,11 +343,13 @@ void Pipeline::Start() {
 }
 
 void Pipeline::Process(vector<PipelineEventGroup>& logGroupList, size_t inputIndex) {
+    // sampling is decided once per call so that all processors are timed on the same event groups
+    bool sampleLatency = ShouldSampleStageLatency(LatencyStage::PROCESS);
     for (auto& p : mInputs[inputIndex]->GetInnerProcessors()) {
-        p->Process(logGroupList);
+        p->Process(logGroupList, sampleLatency);
     }
     for (auto& p : mProcessorLine) {
-        p->Process(logGroupList);
+        p->Process(logGroupList, sampleLatency);
     }
 }
 
@@ -380,6 +385,12 @@ bool Pipeline::FlushBatch() {
 }
 
 void Pipeline::Stop(bool isRemoving) {
+    PrepareStop(isRemoving);
+    LogProcess::GetInstance()->WaitForCurrentRounds();
+    FinishStop(isRemoving);
+}
+
+void Pipeline::PrepareStop(bool isRemoving) {
     // TODO: 应该保证指定时间内返回，如果无法返回，将配置放入stopDisabled里
     for (const auto& input : mInputs) {
         input->Stop(isRemoving);
@@ -389,10 +400,16 @@ void Pipeline::Stop(bool isRemoving) {
         // TODO: 卸载该Go流水线
     }
 
-    // TODO: 禁用Process中改流水线对应的输入队列
+    // Only this pipeline is quiesced, other pipelines keep being processed. Items already popped are processed by the
+    // old pipeline, and the rest are left in the queue for the new one if the pipeline is not removed.
+    ProcessQueueManager::GetInstance()->InvalidatePop(mName);
+}
 
+void Pipeline::FinishStop(bool isRemoving) {
     if (!isRemoving) {
         FlushBatch();
+    } else {
+        TimeoutFlushManager::GetInstance()->ClearRecords(mName);
     }
 
     if (!mGoPipelineWithoutInput.isNull()) {
@@ -41,6 +41,11 @@ public:
     bool Init(PipelineConfig&& config);
     void Start();
     void Stop(bool isRemoving);
+    // Stop split in two, so that several pipelines can be stopped with a single LogProcess::WaitForCurrentRounds in
+    // between: PrepareStop stops the inputs and the pop of the process queue, and FinishStop stops the flushers once
+    // no item of the pipeline is being processed.
+    void PrepareStop(bool isRemoving);
+    void FinishStop(bool isRemoving);
     void Process(std::vector<PipelineEventGroup>& logGroupList, size_t inputIndex);
     bool Send(std::vector<PipelineEventGroup>&& groupList);
     bool FlushBatch();
@@ -51,6 +56,7 @@ public:
     const Json::Value& GetConfig() const { return *mConfig; }
     const std::vector<std::unique_ptr<FlusherInstance>>& GetFlushers() const { return mFlushers; }
     bool IsFlushingThroughGoPipeline() const { return !mGoPipelineWithoutInput.isNull(); }
+    bool HasGoPipelines() const { return !mGoPipelineWithInput.isNull() || !mGoPipelineWithoutInput.isNull(); }
     const std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>>& GetPluginStatistics() const {
         return mPluginCntMap;
     }
@@ -31,6 +31,7 @@
 #include "streamlog/StreamLogManager.h"
 #endif
 #include "config/feedbacker/ConfigFeedbackReceiver.h"
+#include "pipeline/batch/TimeoutFlushManager.h"
 #include "pipeline/queue/ProcessQueueManager.h"
 #include "pipeline/queue/QueueKeyManager.h"
 
@@ -46,13 +47,14 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
     static bool isInputStreamStarted = false;
 #endif
     bool isInputObserverChanged = false, isInputFileChanged = false, isInputStreamChanged = false,
-         isInputContainerStdioChanged = false;
+         isInputContainerStdioChanged = false, isGoPipelineChanged = false;
     for (const auto& name : diff.mRemoved) {
         CheckIfInputUpdated(mPipelineNameEntityMap[name]->GetConfig()["inputs"][0],
                             isInputObserverChanged,
                             isInputFileChanged,
                             isInputStreamChanged,
                             isInputContainerStdioChanged);
+        isGoPipelineChanged = isGoPipelineChanged || mPipelineNameEntityMap[name]->HasGoPipelines();
     }
     for (const auto& config : diff.mModified) {
         CheckIfInputUpdated(*config.mInputs[0],
@@ -60,6 +62,8 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
                             isInputFileChanged,
                             isInputStreamChanged,
                             isInputContainerStdioChanged);
+        isGoPipelineChanged
+            = isGoPipelineChanged || config.HasGoPlugin() || mPipelineNameEntityMap[config.mName]->HasGoPipelines();
     }
     for (const auto& config : diff.mAdded) {
         CheckIfInputUpdated(*config.mInputs[0],
@@ -67,6 +71,7 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
                             isInputFileChanged,
                             isInputStreamChanged,
                             isInputContainerStdioChanged);
+        isGoPipelineChanged = isGoPipelineChanged || config.HasGoPlugin();
     }
 
 #if defined(__ENTERPRISE__) && defined(__linux__) && !defined(__ANDROID__)
@@ -85,18 +90,16 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
     if (isFileServerStarted && (isInputFileChanged || isInputContainerStdioChanged)) {
         FileServer::GetInstance()->Pause();
     }
-    LogProcess::GetInstance()->HoldOn();
-    LogtailPlugin::GetInstance()->HoldOn(false);
+    // Processing is not paused globally, each pipeline changed is quiesced by itself in Pipeline::Stop. Go pipelines
+    // are still paused all together, since they can only be reloaded that way.
+    if (isGoPipelineChanged) {
+        LogtailPlugin::GetInstance()->HoldOn(false);
+    }
 #endif
 
-    for (const auto& name : diff.mRemoved) {
-        auto iter = mPipelineNameEntityMap.find(name);
-        iter->second->Stop(true);
-        DecreasePluginUsageCnt(iter->second->GetPluginStatistics());
-        iter->second->RemoveProcessQueue();
-        mPipelineNameEntityMap.erase(iter);
-        ConfigFeedbackReceiver::GetInstance().FeedbackPipelineConfigStatus(name, ConfigFeedbackStatus::DELETED);
-    }
+    // new pipelines of modified configs are built before any old pipeline is stopped, so that the old ones can be
+    // quiesced all together, with a single wait for the processing threads
+    vector<pair<shared_ptr<Pipeline>, shared_ptr<Pipeline>>> modified;
     for (auto& config : diff.mModified) {
         auto p = BuildPipeline(std::move(config));
         if (!p) {
@@ -118,13 +121,43 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
         LOG_INFO(sLogger,
                  ("pipeline building for existing config succeeded",
                   "stop the old pipeline and start the new one")("config", config.mName));
+        modified.emplace_back(mPipelineNameEntityMap[config.mName], std::move(p));
+    }
+
+    for (const auto& name : diff.mRemoved) {
+        mPipelineNameEntityMap[name]->PrepareStop(true);
+    }
+    for (const auto& item : modified) {
+        item.first->PrepareStop(false);
+    }
+    if (!diff.mRemoved.empty() || !modified.empty()) {
+        LogProcess::GetInstance()->WaitForCurrentRounds();
+    }
 
-        auto iter = mPipelineNameEntityMap.find(config.mName);
-        iter->second->Stop(false);
+    for (const auto& name : diff.mRemoved) {
+        auto iter = mPipelineNameEntityMap.find(name);
+        iter->second->FinishStop(true);
         DecreasePluginUsageCnt(iter->second->GetPluginStatistics());
-        mPipelineNameEntityMap[config.mName] = p;
-        IncreasePluginUsageCnt(p->GetPluginStatistics());
-        p->Start();
+        iter->second->RemoveProcessQueue();
+        shared_ptr<Pipeline> removed;
+        {
+            ScopedSpinLock lock(mPipelineMapLock);
+            removed = std::move(iter->second);
+            mPipelineNameEntityMap.erase(iter);
+        }
+        ConfigFeedbackReceiver::GetInstance().FeedbackPipelineConfigStatus(name, ConfigFeedbackStatus::DELETED);
+    }
+    for (auto& item : modified) {
+        item.first->FinishStop(false);
+        DecreasePluginUsageCnt(item.first->GetPluginStatistics());
+        auto iter = mPipelineNameEntityMap.find(item.first->Name());
+        {
+            // the old pipeline is released out of the lock
+            ScopedSpinLock lock(mPipelineMapLock);
+            iter->second.swap(item.second);
+        }
+        IncreasePluginUsageCnt(iter->second->GetPluginStatistics());
+        iter->second->Start();
     }
     for (auto& config : diff.mAdded) {
         auto p = BuildPipeline(std::move(config));
@@ -144,22 +177,26 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
         LOG_INFO(sLogger,
                  ("pipeline building for new config succeeded", "begin to start pipeline")("config", config.mName));
         ConfigFeedbackReceiver::GetInstance().FeedbackPipelineConfigStatus(config.mName, ConfigFeedbackStatus::APPLIED);
-        mPipelineNameEntityMap[config.mName] = p;
+        {
+            ScopedSpinLock lock(mPipelineMapLock);
+            mPipelineNameEntityMap[config.mName] = p;
+        }
         IncreasePluginUsageCnt(p->GetPluginStatistics());
         p->Start();
     }
 
 #ifndef APSARA_UNIT_TEST_MAIN
-    // 过渡使用，有变更的流水线的Go流水线加载在BuildPipeline中完成
-    for (auto& name : diff.mUnchanged) {
-        mPipelineNameEntityMap[name]->LoadGoPipelines();
-    }
     // 在Flusher改造完成前，先不执行如下步骤，不会造成太大影响
     // Sender::CleanUnusedAk();
 
     // 过渡使用
-    LogtailPlugin::GetInstance()->Resume();
-    LogProcess::GetInstance()->Resume();
+    if (isGoPipelineChanged) {
+        // 有变更的流水线的Go流水线加载在BuildPipeline中完成
+        for (auto& name : diff.mUnchanged) {
+            mPipelineNameEntityMap[name]->LoadGoPipelines();
+        }
+        LogtailPlugin::GetInstance()->Resume();
+    }
     if (isInputFileChanged || isInputContainerStdioChanged) {
         if (isFileServerStarted) {
             FileServer::GetInstance()->Resume();
@@ -200,6 +237,7 @@ void logtail::PipelineManager::UpdatePipelines(PipelineConfigDiff& diff) {
 }
 
 shared_ptr<Pipeline> PipelineManager::FindConfigByName(const string& configName) const {
+    ScopedSpinLock lock(mPipelineMapLock);
     auto it = mPipelineNameEntityMap.find(configName);
     if (it != mPipelineNameEntityMap.end()) {
         return it->second;
@@ -209,6 +247,7 @@ shared_ptr<Pipeline> PipelineManager::FindConfigByName(const string& configName)
 
 vector<string> PipelineManager::GetAllConfigNames() const {
     vector<string> res;
+    ScopedSpinLock lock(mPipelineMapLock);
     for (const auto& item : mPipelineNameEntityMap) {
         res.push_back(item.first);
     }
@@ -250,6 +289,7 @@ void PipelineManager::StopAllPipelines() {
         LOG_INFO(sLogger, ("flush process daemon queue", "succeeded"));
     }
     LogProcess::GetInstance()->HoldOn();
+    TimeoutFlushManager::GetInstance()->Stop();
 
     FlushAllBatch();
 
@@ -64,7 +64,9 @@ private:
                              bool& isInputStreamChanged,
                              bool& isInputContainerStdioChanged);
 
+    // only modified by the config update thread, which therefore reads it without lock
     std::unordered_map<std::string, std::shared_ptr<Pipeline>> mPipelineNameEntityMap;
+    mutable SpinLock mPipelineMapLock;
     mutable SpinLock mPluginCntMapLock;
     std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>> mPluginCntMap;
 
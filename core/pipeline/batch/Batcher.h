@@ -84,14 +84,37 @@ public:
                                   ctx.GetRegion());
         }
 
+        // TimeoutMs takes precedence over TimeoutSecs, for pipelines which should be flushed within a second
+        uint32_t timeoutMs = 0;
+        if (!GetOptionalUIntParam(config, "TimeoutMs", timeoutMs, errorMsg)) {
+            PARAM_WARNING_IGNORE(ctx.GetLogger(),
+                                 ctx.GetAlarm(),
+                                 errorMsg,
+                                 flusher->Name(),
+                                 ctx.GetConfigName(),
+                                 ctx.GetProjectName(),
+                                 ctx.GetLogstoreName(),
+                                 ctx.GetRegion());
+            timeoutMs = 0;
+        }
+
+        uint32_t groupTimeoutMs = 0;
+        if (timeoutMs == 0) {
+            uint32_t groupTimeout = enableGroupBatch ? timeoutSecs / 2 : 0;
+            groupTimeoutMs = groupTimeout * 1000;
+            mEventTimeoutMs = (timeoutSecs - groupTimeout) * 1000;
+        } else {
+            groupTimeoutMs = enableGroupBatch ? timeoutMs / 2 : 0;
+            mEventTimeoutMs = timeoutMs - groupTimeoutMs;
+        }
+        // batches are flushed on time by TimeoutFlushManager, the timeout in seconds is only checked when events are
+        // added
         if (enableGroupBatch) {
-            uint32_t groupTimeout = timeoutSecs / 2;
-            mGroupFlushStrategy = GroupFlushStrategy(maxSizeBytes, groupTimeout);
+            mGroupTimeoutMs = groupTimeoutMs;
+            mGroupFlushStrategy = GroupFlushStrategy(maxSizeBytes, (groupTimeoutMs + 999) / 1000);
             mGroupQueue = GroupBatchItem();
-            mEventFlushStrategy.SetTimeoutSecs(timeoutSecs - groupTimeout);
-        } else {
-            mEventFlushStrategy.SetTimeoutSecs(timeoutSecs);
         }
+        mEventFlushStrategy.SetTimeoutSecs((mEventTimeoutMs + 999) / 1000);
         mEventFlushStrategy.SetMaxSizeBytes(maxSizeBytes);
         mEventFlushStrategy.SetMaxCnt(maxCnt);
 
@@ -117,11 +140,8 @@ public:
                         mGroupQueue->Flush(res);
                     }
                     if (mGroupQueue->IsEmpty()) {
-                        TimeoutFlushManager::GetInstance()->UpdateRecord(mFlusher->GetContext().GetConfigName(),
-                                                                         0,
-                                                                         0,
-                                                                         mGroupFlushStrategy->GetTimeoutSecs(),
-                                                                         mFlusher);
+                        TimeoutFlushManager::GetInstance()->UpdateRecord(
+                            mFlusher->GetContext().GetConfigName(), 0, 0, mGroupTimeoutMs, mFlusher);
                     }
                     item.Flush(mGroupQueue.value());
                     if (mGroupFlushStrategy->NeedFlushBySize(mGroupQueue->GetStatus())) {
@@ -135,7 +155,7 @@ public:
                            g.GetExactlyOnceCheckpoint(),
                            g.GetMetadata(EventGroupMetaKey::SOURCE_ID));
                 TimeoutFlushManager::GetInstance()->UpdateRecord(
-                    mFlusher->GetContext().GetConfigName(), 0, key, mEventFlushStrategy.GetTimeoutSecs(), mFlusher);
+                    mFlusher->GetContext().GetConfigName(), 0, key, mEventTimeoutMs, mFlusher);
             } else if (i == 0) {
                 item.AddSourceBuffer(g.GetSourceBuffer());
             }
@@ -174,7 +194,7 @@ public:
         }
         if (mGroupQueue->IsEmpty()) {
             TimeoutFlushManager::GetInstance()->UpdateRecord(
-                mFlusher->GetContext().GetConfigName(), 0, 0, mGroupFlushStrategy->GetTimeoutSecs(), mFlusher);
+                mFlusher->GetContext().GetConfigName(), 0, 0, mGroupTimeoutMs, mFlusher);
         }
         iter->second.Flush(mGroupQueue.value());
         mEventQueueMap.erase(iter);
@@ -216,6 +236,8 @@ private:
 
     std::optional<GroupBatchItem> mGroupQueue;
     std::optional<GroupFlushStrategy> mGroupFlushStrategy;
+    uint32_t mEventTimeoutMs = 0;
+    uint32_t mGroupTimeoutMs = 0;
 
     Flusher* mFlusher = nullptr;
 
@@ -14,37 +14,124 @@
 
 #include "pipeline/batch/TimeoutFlushManager.h"
 
+#include <chrono>
+
+#include "common/Flags.h"
+#include "logger/Logger.h"
+
+DEFINE_FLAG_INT32(batch_timeout_flush_max_wait_ms, "max interval of checking batches to flush on timeout", 1000);
+
 using namespace std;
 
 namespace logtail {
 
-void TimeoutFlushManager::UpdateRecord(
-    const string& config, size_t index, size_t key, uint32_t timeoutSecs, Flusher* f) {
-    lock_guard<mutex> lock(mMux);
-    auto& item = mTimeoutRecords[config];
-    auto it = item.find({index, key});
-    if (it == item.end()) {
-        item.try_emplace({index, key}, f, key, timeoutSecs);
+const size_t TimeoutFlushManager::kShardCount;
+
+uint64_t TimeoutFlushManager::GetSteadyTimeInMs() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TimeoutFlushManager::Init() {
+    {
+        lock_guard<mutex> lock(mThreadMux);
+        if (mIsThreadRunning) {
+            return;
+        }
+        mIsThreadRunning = true;
+    }
+    mThreadRes = async(launch::async, &TimeoutFlushManager::Run, this);
+    LOG_INFO(sLogger, ("timeout flush manager", "started"));
+}
+
+void TimeoutFlushManager::Stop() {
+    {
+        lock_guard<mutex> lock(mThreadMux);
+        if (!mIsThreadRunning) {
+            return;
+        }
+        mIsThreadRunning = false;
+    }
+    mCond.notify_one();
+    future_status s = mThreadRes.wait_for(chrono::seconds(1));
+    if (s == future_status::ready) {
+        LOG_INFO(sLogger, ("timeout flush manager", "stopped successfully"));
     } else {
-        it->second.Update();
+        LOG_WARNING(sLogger, ("timeout flush manager", "forced to stopped"));
+    }
+}
+
+uint32_t TimeoutFlushManager::Shard::GetConfigId(const string& config) {
+    auto res = mConfigIds.try_emplace(config, mNextConfigId);
+    if (res.second) {
+        mConfigNames.emplace(mNextConfigId++, config);
+    }
+    return res.first->second;
+}
+
+void TimeoutFlushManager::Shard::PushDeadline(uint32_t configId,
+                                              const pair<size_t, size_t>& id,
+                                              TimeoutRecord& record) {
+    record.mDeadlineSeq = mNextDeadlineSeq++;
+    mDeadlines.push({record.GetDeadline(), record.mDeadlineSeq, configId, id});
+}
+
+void TimeoutFlushManager::UpdateRecord(
+    const string& config, size_t index, size_t key, uint32_t timeoutMs, Flusher* f) {
+    const uint64_t now = GetSteadyTimeInMs();
+    uint64_t deadline = 0;
+    {
+        auto& shard = GetShard(config);
+        lock_guard<mutex> lock(shard.mMux);
+        auto& item = shard.mTimeoutRecords[config];
+        auto it = item.find({index, key});
+        if (it != item.end()) {
+            // the deadline only gets later, which is handled when the one in the heap is popped
+            it->second.Update(now);
+            return;
+        }
+        it = item.try_emplace({index, key}, f, key, timeoutMs, now).first;
+        shard.PushDeadline(shard.GetConfigId(config), {index, key}, it->second);
+        deadline = it->second.GetDeadline();
+    }
+    if (deadline < mNextWakeupTime.load(memory_order_relaxed)) {
+        {
+            lock_guard<mutex> lock(mThreadMux);
+            mHasEarlierDeadline = true;
+        }
+        mCond.notify_one();
     }
 }
 
 void TimeoutFlushManager::FlushTimeoutBatch() {
+    lock_guard<mutex> flushLock(mFlushMux);
     vector<pair<Flusher*, size_t>> records;
-    {
-        lock_guard<mutex> lock(mMux);
-        for (auto& item : mTimeoutRecords) {
-            for (auto it = item.second.begin(); it != item.second.end();) {
-                if (time(nullptr) - it->second.mUpdateTime >= it->second.mTimeoutSecs) {
-                    // cannot flush here, since flush may also update record, which will lead to both deadlock and map
-                    // iterator invalidation problems
-                    records.emplace_back(it->second.mFlusher, it->second.mKey);
-                    it = item.second.erase(it);
-                } else {
-                    ++it;
-                }
+    const uint64_t now = GetSteadyTimeInMs();
+    for (auto& shard : mShards) {
+        lock_guard<mutex> lock(shard.mMux);
+        while (!shard.mDeadlines.empty() && shard.mDeadlines.top().mTime <= now) {
+            const Deadline deadline = shard.mDeadlines.top();
+            shard.mDeadlines.pop();
+            auto name = shard.mConfigNames.find(deadline.mConfigId);
+            if (name == shard.mConfigNames.end()) {
+                continue;
+            }
+            auto item = shard.mTimeoutRecords.find(name->second);
+            if (item == shard.mTimeoutRecords.end()) {
+                continue;
             }
+            auto it = item->second.find(deadline.mId);
+            if (it == item->second.end() || it->second.mDeadlineSeq != deadline.mSeq) {
+                continue;
+            }
+            if (it->second.GetDeadline() > now) {
+                // the record has been updated since the deadline was pushed
+                shard.PushDeadline(deadline.mConfigId, deadline.mId, it->second);
+                continue;
+            }
+            // cannot flush here, since flush may also update record, which will lead to both deadlock and map
+            // iterator invalidation problems
+            records.emplace_back(it->second.mFlusher, it->second.mKey);
+            item->second.erase(it);
         }
     }
     for (auto& item : records) {
@@ -53,8 +140,40 @@ void TimeoutFlushManager::FlushTimeoutBatch() {
 }
 
 void TimeoutFlushManager::ClearRecords(const string& config) {
-    lock_guard<mutex> lock(mMux);
-    mTimeoutRecords.erase(config);
+    lock_guard<mutex> flushLock(mFlushMux);
+    auto& shard = GetShard(config);
+    lock_guard<mutex> lock(shard.mMux);
+    shard.mTimeoutRecords.erase(config);
+    auto it = shard.mConfigIds.find(config);
+    if (it != shard.mConfigIds.end()) {
+        shard.mConfigNames.erase(it->second);
+        shard.mConfigIds.erase(it);
+    }
+}
+
+void TimeoutFlushManager::Run() {
+    unique_lock<mutex> lock(mThreadMux);
+    while (mIsThreadRunning) {
+        // records with deadlines earlier than the wakeup time wake the thread up once they are updated
+        mNextWakeupTime = GetSteadyTimeInMs() + INT32_FLAG(batch_timeout_flush_max_wait_ms);
+        mHasEarlierDeadline = false;
+        lock.unlock();
+
+        FlushTimeoutBatch();
+        uint64_t nextWakeupTime = mNextWakeupTime;
+        for (auto& shard : mShards) {
+            lock_guard<mutex> shardLock(shard.mMux);
+            if (!shard.mDeadlines.empty()) {
+                nextWakeupTime = min(nextWakeupTime, shard.mDeadlines.top().mTime);
+            }
+        }
+
+        lock.lock();
+        mNextWakeupTime = nextWakeupTime;
+        mCond.wait_until(lock,
+                         chrono::steady_clock::time_point(chrono::milliseconds(nextWakeupTime)),
+                         [this]() { return !mIsThreadRunning || mHasEarlierDeadline; });
+    }
 }
 
 } // namespace logtail
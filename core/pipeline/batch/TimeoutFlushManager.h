@@ -16,11 +16,17 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <ctime>
+#include <functional>
+#include <future>
 #include <map>
 #include <mutex>
+#include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "pipeline/plugin/interface/Flusher.h"
@@ -30,15 +36,21 @@ namespace logtail {
 struct TimeoutRecord {
     Flusher* mFlusher = nullptr;
     size_t mKey;
-    time_t mUpdateTime = 0;
-    uint32_t mTimeoutSecs = 0;
+    // steady time in milliseconds
+    uint64_t mUpdateTime = 0;
+    uint32_t mTimeoutMs = 0;
+    // sequence of the only deadline in the heap that stands for the record, others are stale
+    uint64_t mDeadlineSeq = 0;
 
-    TimeoutRecord(Flusher* flusher, size_t key, uint32_t timeoutSecs)
-        : mFlusher(flusher), mKey(key), mUpdateTime(time(nullptr)), mTimeoutSecs(timeoutSecs) {}
+    TimeoutRecord(Flusher* flusher, size_t key, uint32_t timeoutMs, uint64_t now)
+        : mFlusher(flusher), mKey(key), mUpdateTime(now), mTimeoutMs(timeoutMs) {}
 
-    void Update() { mUpdateTime = time(nullptr); }
+    void Update(uint64_t now) { mUpdateTime = now; }
+    uint64_t GetDeadline() const { return mUpdateTime + mTimeoutMs; }
 };
 
+// TimeoutFlushManager flushes batches on timeout in a dedicated thread, which sleeps until the earliest deadline, so
+// that batches are flushed in time regardless of the load of processing threads.
 class TimeoutFlushManager {
 public:
     TimeoutFlushManager(const TimeoutFlushManager&) = delete;
@@ -49,16 +61,64 @@ public:
         return &instance;
     }
 
-    void UpdateRecord(const std::string& config, size_t index, size_t key, uint32_t timeoutSecs, Flusher* f);
+    void Init();
+    void Stop();
+
+    void UpdateRecord(const std::string& config, size_t index, size_t key, uint32_t timeoutMs, Flusher* f);
+    // Flush all batches whose deadline has been reached.
     void FlushTimeoutBatch();
+    // No batch of the config is being flushed by timeout when it returns.
     void ClearRecords(const std::string& config);
 
 private:
+    static const size_t kShardCount = 16;
+
+    struct Deadline {
+        uint64_t mTime;
+        uint64_t mSeq;
+        uint32_t mConfigId;
+        std::pair<size_t, size_t> mId;
+
+        bool operator>(const Deadline& rhs) const { return mTime > rhs.mTime; }
+    };
+
+    // records are sharded by config, so that batchers of different pipelines do not contend for one lock
+    struct Shard {
+        std::mutex mMux;
+        std::map<std::string, std::map<std::pair<size_t, size_t>, TimeoutRecord>> mTimeoutRecords;
+        // one deadline per record, pushed when the record is created and pushed again with the updated deadline when
+        // popped before it, so that updating a record costs no push. Deadlines of removed records are dropped when
+        // popped.
+        std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> mDeadlines;
+        uint64_t mNextDeadlineSeq = 1;
+        // config names are interned, so that deadlines do not hold copies of them. Ids are released when records of the
+        // config are cleared and never reused, so that deadlines left in the heap for a cleared config are dropped.
+        std::unordered_map<std::string, uint32_t> mConfigIds;
+        std::unordered_map<uint32_t, std::string> mConfigNames;
+        uint32_t mNextConfigId = 0;
+
+        uint32_t GetConfigId(const std::string& config);
+        void PushDeadline(uint32_t configId, const std::pair<size_t, size_t>& id, TimeoutRecord& record);
+    };
+
     TimeoutFlushManager() = default;
     ~TimeoutFlushManager() = default;
 
-    std::mutex mMux;
-    std::map<std::string, std::map<std::pair<size_t, size_t>, TimeoutRecord>> mTimeoutRecords;
+    static uint64_t GetSteadyTimeInMs();
+
+    Shard& GetShard(const std::string& config) { return mShards[std::hash<std::string>()(config) % kShardCount]; }
+    void Run();
+
+    std::array<Shard, kShardCount> mShards;
+    // held while flushing, so that ClearRecords can wait for the flushing round
+    std::mutex mFlushMux;
+
+    std::future<void> mThreadRes;
+    std::mutex mThreadMux;
+    std::condition_variable mCond;
+    bool mIsThreadRunning = false;
+    bool mHasEarlierDeadline = false;
+    std::atomic_uint64_t mNextWakeupTime{0};
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class PipelineUnittest;
@@ -43,12 +43,11 @@ public:
                                        const PipelineContext& ctx,
                                        const std::string& pluginType,
                                        CompressType defaultType);
+    std::unique_ptr<Compressor> Create(CompressType defaultType);
 
 private:
     CompressorFactory() = default;
     ~CompressorFactory() = default;
-
-    std::unique_ptr<Compressor> Create(CompressType defaultType);
 };
 
 } // namespace logtail
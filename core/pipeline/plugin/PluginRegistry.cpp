@@ -26,6 +26,7 @@
 #include "app_config/AppConfig.h"
 #include "common/Flags.h"
 #include "plugin/flusher/blackhole/FlusherBlackHole.h"
+#include "plugin/flusher/file/FlusherFile.h"
 #include "plugin/flusher/sls/FlusherSLS.h"
 #include "plugin/input/InputContainerStdio.h"
 #include "plugin/input/InputFile.h"
@@ -164,6 +165,7 @@ void PluginRegistry::LoadStaticPlugins() {
 
     RegisterFlusherCreator(new StaticFlusherCreator<FlusherSLS>());
     RegisterFlusherCreator(new StaticFlusherCreator<FlusherBlackHole>());
+    RegisterFlusherCreator(new StaticFlusherCreator<FlusherFile>());
 }
 
 void PluginRegistry::LoadDynamicPlugins(const set<string>& plugins) {
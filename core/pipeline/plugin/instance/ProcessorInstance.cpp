@@ -37,11 +37,13 @@ bool ProcessorInstance::Init(const Json::Value& config, PipelineContext& context
     mProcInRecordsTotal = mPlugin->GetMetricsRecordRef().CreateCounter(METRIC_PROC_IN_RECORDS_TOTAL);
     mProcOutRecordsTotal = mPlugin->GetMetricsRecordRef().CreateCounter(METRIC_PROC_OUT_RECORDS_TOTAL);
     mProcTimeMS = mPlugin->GetMetricsRecordRef().CreateCounter(METRIC_PROC_TIME_MS);
+    mProcLatencyNs = mPlugin->GetMetricsRecordRef().CreateHistogram(METRIC_PROC_LATENCY_NS);
+    mProcCpuTimeNs = mPlugin->GetMetricsRecordRef().CreateHistogram(METRIC_PROC_CPU_TIME_NS);
 
     return true;
 }
 
-void ProcessorInstance::Process(vector<PipelineEventGroup>& logGroupList) {
+void ProcessorInstance::Process(vector<PipelineEventGroup>& logGroupList, bool sampleLatency) {
     if (logGroupList.empty()) {
         return;
     } 
@@ -49,11 +51,27 @@ void ProcessorInstance::Process(vector<PipelineEventGroup>& logGroupList) {
         mProcInRecordsTotal->Add(logGroup.GetEvents().size());
     }
 
+    uint64_t startCycles = 0, startCpuTime = 0;
+    if (sampleLatency) {
+        startCpuTime = GetCurrentThreadCpuTimeInNanoSeconds();
+        startCycles = GetCurrentCycles();
+    }
     uint64_t startTime = GetCurrentTimeInMilliSeconds();
     mPlugin->Process(logGroupList);
     uint64_t durationTime = GetCurrentTimeInMilliSeconds() - startTime;
 
     mProcTimeMS->Add(durationTime);
+    if (sampleLatency) {
+        uint64_t endCycles = GetCurrentCycles();
+        uint64_t endCpuTime = GetCurrentThreadCpuTimeInNanoSeconds();
+        // cycles may go backwards if the thread migrates across cores with unsynchronized TSC
+        if (endCycles >= startCycles) {
+            mProcLatencyNs->Observe(CyclesToNanoSeconds(endCycles - startCycles));
+        }
+        if (endCpuTime >= startCpuTime) {
+            mProcCpuTimeNs->Observe(endCpuTime - startCpuTime);
+        }
+    }
 
     for (const auto& logGroup : logGroupList) {
         mProcOutRecordsTotal->Add(logGroup.GetEvents().size());
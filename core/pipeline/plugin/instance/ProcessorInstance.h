@@ -35,7 +35,8 @@ public:
     const std::string& Name() const override { return mPlugin->Name(); };
 
     bool Init(const Json::Value& config, PipelineContext& context);
-    void Process(std::vector<PipelineEventGroup>& logGroupList);
+    // sampleLatency: whether to record latency and cpu time of this call into histograms
+    void Process(std::vector<PipelineEventGroup>& logGroupList, bool sampleLatency = false);
 
 private:
     std::unique_ptr<Processor> mPlugin;
@@ -45,6 +46,8 @@ private:
     // CounterPtr mProcInRecordsSizeBytes;
     // CounterPtr mProcOutRecordsSizeBytes;
     CounterPtr mProcTimeMS;
+    HistogramPtr mProcLatencyNs;
+    HistogramPtr mProcCpuTimeNs;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorInstanceUnittest;
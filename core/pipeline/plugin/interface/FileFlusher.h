@@ -0,0 +1,37 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "pipeline/plugin/interface/Flusher.h"
+#include "pipeline/queue/SenderQueueItem.h"
+
+namespace logtail {
+
+class FileFlusher : public Flusher {
+public:
+    virtual ~FileFlusher() = default;
+
+    // Write items to local files in order, and remove or reset each of them afterwards. Only called by the file sink
+    // thread.
+    virtual void Write(std::vector<SenderQueueItem*>& items) = 0;
+
+    virtual SinkType GetSinkType() override { return SinkType::FILE; }
+};
+
+} // namespace logtail
@@ -85,8 +85,8 @@ bool Flusher::PushToQueue(unique_ptr<SenderQueueItem>&& item, uint32_t retryTime
 
 void Flusher::DealSenderQueueItemAfterSend(SenderQueueItem* item, bool keep) {
     if (keep) {
-        item->mStatus = SendingStatus::IDLE;
         ++item->mTryCnt;
+        SenderQueueManager::GetInstance()->ResetItem(item->mQueueKey, item);
     } else {
         // TODO: because current profile has a dummy flusher, we have to use item->mQueueKey here
         SenderQueueManager::GetInstance()->RemoveItem(item->mQueueKey, item);
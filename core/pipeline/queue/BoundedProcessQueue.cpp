@@ -33,6 +33,7 @@ bool BoundedProcessQueue::Pop(unique_ptr<ProcessQueueItem>& item) {
     }
     item = std::move(mQueue.front());
     mQueue.pop();
+    RecordDwellTime(*item);
     if (ChangeStateIfNeededAfterPop()) {
         GiveFeedback();
     }
@@ -14,13 +14,24 @@
 
 #include "pipeline/queue/BoundedSenderQueueInterface.h"
 
-
+#include "common/TimeUtil.h"
+#include "monitor/MetricConstants.h"
+#include "pipeline/queue/QueueKeyManager.h"
 using namespace std;
 
 namespace logtail {
 
 FeedbackInterface* BoundedSenderQueueInterface::sFeedback = nullptr;
 
+BoundedSenderQueueInterface::BoundedSenderQueueInterface(size_t cap, size_t low, size_t high, QueueKey key)
+    : QueueInterface(key, cap), BoundedQueueInterface<std::unique_ptr<SenderQueueItem>>(key, cap, low, high) {
+    WriteMetrics::GetInstance()->PrepareMetricsRecordRef(
+        mMetricsRecordRef,
+        {{METRIC_LABEL_COMPONENT_NAME, "sender_queue"},
+         {METRIC_LABEL_QUEUE_NAME, QueueKeyManager::GetInstance()->GetName(key)}});
+    mDwellTimeNs = mMetricsRecordRef.CreateHistogram(METRIC_QUEUE_DWELL_TIME_NS);
+}
+
 void BoundedSenderQueueInterface::SetFeedback(FeedbackInterface* feedback) {
     if (feedback == nullptr) {
         // should not happen
@@ -51,6 +62,18 @@ void BoundedSenderQueueInterface::GiveFeedback() const {
     sFeedback->Feedback(0);
 }
 
+void BoundedSenderQueueInterface::RecordDwellTime(SenderQueueItem* item) {
+    if (item->mEnqueueCycles == 0) {
+        return;
+    }
+    uint64_t now = GetCurrentCycles();
+    if (now >= item->mEnqueueCycles) {
+        mDwellTimeNs->Observe(CyclesToNanoSeconds(now - item->mEnqueueCycles));
+    }
+    // only the first sending attempt is counted
+    item->mEnqueueCycles = 0;
+}
+
 void BoundedSenderQueueInterface::Reset(size_t cap, size_t low, size_t high) {
     queue<unique_ptr<SenderQueueItem>>().swap(mExtraBuffer);
     mRateLimiter.reset();
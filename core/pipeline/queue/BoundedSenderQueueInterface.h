@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "common/FeedbackInterface.h"
+#include "monitor/LogtailMetric.h"
 #include "pipeline/queue/BoundedQueueInterface.h"
 #include "pipeline/queue/QueueKey.h"
 #include "pipeline/queue/SenderQueueItem.h"
@@ -37,13 +38,13 @@ class BoundedSenderQueueInterface : public BoundedQueueInterface<std::unique_ptr
 public:
     static void SetFeedback(FeedbackInterface* feedback);
 
-    BoundedSenderQueueInterface(size_t cap, size_t low, size_t high, QueueKey key)
-        : QueueInterface(key, cap), BoundedQueueInterface<std::unique_ptr<SenderQueueItem>>(key, cap, low, high) {}
+    BoundedSenderQueueInterface(size_t cap, size_t low, size_t high, QueueKey key);
 
     bool Pop(std::unique_ptr<SenderQueueItem>& item) override { return false; }
 
     virtual bool Remove(SenderQueueItem* item) = 0;
-    virtual void GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true) = 0;
+    // @return false if stopped by limiters while there may be idle items left
+    virtual bool GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true) = 0;
 
     void SetRateLimiter(uint32_t maxRate);
     void SetConcurrencyLimiters(std::vector<std::shared_ptr<ConcurrencyLimiter>>&& limiters);
@@ -58,11 +59,15 @@ protected:
 
     void GiveFeedback() const override;
     void Reset(size_t cap, size_t low, size_t high);
+    void RecordDwellTime(SenderQueueItem* item);
 
     std::optional<RateLimiter> mRateLimiter;
     std::vector<std::shared_ptr<ConcurrencyLimiter>> mConcurrencyLimiters;
 
     std::queue<std::unique_ptr<SenderQueueItem>> mExtraBuffer;
+
+    MetricsRecordRef mMetricsRecordRef;
+    HistogramPtr mDwellTimeNs;
 };
 
 } // namespace logtail
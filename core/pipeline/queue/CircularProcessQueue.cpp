@@ -42,6 +42,7 @@ bool CircularProcessQueue::Pop(unique_ptr<ProcessQueueItem>& item) {
     item = std::move(mQueue.front());
     mQueue.pop_front();
     mEventCnt -= item->mEventGroup.GetEvents().size();
+    RecordDwellTime(*item);
     return true;
 }
 
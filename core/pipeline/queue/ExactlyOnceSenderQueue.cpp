@@ -99,27 +99,32 @@ bool ExactlyOnceSenderQueue::Remove(SenderQueueItem* item) {
     return true;
 }
 
-void ExactlyOnceSenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool withLimits) {
+bool ExactlyOnceSenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool withLimits) {
     if (Empty()) {
-        return;
+        return true;
     }
     for (size_t index = 0; index < mCapacity; ++index) {
         SenderQueueItem* item = mQueue[index].get();
         if (item == nullptr) {
             continue;
         }
+        // the prepared checkpoint is still being persisted in group commit, the queue is triggered once it is done
+        if (!static_cast<SLSSenderQueueItem*>(item)->mExactlyOnceCheckpoint->IsPersisted()) {
+            continue;
+        }
         if (withLimits) {
             if (mRateLimiter && !mRateLimiter->IsValidToPop()) {
-                return;
+                return false;
             }
             for (auto& limiter : mConcurrencyLimiters) {
                 if (!limiter->IsValidToPop()) {
-                    return;
+                    return false;
                 }
             }
         }
         if (item->mStatus == SendingStatus::IDLE) {
             item->mStatus = SendingStatus::SENDING;
+            RecordDwellTime(item);
             items.emplace_back(item);
             if (withLimits) {
                 for (auto& limiter : mConcurrencyLimiters) {
@@ -131,6 +136,7 @@ void ExactlyOnceSenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& item
             }
         }
     }
+    return true;
 }
 
 void ExactlyOnceSenderQueue::Reset(const vector<RangeCheckpointPtr>& checkpoints) {
@@ -40,7 +40,7 @@ public:
 
     bool Push(std::unique_ptr<SenderQueueItem>&& item) override;
     bool Remove(SenderQueueItem* item) override;
-    void GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true) override;
+    bool GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true) override;
 
     void Reset(const std::vector<RangeCheckpointPtr>& checkpoints);
 
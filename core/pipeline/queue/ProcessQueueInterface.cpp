@@ -14,12 +14,21 @@
 
 #include "pipeline/queue/ProcessQueueInterface.h"
 
+#include "common/TimeUtil.h"
+#include "monitor/MetricConstants.h"
 #include "pipeline/queue/BoundedSenderQueueInterface.h"
 
 using namespace std;
 
 namespace logtail {
 
+ProcessQueueInterface::ProcessQueueInterface(int64_t key, size_t cap, uint32_t priority, const string& config)
+    : QueueInterface(key, cap), mPriority(priority), mConfigName(config) {
+    WriteMetrics::GetInstance()->PrepareMetricsRecordRef(
+        mMetricsRecordRef, {{METRIC_LABEL_COMPONENT_NAME, "process_queue"}, {METRIC_LABEL_QUEUE_NAME, config}});
+    mDwellTimeNs = mMetricsRecordRef.CreateHistogram(METRIC_QUEUE_DWELL_TIME_NS);
+}
+
 void ProcessQueueInterface::SetDownStreamQueues(vector<BoundedSenderQueueInterface*>&& ques) {
     mDownStreamQueues.clear();
     for (auto& item : ques) {
@@ -35,6 +44,16 @@ bool ProcessQueueInterface::IsValidToPop() const {
     return mValidToPop && !Empty() && IsDownStreamQueuesValidToPush();
 }
 
+void ProcessQueueInterface::RecordDwellTime(const ProcessQueueItem& item) {
+    if (item.mEnqueueCycles == 0) {
+        return;
+    }
+    uint64_t now = GetCurrentCycles();
+    if (now >= item.mEnqueueCycles) {
+        mDwellTimeNs->Observe(CyclesToNanoSeconds(now - item.mEnqueueCycles));
+    }
+}
+
 bool ProcessQueueInterface::IsDownStreamQueuesValidToPush() const {
     // TODO: support other strategy
     for (const auto& q : mDownStreamQueues) {
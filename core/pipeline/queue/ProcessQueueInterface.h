@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "monitor/LogtailMetric.h"
 #include "pipeline/queue/ProcessQueueItem.h"
 #include "pipeline/queue/QueueInterface.h"
 
@@ -31,8 +32,7 @@ class BoundedSenderQueueInterface;
 // not thread-safe, should be protected explicitly by queue manager
 class ProcessQueueInterface : virtual public QueueInterface<std::unique_ptr<ProcessQueueItem>> {
 public:
-    ProcessQueueInterface(int64_t key, size_t cap, uint32_t priority, const std::string& config)
-        : QueueInterface(key, cap), mPriority(priority), mConfigName(config) {}
+    ProcessQueueInterface(int64_t key, size_t cap, uint32_t priority, const std::string& config);
     virtual ~ProcessQueueInterface() = default;
 
     void SetPriority(uint32_t priority) { mPriority = priority; }
@@ -52,6 +52,7 @@ public:
 
 protected:
     bool IsValidToPop() const;
+    void RecordDwellTime(const ProcessQueueItem& item);
 
 private:
     bool IsDownStreamQueuesValidToPush() const;
@@ -62,6 +63,9 @@ private:
     std::vector<BoundedSenderQueueInterface*> mDownStreamQueues;
     bool mValidToPop = true;
 
+    MetricsRecordRef mMetricsRecordRef;
+    HistogramPtr mDwellTimeNs;
+
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class BoundedProcessQueueUnittest;
     friend class CircularProcessQueueUnittest;
@@ -15,6 +15,8 @@
 #include "pipeline/queue/ProcessQueueManager.h"
 
 #include "common/Flags.h"
+#include "common/TimeUtil.h"
+#include "monitor/LogtailMetric.h"
 #include "pipeline/queue/BoundedProcessQueue.h"
 #include "pipeline/queue/CircularProcessQueue.h"
 #include "pipeline/queue/ExactlyOnceQueueManager.h"
@@ -107,6 +109,7 @@ bool ProcessQueueManager::IsValidToPush(QueueKey key) const {
 }
 
 int ProcessQueueManager::PushQueue(QueueKey key, unique_ptr<ProcessQueueItem>&& item) {
+    item->mEnqueueCycles = ShouldSampleStageLatency(LatencyStage::PROCESS_QUEUE) ? GetCurrentCycles() : 0;
     {
         lock_guard<mutex> lock(mQueueMux);
         auto iter = mQueues.find(key);
@@ -69,9 +69,9 @@ bool SenderQueue::Remove(SenderQueueItem* item) {
     return true;
 }
 
-void SenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool withLimits) {
+bool SenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool withLimits) {
     if (Empty()) {
-        return;
+        return true;
     }
     for (auto index = mRead; index < mWrite; ++index) {
         SenderQueueItem* item = mQueue[index % mCapacity].get();
@@ -80,16 +80,17 @@ void SenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool wit
         }
         if (withLimits) {
             if (mRateLimiter && !mRateLimiter->IsValidToPop()) {
-                return;
+                return false;
             }
             for (auto& limiter : mConcurrencyLimiters) {
                 if (!limiter->IsValidToPop()) {
-                    return;
+                    return false;
                 }
             }
         }
         if (item->mStatus == SendingStatus::IDLE) {
             item->mStatus = SendingStatus::SENDING;
+            RecordDwellTime(item);
             items.emplace_back(item);
             if (withLimits) {
                 for (auto& limiter : mConcurrencyLimiters) {
@@ -103,6 +104,7 @@ void SenderQueue::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool wit
             }
         }
     }
+    return true;
 }
 
 } // namespace logtail
@@ -37,7 +37,11 @@ public:
 
     bool Push(std::unique_ptr<SenderQueueItem>&& item) override;
     bool Remove(SenderQueueItem* item) override;
-    void GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true) override;
+    bool GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true) override;
+
+    // index of the flusher runner thread serving the queue
+    size_t GetShard() const { return mShard; }
+    void SetShard(size_t shard) { mShard = shard; }
 
 private:
     size_t Size() const override { return mSize; }
@@ -46,6 +50,7 @@ private:
     size_t mWrite = 0;
     size_t mRead = 0;
     size_t mSize = 0;
+    size_t mShard = 0;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class SenderQueueUnittest;
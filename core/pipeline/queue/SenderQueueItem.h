@@ -42,6 +42,7 @@ struct SenderQueueItem {
 
     SendingStatus mStatus = SendingStatus::IDLE;
     time_t mEnqueTime = 0;
+    uint64_t mEnqueueCycles = 0; // non-zero only when sampled for queue dwell time
     time_t mLastSendTime = 0;
     uint32_t mTryCnt = 1;
 
@@ -15,31 +15,44 @@
 #include "pipeline/queue/SenderQueueManager.h"
 
 #include "common/Flags.h"
+#include "common/TimeUtil.h"
+#include "monitor/LogtailMetric.h"
 #include "pipeline/queue/ExactlyOnceQueueManager.h"
 #include "pipeline/queue/QueueKeyManager.h"
 
 DEFINE_FLAG_INT32(sender_queue_gc_threshold_sec, "30s", 30);
 DEFINE_FLAG_INT32(sender_queue_capacity, "", 10);
+DECLARE_FLAG_INT32(flusher_runner_thread_num);
 
 using namespace std;
 
 namespace logtail {
 
-SenderQueueManager::SenderQueueManager() : mQueueParam(INT32_FLAG(sender_queue_capacity)) {
+SenderQueueManager::SenderQueueManager()
+    : mQueueParam(INT32_FLAG(sender_queue_capacity)),
+      mShards(max(INT32_FLAG(flusher_runner_thread_num), 1)),
+      mValidToPop(mShards.size(), false) {
 }
 
 bool SenderQueueManager::CreateQueue(QueueKey key,
                                      vector<shared_ptr<ConcurrencyLimiter>>&& concurrencyLimiters,
-                                     uint32_t maxRate) {
+                                     uint32_t maxRate,
+                                     const string& shardKey) {
+    size_t shard = shardKey.empty() ? 0 : hash<string>()(shardKey) % mShards.size();
     lock_guard<mutex> lock(mQueueMux);
     auto iter = mQueues.find(key);
     if (iter == mQueues.end()) {
         mQueues.try_emplace(
             key, mQueueParam.GetCapacity(), mQueueParam.GetLowWatermark(), mQueueParam.GetHighWatermark(), key);
         iter = mQueues.find(key);
+    } else if (iter->second.GetShard() != shard) {
+        mShards[iter->second.GetShard()].mReadyQueues.erase(key);
+        mShards[iter->second.GetShard()].mLimitedQueues.erase(key);
     }
     iter->second.SetConcurrencyLimiters(std::move(concurrencyLimiters));
     iter->second.SetRateLimiter(maxRate);
+    iter->second.SetShard(shard);
+    mShards[shard].mReadyQueues.insert(key);
     return true;
 }
 
@@ -81,6 +94,8 @@ bool SenderQueueManager::ReuseQueue(QueueKey key) {
 }
 
 int SenderQueueManager::PushQueue(QueueKey key, unique_ptr<SenderQueueItem>&& item) {
+    item->mEnqueueCycles = ShouldSampleStageLatency(LatencyStage::SENDER_QUEUE) ? GetCurrentCycles() : 0;
+    size_t shard = 0;
     {
         lock_guard<mutex> lock(mQueueMux);
         auto iter = mQueues.find(key);
@@ -88,6 +103,8 @@ int SenderQueueManager::PushQueue(QueueKey key, unique_ptr<SenderQueueItem>&& it
             if (!iter->second.Push(std::move(item))) {
                 return 1;
             }
+            shard = iter->second.GetShard();
+            mShards[shard].mReadyQueues.insert(key);
         } else {
             int res = ExactlyOnceQueueManager::GetInstance()->PushSenderQueue(key, std::move(item));
             if (res != 0) {
@@ -95,18 +112,46 @@ int SenderQueueManager::PushQueue(QueueKey key, unique_ptr<SenderQueueItem>&& it
             }
         }
     }
-    Trigger();
+    Trigger(shard);
     return 0;
 }
 
-void SenderQueueManager::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool withLimits) {
+void SenderQueueManager::GetAllAvailableItems(vector<SenderQueueItem*>& items, bool withLimits, size_t shard) {
     {
         lock_guard<mutex> lock(mQueueMux);
-        for (auto iter = mQueues.begin(); iter != mQueues.end(); ++iter) {
-            iter->second.GetAllAvailableItems(items, withLimits);
+        auto& s = mShards[shard];
+        if (!withLimits) {
+            for (auto iter = mQueues.begin(); iter != mQueues.end(); ++iter) {
+                if (iter->second.GetShard() == shard) {
+                    iter->second.GetAllAvailableItems(items, false);
+                }
+            }
+            s.mReadyQueues.clear();
+            s.mLimitedQueues.clear();
+        } else {
+            // rate limiters are reset every second, and concurrency limiters may be reset without any item released
+            if (!s.mLimitedQueues.empty() && time(nullptr) >= s.mLimitedQueuesRetryTime) {
+                releaseLimitedQueues(s);
+            }
+            for (auto key : s.mReadyQueues) {
+                auto iter = mQueues.find(key);
+                if (iter == mQueues.end()) {
+                    continue;
+                }
+                if (!iter->second.GetAllAvailableItems(items, true)) {
+                    if (s.mLimitedQueues.empty()) {
+                        s.mLimitedQueuesRetryTime = time(nullptr) + 1;
+                    }
+                    s.mLimitedQueues.insert(key);
+                }
+            }
+            // all idle items in the ready queues are taken, unless the queue is limited
+            s.mReadyQueues.clear();
         }
     }
-    ExactlyOnceQueueManager::GetInstance()->GetAllAvailableSenderQueueItems(items, withLimits);
+    if (shard == 0) {
+        ExactlyOnceQueueManager::GetInstance()->GetAllAvailableSenderQueueItems(items, withLimits);
+    }
 }
 
 bool SenderQueueManager::RemoveItem(QueueKey key, SenderQueueItem* item) {
@@ -114,12 +159,34 @@ bool SenderQueueManager::RemoveItem(QueueKey key, SenderQueueItem* item) {
         lock_guard<mutex> lock(mQueueMux);
         auto iter = mQueues.find(key);
         if (iter != mQueues.end()) {
-            return iter->second.Remove(item);
+            if (!iter->second.Remove(item)) {
+                return false;
+            }
+            // item in the extra buffer may be moved to the queue, and limiters are released
+            auto& shard = mShards[iter->second.GetShard()];
+            shard.mReadyQueues.insert(key);
+            releaseLimitedQueues(shard);
+            return true;
         }
     }
     return ExactlyOnceQueueManager::GetInstance()->RemoveSenderQueueItem(key, item);
 }
 
+void SenderQueueManager::ResetItem(QueueKey key, SenderQueueItem* item) {
+    size_t shard = 0;
+    {
+        lock_guard<mutex> lock(mQueueMux);
+        item->mStatus = SendingStatus::IDLE;
+        auto iter = mQueues.find(key);
+        if (iter != mQueues.end()) {
+            shard = iter->second.GetShard();
+            mShards[shard].mReadyQueues.insert(key);
+            releaseLimitedQueues(mShards[shard]);
+        }
+    }
+    Trigger(shard);
+}
+
 bool SenderQueueManager::IsAllQueueEmpty() const {
     {
         lock_guard<mutex> lock(mQueueMux);
@@ -152,6 +219,8 @@ void SenderQueueManager::ClearUnusedQueues() {
                 ++iter;
                 continue;
             }
+            mShards[itr->second.GetShard()].mReadyQueues.erase(iter->first);
+            mShards[itr->second.GetShard()].mLimitedQueues.erase(iter->first);
             mQueues.erase(itr);
         }
         QueueKeyManager::GetInstance()->RemoveKey(iter->first);
@@ -170,29 +239,62 @@ bool SenderQueueManager::IsValidToPush(QueueKey key) const {
     return false;
 }
 
-bool SenderQueueManager::Wait(uint64_t ms) {
+size_t SenderQueueManager::GetQueueShard(QueueKey key) const {
+    lock_guard<mutex> lock(mQueueMux);
+    auto iter = mQueues.find(key);
+    if (iter != mQueues.end()) {
+        return iter->second.GetShard();
+    }
+    return 0;
+}
+
+bool SenderQueueManager::Wait(uint64_t ms, size_t shard) {
     // TODO: use semaphore instead
     unique_lock<mutex> lock(mStateMux);
-    mCond.wait_for(lock, chrono::milliseconds(ms), [this] { return mValidToPop; });
-    if (mValidToPop) {
-        mValidToPop = false;
+    mCond.wait_for(lock, chrono::milliseconds(ms), [this, shard] { return mValidToPop[shard]; });
+    if (mValidToPop[shard]) {
+        mValidToPop[shard] = false;
         return true;
     }
     return false;
 }
 
+void SenderQueueManager::releaseLimitedQueues(Shard& shard) {
+    if (shard.mLimitedQueues.empty()) {
+        return;
+    }
+    if (shard.mReadyQueues.empty()) {
+        shard.mReadyQueues.swap(shard.mLimitedQueues);
+    } else {
+        shard.mReadyQueues.insert(shard.mLimitedQueues.begin(), shard.mLimitedQueues.end());
+        shard.mLimitedQueues.clear();
+    }
+}
+
 void SenderQueueManager::Trigger() {
     {
         lock_guard<mutex> lock(mStateMux);
-        mValidToPop = true;
+        mValidToPop.assign(mValidToPop.size(), true);
+    }
+    mCond.notify_all();
+}
+
+void SenderQueueManager::Trigger(size_t shard) {
+    {
+        lock_guard<mutex> lock(mStateMux);
+        mValidToPop[shard] = true;
     }
-    mCond.notify_one();
+    // all flusher runner threads wait on the same condition
+    mCond.notify_all();
 }
 
 #ifdef APSARA_UNIT_TEST_MAIN
 void SenderQueueManager::Clear() {
     lock_guard<mutex> lock(mQueueMux);
     mQueues.clear();
+    for (auto& shard : mShards) {
+        shard = Shard();
+    }
     mQueueDeletionTimeMap.clear();
 }
 
@@ -20,7 +20,9 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common/FeedbackInterface.h"
@@ -46,22 +48,34 @@ public:
 
     void Feedback(QueueKey key) override { Trigger(); }
 
+    // Queues with the same shardKey (e.g. region) are served by the same flusher runner thread.
     bool CreateQueue(QueueKey key,
                      std::vector<std::shared_ptr<ConcurrencyLimiter>>&& concurrencyLimiters
                      = std::vector<std::shared_ptr<ConcurrencyLimiter>>(),
-                     uint32_t maxRate = 0);
+                     uint32_t maxRate = 0,
+                     const std::string& shardKey = "");
     SenderQueue* GetQueue(QueueKey key);
     bool DeleteQueue(QueueKey key);
     bool ReuseQueue(QueueKey key);
     // 0: success, 1: queue is full, 2: queue not found
     int PushQueue(QueueKey key, std::unique_ptr<SenderQueueItem>&& item);
-    void GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true);
+    // Only queues in the shard are visited, and only those marked ready, i.e. with items pushed, removed or reset since
+    // they were last visited, when withLimits is true. Queues stopped by limiters are visited again once an item in
+    // the shard is released or in the next second. Exactly once queues belong to shard 0.
+    void GetAllAvailableItems(std::vector<SenderQueueItem*>& items, bool withLimits = true, size_t shard = 0);
     bool RemoveItem(QueueKey key, SenderQueueItem* item);
+    // put the item back to the queue to be sent again
+    void ResetItem(QueueKey key, SenderQueueItem* item);
     bool IsAllQueueEmpty() const;
     void ClearUnusedQueues();
 
-    bool Wait(uint64_t ms);
+    size_t GetShardCnt() const { return mShards.size(); }
+    size_t GetQueueShard(QueueKey key) const;
+
+    bool Wait(uint64_t ms, size_t shard = 0);
+    // wake up all shards
     void Trigger();
+    void Trigger(size_t shard);
 
     // only used for go pipeline before flushing data to C++ flusher
     bool IsValidToPush(QueueKey key) const;
@@ -75,10 +89,21 @@ private:
     SenderQueueManager();
     ~SenderQueueManager() = default;
 
+    // queues to be visited by a flusher runner thread, protected by mQueueMux
+    struct Shard {
+        std::unordered_set<QueueKey> mReadyQueues;
+        std::unordered_set<QueueKey> mLimitedQueues;
+        time_t mLimitedQueuesRetryTime = 0;
+    };
+
+    // should be called with mQueueMux held
+    void releaseLimitedQueues(Shard& shard);
+
     BoundedQueueParam mQueueParam;
 
     mutable std::mutex mQueueMux;
     std::unordered_map<QueueKey, SenderQueue> mQueues;
+    std::vector<Shard> mShards;
 
     mutable std::mutex mGCMux;
     std::unordered_map<QueueKey, time_t> mQueueDeletionTimeMap;
@@ -87,7 +112,7 @@ private:
 
     mutable std::mutex mStateMux;
     mutable std::condition_variable mCond;
-    bool mValidToPop = false;
+    std::vector<bool> mValidToPop;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class SenderQueueManagerUnittest;
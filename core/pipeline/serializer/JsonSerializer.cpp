@@ -0,0 +1,100 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipeline/serializer/JsonSerializer.h"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <vector>
+
+#include "models/LogEvent.h"
+#include "models/MetricEvent.h"
+
+using namespace std;
+
+namespace logtail {
+
+const string JSON_KEY_TIME = "__time__";
+const string JSON_KEY_TIME_NANO = "__time_nano__";
+const string JSON_KEY_TAG_PREFIX = "__tag__:";
+const string JSON_KEY_METRIC_NAME = "__name__";
+const string JSON_KEY_METRIC_LABELS = "__labels__";
+const string JSON_KEY_METRIC_VALUE = "__value__";
+
+bool JsonEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, string& errorMsg) {
+    // tag keys are the same for all events in the group, so they are prefixed only once
+    vector<string> tagKeys;
+    tagKeys.reserve(group.mTags.mInner.size());
+    for (const auto& tag : group.mTags.mInner) {
+        tagKeys.emplace_back(JSON_KEY_TAG_PREFIX + tag.first.to_string());
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    for (const auto& e : group.mEvents) {
+        // the writer only allows one root value, so it is reset for each line
+        writer.Reset(buffer);
+        writer.StartObject();
+        if (e.Is<LogEvent>()) {
+            const auto& logEvent = e.Cast<LogEvent>();
+            writer.Key(JSON_KEY_TIME.data(), JSON_KEY_TIME.size());
+            writer.Int64(logEvent.GetTimestamp());
+            if (logEvent.GetTimestampNanosecond()) {
+                writer.Key(JSON_KEY_TIME_NANO.data(), JSON_KEY_TIME_NANO.size());
+                writer.Uint(logEvent.GetTimestampNanosecond().value());
+            }
+            for (const auto& kv : logEvent) {
+                writer.Key(kv.first.data(), kv.first.size());
+                writer.String(kv.second.data(), kv.second.size());
+            }
+        } else if (e.Is<MetricEvent>()) {
+            const auto& metricEvent = e.Cast<MetricEvent>();
+            writer.Key(JSON_KEY_TIME.data(), JSON_KEY_TIME.size());
+            writer.Int64(metricEvent.GetTimestamp());
+            if (metricEvent.GetTimestampNanosecond()) {
+                writer.Key(JSON_KEY_TIME_NANO.data(), JSON_KEY_TIME_NANO.size());
+                writer.Uint(metricEvent.GetTimestampNanosecond().value());
+            }
+            writer.Key(JSON_KEY_METRIC_NAME.data(), JSON_KEY_METRIC_NAME.size());
+            writer.String(metricEvent.GetName().data(), metricEvent.GetName().size());
+            writer.Key(JSON_KEY_METRIC_LABELS.data(), JSON_KEY_METRIC_LABELS.size());
+            writer.StartObject();
+            for (auto it = metricEvent.TagsBegin(); it != metricEvent.TagsEnd(); ++it) {
+                writer.Key(it->first.data(), it->first.size());
+                writer.String(it->second.data(), it->second.size());
+            }
+            writer.EndObject();
+            if (metricEvent.Is<UntypedSingleValue>()) {
+                writer.Key(JSON_KEY_METRIC_VALUE.data(), JSON_KEY_METRIC_VALUE.size());
+                writer.Double(metricEvent.GetValue<UntypedSingleValue>()->mValue);
+            }
+        } else {
+            errorMsg = "unsupported event type in event group";
+            return false;
+        }
+        size_t i = 0;
+        for (const auto& tag : group.mTags.mInner) {
+            writer.Key(tagKeys[i].data(), tagKeys[i].size());
+            writer.String(tag.second.data(), tag.second.size());
+            ++i;
+        }
+        writer.EndObject();
+        buffer.Put('\n');
+    }
+    res.assign(buffer.GetString(), buffer.GetSize());
+    return true;
+}
+
+} // namespace logtail
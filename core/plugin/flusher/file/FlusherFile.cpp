@@ -0,0 +1,464 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plugin/flusher/file/FlusherFile.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(_MSC_VER)
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "common/ParamExtractor.h"
+#include "logger/Logger.h"
+#include "monitor/LogtailAlarm.h"
+#include "pipeline/compression/CompressorFactory.h"
+#include "pipeline/queue/SenderQueueManager.h"
+#include "pipeline/serializer/JsonSerializer.h"
+#include "pipeline/serializer/SLSSerializer.h"
+
+using namespace std;
+
+namespace logtail {
+
+namespace {
+
+const uint32_t kDefaultBatchSizeBytes = 512 * 1024;
+const uint32_t kDefaultBatchCnt = 4096;
+const uint32_t kDefaultBatchTimeoutSecs = 1;
+// items failed to be written are retried a few times, since writing fails mostly for disk full or permission issues
+const uint32_t kMaxWriteTryCnt = 3;
+
+void AppendVarint(string& res, uint64_t value) {
+    while (value >= 0x80) {
+        res.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    res.push_back(static_cast<char>(value));
+}
+
+} // namespace
+
+const string FlusherFile::sName = "flusher_file";
+
+FlusherFile::~FlusherFile() {
+    CloseFile();
+}
+
+bool FlusherFile::Init(const Json::Value& config, Json::Value& optionalGoPipeline) {
+    string errorMsg;
+
+    // FilePath
+    if (!GetMandatoryStringParam(config, "FilePath", mFilePath, errorMsg)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           errorMsg,
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+
+    // Format
+    string format;
+    if (!GetOptionalStringParam(config, "Format", format, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              "json",
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    } else if (format == "protobuf") {
+        mFormat = Format::PROTOBUF;
+    } else if (!format.empty() && format != "json") {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              "string param Format is not valid",
+                              "json",
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // MaxFileSizeMB
+    uint32_t maxFileSizeMB = static_cast<uint32_t>(mMaxFileSize / 1024 / 1024);
+    if (!GetOptionalUIntParam(config, "MaxFileSizeMB", maxFileSizeMB, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              maxFileSizeMB,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+    mMaxFileSize = static_cast<uint64_t>(maxFileSizeMB) * 1024 * 1024;
+
+    // RotateIntervalSecs
+    if (!GetOptionalUIntParam(config, "RotateIntervalSecs", mRotateIntervalSecs, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mRotateIntervalSecs,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // MaxFiles
+    if (!GetOptionalUIntParam(config, "MaxFiles", mMaxFiles, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mMaxFiles,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // Batch
+    const char* key = "Batch";
+    const Json::Value* itr = config.find(key, key + strlen(key));
+    if (itr && !itr->isObject()) {
+        PARAM_WARNING_IGNORE(mContext->GetLogger(),
+                             mContext->GetAlarm(),
+                             "param Batch is not of type object",
+                             sName,
+                             mContext->GetConfigName(),
+                             mContext->GetProjectName(),
+                             mContext->GetLogstoreName(),
+                             mContext->GetRegion());
+        itr = nullptr;
+    }
+    DefaultFlushStrategyOptions strategy{kDefaultBatchSizeBytes, kDefaultBatchCnt, kDefaultBatchTimeoutSecs};
+    if (!mBatcher.Init(itr ? *itr : Json::Value(), this, strategy)) {
+        return false;
+    }
+
+    // CompressType
+    mCompressor = CompressorFactory::GetInstance()->Create(config, *mContext, sName, CompressType::NONE);
+    if (mCompressor && mCompressor->GetCompressType() != CompressType::ZSTD) {
+        // lz4 blocks cannot be decompressed without their sizes, so only zstd frames are written to files
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              "only zstd is supported for CompressType",
+                              "none",
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+        mCompressor.reset();
+    }
+
+    if (mFormat == Format::PROTOBUF) {
+        mGroupSerializer = make_unique<SLSEventGroupSerializer>(this);
+    } else {
+        mGroupSerializer = make_unique<JsonEventGroupSerializer>(this);
+    }
+
+    GenerateQueueKey(mFilePath);
+    SenderQueueManager::GetInstance()->CreateQueue(mQueueKey);
+    return true;
+}
+
+bool FlusherFile::Send(PipelineEventGroup&& g) {
+    vector<BatchedEventsList> res;
+    mBatcher.Add(std::move(g), res);
+    return SerializeAndPush(std::move(res));
+}
+
+bool FlusherFile::Flush(size_t key) {
+    BatchedEventsList res;
+    mBatcher.FlushQueue(key, res);
+    return SerializeAndPush(std::move(res));
+}
+
+bool FlusherFile::FlushAll() {
+    vector<BatchedEventsList> res;
+    mBatcher.FlushAll(res);
+    return SerializeAndPush(std::move(res));
+}
+
+bool FlusherFile::SerializeAndPush(vector<BatchedEventsList>&& groupLists) {
+    bool allSucceeded = true;
+    for (auto& groupList : groupLists) {
+        allSucceeded = SerializeAndPush(std::move(groupList)) && allSucceeded;
+    }
+    return allSucceeded;
+}
+
+bool FlusherFile::SerializeAndPush(BatchedEventsList&& groupList) {
+    bool allSucceeded = true;
+    string serializedData, data, compressedData, errorMsg;
+    for (auto& group : groupList) {
+        if (!mGroupSerializer->Serialize(std::move(group), serializedData, errorMsg)) {
+            LOG_WARNING(mContext->GetLogger(),
+                        ("failed to serialize event group",
+                         errorMsg)("action", "discard data")("plugin", sName)("config", mContext->GetConfigName()));
+            mContext->GetAlarm().SendAlarm(SERIALIZE_FAIL_ALARM,
+                                           "failed to serialize event group: " + errorMsg
+                                               + "\taction: discard data\tplugin: " + sName
+                                               + "\tconfig: " + mContext->GetConfigName(),
+                                           mContext->GetProjectName(),
+                                           mContext->GetLogstoreName(),
+                                           mContext->GetRegion());
+            allSucceeded = false;
+            continue;
+        }
+        if (serializedData.empty()) {
+            continue;
+        }
+        if (mFormat == Format::PROTOBUF) {
+            // log groups are length delimited, so that they can be parsed from the file one by one
+            data.clear();
+            data.reserve(serializedData.size() + 10);
+            AppendVarint(data, serializedData.size());
+            data.append(serializedData);
+        } else {
+            data.swap(serializedData);
+        }
+        size_t rawSize = data.size();
+        if (mCompressor) {
+            if (!mCompressor->Compress(data, compressedData, errorMsg)) {
+                LOG_WARNING(mContext->GetLogger(),
+                            ("failed to compress event group",
+                             errorMsg)("action", "discard data")("plugin", sName)("config", mContext->GetConfigName()));
+                mContext->GetAlarm().SendAlarm(COMPRESS_FAIL_ALARM,
+                                               "failed to compress event group: " + errorMsg
+                                                   + "\taction: discard data\tplugin: " + sName
+                                                   + "\tconfig: " + mContext->GetConfigName(),
+                                               mContext->GetProjectName(),
+                                               mContext->GetLogstoreName(),
+                                               mContext->GetRegion());
+                allSucceeded = false;
+                continue;
+            }
+            data.swap(compressedData);
+        }
+        allSucceeded = PushToQueue(make_unique<SenderQueueItem>(std::move(data), rawSize, this, mQueueKey))
+            && allSucceeded;
+        data.clear();
+    }
+    return allSucceeded;
+}
+
+void FlusherFile::Write(vector<SenderQueueItem*>& items) {
+    if (mFd >= 0 && mRotateIntervalSecs > 0 && mFileSize > 0
+        && time(nullptr) - mFileOpenTime >= static_cast<time_t>(mRotateIntervalSecs)) {
+        RotateFile();
+    }
+    size_t begin = 0;
+    uint64_t pendingSize = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        uint64_t size = items[i]->mData.size();
+        if (mMaxFileSize > 0 && mFileSize + pendingSize > 0 && mFileSize + pendingSize + size > mMaxFileSize) {
+            WriteToFile(items, begin, i);
+            RotateFile();
+            begin = i;
+            pendingSize = 0;
+        }
+        pendingSize += size;
+    }
+    WriteToFile(items, begin, items.size());
+}
+
+void FlusherFile::WriteToFile(vector<SenderQueueItem*>& items, size_t begin, size_t end) {
+    if (begin >= end) {
+        return;
+    }
+    size_t cur = begin;
+    // offset already written in items[cur]
+    size_t curOffset = 0;
+    bool succeeded = OpenFile();
+    int err = succeeded ? 0 : errno;
+    if (succeeded) {
+#if !defined(_MSC_VER)
+        vector<iovec> iov;
+        while (cur < end) {
+            iov.clear();
+            for (size_t i = cur; i < end && iov.size() < IOV_MAX; ++i) {
+                size_t offset = i == cur ? curOffset : 0;
+                iov.push_back({const_cast<char*>(items[i]->mData.data()) + offset, items[i]->mData.size() - offset});
+            }
+            ssize_t written = writev(mFd, iov.data(), static_cast<int>(iov.size()));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                err = errno;
+                succeeded = false;
+                break;
+            }
+            mFileSize += written;
+            // remove items completely written, and remember the offset of the partially written one
+            size_t left = static_cast<size_t>(written);
+            while (cur < end && left >= items[cur]->mData.size() - curOffset) {
+                left -= items[cur]->mData.size() - curOffset;
+                curOffset = 0;
+                DealSenderQueueItemAfterSend(items[cur++], false);
+            }
+            curOffset += left;
+        }
+#else
+        for (; cur < end; ++cur) {
+            const string& data = items[cur]->mData;
+            int written = _write(mFd, data.data(), static_cast<unsigned int>(data.size()));
+            if (written != static_cast<int>(data.size())) {
+                err = errno;
+                succeeded = false;
+                if (written > 0) {
+                    mFileSize += written;
+                    curOffset = written;
+                }
+                break;
+            }
+            mFileSize += data.size();
+            DealSenderQueueItemAfterSend(items[cur], false);
+        }
+#endif
+    }
+    if (succeeded) {
+        return;
+    }
+
+    LOG_WARNING(sLogger, ("failed to write file", mFilePath)("errno", err)("config", mContext->GetConfigName()));
+    // the partially written item is cut off, so that it is written again from start on retry without leaving a torn
+    // record in the file
+    if (curOffset > 0) {
+        TruncateFile(mFileSize - curOffset);
+    }
+    // the file is reopened on the next write
+    CloseFile();
+    for (; cur < end; ++cur) {
+        auto item = items[cur];
+        if (item->mTryCnt < kMaxWriteTryCnt) {
+            DealSenderQueueItemAfterSend(item, true);
+            continue;
+        }
+        mContext->GetAlarm().SendAlarm(SEND_DATA_FAIL_ALARM,
+                                       "failed to write file: " + mFilePath + "\terrno: " + to_string(err)
+                                           + "\taction: discard data\tplugin: " + sName
+                                           + "\tconfig: " + mContext->GetConfigName(),
+                                       mContext->GetProjectName(),
+                                       mContext->GetLogstoreName(),
+                                       mContext->GetRegion());
+        DealSenderQueueItemAfterSend(item, false);
+    }
+}
+
+void FlusherFile::TruncateFile(uint64_t size) {
+#if defined(_MSC_VER)
+    bool succeeded = _chsize_s(mFd, static_cast<__int64>(size)) == 0;
+#else
+    bool succeeded = ftruncate(mFd, static_cast<off_t>(size)) == 0;
+#endif
+    if (!succeeded) {
+        LOG_WARNING(sLogger,
+                    ("failed to truncate partially written data", mFilePath)("errno", errno)("size", size)(
+                        "config", mContext->GetConfigName()));
+        return;
+    }
+    mFileSize = size;
+}
+
+bool FlusherFile::OpenFile() {
+    if (mFd >= 0) {
+        return true;
+    }
+    error_code ec;
+    filesystem::path path(mFilePath);
+    if (path.has_parent_path()) {
+        filesystem::create_directories(path.parent_path(), ec);
+    }
+#if defined(_MSC_VER)
+    mFd = _open(mFilePath.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    mFd = open(mFilePath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+    if (mFd < 0) {
+        LOG_WARNING(sLogger, ("failed to open file", mFilePath)("errno", errno)("config", mContext->GetConfigName()));
+        return false;
+    }
+    // the size is taken from the existing file, since partially written data is truncated based on it
+    struct stat st;
+    if (fstat(mFd, &st) != 0) {
+        LOG_WARNING(sLogger, ("failed to stat file", mFilePath)("errno", errno)("config", mContext->GetConfigName()));
+        CloseFile();
+        return false;
+    }
+    mFileSize = static_cast<uint64_t>(st.st_size);
+    mFileOpenTime = time(nullptr);
+    return true;
+}
+
+void FlusherFile::CloseFile() {
+    if (mFd < 0) {
+        return;
+    }
+#if defined(_MSC_VER)
+    _close(mFd);
+#else
+    close(mFd);
+#endif
+    mFd = -1;
+    mFileSize = 0;
+}
+
+void FlusherFile::RotateFile() {
+    CloseFile();
+    error_code ec;
+    if (mMaxFiles == 0) {
+        filesystem::remove(mFilePath, ec);
+    } else {
+        // the current file becomes <file>.1, and the older ones are shifted until a missing one, e.g. <file>.1 ->
+        // <file>.2, while the oldest one is dropped if there are already MaxFiles rotated files
+        uint32_t last = 1;
+        while (last < mMaxFiles && filesystem::exists(mFilePath + "." + to_string(last), ec)) {
+            ++last;
+        }
+        filesystem::remove(mFilePath + "." + to_string(last), ec);
+        for (uint32_t i = last; i > 1; --i) {
+            filesystem::rename(mFilePath + "." + to_string(i - 1), mFilePath + "." + to_string(i), ec);
+        }
+        filesystem::rename(mFilePath, mFilePath + ".1", ec);
+    }
+    if (ec) {
+        LOG_WARNING(sLogger, ("failed to rotate file", mFilePath)("error", ec.message()));
+        return;
+    }
+    LOG_INFO(sLogger, ("file rotated", mFilePath)("config", mContext->GetConfigName()));
+}
+
+} // namespace logtail
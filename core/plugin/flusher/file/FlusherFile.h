@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <json/json.h>
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pipeline/batch/Batcher.h"
+#include "pipeline/compression/Compressor.h"
+#include "pipeline/plugin/interface/FileFlusher.h"
+#include "pipeline/serializer/Serializer.h"
+
+namespace logtail {
+
+// FlusherFile writes batches of events to a local file, which is rotated by size or time. Batches are serialized (and
+// compressed if required) in the processor thread, and written by the file sink thread with one writev for all
+// batches ready.
+//
+// Each batch is written as json lines, or as a LogGroup protobuf prefixed by its varint encoded size. When compressed,
+// each batch is a zstd frame, so that the file can be decompressed as a whole.
+class FlusherFile : public FileFlusher {
+public:
+    enum class Format { JSON, PROTOBUF };
+
+    static const std::string sName;
+
+    ~FlusherFile();
+
+    const std::string& Name() const override { return sName; }
+    bool Init(const Json::Value& config, Json::Value& optionalGoPipeline) override;
+    bool Send(PipelineEventGroup&& g) override;
+    bool Flush(size_t key) override;
+    bool FlushAll() override;
+
+    void Write(std::vector<SenderQueueItem*>& items) override;
+
+private:
+    bool SerializeAndPush(std::vector<BatchedEventsList>&& groupLists);
+    bool SerializeAndPush(BatchedEventsList&& groupList);
+
+    // write items in [begin, end) to the current file with as few syscalls as possible
+    void WriteToFile(std::vector<SenderQueueItem*>& items, size_t begin, size_t end);
+    bool OpenFile();
+    void CloseFile();
+    void RotateFile();
+    void TruncateFile(uint64_t size);
+
+    std::string mFilePath;
+    Format mFormat = Format::JSON;
+    // 0 means no limit
+    uint64_t mMaxFileSize = 100 * 1024 * 1024;
+    uint32_t mRotateIntervalSecs = 0;
+    // count of rotated files kept, 0 means the file is removed on rotation
+    uint32_t mMaxFiles = 5;
+
+    Batcher<> mBatcher;
+    std::unique_ptr<EventGroupSerializer> mGroupSerializer;
+    std::unique_ptr<Compressor> mCompressor;
+
+    // only accessed by the file sink thread
+    int mFd = -1;
+    uint64_t mFileSize = 0;
+    time_t mFileOpenTime = 0;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class FlusherFileUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -14,6 +14,9 @@
 
 #include "plugin/flusher/sls/DiskBufferWriter.h"
 
+#include <algorithm>
+#include <cstddef>
+
 #include "app_config/AppConfig.h"
 #include "application/Application.h"
 #include "common/CompressTools.h"
@@ -30,17 +33,23 @@
 #include "profile_sender/ProfileSender.h"
 #include "pipeline/queue/QueueKeyManager.h"
 #include "pipeline/queue/SLSSenderQueueItem.h"
-#include "sdk/Exception.h"
+#include "pipeline/queue/SenderQueueManager.h"
 #include "pipeline/limiter/RateLimiter.h"
-#include "sls_control/SLSControl.h"
 
 DEFINE_FLAG_INT32(write_secondary_wait_timeout, "interval of dump seconary buffer from memory to file, seconds", 2);
 DEFINE_FLAG_INT32(buffer_file_alive_interval, "the max alive time of a bufferfile, 5 minutes", 300);
 DEFINE_FLAG_INT32(log_expire_time, "log expire time", 24 * 3600);
-DEFINE_FLAG_INT32(quota_exceed_wait_interval, "when daemon buffer thread get quotaExceed error, sleep 5 seconds", 5);
 DEFINE_FLAG_INT32(secondary_buffer_count_limit, "data ready for write buffer file", 20);
-DEFINE_FLAG_INT32(send_retry_sleep_interval, "sleep microseconds when sync send fail, 50ms", 50000);
 DEFINE_FLAG_INT32(buffer_check_period, "check logtail local storage buffer period", 60);
+DEFINE_FLAG_INT32(disk_buffer_replay_read_buffer_size,
+                  "size of read ahead buffer when replaying buffer files",
+                  8 * 1024 * 1024);
+DEFINE_FLAG_INT32(disk_buffer_replay_batch_size,
+                  "max records read and decrypted at once when replaying buffer files",
+                  64);
+DEFINE_FLAG_INT32(disk_buffer_replay_batch_bytes,
+                  "max bytes read and decrypted at once when replaying buffer files",
+                  32 * 1024 * 1024);
 
 using namespace std;
 
@@ -49,6 +58,52 @@ namespace logtail {
 const string DiskBufferWriter::BUFFER_FILE_NAME_PREFIX = "logtail_buffer_file_";
 const int32_t DiskBufferWriter::BUFFER_META_BASE_SIZE = 65536;
 
+struct DiskBufferWriter::ReplaySenderQueueItem : public SLSSenderQueueItem {
+    ReplaySenderQueueItem(string&& data,
+                          FlusherSLS* flusher,
+                          const sls_logs::LogtailBufferMeta& bufferMeta,
+                          const shared_ptr<ReplayFile>& file,
+                          int32_t metaPos)
+        : SLSSenderQueueItem(std::move(data),
+                             bufferMeta.rawsize(),
+                             flusher,
+                             flusher->GetQueueKey(),
+                             bufferMeta.logstore(),
+                             static_cast<RawDataType>(bufferMeta.datatype()),
+                             bufferMeta.shardhashkey()),
+          mFile(file),
+          mMetaPos(metaPos) {
+        lock_guard<mutex> lock(mFile->mMux);
+        ++mFile->mInflightCnt;
+    }
+
+    ~ReplaySenderQueueItem() override {
+        if (mFile) {
+            lock_guard<mutex> lock(mFile->mMux);
+            mFile->mReleasedPos.push_back(mMetaPos);
+            --mFile->mInflightCnt;
+        }
+    }
+
+    // the record is left unhandled in the file, which is kept to be replayed again
+    void Cancel() {
+        if (!mFile) {
+            return;
+        }
+        lock_guard<mutex> lock(mFile->mMux);
+        --mFile->mInflightCnt;
+        mFile->mHasCanceled = true;
+        mFile.reset();
+    }
+
+    shared_ptr<ReplayFile> mFile;
+    int32_t mMetaPos = 0;
+};
+
+DiskBufferWriter::DiskBufferWriter() = default;
+
+DiskBufferWriter::~DiskBufferWriter() = default;
+
 void DiskBufferWriter::Init() {
     mBufferDivideTime = time(NULL);
     mCheckPeriod = INT32_FLAG(buffer_check_period);
@@ -88,6 +143,12 @@ void DiskBufferWriter::Stop() {
 
 bool DiskBufferWriter::PushToDiskBuffer(SenderQueueItem* item, uint32_t retryTimes) {
     auto slsItem = static_cast<SLSSenderQueueItem*>(item);
+    if (auto replayItem = dynamic_cast<ReplaySenderQueueItem*>(item)) {
+        // the record is still in the buffer file being replayed, so it is left unhandled there rather than buffered
+        // again, which would have it replayed twice
+        replayItem->Cancel();
+        return true;
+    }
 
     uint32_t retry = 0;
     while (++retry < retryTimes) {
@@ -144,17 +205,18 @@ void DiskBufferWriter::BufferSenderThread() {
     LOG_INFO(sLogger, ("disk buffer sender", "started"));
     unique_lock<mutex> lock(mBufferSenderThreadRunningMux);
     while (mIsSendBufferThreadRunning) {
+        CheckReplayFiles();
+        // files being replayed are checked frequently, so that they are removed soon after all records are sent
+        auto checkPeriod = chrono::seconds(mReplayFiles.empty() ? mCheckPeriod : 1);
         if (!SLSClientManager::GetInstance()->HasNetworkAvailable()) {
-            if (mStopCV.wait_for(
-                    lock, chrono::seconds(mCheckPeriod), [this]() { return !mIsSendBufferThreadRunning; })) {
+            if (mStopCV.wait_for(lock, checkPeriod, [this]() { return !mIsSendBufferThreadRunning; })) {
                 break;
             }
             continue;
         }
         vector<string> filesToSend;
         if (!LoadFileToSend(mBufferDivideTime, filesToSend)) {
-            if (mStopCV.wait_for(
-                    lock, chrono::seconds(mCheckPeriod), [this]() { return !mIsSendBufferThreadRunning; })) {
+            if (mStopCV.wait_for(lock, checkPeriod, [this]() { return !mIsSendBufferThreadRunning; })) {
                 break;
             }
             continue;
@@ -166,6 +228,12 @@ void DiskBufferWriter::BufferSenderThread() {
              i < fileToSendCount && mIsSendBufferThreadRunning;
              ++i) {
             string fileName = GetBufferFilePath() + filesToSend[i];
+            if (find_if(mReplayFiles.begin(),
+                        mReplayFiles.end(),
+                        [&fileName](const shared_ptr<ReplayFile>& file) { return file->mFileName == fileName; })
+                != mReplayFiles.end()) {
+                continue;
+            }
             unordered_map<string, string> kvMap;
             if (FileEncryption::CheckHeader(fileName, kvMap)) {
                 int32_t keyVersion = -1;
@@ -181,7 +249,7 @@ void DiskBufferWriter::BufferSenderThread() {
                 }
                 if (keyVersion >= 1 && keyVersion <= FileEncryption::GetInstance()->GetDefaultKeyVersion()) {
                     LOG_INFO(sLogger, ("check local encryption file", fileName)("key_version", keyVersion));
-                    SendEncryptionBuffer(fileName, keyVersion);
+                    SendEncryptionBuffer(fileName, keyVersion, lock);
                 } else {
                     remove(fileName.c_str());
                     LOG_ERROR(sLogger,
@@ -198,10 +266,12 @@ void DiskBufferWriter::BufferSenderThread() {
             }
         }
         // mIsSendingBuffer = false;
-        if (mStopCV.wait_for(lock, chrono::seconds(mCheckPeriod), [this]() { return !mIsSendBufferThreadRunning; })) {
+        checkPeriod = chrono::seconds(mReplayFiles.empty() ? mCheckPeriod : 1);
+        if (mStopCV.wait_for(lock, checkPeriod, [this]() { return !mIsSendBufferThreadRunning; })) {
             break;
         }
     }
+    CheckReplayFiles();
 }
 
 void DiskBufferWriter::SetBufferFilePath(const std::string& bufferfilepath) {
@@ -276,7 +346,9 @@ bool DiskBufferWriter::LoadFileToSend(time_t timeLine, std::vector<std::string>&
     return true;
 }
 
-bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
+bool DiskBufferWriter::ReadNextEncryption(FILE* fin,
+                                          int64_t fileSize,
+                                          int32_t& pos,
                                           const std::string& filename,
                                           std::string& encryption,
                                           EncryptionStateMeta& meta,
@@ -285,29 +357,11 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
     bufferMeta.Clear();
     readResult = false;
     encryption.clear();
-    int retryTimes = 0;
 
-    FILE* fin = NULL;
-    while (true) {
-        retryTimes++;
-        fin = FileReadOnlyOpen(filename.c_str(), "rb");
-        if (fin)
-            break;
-        if (retryTimes >= 3) {
-            string errorStr = ErrnoToString(GetErrno());
-            LogtailAlarm::GetInstance()->SendAlarm(SECONDARY_READ_WRITE_ALARM,
-                                                   string("open file error:") + filename + ",error:" + errorStr);
-            LOG_ERROR(sLogger, ("open file error", filename)("error", errorStr));
-            return false;
-        }
-        usleep(5000);
-    }
-    fseek(fin, 0, SEEK_END);
-    auto const currentSize = ftell(fin);
-    if (currentSize == pos) {
-        fclose(fin);
+    if (pos >= fileSize) {
         return false;
     }
+    // records are read in order, so the seek is done within the read ahead buffer in most cases
     fseek(fin, pos, SEEK_SET);
     auto nbytes = fread(static_cast<void*>(&meta), sizeof(char), sizeof(meta), fin);
     if (nbytes != sizeof(meta)) {
@@ -316,11 +370,10 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
                                                string("read encryption file meta error:") + filename
                                                    + ", error:" + errorStr + ", meta.mEncryptionSize:"
                                                    + ToString(meta.mEncryptionSize) + ", nbytes: " + ToString(nbytes)
-                                                   + ", pos: " + ToString(pos) + ", ftell: " + ToString(currentSize));
+                                                   + ", pos: " + ToString(pos) + ", ftell: " + ToString(fileSize));
         LOG_ERROR(sLogger,
                   ("read encryption file meta error",
-                   filename)("error", errorStr)("nbytes", nbytes)("pos", pos)("ftell", currentSize));
-        fclose(fin);
+                   filename)("error", errorStr)("nbytes", nbytes)("pos", pos)("ftell", fileSize));
         return false;
     }
 
@@ -339,13 +392,11 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
         LOG_ERROR(sLogger,
                   ("meta of encryption file invalid", filename)("meta.mEncryptionSize", meta.mEncryptionSize)(
                       "meta.mEncodedInfoSize", meta.mEncodedInfoSize));
-        fclose(fin);
         return false;
     }
 
     pos += sizeof(meta) + encodedInfoSize + meta.mEncryptionSize;
     if ((time(NULL) - meta.mTimeStamp) > INT32_FLAG(log_expire_time) || meta.mHandled == 1) {
-        fclose(fin);
         if (meta.mHandled != 1) {
             LOG_WARNING(sLogger, ("timeout buffer file, meta.mTimeStamp", meta.mTimeStamp));
             LogtailAlarm::GetInstance()->SendAlarm(DISCARD_SECONDARY_ALARM,
@@ -354,10 +405,9 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
         return true;
     }
 
-    char* buffer = new char[encodedInfoSize + 1];
-    nbytes = fread(buffer, sizeof(char), encodedInfoSize, fin);
+    string encodedInfo(encodedInfoSize, '\0');
+    nbytes = fread(&encodedInfo[0], sizeof(char), encodedInfoSize, fin);
     if (nbytes != static_cast<size_t>(encodedInfoSize)) {
-        fclose(fin);
         string errorStr = ErrnoToString(GetErrno());
         LogtailAlarm::GetInstance()->SendAlarm(SECONDARY_READ_WRITE_ALARM,
                                                string("read projectname from file error:") + filename
@@ -366,14 +416,10 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
         LOG_ERROR(sLogger,
                   ("read encodedInfo from file error",
                    filename)("error", errorStr)("meta.mEncodedInfoSize", meta.mEncodedInfoSize)("nbytes", nbytes));
-        delete[] buffer;
         return true;
     }
-    string encodedInfo = string(buffer, encodedInfoSize);
-    delete[] buffer;
     if (pbMeta) {
         if (!bufferMeta.ParseFromString(encodedInfo)) {
-            fclose(fin);
             LogtailAlarm::GetInstance()->SendAlarm(SECONDARY_READ_WRITE_ALARM,
                                                    string("parse buffer meta from file error:") + filename);
             LOG_ERROR(sLogger, ("parse buffer meta from file error", filename)("buffer meta", encodedInfo));
@@ -389,10 +435,9 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
         bufferMeta.set_compresstype(sls_logs::SlsCompressType::SLS_CMP_LZ4);
     }
 
-    buffer = new char[meta.mEncryptionSize + 1];
-    nbytes = fread(buffer, sizeof(char), meta.mEncryptionSize, fin);
+    encryption.resize(meta.mEncryptionSize);
+    nbytes = fread(&encryption[0], sizeof(char), meta.mEncryptionSize, fin);
     if (nbytes != static_cast<size_t>(meta.mEncryptionSize)) {
-        fclose(fin);
         string errorStr = ErrnoToString(GetErrno());
         LogtailAlarm::GetInstance()->SendAlarm(SECONDARY_READ_WRITE_ALARM,
                                                string("read encryption from file error:") + filename
@@ -401,121 +446,223 @@ bool DiskBufferWriter::ReadNextEncryption(int32_t& pos,
         LOG_ERROR(sLogger,
                   ("read encryption from file error",
                    filename)("error", errorStr)("meta.mEncryptionSize", meta.mEncryptionSize)("nbytes", nbytes));
-        delete[] buffer;
+        encryption.clear();
         return true;
     }
-    encryption = string(buffer, meta.mEncryptionSize);
     readResult = true;
-    delete[] buffer;
-    fclose(fin);
     return true;
 }
 
-void DiskBufferWriter::SendEncryptionBuffer(const std::string& filename, int32_t keyVersion) {
-    string encryption;
-    string logData;
-    EncryptionStateMeta meta;
-    bool readResult;
-    bool writeBack = false;
+void DiskBufferWriter::SendEncryptionBuffer(const std::string& filename,
+                                            int32_t keyVersion,
+                                            unique_lock<mutex>& lock) {
+    FILE* fin = FileReadOnlyOpen(filename.c_str(), "rb");
+    if (!fin) {
+        string errorStr = ErrnoToString(GetErrno());
+        LogtailAlarm::GetInstance()->SendAlarm(SECONDARY_READ_WRITE_ALARM,
+                                               string("open file error:") + filename + ",error:" + errorStr);
+        LOG_ERROR(sLogger, ("open file error", filename)("error", errorStr));
+        return;
+    }
+    // records are read sequentially, so a large buffer turns them into few large reads
+    vector<char> readBuffer(INT32_FLAG(disk_buffer_replay_read_buffer_size));
+    setvbuf(fin, readBuffer.data(), _IOFBF, readBuffer.size());
+    fseek(fin, 0, SEEK_END);
+    int64_t fileSize = ftell(fin);
+
+    auto file = make_shared<ReplayFile>();
+    file->mFileName = filename;
+    mReplayFiles.push_back(file);
+
     int32_t pos = INT32_FLAG(file_encryption_header_length);
-    sls_logs::LogtailBufferMeta bufferMeta;
-    int32_t discardCount = 0;
-    while (ReadNextEncryption(pos, filename, encryption, meta, readResult, bufferMeta)) {
-        logData.clear();
-        bool sendResult = false;
-        if (!readResult || bufferMeta.project().empty()) {
-            if (meta.mHandled == 1)
-                continue;
-            sendResult = true;
-            discardCount++;
+    bool finished = false, stopped = false;
+    vector<ReplayRecord> records;
+    while (!finished && !stopped) {
+        // read a batch of records ahead, which are then decrypted and pushed
+        records.clear();
+        size_t batchBytes = 0;
+        while (records.size() < static_cast<size_t>(INT32_FLAG(disk_buffer_replay_batch_size))
+               && batchBytes < static_cast<size_t>(INT32_FLAG(disk_buffer_replay_batch_bytes))) {
+            ReplayRecord record;
+            record.mMetaPos = pos;
+            bool readResult = false;
+            if (!ReadNextEncryption(
+                    fin, fileSize, pos, filename, record.mEncryption, record.mMeta, readResult, record.mBufferMeta)) {
+                finished = true;
+                break;
+            }
+            if (readResult && !record.mBufferMeta.project().empty()) {
+                batchBytes += record.mEncryption.size();
+                records.emplace_back(std::move(record));
+            } else if (record.mMeta.mHandled != 1) {
+                ++file->mDiscardCount;
+                MarkRecordHandled(filename, record.mMetaPos);
+            }
         }
-        if (!sendResult) {
-            char* des = new char[meta.mLogDataSize];
-            if (!FileEncryption::GetInstance()->Decrypt(
-                    encryption.c_str(), meta.mEncryptionSize, des, meta.mLogDataSize, keyVersion)) {
-                sendResult = true;
-                discardCount++;
-                LOG_ERROR(sLogger,
-                          ("decrypt error, project_name",
-                           bufferMeta.project())("key_version", keyVersion)("meta.mLogDataSize", meta.mLogDataSize));
-                LogtailAlarm::GetInstance()->SendAlarm(ENCRYPT_DECRYPT_FAIL_ALARM,
-                                                       string("decrypt error, project_name:" + bufferMeta.project()
-                                                              + ", key_version:" + ToString(keyVersion)
-                                                              + ", meta.mLogDataSize:" + ToString(meta.mLogDataSize)));
-            } else {
-                if (bufferMeta.has_logstore())
-                    logData = string(des, meta.mLogDataSize);
-                else {
-                    // compatible to old buffer file (logGroup string), convert to LZ4 compressed
-                    string logGroupStr = string(des, meta.mLogDataSize);
-                    sls_logs::LogGroup logGroup;
-                    if (!logGroup.ParseFromString(logGroupStr)) {
-                        sendResult = true;
-                        LOG_ERROR(sLogger,
-                                  ("parse error from string to loggroup, projectName is", bufferMeta.project()));
-                        discardCount++;
-                        LogtailAlarm::GetInstance()->SendAlarm(
-                            LOG_GROUP_PARSE_FAIL_ALARM,
-                            string("projectName is:" + bufferMeta.project() + ", fileName is:" + filename));
-                    } else if (!CompressLz4(logGroupStr, logData)) {
-                        sendResult = true;
-                        LOG_ERROR(sLogger, ("LZ4 compress loggroup fail, projectName is", bufferMeta.project()));
-                        discardCount++;
-                        LogtailAlarm::GetInstance()->SendAlarm(
-                            SEND_COMPRESS_FAIL_ALARM,
-                            string("projectName is:" + bufferMeta.project() + ", fileName is:" + filename));
-                    } else {
-                        bufferMeta.set_logstore(logGroup.category());
-                        bufferMeta.set_datatype(int(RawDataType::EVENT_GROUP));
-                        bufferMeta.set_rawsize(meta.mLogDataSize);
-                        bufferMeta.set_compresstype(sls_logs::SLS_CMP_LZ4);
-                    }
-                }
-                if (!sendResult) {
-                    string errorCode;
-                    SendResult res = SendBufferFileData(bufferMeta, logData, errorCode);
-                    if (res == SEND_OK)
-                        sendResult = true;
-                    else if (res == SEND_DISCARD_ERROR || res == SEND_UNAUTHORIZED) {
-                        LogtailAlarm::GetInstance()->SendAlarm(SEND_DATA_FAIL_ALARM,
-                                                               string("send buffer file fail, rawsize:")
-                                                                   + ToString(bufferMeta.rawsize())
-                                                                   + "errorCode: " + errorCode,
-                                                               bufferMeta.project(),
-                                                               bufferMeta.logstore(),
-                                                               "");
-                        sendResult = true;
-                        discardCount++;
-                    } else if (res == SEND_QUOTA_EXCEED && INT32_FLAG(quota_exceed_wait_interval) > 0)
-                        sleep(INT32_FLAG(quota_exceed_wait_interval));
-                }
+
+        DecryptRecords(records, keyVersion, *file);
+        for (auto& record : records) {
+            if (!record.mValid) {
+                MarkRecordHandled(filename, record.mMetaPos);
+                continue;
             }
-            delete[] des;
+            if (!PushReplayRecord(std::move(record), file, lock)) {
+                stopped = true;
+                break;
+            }
+        }
+        CheckReplayFiles();
+    }
+    fclose(fin);
+
+    if (!stopped) {
+        lock_guard<mutex> fileLock(file->mMux);
+        file->mAllPushed = true;
+    }
+    CheckReplayFiles();
+}
+
+void DiskBufferWriter::DecryptRecords(vector<ReplayRecord>& records, int32_t keyVersion, ReplayFile& file) {
+    // records are decrypted inline, since replay is bounded by the buffered data rate limit rather than by decryption
+    for (auto& record : records) {
+        if (record.mMeta.mLogDataSize < 0) {
+            continue;
         }
-        if (sendResult)
-            meta.mHandled = 1;
-        LOG_DEBUG(sLogger,
-                  ("send LogGroup from local buffer file", filename)("rawsize", bufferMeta.rawsize())("sendResult",
-                                                                                                      sendResult));
-        WriteBackMeta(pos - meta.mEncryptionSize - sizeof(meta)
-                          - (meta.mEncodedInfoSize > BUFFER_META_BASE_SIZE
-                                 ? (meta.mEncodedInfoSize - BUFFER_META_BASE_SIZE)
-                                 : meta.mEncodedInfoSize),
-                      (char*)&meta,
-                      sizeof(meta),
-                      filename);
-        if (!sendResult)
-            writeBack = true;
-    }
-    if (!writeBack) {
-        remove(filename.c_str());
-        if (discardCount > 0) {
-            LOG_ERROR(sLogger, ("send buffer file, discard LogGroup count", discardCount)("delete file", filename));
+        record.mLogData.resize(record.mMeta.mLogDataSize);
+        record.mValid = FileEncryption::GetInstance()->Decrypt(record.mEncryption.data(),
+                                                               record.mMeta.mEncryptionSize,
+                                                               &record.mLogData[0],
+                                                               record.mMeta.mLogDataSize,
+                                                               keyVersion);
+        string().swap(record.mEncryption);
+    }
+
+    for (auto& record : records) {
+        auto& bufferMeta = record.mBufferMeta;
+        if (!record.mValid) {
+            ++file.mDiscardCount;
+            LOG_ERROR(sLogger,
+                      ("decrypt error, project_name", bufferMeta.project())("key_version", keyVersion)(
+                          "meta.mLogDataSize", record.mMeta.mLogDataSize));
+            LogtailAlarm::GetInstance()->SendAlarm(ENCRYPT_DECRYPT_FAIL_ALARM,
+                                                   string("decrypt error, project_name:" + bufferMeta.project()
+                                                          + ", key_version:" + ToString(keyVersion)
+                                                          + ", meta.mLogDataSize:"
+                                                          + ToString(record.mMeta.mLogDataSize)));
+            continue;
+        }
+        if (bufferMeta.has_logstore()) {
+            continue;
+        }
+        // compatible to old buffer file (logGroup string), convert to LZ4 compressed
+        sls_logs::LogGroup logGroup;
+        string logData;
+        if (!logGroup.ParseFromString(record.mLogData)) {
+            record.mValid = false;
+            ++file.mDiscardCount;
+            LOG_ERROR(sLogger, ("parse error from string to loggroup, projectName is", bufferMeta.project()));
+            LogtailAlarm::GetInstance()->SendAlarm(
+                LOG_GROUP_PARSE_FAIL_ALARM,
+                string("projectName is:" + bufferMeta.project() + ", fileName is:" + file.mFileName));
+        } else if (!CompressLz4(record.mLogData, logData)) {
+            record.mValid = false;
+            ++file.mDiscardCount;
+            LOG_ERROR(sLogger, ("LZ4 compress loggroup fail, projectName is", bufferMeta.project()));
+            LogtailAlarm::GetInstance()->SendAlarm(
+                SEND_COMPRESS_FAIL_ALARM,
+                string("projectName is:" + bufferMeta.project() + ", fileName is:" + file.mFileName));
+        } else {
+            bufferMeta.set_logstore(logGroup.category());
+            bufferMeta.set_datatype(int(RawDataType::EVENT_GROUP));
+            bufferMeta.set_rawsize(record.mMeta.mLogDataSize);
+            bufferMeta.set_compresstype(sls_logs::SLS_CMP_LZ4);
+            record.mLogData.swap(logData);
+        }
+    }
+}
+
+bool DiskBufferWriter::PushReplayRecord(ReplayRecord&& record,
+                                        const shared_ptr<ReplayFile>& file,
+                                        unique_lock<mutex>& lock) {
+    // buffered data is sent at a lower rate than real time data
+    RateLimiter::FlowControl(record.mBufferMeta.rawsize(), mSendLastTime, mSendLastByte, false);
+
+    FlusherSLS* flusher = GetReplayFlusher(record.mBufferMeta);
+    unique_ptr<SenderQueueItem> item = make_unique<ReplaySenderQueueItem>(
+        std::move(record.mLogData), flusher, record.mBufferMeta, file, record.mMetaPos);
+    while (true) {
+        int rst = SenderQueueManager::GetInstance()->PushQueue(flusher->GetQueueKey(), std::move(item));
+        if (rst == 0) {
+            LOG_DEBUG(sLogger,
+                      ("send LogGroup from local buffer file", file->mFileName)("rawsize",
+                                                                               record.mBufferMeta.rawsize()));
+            return true;
+        }
+        if (rst == 2) {
+            // should not happen, the record is left unhandled and resent next time
+            LOG_ERROR(sLogger,
+                      ("failed to push buffered data to sender queue", "queue not found")(
+                          "project", record.mBufferMeta.project())("logstore", record.mBufferMeta.logstore()));
+            static_cast<ReplaySenderQueueItem*>(item.get())->Cancel();
+            return false;
+        }
+        // the sender queue is full, which bounds the records in flight
+        if (mStopCV.wait_for(lock, chrono::milliseconds(10), [this]() { return !mIsSendBufferThreadRunning; })) {
+            static_cast<ReplaySenderQueueItem*>(item.get())->Cancel();
+            return false;
+        }
+    }
+}
+
+FlusherSLS* DiskBufferWriter::GetReplayFlusher(const sls_logs::LogtailBufferMeta& bufferMeta) {
+    string region = bufferMeta.endpoint();
+    if (region.find("http://") == 0) // old buffer file which record the endpoint
+        region = SLSClientManager::GetInstance()->GetRegionFromEndpoint(region);
+
+    string key = region + "#" + bufferMeta.aliuid() + "#" + bufferMeta.project() + "#"
+        + ToString(static_cast<int>(bufferMeta.compresstype()));
+    auto& flusher = mReplayFlushers[key];
+    if (!flusher) {
+        flusher = make_unique<FlusherSLS>();
+        flusher->InitForReplay(region, bufferMeta.aliuid(), bufferMeta.project(), bufferMeta.compresstype());
+    }
+    return flusher.get();
+}
+
+void DiskBufferWriter::MarkRecordHandled(const std::string& filename, int32_t metaPos) {
+    int32_t handled = 1;
+    WriteBackMeta(metaPos + offsetof(EncryptionStateMeta, mHandled), &handled, sizeof(handled), filename);
+}
+
+void DiskBufferWriter::CheckReplayFiles() {
+    for (auto iter = mReplayFiles.begin(); iter != mReplayFiles.end();) {
+        auto& file = *iter;
+        vector<int32_t> releasedPos;
+        bool done = false;
+        {
+            lock_guard<mutex> lock(file->mMux);
+            releasedPos.swap(file->mReleasedPos);
+            done = file->mAllPushed && !file->mHasCanceled && file->mInflightCnt == 0;
+        }
+        for (auto pos : releasedPos) {
+            MarkRecordHandled(file->mFileName, pos);
+        }
+        if (!done) {
+            ++iter;
+            continue;
+        }
+        remove(file->mFileName.c_str());
+        if (file->mDiscardCount > 0) {
+            LOG_ERROR(sLogger,
+                      ("send buffer file, discard LogGroup count", file->mDiscardCount)("delete file",
+                                                                                       file->mFileName));
             LogtailAlarm::GetInstance()->SendAlarm(DISCARD_SECONDARY_ALARM,
-                                                   "delete buffer file: " + filename + ", discard "
-                                                       + ToString(discardCount) + " logGroups");
-        } else
-            LOG_INFO(sLogger, ("send buffer file success, delete buffer file", filename));
+                                                   "delete buffer file: " + file->mFileName + ", discard "
+                                                       + ToString(file->mDiscardCount) + " logGroups");
+        } else {
+            LOG_INFO(sLogger, ("send buffer file success, delete buffer file", file->mFileName));
+        }
+        iter = mReplayFiles.erase(iter);
     }
 }
 
@@ -688,114 +835,4 @@ bool DiskBufferWriter::SendToBufferFile(SenderQueueItem* dataPtr) {
     return true;
 }
 
-SendResult DiskBufferWriter::SendBufferFileData(const sls_logs::LogtailBufferMeta& bufferMeta,
-                                                const std::string& logData,
-                                                std::string& errorCode) {
-    RateLimiter::FlowControl(bufferMeta.rawsize(), mSendLastTime, mSendLastByte, false);
-    string region = bufferMeta.endpoint();
-    if (region.find("http://") == 0) // old buffer file which record the endpoint
-        region = SLSClientManager::GetInstance()->GetRegionFromEndpoint(region);
-
-    sdk::Client* sendClient = SLSClientManager::GetInstance()->GetClient(region, bufferMeta.aliuid());
-    SendResult sendRes;
-    const string& endpoint = sendClient->GetRawSlsHost();
-    if (endpoint.empty())
-        sendRes = SEND_NETWORK_ERROR;
-    else {
-        sendRes = SendToNetSync(sendClient, bufferMeta, logData, errorCode);
-    }
-    if (sendRes == SEND_NETWORK_ERROR) {
-        SLSClientManager::GetInstance()->UpdateEndpointStatus(region, endpoint, false);
-        SLSClientManager::GetInstance()->ResetClientEndpoint(bufferMeta.aliuid(), region, time(NULL));
-        LOG_DEBUG(sLogger,
-                  ("SendBufferFileData",
-                   "SEND_NETWORK_ERROR")("region", region)("aliuid", bufferMeta.aliuid())("endpoint", endpoint));
-    } else if (sendRes == SEND_UNAUTHORIZED) {
-        int32_t lastUpdateTime;
-        if (SLSControl::GetInstance()->SetSlsSendClientAuth(bufferMeta.aliuid(), false, sendClient, lastUpdateTime))
-            sendRes = SendToNetSync(sendClient, bufferMeta, logData, errorCode);
-    }
-    return sendRes;
-}
-
-SendResult DiskBufferWriter::SendToNetSync(sdk::Client* sendClient,
-                                           const sls_logs::LogtailBufferMeta& bufferMeta,
-                                           const std::string& logData,
-                                           std::string& errorCode) {
-    int32_t retryTimes = 0;
-    while (true) {
-        ++retryTimes;
-        try {
-            if (bufferMeta.datatype() == int(RawDataType::EVENT_GROUP)) {
-                if (bufferMeta.has_shardhashkey() && !bufferMeta.shardhashkey().empty())
-                    sendClient->PostLogStoreLogs(bufferMeta.project(),
-                                                 bufferMeta.logstore(),
-                                                 bufferMeta.compresstype(),
-                                                 logData,
-                                                 bufferMeta.rawsize(),
-                                                 bufferMeta.shardhashkey());
-                else
-                    sendClient->PostLogStoreLogs(bufferMeta.project(),
-                                                 bufferMeta.logstore(),
-                                                 bufferMeta.compresstype(),
-                                                 logData,
-                                                 bufferMeta.rawsize());
-            } else {
-                if (bufferMeta.has_shardhashkey() && !bufferMeta.shardhashkey().empty())
-                    sendClient->PostLogStoreLogPackageList(bufferMeta.project(),
-                                                           bufferMeta.logstore(),
-                                                           bufferMeta.compresstype(),
-                                                           logData,
-                                                           bufferMeta.shardhashkey());
-                else
-                    sendClient->PostLogStoreLogPackageList(
-                        bufferMeta.project(), bufferMeta.logstore(), bufferMeta.compresstype(), logData);
-            }
-            return SEND_OK;
-        } catch (sdk::LOGException& ex) {
-            errorCode = ex.GetErrorCode();
-            SendResult sendRes = ConvertErrorCode(errorCode);
-            if (sendRes == SEND_DISCARD_ERROR || sendRes == SEND_UNAUTHORIZED || sendRes == SEND_QUOTA_EXCEED
-                || retryTimes >= INT32_FLAG(send_retrytimes)) {
-                if (sendRes == SEND_QUOTA_EXCEED)
-                    LogtailAlarm::GetInstance()->SendAlarm(SEND_QUOTA_EXCEED_ALARM,
-                                                           "error_code: " + errorCode
-                                                               + ", error_message: " + ex.GetMessage(),
-                                                           bufferMeta.project(),
-                                                           bufferMeta.logstore(),
-                                                           "");
-                // no region
-                if (!ProfileSender::GetInstance()->IsProfileData("", bufferMeta.project(), bufferMeta.logstore()))
-                    LOG_ERROR(sLogger,
-                              ("send data to SLS fail, error_code", errorCode)("error_message", ex.GetMessage())(
-                                  "endpoint", sendClient->GetRawSlsHost())("projectName", bufferMeta.project())(
-                                  "logstore", bufferMeta.logstore())("RetryTimes", retryTimes)("rawsize",
-                                                                                               bufferMeta.rawsize()));
-                return sendRes;
-            } else {
-                LOG_DEBUG(
-                    sLogger,
-                    ("send data to SLS fail", "retry later")("error_code", errorCode)("error_message", ex.GetMessage())(
-                        "endpoint", sendClient->GetRawSlsHost())("projectName", bufferMeta.project())(
-                        "logstore", bufferMeta.logstore())("RetryTimes", retryTimes)("rawsize", bufferMeta.rawsize()));
-                usleep(INT32_FLAG(send_retry_sleep_interval));
-            }
-        } catch (...) {
-            if (retryTimes >= INT32_FLAG(send_retrytimes)) {
-                LOG_ERROR(sLogger,
-                          ("send data fail", "unknown excepiton")("endpoint", sendClient->GetRawSlsHost())(
-                              "projectName", bufferMeta.project())("logstore", bufferMeta.logstore())(
-                              "rawsize", bufferMeta.rawsize()));
-                return SEND_DISCARD_ERROR;
-            } else {
-                LOG_DEBUG(sLogger,
-                          ("send data fail", "unknown excepiton, retry later")("endpoint", sendClient->GetRawSlsHost())(
-                              "projectName", bufferMeta.project())("logstore", bufferMeta.logstore())(
-                              "rawsize", bufferMeta.rawsize()));
-                usleep(INT32_FLAG(send_retry_sleep_interval));
-            }
-        }
-    }
-}
-
 } // namespace logtail
\ No newline at end of file
@@ -18,19 +18,23 @@
 
 #include <condition_variable>
 #include <cstdint>
+#include <cstdio>
 #include <future>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/SafeQueue.h"
-#include "plugin/flusher/sls/SendResult.h"
 #include "protobuf/sls/logtail_buffer_meta.pb.h"
 #include "pipeline/queue/SenderQueueItem.h"
-#include "sdk/Client.h"
 
 namespace logtail {
 
+class FlusherSLS;
+
 class DiskBufferWriter {
 public:
     DiskBufferWriter(const DiskBufferWriter&) = delete;
@@ -59,30 +63,61 @@ private:
         int32_t mRetryTime;
     };
 
-    DiskBufferWriter() = default;
-    ~DiskBufferWriter() = default;
+    // A buffer file being replayed. Records are resent asynchronously through sender queues, and each record is marked
+    // handled in the file once the item sent from it is released by the sender, i.e. sent, discarded or buffered again
+    // on exit. The file is removed when all its records are handled.
+    struct ReplayFile {
+        std::string mFileName;
+        int32_t mDiscardCount = 0;
+        // all records have been read and pushed to sender queues
+        bool mAllPushed = false;
+
+        std::mutex mMux;
+        // meta positions of records released by the sender, which are to be marked handled
+        std::vector<int32_t> mReleasedPos;
+        int32_t mInflightCnt = 0;
+        // some records pushed are left unhandled on exit, so the file is kept
+        bool mHasCanceled = false;
+    };
+
+    struct ReplayRecord {
+        int32_t mMetaPos = 0;
+        EncryptionStateMeta mMeta;
+        sls_logs::LogtailBufferMeta mBufferMeta;
+        std::string mEncryption;
+        std::string mLogData;
+        bool mValid = false;
+    };
+
+    struct ReplaySenderQueueItem;
+
+    DiskBufferWriter();
+    ~DiskBufferWriter();
 
     void BufferWriterThread();
     void BufferSenderThread();
 
-    SendResult SendToNetSync(sdk::Client* sendClient,
-                             const sls_logs::LogtailBufferMeta& bufferMeta,
-                             const std::string& logData,
-                             std::string& errorCode);
-    SendResult SendBufferFileData(const sls_logs::LogtailBufferMeta& bufferMeta,
-                                  const std::string& logData,
-                                  std::string& errorCode);
     bool SendToBufferFile(SenderQueueItem* dataPtr);
     bool LoadFileToSend(time_t timeLine, std::vector<std::string>& filesToSend);
     bool CreateNewFile();
     bool WriteBackMeta(const int32_t pos, const void* buf, int32_t length, const std::string& filename);
-    bool ReadNextEncryption(int32_t& pos,
+    bool ReadNextEncryption(FILE* fin,
+                            int64_t fileSize,
+                            int32_t& pos,
                             const std::string& filename,
                             std::string& encryption,
                             EncryptionStateMeta& meta,
                             bool& readResult,
                             sls_logs::LogtailBufferMeta& bufferMeta);
-    void SendEncryptionBuffer(const std::string& filename, int32_t keyVersion);
+    void SendEncryptionBuffer(const std::string& filename, int32_t keyVersion, std::unique_lock<std::mutex>& lock);
+    void DecryptRecords(std::vector<ReplayRecord>& records, int32_t keyVersion, ReplayFile& file);
+    bool PushReplayRecord(ReplayRecord&& record,
+                          const std::shared_ptr<ReplayFile>& file,
+                          std::unique_lock<std::mutex>& lock);
+    FlusherSLS* GetReplayFlusher(const sls_logs::LogtailBufferMeta& bufferMeta);
+    void MarkRecordHandled(const std::string& filename, int32_t metaPos);
+    // write back records released by the sender, and remove files whose records are all handled
+    void CheckReplayFiles();
     void SetBufferFilePath(const std::string& bufferfilepath);
     std::string GetBufferFilePath();
     std::string GetBufferFileName();
@@ -109,6 +144,16 @@ private:
 
     int64_t mSendLastTime = 0;
     int32_t mSendLastByte = 0;
+
+    // only accessed by buffer sender thread
+    std::list<std::shared_ptr<ReplayFile>> mReplayFiles;
+    // flushers without pipeline context used to resend buffered data, which are never released since items sent may
+    // still refer to them
+    std::unordered_map<std::string, std::unique_ptr<FlusherSLS>> mReplayFlushers;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class DiskBufferWriterUnittest;
+#endif
 };
 
 } // namespace logtail
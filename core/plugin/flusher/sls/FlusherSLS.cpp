@@ -472,7 +472,8 @@ bool FlusherSLS::Init(const Json::Value& config, Json::Value& optionalGoPipeline
             mQueueKey,
             vector<shared_ptr<ConcurrencyLimiter>>{GetRegionConcurrencyLimiter(mRegion),
                                                    GetProjectConcurrencyLimiter(mProject)},
-            mMaxSendRate);
+            mMaxSendRate,
+            mRegion);
     }
 
     // (Deprecated) FlowControlExpireTime
@@ -767,7 +768,7 @@ void FlusherSLS::OnSendDone(const HttpResponse& response, SenderQueueItem* item)
         switch (operation) {
             case OperationOnFail::RETRY_IMMEDIATELY:
                 ++item->mTryCnt;
-                FlusherRunner::GetInstance()->PushToHttpSink(item, false);
+                FlusherRunner::GetInstance()->PushToHttpSink(item);
                 break;
             case OperationOnFail::RETRY_LATER:
                 if (slsResponse.mErrorCode == sdk::LOGE_REQUEST_TIMEOUT
@@ -834,6 +835,34 @@ bool FlusherSLS::Send(string&& data, const string& shardHashKey, const string& l
                                                                 shardHashKey));
 }
 
+void FlusherSLS::InitForReplay(const string& region,
+                               const string& aliuid,
+                               const string& project,
+                               sls_logs::SlsCompressType compressType) {
+    mRegion = region;
+    mAliuid = aliuid;
+    mProject = project;
+    switch (compressType) {
+        case sls_logs::SLS_CMP_LZ4:
+            mCompressor = CompressorFactory::GetInstance()->Create(CompressType::LZ4);
+            break;
+        case sls_logs::SLS_CMP_ZSTD:
+            mCompressor = CompressorFactory::GetInstance()->Create(CompressType::ZSTD);
+            break;
+        default:
+            mCompressor.reset();
+            break;
+    }
+    GenerateQueueKey("disk_buffer#" + mRegion + "#" + mAliuid + "#" + mProject + "#"
+                     + ToString(static_cast<int>(compressType)));
+    SenderQueueManager::GetInstance()->CreateQueue(
+        mQueueKey,
+        vector<shared_ptr<ConcurrencyLimiter>>{GetRegionConcurrencyLimiter(mRegion),
+                                               GetProjectConcurrencyLimiter(mProject)},
+        0,
+        mRegion);
+}
+
 void FlusherSLS::GenerateGoPlugin(const Json::Value& config, Json::Value& res) const {
     Json::Value detail(Json::objectValue);
     for (auto itr = config.begin(); itr != config.end(); ++itr) {
@@ -72,6 +72,12 @@ public:
     // for use of Go pipeline, stream, observer and shennong
     bool Send(std::string&& data, const std::string& shardHashKey, const std::string& logstore = "");
 
+    // for use of disk buffer replay, which sends data of the project without pipeline context
+    void InitForReplay(const std::string& region,
+                       const std::string& aliuid,
+                       const std::string& project,
+                       sls_logs::SlsCompressType compressType);
+
     std::string mProject;
     std::string mLogstore;
     std::string mRegion;
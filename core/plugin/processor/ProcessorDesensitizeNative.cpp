@@ -15,6 +15,10 @@
  */
 #include "plugin/processor/ProcessorDesensitizeNative.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
 #include "common/Constants.h"
 #include "common/ParamExtractor.h"
 #include "models/LogEvent.h"
@@ -123,6 +127,12 @@ bool ProcessorDesensitizeNative::Init(const Json::Value& config) {
                            mContext->GetRegion());
     }
 
+    // anchors are extracted from the whole regex, since an alternation in ReplacedContentPattern may match alone
+    std::vector<std::string> anchors;
+    if (ExtractAnchors(regexStr, anchors)) {
+        mAnchorMatcher.Build(anchors);
+    }
+
     // ReplacingAll
     if (!GetOptionalBoolParam(config, "ReplacingAll", mReplacingAll, errorMsg)) {
         PARAM_WARNING_DEFAULT(mContext->GetLogger(),
@@ -171,21 +181,27 @@ void ProcessorDesensitizeNative::ProcessEvent(PipelineEventPtr& e) {
         if (item.second.empty()) {
             continue;
         }
-        std::string value = item.second.to_string();
-        CastOneSensitiveWord(&value);
         mProcDesensitizeRecodesTotal->Add(1);
+        // Most lines contain no sensitive content, which is told without running the regex.
+        if (mAnchorMatcher.IsBuilt() && !mAnchorMatcher.Contains(item.second.data(), item.second.size())) {
+            continue;
+        }
+        std::string value = item.second.to_string();
+        if (!CastOneSensitiveWord(&value)) {
+            continue;
+        }
         StringBuffer valueBuffer = sourceEvent.GetSourceBuffer()->CopyString(value);
         sourceEvent.SetContentNoCopy(item.first, StringView(valueBuffer.data, valueBuffer.size));
     }
 }
 
-void ProcessorDesensitizeNative::CastOneSensitiveWord(std::string* value) {
+bool ProcessorDesensitizeNative::CastOneSensitiveWord(std::string* value) {
     std::string* pVal = value;
     bool rst = false;
 
     if (mMethod == DesensitizeMethod::CONST_OPTION) {
         if (mReplacingAll) {
-            rst = RE2::GlobalReplace(pVal, *mRegex, mReplacingString);
+            rst = RE2::GlobalReplace(pVal, *mRegex, mReplacingString) > 0;
         } else {
             rst = RE2::Replace(pVal, *mRegex, mReplacingString);
         }
@@ -230,10 +246,286 @@ void ProcessorDesensitizeNative::CastOneSensitiveWord(std::string* value) {
             pVal = value;
         }
     }
+    return rst;
 }
 
 bool ProcessorDesensitizeNative::IsSupportedEvent(const PipelineEventPtr& e) const {
     return e.Is<LogEvent>();
 }
 
+namespace {
+
+// Extracts literals one of which must occur in any match of a RE2 regex. Only a subset of the syntax is understood,
+// and Parse fails on anything else, e.g. flags like (?i), so that the literals are never wrong.
+class AnchorParser {
+public:
+    explicit AnchorParser(const std::string& regex) : mRegex(regex) {}
+
+    bool Parse(std::vector<std::string>& anchors) {
+        return ParseAlternation(anchors) && mPos == mRegex.size() && !anchors.empty();
+    }
+
+private:
+    enum class Repeat { ONCE, OPTIONAL, AT_LEAST_ONCE, INVALID };
+
+    // in the following functions, anchors are left empty if the expression requires no literal
+    bool ParseAlternation(std::vector<std::string>& anchors) {
+        anchors.clear();
+        bool hasEmptyBranch = false;
+        while (true) {
+            std::vector<std::string> branch;
+            if (!ParseConcatenation(branch)) {
+                return false;
+            }
+            hasEmptyBranch = hasEmptyBranch || branch.empty();
+            anchors.insert(anchors.end(), branch.begin(), branch.end());
+            if (mPos == mRegex.size() || mRegex[mPos] != '|') {
+                break;
+            }
+            ++mPos;
+        }
+        if (hasEmptyBranch) {
+            anchors.clear();
+        }
+        return true;
+    }
+
+    bool ParseConcatenation(std::vector<std::string>& anchors) {
+        std::string literal;
+        // keep the alternatives whose shortest literal is the longest
+        auto consider = [&anchors](std::vector<std::string>&& candidate) {
+            if (candidate.empty()) {
+                return;
+            }
+            if (anchors.empty() || MinLength(candidate) > MinLength(anchors)
+                || (MinLength(candidate) == MinLength(anchors) && candidate.size() < anchors.size())) {
+                anchors = std::move(candidate);
+            }
+        };
+        auto endLiteral = [&]() {
+            if (!literal.empty()) {
+                consider({literal});
+                literal.clear();
+            }
+        };
+        while (mPos < mRegex.size() && mRegex[mPos] != '|' && mRegex[mPos] != ')') {
+            char c = mRegex[mPos];
+            if (c == '(') {
+                endLiteral();
+                std::vector<std::string> group;
+                if (!ParseGroup(group)) {
+                    return false;
+                }
+                Repeat repeat = ParseRepeat();
+                if (repeat == Repeat::INVALID) {
+                    return false;
+                }
+                if (repeat != Repeat::OPTIONAL) {
+                    consider(std::move(group));
+                }
+                continue;
+            }
+            if (c == '^' || c == '$') {
+                endLiteral();
+                ++mPos;
+                continue;
+            }
+            if (c == '[' || c == '.') {
+                endLiteral();
+                if (c == '.') {
+                    ++mPos;
+                } else if (!SkipClass()) {
+                    return false;
+                }
+                if (ParseRepeat() == Repeat::INVALID) {
+                    return false;
+                }
+                continue;
+            }
+            char ch = '\0';
+            bool isLiteral = true;
+            if (!ParseChar(ch, isLiteral)) {
+                return false;
+            }
+            Repeat repeat = ParseRepeat();
+            // the repeat applies to the whole utf-8 char rather than the last byte
+            if (repeat == Repeat::INVALID || (repeat != Repeat::ONCE && static_cast<unsigned char>(ch) >= 0x80)) {
+                return false;
+            }
+            if (!isLiteral) {
+                endLiteral();
+                continue;
+            }
+            if (repeat == Repeat::OPTIONAL) {
+                endLiteral();
+            } else {
+                literal.push_back(ch);
+                if (repeat == Repeat::AT_LEAST_ONCE) {
+                    endLiteral();
+                }
+            }
+        }
+        endLiteral();
+        return true;
+    }
+
+    bool ParseGroup(std::vector<std::string>& anchors) {
+        // mRegex[mPos] == '('
+        ++mPos;
+        if (mRegex.compare(mPos, 2, "?:") == 0) {
+            mPos += 2;
+        } else if (mRegex.compare(mPos, 3, "?P<") == 0) {
+            mPos = mRegex.find('>', mPos);
+            if (mPos == std::string::npos) {
+                return false;
+            }
+            ++mPos;
+        } else if (mPos < mRegex.size() && mRegex[mPos] == '?') {
+            return false;
+        }
+        if (!ParseAlternation(anchors) || mPos == mRegex.size() || mRegex[mPos] != ')') {
+            return false;
+        }
+        ++mPos;
+        return true;
+    }
+
+    bool SkipClass() {
+        // mRegex[mPos] == '[', a leading ']' or '^]' is a literal inside the class
+        ++mPos;
+        if (mPos < mRegex.size() && mRegex[mPos] == '^') {
+            ++mPos;
+        }
+        if (mPos < mRegex.size() && mRegex[mPos] == ']') {
+            ++mPos;
+        }
+        while (mPos < mRegex.size()) {
+            if (mRegex[mPos] == '\\') {
+                mPos += 2;
+            } else if (mRegex.compare(mPos, 2, "[:") == 0) {
+                mPos = mRegex.find(":]", mPos + 2);
+                if (mPos == std::string::npos) {
+                    return false;
+                }
+                mPos += 2;
+            } else if (mRegex[mPos++] == ']') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // parse a char or an escape, isLiteral is false for classes like \d and assertions like \b
+    bool ParseChar(char& c, bool& isLiteral) {
+        c = mRegex[mPos++];
+        isLiteral = true;
+        if (c == '*' || c == '+' || c == '?' || c == '{') {
+            return false;
+        }
+        if (c != '\\') {
+            return true;
+        }
+        if (mPos == mRegex.size()) {
+            return false;
+        }
+        c = mRegex[mPos++];
+        switch (c) {
+            case 't':
+                c = '\t';
+                return true;
+            case 'n':
+                c = '\n';
+                return true;
+            case 'r':
+                c = '\r';
+                return true;
+            case 'f':
+                c = '\f';
+                return true;
+            case 'v':
+                c = '\v';
+                return true;
+            case 'd':
+            case 'D':
+            case 'w':
+            case 'W':
+            case 's':
+            case 'S':
+            case 'b':
+            case 'B':
+            case 'A':
+            case 'z':
+                isLiteral = false;
+                return true;
+            default:
+                return !isalnum(static_cast<unsigned char>(c));
+        }
+    }
+
+    Repeat ParseRepeat() {
+        if (mPos == mRegex.size()) {
+            return Repeat::ONCE;
+        }
+        Repeat repeat = Repeat::ONCE;
+        switch (mRegex[mPos]) {
+            case '?':
+            case '*':
+                repeat = Repeat::OPTIONAL;
+                ++mPos;
+                break;
+            case '+':
+                repeat = Repeat::AT_LEAST_ONCE;
+                ++mPos;
+                break;
+            case '{': {
+                // only {n}, {n,} and {n,m} are repetitions, RE2 takes any other brace as a literal, which is not
+                // handled here
+                size_t end = mPos + 1;
+                while (end < mRegex.size() && isdigit(static_cast<unsigned char>(mRegex[end]))) {
+                    ++end;
+                }
+                if (end == mPos + 1) {
+                    return Repeat::INVALID;
+                }
+                if (end < mRegex.size() && mRegex[end] == ',') {
+                    ++end;
+                    while (end < mRegex.size() && isdigit(static_cast<unsigned char>(mRegex[end]))) {
+                        ++end;
+                    }
+                }
+                if (end == mRegex.size() || mRegex[end] != '}') {
+                    return Repeat::INVALID;
+                }
+                repeat = atoi(mRegex.c_str() + mPos + 1) == 0 ? Repeat::OPTIONAL : Repeat::AT_LEAST_ONCE;
+                mPos = end + 1;
+                break;
+            }
+            default:
+                return Repeat::ONCE;
+        }
+        // non-greedy
+        if (mPos < mRegex.size() && mRegex[mPos] == '?') {
+            ++mPos;
+        }
+        return repeat;
+    }
+
+    static size_t MinLength(const std::vector<std::string>& anchors) {
+        size_t res = std::string::npos;
+        for (const auto& anchor : anchors) {
+            res = std::min(res, anchor.size());
+        }
+        return res;
+    }
+
+    const std::string& mRegex;
+    size_t mPos = 0;
+};
+
+} // namespace
+
+bool ProcessorDesensitizeNative::ExtractAnchors(const std::string& regex, std::vector<std::string>& anchors) {
+    return AnchorParser(regex).Parse(anchors);
+}
+
 } // namespace logtail
\ No newline at end of file
@@ -18,6 +18,10 @@
 
 #include <re2/re2.h>
 
+#include <string>
+#include <vector>
+
+#include "common/AhoCorasickMatcher.h"
 #include "pipeline/plugin/interface/Processor.h"
 
 namespace logtail {
@@ -52,14 +56,21 @@ protected:
 
 private:
     void ProcessEvent(PipelineEventPtr& e);
-    void CastOneSensitiveWord(std::string* value);
+    // @return false if value is not changed
+    bool CastOneSensitiveWord(std::string* value);
+    // @return false if anchors cannot be extracted from regex, otherwise any match of regex contains one of anchors
+    static bool ExtractAnchors(const std::string& regex, std::vector<std::string>& anchors);
 
     std::shared_ptr<re2::RE2> mRegex;
+    // literals required by the whole regex, i.e. ContentPatternBeforeReplacedString followed by ReplacedContentPattern,
+    // e.g. "pwd=", which are searched in one pass before running the regex
+    AhoCorasickMatcher mAnchorMatcher;
 
     CounterPtr mProcDesensitizeRecodesTotal;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorParseApsaraNativeUnittest;
+    friend class ProcessorDesensitizeNativeUnittest;
 #endif
 };
 
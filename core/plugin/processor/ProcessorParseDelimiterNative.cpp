@@ -106,7 +106,7 @@ bool ProcessorParseDelimiterNative::Init(const Json::Value& config) {
                              mContext->GetRegion());
     }
 
-    mDelimiterModeFsmParserPtr.reset(new DelimiterModeFsmParser(mQuote, mSeparatorChar));
+    mSplitter = DelimiterSplitter(mSeparator, mQuote, true);
 
     // Keys
     if (!GetMandatoryListParam(config, "Keys", mKeys, errorMsg)) {
@@ -193,9 +193,25 @@ void ProcessorParseDelimiterNative::Process(PipelineEventGroup& logGroup) {
     const StringView& logPath = logGroup.GetMetadata(EventGroupMetaKey::LOG_FILE_PATH_RESOLVED);
     EventsContainer& events = logGroup.MutableEvents();
 
+    // split lines of all events at once, so that field offsets of the whole group are kept in one array
+    std::vector<StringView> buffers(events.size());
+    std::vector<StringView> lines(events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        lines[i] = GetLine(events[i], buffers[i]);
+    }
+    std::vector<DelimiterField> fields;
+    std::vector<DelimiterLine> splitRes(events.size());
+    if (!mKeys.empty()) {
+        fields.reserve(events.size() * (mKeys.size() + 1));
+        mSplitter.Split(lines, fields, splitRes);
+    }
+
+    std::vector<LogContent> contents;
+    contents.reserve(mKeys.size() + 1);
     size_t wIdx = 0;
     for (size_t rIdx = 0; rIdx < events.size(); ++rIdx) {
-        if (ProcessEvent(logPath, events[rIdx])) {
+        if (lines[rIdx].empty()
+            || ProcessEvent(logPath, events[rIdx], buffers[rIdx], lines[rIdx], fields, splitRes[rIdx], contents)) {
             if (wIdx != rIdx) {
                 events[wIdx] = std::move(events[rIdx]);
             }
@@ -206,20 +222,17 @@ void ProcessorParseDelimiterNative::Process(PipelineEventGroup& logGroup) {
     return;
 }
 
-bool ProcessorParseDelimiterNative::ProcessEvent(const StringView& logPath, PipelineEventPtr& e) {
+StringView ProcessorParseDelimiterNative::GetLine(PipelineEventPtr& e, StringView& buffer) {
     if (!IsSupportedEvent(e)) {
-        return true;
+        return StringView();
     }
     LogEvent& sourceEvent = e.Cast<LogEvent>();
     if (!sourceEvent.HasContent(mSourceKey)) {
-        return true;
+        return StringView();
     }
-    StringView buffer = sourceEvent.GetContent(mSourceKey);
+    buffer = sourceEvent.GetContent(mSourceKey);
     mProcParseInSizeBytes->Add(buffer.size());
     int32_t endIdx = buffer.size();
-    if (endIdx == 0)
-        return true;
-
     for (int32_t i = endIdx - 1; i >= 0; --i) {
         if (buffer.data()[i] == ' ' || '\r' == buffer.data()[i])
             endIdx = i;
@@ -234,45 +247,58 @@ bool ProcessorParseDelimiterNative::ProcessEvent(const StringView& logPath, Pipe
             break;
     }
     if (begIdx >= endIdx)
-        return true;
-    size_t reserveSize
-        = mOverflowedFieldsTreatment == OverflowedFieldsTreatment::EXTEND ? (mKeys.size() + 10) : (mKeys.size() + 1);
-    std::vector<StringView> columnValues;
-    std::vector<size_t> colBegIdxs;
-    std::vector<size_t> colLens;
+        return StringView();
+    return StringView(buffer.data() + begIdx, endIdx - begIdx);
+}
+
+bool ProcessorParseDelimiterNative::ProcessEvent(const StringView& logPath,
+                                                 PipelineEventPtr& e,
+                                                 StringView buffer,
+                                                 StringView line,
+                                                 const std::vector<DelimiterField>& fields,
+                                                 const DelimiterLine& splitRes,
+                                                 std::vector<LogContent>& contents) {
+    LogEvent& sourceEvent = e.Cast<LogEvent>();
     bool parseSuccess = false;
-    size_t parsedColCount = 0;
-    bool useQuote = (mSeparator.size() == 1) && (mQuote != mSeparatorChar);
+    size_t parsedColCount = splitRes.mFieldEnd - splitRes.mFieldBegin;
+    const DelimiterField* cols = fields.data() + splitRes.mFieldBegin;
+    // excess fields are kept as a whole in one column unless they are extended
+    bool overflowed = false;
+    StringView overflowedFields;
     if (mKeys.size() > 0) {
-        if (useQuote) {
-            columnValues.reserve(reserveSize);
-            parseSuccess
-                = mDelimiterModeFsmParserPtr->ParseDelimiterLine(buffer, begIdx, endIdx, columnValues, sourceEvent);
-            // handle auto extend
-            if (!(mOverflowedFieldsTreatment == OverflowedFieldsTreatment::EXTEND)
-                && columnValues.size() > mKeys.size()) {
-                int requiredLen = 0;
-                for (size_t i = mKeys.size(); i < columnValues.size(); ++i) {
-                    requiredLen += 1 + columnValues[i].size();
+        parseSuccess = splitRes.mSuccess;
+        if (parseSuccess && mOverflowedFieldsTreatment != OverflowedFieldsTreatment::EXTEND
+            && parsedColCount > mKeys.size()) {
+            bool quoted = false;
+            for (size_t i = mKeys.size(); i < parsedColCount; ++i) {
+                quoted |= cols[i].mQuoted;
+            }
+            if (!quoted) {
+                // each field is preceded by the separator, which is the same as joining them
+                size_t begin = cols[mKeys.size()].mOffset - mSeparator.size();
+                overflowedFields = StringView(line.data() + begin, line.size() - begin);
+            } else {
+                size_t requiredLen = 0;
+                for (size_t i = mKeys.size(); i < parsedColCount; ++i) {
+                    requiredLen += 1 + cols[i].mLength;
                 }
                 StringBuffer sb = sourceEvent.GetSourceBuffer()->AllocateStringBuffer(requiredLen);
                 char* extraFields = sb.data;
-                for (size_t i = mKeys.size(); i < columnValues.size(); ++i) {
+                for (size_t i = mKeys.size(); i < parsedColCount; ++i) {
                     extraFields[0] = mSeparatorChar;
                     extraFields++;
-                    memcpy(extraFields, columnValues[i].data(), columnValues[i].size());
-                    extraFields += columnValues[i].size();
+                    StringView field(line.data() + cols[i].mOffset, cols[i].mLength);
+                    if (cols[i].mEscaped) {
+                        extraFields += mSplitter.Unescape(field, extraFields);
+                    } else {
+                        memcpy(extraFields, field.data(), field.size());
+                        extraFields += field.size();
+                    }
                 }
-                // remove extra fields
-                columnValues.resize(mKeys.size());
-                columnValues.push_back(StringView(sb.data, requiredLen));
+                overflowedFields = StringView(sb.data, extraFields - sb.data);
             }
-            parsedColCount = columnValues.size();
-        } else {
-            colBegIdxs.reserve(reserveSize);
-            colLens.reserve(reserveSize);
-            parseSuccess = SplitString(buffer.data(), begIdx, endIdx, colBegIdxs, colLens);
-            parsedColCount = colBegIdxs.size();
+            overflowed = true;
+            parsedColCount = mKeys.size() + 1;
         }
 
         if (parseSuccess) {
@@ -320,25 +346,31 @@ bool ProcessorParseDelimiterNative::ProcessEvent(const StringView& logPath, Pipe
     }
 
     if (parseSuccess) {
+        contents.clear();
+        size_t contentSize = 0;
         for (uint32_t idx = 0; idx < parsedColCount; idx++) {
+            StringView key;
             if (mKeys.size() > idx) {
                 if (mExtractingPartialFields && mKeys[idx] == s_mDiscardedFieldKey) {
                     continue;
                 }
-                AddLog(mKeys[idx],
-                       useQuote ? columnValues[idx] : StringView(buffer.data() + colBegIdxs[idx], colLens[idx]),
-                       sourceEvent);
+                key = mKeys[idx];
             } else {
                 if (mExtractingPartialFields) {
                     continue;
                 }
-                std::string key = "__column" + ToString(idx) + "__";
-                StringBuffer sb = sourceEvent.GetSourceBuffer()->CopyString(key);
-                AddLog(StringView(sb.data, sb.size),
-                       useQuote ? columnValues[idx] : StringView(buffer.data() + colBegIdxs[idx], colLens[idx]),
-                       sourceEvent);
+                std::string column = "__column" + ToString(idx) + "__";
+                StringBuffer sb = sourceEvent.GetSourceBuffer()->CopyString(column);
+                key = StringView(sb.data, sb.size);
             }
+            StringView value
+                = overflowed && idx == mKeys.size() ? overflowedFields : GetFieldValue(line, cols[idx], sourceEvent);
+            contents.emplace_back(key, value);
+            contentSize += key.size() + value.size();
         }
+        sourceEvent.SetContentsNoCopy(contents);
+        *mLogGroupSize += contentSize + 5 * contents.size();
+        mProcParseOutSizeBytes->Add(contentSize);
     }
     if (!parseSuccess || !mSourceKeyOverwritten) {
         sourceEvent.DelContent(mSourceKey);
@@ -356,49 +388,14 @@ bool ProcessorParseDelimiterNative::ProcessEvent(const StringView& logPath, Pipe
     return true;
 }
 
-bool ProcessorParseDelimiterNative::SplitString(
-    const char* buffer, int32_t begIdx, int32_t endIdx, std::vector<size_t>& colBegIdxs, std::vector<size_t>& colLens) {
-    if (endIdx <= begIdx || mSeparator.size() == 0 || mKeys.size() == 0)
-        return false;
-    size_t size = endIdx - begIdx;
-    size_t d_size = mSeparator.size();
-    if (d_size == 0 || d_size > size) {
-        colBegIdxs.push_back(begIdx);
-        colLens.push_back(size);
-        return true;
+StringView
+ProcessorParseDelimiterNative::GetFieldValue(StringView line, const DelimiterField& field, LogEvent& targetEvent) {
+    StringView value(line.data() + field.mOffset, field.mLength);
+    if (!field.mEscaped) {
+        return value;
     }
-    size_t pos = begIdx;
-    size_t top = endIdx - d_size;
-    while (pos <= top) {
-        const char* pch = std::search(buffer + pos, buffer + endIdx, mSeparator.begin(), mSeparator.end());
-        size_t pos2;
-        // if not found, pos2 = endIdx
-        if (pch == buffer + endIdx) {
-            pos2 = endIdx;
-        } else {
-            pos2 = pch - buffer;
-        }
-        if (pos2 != pos) {
-            colBegIdxs.push_back(pos);
-            colLens.push_back(pos2 - pos);
-        } else {
-            colBegIdxs.push_back(pos);
-            colLens.push_back(0);
-        }
-        if (pos2 == (size_t)endIdx)
-            return true;
-        pos = pos2 + d_size;
-        if (colLens.size() >= mKeys.size() && !(mOverflowedFieldsTreatment == OverflowedFieldsTreatment::EXTEND)) {
-            colBegIdxs.push_back(pos2);
-            colLens.push_back(endIdx - pos2);
-            return true;
-        }
-    }
-    if (pos <= (size_t)endIdx) {
-        colBegIdxs.push_back(pos);
-        colLens.push_back(endIdx - pos);
-    }
-    return true;
+    StringBuffer sb = targetEvent.GetSourceBuffer()->AllocateStringBuffer(value.size());
+    return StringView(sb.data, mSplitter.Unescape(value, sb.data));
 }
 
 void ProcessorParseDelimiterNative::AddLog(const StringView& key,
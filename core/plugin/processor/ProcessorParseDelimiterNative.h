@@ -16,10 +16,8 @@
 
 #pragma once
 
-#include <memory>
-
 #include "models/LogEvent.h"
-#include "parser/DelimiterModeFsmParser.h"
+#include "parser/DelimiterSplitter.h"
 #include "pipeline/plugin/interface/Processor.h"
 #include "plugin/processor/CommonParserOptions.h"
 
@@ -62,17 +60,21 @@ protected:
 private:
     static const std::string s_mDiscardedFieldKey;
 
-    bool ProcessEvent(const StringView& logPath, PipelineEventPtr& e);
-    bool SplitString(const char* buffer,
-                     int32_t begIdx,
-                     int32_t endIdx,
-                     std::vector<size_t>& colBegIdxs,
-                     std::vector<size_t>& colLens);
+    // @return trimmed line to split, or empty if the event should be left as is
+    StringView GetLine(PipelineEventPtr& e, StringView& buffer);
+    bool ProcessEvent(const StringView& logPath,
+                      PipelineEventPtr& e,
+                      StringView buffer,
+                      StringView line,
+                      const std::vector<DelimiterField>& fields,
+                      const DelimiterLine& splitRes,
+                      std::vector<LogContent>& contents);
+    StringView GetFieldValue(StringView line, const DelimiterField& field, LogEvent& targetEvent);
     void AddLog(const StringView& key, const StringView& value, LogEvent& targetEvent, bool overwritten = true);
 
     char mSeparatorChar;
     bool mSourceKeyOverwritten = false;
-    std::unique_ptr<DelimiterModeFsmParser> mDelimiterModeFsmParserPtr;
+    DelimiterSplitter mSplitter;
 
     int* mLogGroupSize = nullptr;
     int* mParseFailures = nullptr;
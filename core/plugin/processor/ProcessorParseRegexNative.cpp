@@ -16,6 +16,10 @@
 
 #include "plugin/processor/ProcessorParseRegexNative.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
 #include "app_config/AppConfig.h"
 #include "common/ParamExtractor.h"
 #include "monitor/MetricConstants.h"
@@ -61,6 +65,9 @@ bool ProcessorParseRegexNative::Init(const Json::Value& config) {
     }
     mReg = boost::regex(mRegex);
     mIsWholeLineMode = mRegex == "(.*)";
+    if (!mIsWholeLineMode) {
+        InitMatcher();
+    }
 
     // Keys
     if (!GetMandatoryListParam(config, "Keys", mKeys, errorMsg)) {
@@ -143,7 +150,7 @@ bool ProcessorParseRegexNative::ProcessEvent(const StringView& logPath, Pipeline
     if (mIsWholeLineMode) {
         parseSuccess = WholeLineModeParser(sourceEvent, mKeys.empty() ? DEFAULT_CONTENT_KEY : mKeys[0]);
     } else {
-        parseSuccess = RegexLogLineParser(sourceEvent, mReg, mKeys, logPath);
+        parseSuccess = RegexLogLineParser(sourceEvent, mKeys, logPath);
     }
 
     if (!parseSuccess || !mSourceKeyOverwritten) {
@@ -182,15 +189,14 @@ void ProcessorParseRegexNative::AddLog(const StringView& key,
 }
 
 bool ProcessorParseRegexNative::RegexLogLineParser(LogEvent& sourceEvent,
-                                                   const boost::regex& reg,
                                                    const std::vector<std::string>& keys,
                                                    const StringView& logPath) {
-    boost::match_results<const char*> what;
+    static thread_local std::vector<StringView> sCaptures;
     std::string exception;
     StringView buffer = sourceEvent.GetContent(mSourceKey);
     bool parseSuccess = true;
     mProcParseInSizeBytes->Add(buffer.size());
-    if (!BoostRegexMatch(buffer.data(), buffer.size(), reg, exception, what, boost::match_default)) {
+    if (!Match(buffer, keys.size(), sCaptures, exception)) {
         if (!exception.empty()) {
             if (AppConfig::GetInstance()->IsLogParseAlarmValid()) {
                 if (GetContext().GetAlarm().IsLowLevelAlarmValid()) {
@@ -223,16 +229,16 @@ bool ProcessorParseRegexNative::RegexLogLineParser(LogEvent& sourceEvent,
         ++(*mParseFailures);
         mProcParseErrorTotal->Add(1);
         parseSuccess = false;
-    } else if (what.size() <= keys.size()) {
+    } else if (mGroupCnt < keys.size()) {
         if (AppConfig::GetInstance()->IsLogParseAlarmValid()) {
             if (GetContext().GetAlarm().IsLowLevelAlarmValid()) {
                 LOG_WARNING(GetContext().GetLogger(),
                             ("parse key count not match",
-                             what.size())("parse regex log fail", buffer)("project", GetContext().GetProjectName())(
+                             mGroupCnt + 1)("parse regex log fail", buffer)("project", GetContext().GetProjectName())(
                                 "logstore", GetContext().GetLogstoreName())("file", logPath));
             }
             GetContext().GetAlarm().SendAlarm(REGEX_MATCH_ALARM,
-                                              "parse key count not match" + ToString(what.size())
+                                              "parse key count not match" + ToString(mGroupCnt + 1)
                                                   + "errorlog:" + buffer.to_string(),
                                               GetContext().GetProjectName(),
                                               GetContext().GetLogstoreName(),
@@ -248,7 +254,197 @@ bool ProcessorParseRegexNative::RegexLogLineParser(LogEvent& sourceEvent,
     }
 
     for (uint32_t i = 0; i < keys.size(); i++) {
-        AddLog(keys[i], StringView(what[i + 1].begin(), what[i + 1].length()), sourceEvent);
+        AddLog(keys[i], sCaptures[i], sourceEvent);
+    }
+    return true;
+}
+
+namespace {
+
+// a trailing $ makes no difference when the whole line must be matched
+size_t GetRegexEnd(const std::string& regex) {
+    if (regex.empty() || regex.back() != '$') {
+        return regex.size();
+    }
+    size_t backslashCnt = 0;
+    while (backslashCnt + 1 < regex.size() && regex[regex.size() - 2 - backslashCnt] == '\\') {
+        ++backslashCnt;
+    }
+    return backslashCnt % 2 == 0 ? regex.size() - 1 : regex.size();
+}
+
+// parse a single char at regex[pos], which is either a plain char or an escaped punctuation
+bool ParseLiteralChar(const std::string& regex, size_t& pos, size_t end, const char* specialChars, char& c) {
+    c = regex[pos];
+    if (c == '\\') {
+        if (pos + 1 >= end) {
+            return false;
+        }
+        c = regex[pos + 1];
+        if (c == 't') {
+            c = '\t';
+        } else if (isalnum(static_cast<unsigned char>(c))) {
+            return false;
+        }
+        pos += 2;
+        return true;
+    }
+    if (c == '\0' || strchr(specialChars, c) != nullptr) {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+} // namespace
+
+void ProcessorParseRegexNative::InitMatcher() {
+    mGroupCnt = mReg.mark_count();
+    mIsLiteralSplit = ParseLiteralSplit(mRegex, mSplitFields, mSplitSuffix) && mSplitFields.size() == mGroupCnt;
+    if (mIsLiteralSplit) {
+        return;
+    }
+    std::string regex = mRegex.substr(0, GetRegexEnd(mRegex));
+    if (!IsRe2Compatible(regex)) {
+        return;
+    }
+    // boost::regex works on bytes and its dot matches newline by default
+    re2::RE2::Options options;
+    options.set_encoding(re2::RE2::Options::EncodingLatin1);
+    options.set_dot_nl(true);
+    options.set_log_errors(false);
+    std::shared_ptr<re2::RE2> re2(new re2::RE2(regex, options));
+    if (re2->ok() && static_cast<size_t>(re2->NumberOfCapturingGroups()) == mGroupCnt) {
+        mRe2 = std::move(re2);
+    }
+}
+
+bool ProcessorParseRegexNative::ParseLiteralSplit(const std::string& regex,
+                                                  std::vector<LiteralSplitField>& fields,
+                                                  std::string& suffix) {
+    fields.clear();
+    suffix.clear();
+    size_t end = GetRegexEnd(regex);
+    size_t pos = !regex.empty() && regex[0] == '^' ? 1 : 0;
+    while (true) {
+        std::string literal;
+        while (pos < end && regex[pos] != '(') {
+            char c = '\0';
+            if (!ParseLiteralChar(regex, pos, end, "^$.|?*+()[]{}", c)) {
+                return false;
+            }
+            literal.push_back(c);
+        }
+        if (!fields.empty()) {
+            const auto& last = fields.back();
+            // otherwise the regex may backtrack into the last capture
+            if (last.mToEnd ? pos < end : !(literal.empty() ? pos == end : literal[0] == last.mStop)) {
+                return false;
+            }
+        }
+        if (pos == end) {
+            suffix = std::move(literal);
+            return !fields.empty();
+        }
+
+        // one of ([^c]*), ([^c]+), (.*) and (.+)
+        LiteralSplitField field;
+        field.mPrefix = std::move(literal);
+        ++pos;
+        if (pos < end && regex[pos] == '.') {
+            field.mToEnd = true;
+            ++pos;
+        } else if (pos + 1 < end && regex[pos] == '[' && regex[pos + 1] == '^') {
+            pos += 2;
+            if (pos >= end || !ParseLiteralChar(regex, pos, end, "[]^-", field.mStop) || pos >= end
+                || regex[pos] != ']') {
+                return false;
+            }
+            ++pos;
+        } else {
+            return false;
+        }
+        if (pos + 1 >= end || (regex[pos] != '*' && regex[pos] != '+') || regex[pos + 1] != ')') {
+            return false;
+        }
+        field.mNonEmpty = regex[pos] == '+';
+        pos += 2;
+        fields.emplace_back(std::move(field));
+    }
+}
+
+bool ProcessorParseRegexNative::LiteralSplit(StringView buffer,
+                                             size_t captureCnt,
+                                             std::vector<StringView>& captures) const {
+    size_t pos = 0;
+    for (const auto& field : mSplitFields) {
+        if (buffer.size() - pos < field.mPrefix.size()
+            || memcmp(buffer.data() + pos, field.mPrefix.data(), field.mPrefix.size()) != 0) {
+            return false;
+        }
+        pos += field.mPrefix.size();
+        size_t fieldEnd = 0;
+        if (field.mToEnd) {
+            if (buffer.size() - pos < mSplitSuffix.size()) {
+                return false;
+            }
+            fieldEnd = buffer.size() - mSplitSuffix.size();
+        } else {
+            fieldEnd = buffer.find(field.mStop, pos);
+            if (fieldEnd == StringView::npos) {
+                fieldEnd = buffer.size();
+            }
+        }
+        if (field.mNonEmpty && fieldEnd == pos) {
+            return false;
+        }
+        if (captures.size() < captureCnt) {
+            captures.emplace_back(buffer.data() + pos, fieldEnd - pos);
+        }
+        pos = fieldEnd;
+    }
+    return buffer.size() - pos == mSplitSuffix.size()
+        && memcmp(buffer.data() + pos, mSplitSuffix.data(), mSplitSuffix.size()) == 0;
+}
+
+bool ProcessorParseRegexNative::Match(StringView buffer,
+                                      size_t captureCnt,
+                                      std::vector<StringView>& captures,
+                                      std::string& exception) const {
+    captures.clear();
+    if (mIsLiteralSplit) {
+        return LiteralSplit(buffer, captureCnt, captures);
+    }
+    if (!mRe2 || !mRe2Preferred.load(std::memory_order_relaxed)) {
+        static thread_local boost::match_results<const char*> sWhat;
+        if (BoostRegexMatch(buffer.data(), buffer.size(), mReg, exception, sWhat, boost::match_default)) {
+            for (size_t i = 1; i < sWhat.size() && captures.size() < captureCnt; ++i) {
+                captures.emplace_back(sWhat[i].first, sWhat[i].length());
+            }
+            return true;
+        }
+        if (!mRe2 || exception.empty()) {
+            return false;
+        }
+        if (!mRe2Preferred.exchange(true)) {
+            LOG_WARNING(GetContext().GetLogger(),
+                        ("regex is too complex for boost, switch to re2", mRegex)("exception", exception)(
+                            "project", GetContext().GetProjectName())("logstore", GetContext().GetLogstoreName()));
+        }
+        exception.clear();
+    }
+    static thread_local std::vector<re2::StringPiece> sSubmatches;
+    sSubmatches.resize(std::min(captureCnt, mGroupCnt) + 1);
+    if (!mRe2->Match(re2::StringPiece(buffer.data(), buffer.size()),
+                     0,
+                     buffer.size(),
+                     re2::RE2::ANCHOR_BOTH,
+                     sSubmatches.data(),
+                     static_cast<int>(sSubmatches.size()))) {
+        return false;
+    }
+    for (size_t i = 1; i < sSubmatches.size(); ++i) {
+        captures.emplace_back(sSubmatches[i].data(), sSubmatches[i].size());
     }
     return true;
 }
@@ -16,8 +16,12 @@
 
 #pragma once
 
+#include <re2/re2.h>
+
 #include <boost/regex.hpp>
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "models/LogEvent.h"
@@ -46,18 +50,42 @@ protected:
     bool IsSupportedEvent(const PipelineEventPtr& e) const override;
 
 private:
+    // A regex which only consists of literals and captures like ([^,]*), ([^ ]+) and (.*), e.g.
+    // ([^ ]*) ([^ ]*) \[([^\]]*)\] "(.*)", is matched by finding the literals, since each capture ends at the first
+    // stop char or right before the suffix.
+    struct LiteralSplitField {
+        // literal before the capture
+        std::string mPrefix;
+        // the capture ends before the first mStop, or before the suffix of the regex if mToEnd
+        char mStop = '\0';
+        bool mToEnd = false;
+        bool mNonEmpty = false;
+    };
+
     /// @return false if data need to be discarded
     bool ProcessEvent(const StringView& logPath, PipelineEventPtr& e);
     bool WholeLineModeParser(LogEvent& sourceEvent, const std::string& key);
-    bool RegexLogLineParser(LogEvent& sourceEvent,
-                            const boost::regex& reg,
-                            const std::vector<std::string>& keys,
-                            const StringView& logPath);
+    bool RegexLogLineParser(LogEvent& sourceEvent, const std::vector<std::string>& keys, const StringView& logPath);
     void AddLog(const StringView& key, const StringView& value, LogEvent& targetEvent, bool overwritten = true);
 
+    void InitMatcher();
+    // captures are views of buffer, and only the first captureCnt groups are returned
+    bool Match(StringView buffer, size_t captureCnt, std::vector<StringView>& captures, std::string& exception) const;
+    bool LiteralSplit(StringView buffer, size_t captureCnt, std::vector<StringView>& captures) const;
+    static bool
+    ParseLiteralSplit(const std::string& regex, std::vector<LiteralSplitField>& fields, std::string& suffix);
+
     bool mSourceKeyOverwritten = false;
     bool mIsWholeLineMode = false;
     boost::regex mReg;
+    // RE2 runs in linear time, but extracting captures is usually slower than boost. So it is only used once boost
+    // gives up on a line because of too much backtracking.
+    std::shared_ptr<re2::RE2> mRe2;
+    mutable std::atomic_bool mRe2Preferred{false};
+    std::vector<LiteralSplitField> mSplitFields;
+    std::string mSplitSuffix;
+    bool mIsLiteralSplit = false;
+    size_t mGroupCnt = 0;
 
     int* mParseFailures = nullptr;
     int* mRegexMatchFailures = nullptr;
@@ -52,6 +52,10 @@ bool ProcessorParseTimestampNative::Init(const Json::Value& config) {
                            mContext->GetLogstoreName(),
                            mContext->GetRegion());
     }
+    const char* nanosecondPos = strstr(mSourceFormat.c_str(), "%f");
+    mHaveNanosecond = nanosecondPos != nullptr;
+    mEndWithNanosecond = nanosecondPos == (mSourceFormat.c_str() + mSourceFormat.size() - 2);
+    mCompiledFormat.Compile(mSourceFormat);
 
     // SourceTimezone
     if (!GetOptionalStringParam(config, "SourceTimezone", mSourceTimezone, errorMsg)) {
@@ -186,21 +190,25 @@ bool ProcessorParseTimestampNative::ParseLogTime(const StringView& curTimeStr, /
     // Second-level cache only work when:
     // 1. No %f in the time format
     // 2. The %f is at the end of the time format
-    const char* compareResult = strstr(mSourceFormat.c_str(), "%f");
-    bool haveNanosecond = compareResult != nullptr;
-    bool endWithNanosecond = compareResult == (mSourceFormat.c_str() + mSourceFormat.size() - 2);
     int nanosecondLength = -1;
     const char* strptimeResult = NULL;
-    if ((!haveNanosecond || endWithNanosecond) && IsPrefixString(curTimeStr, timeStrCache)) {
+    if ((!mHaveNanosecond || mEndWithNanosecond) && IsPrefixString(curTimeStr, timeStrCache)) {
         bool isTimestampNanosecond = (mSourceFormat == "%s") && (curTimeStr.length() > timeStrCache.length());
-        if (endWithNanosecond || isTimestampNanosecond) {
+        if (mEndWithNanosecond || isTimestampNanosecond) {
             strptimeResult = Strptime(curTimeStr.data() + timeStrCache.length(), "%f", &logTime, nanosecondLength);
         } else {
             strptimeResult = curTimeStr.data() + timeStrCache.length();
             logTime.tv_nsec = 0;
         }
     } else {
-        strptimeResult = Strptime(curTimeStr.data(), mSourceFormat.c_str(), &logTime, nanosecondLength, mSourceYear);
+        // the epoch of the last minute only depends on the time string, so it can be shared by all processors
+        static thread_local CompiledTimeFormat::MinuteCache sMinuteCache;
+        strptimeResult
+            = mCompiledFormat.Parse(curTimeStr.data(), curTimeStr.size(), &logTime, nanosecondLength, sMinuteCache);
+        if (NULL == strptimeResult) {
+            strptimeResult
+                = Strptime(curTimeStr.data(), mSourceFormat.c_str(), &logTime, nanosecondLength, mSourceYear);
+        }
         if (NULL != strptimeResult) {
             timeStrCache = curTimeStr.substr(0, curTimeStr.length() - nanosecondLength);
             logTime.tv_sec = logTime.tv_sec - mLogTimeZoneOffsetSecond;
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "common/CompiledTimeFormat.h"
 #include "common/TimeUtil.h"
 #include "pipeline/plugin/interface/Processor.h"
 
@@ -52,6 +53,10 @@ private:
     bool IsPrefixString(const StringView& all, const StringView& prefix);
 
     int32_t mLogTimeZoneOffsetSecond = 0;
+    // fast path of Strptime, only compiled for formats with fixed layout
+    CompiledTimeFormat mCompiledFormat;
+    bool mHaveNanosecond = false;
+    bool mEndWithNanosecond = false;
 
     int* mParseTimeFailures = nullptr;
     int* mHistoryFailures = nullptr;
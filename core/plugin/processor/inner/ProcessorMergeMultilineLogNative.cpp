@@ -16,7 +16,6 @@
 
 #include "plugin/processor/inner/ProcessorMergeMultilineLogNative.h"
 
-#include <boost/regex.hpp>
 #include <string>
 
 #include "app_config/AppConfig.h"
@@ -172,7 +171,13 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
     auto& sourceEvents = logGroup.MutableEvents();
     size_t begin = 0, newSize = 0;
     std::vector<LogEvent*> events;
-    std::string exception;
+    const MultilineMatcher& matcher = mMultiline.GetMatcher();
+    // the pattern deciding whether a new log begins when not in a partial log
+    const MultilineMatcher::Pattern headPattern
+        = mMultiline.GetStartPatternReg() != nullptr ? MultilineMatcher::START : MultilineMatcher::CONTINUE;
+    // only the patterns which can change the state are evaluated, as some of them may fall back to boost
+    const uint8_t headCandidates = mMultiline.GetCandidatePatterns(false);
+    const uint8_t partialCandidates = mMultiline.GetCandidatePatterns(true);
     bool isPartialLog = false;
     StringView logPath = logGroup.GetMetadata(EventGroupMetaKey::LOG_FILE_PATH_RESOLVED);
     if (mMultiline.GetStartPatternReg() == nullptr && mMultiline.GetContinuePatternReg() == nullptr
@@ -216,22 +221,17 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
             return;
         }
         StringView sourceVal = sourceEvent->GetContent(mSourceKey);
+        // all patterns relevant to the current state are checked against the line at once
+        uint8_t matched
+            = matcher.Classify(sourceVal.data(), sourceVal.size(), isPartialLog ? partialCandidates : headCandidates);
         if (!isPartialLog) {
             // it is impossible to enter this state if only end pattern is given
-            boost::regex regex;
-            if (mMultiline.GetStartPatternReg() != nullptr) {
-                regex = *mMultiline.GetStartPatternReg();
-            } else {
-                regex = *mMultiline.GetContinuePatternReg();
-            }
-            if (BoostRegexSearch(sourceVal.data(), sourceVal.size(), regex, exception)) {
+            if (matched & headPattern) {
                 events.emplace_back(sourceEvent);
                 begin = cur;
                 isPartialLog = true;
             } else if (mMultiline.GetEndPatternReg() != nullptr && mMultiline.GetStartPatternReg() == nullptr
-                       && mMultiline.GetContinuePatternReg() != nullptr
-                       && BoostRegexSearch(
-                           sourceVal.data(), sourceVal.size(), *mMultiline.GetEndPatternReg(), exception)) {
+                       && mMultiline.GetContinuePatternReg() != nullptr && (matched & MultilineMatcher::END)) {
                 // case: continue + end
                 // current line is matched against the end pattern rather than the continue pattern
                 begin = cur;
@@ -242,9 +242,7 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
             }
         } else {
             // case: start + continue or continue + end
-            if (mMultiline.GetContinuePatternReg() != nullptr
-                && BoostRegexSearch(
-                    sourceVal.data(), sourceVal.size(), *mMultiline.GetContinuePatternReg(), exception)) {
+            if (mMultiline.GetContinuePatternReg() != nullptr && (matched & MultilineMatcher::CONTINUE)) {
                 events.emplace_back(sourceEvent);
                 continue;
             }
@@ -254,8 +252,7 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
                 if (mMultiline.GetContinuePatternReg() != nullptr) {
                     // current line is not matched against the continue pattern, so the end pattern will decide if
                     // the current log is a match or not
-                    if (BoostRegexSearch(
-                            sourceVal.data(), sourceVal.size(), *mMultiline.GetEndPatternReg(), exception)) {
+                    if (matched & MultilineMatcher::END) {
                         MergeEvents(events, true);
                         sourceEvents[newSize++] = std::move(sourceEvents[begin]);
                     } else {
@@ -265,8 +262,7 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
                     isPartialLog = false;
                 } else {
                     // case: start + end or end
-                    if (BoostRegexSearch(
-                            sourceVal.data(), sourceVal.size(), *mMultiline.GetEndPatternReg(), exception)) {
+                    if (matched & MultilineMatcher::END) {
                         MergeEvents(events, true);
                         sourceEvents[newSize++] = std::move(sourceEvents[begin]);
                         if (mMultiline.GetStartPatternReg() != nullptr) {
@@ -282,8 +278,7 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
             } else {
                 if (mMultiline.GetContinuePatternReg() == nullptr) {
                     // case: start
-                    if (!BoostRegexSearch(
-                            sourceVal.data(), sourceVal.size(), *mMultiline.GetStartPatternReg(), exception)) {
+                    if (!(matched & MultilineMatcher::START)) {
                         events.emplace_back(sourceEvent);
                     } else {
                         MergeEvents(events, true);
@@ -296,8 +291,7 @@ void ProcessorMergeMultilineLogNative::MergeLogsByRegex(PipelineEventGroup& logG
                     // continue pattern is given, but current line is not matched against the continue pattern
                     MergeEvents(events, true);
                     sourceEvents[newSize++] = std::move(sourceEvents[begin]);
-                    if (!BoostRegexSearch(
-                            sourceVal.data(), sourceVal.size(), *mMultiline.GetStartPatternReg(), exception)) {
+                    if (!(matched & MultilineMatcher::START)) {
                         // when no end pattern is given, the only chance to enter unmatched state is when both start
                         // and continue pattern are given, and the current line is not matched against the start
                         // pattern
@@ -20,8 +20,13 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
-#include <codecvt>
-#include <locale>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <cstring>
 
 #include "common/JsonUtil.h"
 #include "common/ParamExtractor.h"
@@ -298,65 +303,171 @@ static int32_t parseLogType(char* buffer, int32_t idx, int32_t size, DockerLogTy
     return idx;
 }
 
-std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> convert;
+// index of the first '"' or '\\' in [idx, size), or size if not found
+static int32_t findQuoteOrBackslash(const char* buffer, int32_t idx, int32_t size) {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    // 32 bytes per iteration, so that the loop overhead is paid once per two loads
+    for (; idx + 32 <= size; idx += 32) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + idx));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + idx + 16));
+        uint32_t mask = static_cast<uint32_t>(
+                            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(lo, quote), _mm_cmpeq_epi8(lo, backslash))))
+            | (static_cast<uint32_t>(
+                   _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(hi, quote), _mm_cmpeq_epi8(hi, backslash))))
+               << 16);
+        if (mask != 0) {
+            return idx + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__aarch64__)
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    for (; idx + 32 <= size; idx += 32) {
+        uint8x16_t lo = vld1q_u8(reinterpret_cast<const uint8_t*>(buffer + idx));
+        uint8x16_t hi = vld1q_u8(reinterpret_cast<const uint8_t*>(buffer + idx + 16));
+        uint8x16_t match = vorrq_u8(vorrq_u8(vceqq_u8(lo, quote), vceqq_u8(lo, backslash)),
+                                    vorrq_u8(vceqq_u8(hi, quote), vceqq_u8(hi, backslash)));
+        if (vmaxvq_u8(match) != 0) {
+            break;
+        }
+    }
+#endif
+    while (idx < size && buffer[idx] != '\"' && buffer[idx] != '\\') {
+        ++idx;
+    }
+    return idx;
+}
+
+// @return code unit of 4 hex digits, or -1 if invalid
+static int32_t parseHex4(const char* buffer) {
+    int32_t res = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = buffer[i];
+        res <<= 4;
+        if (c >= '0' && c <= '9') {
+            res |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            res |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            res |= c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return res;
+}
+
+// utf-8 of a code point is never longer than the \uXXXX sequence it is decoded from, so it can be written in place
+static void writeUtf8(char* buffer, int32_t& endIndex, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        buffer[endIndex++] = static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        buffer[endIndex++] = static_cast<char>(0xC0 | (codePoint >> 6));
+        buffer[endIndex++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        buffer[endIndex++] = static_cast<char>(0xE0 | (codePoint >> 12));
+        buffer[endIndex++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        buffer[endIndex++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        buffer[endIndex++] = static_cast<char>(0xF0 | (codePoint >> 18));
+        buffer[endIndex++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        buffer[endIndex++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        buffer[endIndex++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// @param idx index of 'u' in \uXXXX
+// @return index of the last char consumed, or -1 if the sequence is not valid
+static int32_t parseUnicode(char* buffer, int32_t idx, int32_t size, int32_t& endIndex) {
+    if (idx + 4 >= size) {
+        return -1;
+    }
+    int32_t codeUnit = parseHex4(buffer + idx + 1);
+    if (codeUnit < 0) {
+        return -1;
+    }
+    idx += 4;
+    uint32_t codePoint = codeUnit;
+    if (codeUnit >= 0xD800 && codeUnit <= 0xDBFF) {
+        // characters beyond BMP are escaped as surrogate pairs, e.g. 🌍
+        int32_t low = -1;
+        if (idx + 6 < size && buffer[idx + 1] == '\\' && buffer[idx + 2] == 'u') {
+            low = parseHex4(buffer + idx + 3);
+        }
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+            codePoint = 0x10000 + ((codeUnit - 0xD800) << 10) + (low - 0xDC00);
+            idx += 6;
+        } else {
+            codePoint = 0xFFFD;
+        }
+    } else if (codeUnit >= 0xDC00 && codeUnit <= 0xDFFF) {
+        codePoint = 0xFFFD;
+    }
+    writeUtf8(buffer, endIndex, codePoint);
+    return idx;
+}
 
+// unescape value in place, endIndex is the index to write the next char at, which never exceeds idx
 static int32_t parseValue(char* buffer, int32_t idx, int32_t size, DockerLogType logType, int32_t& endIndex) {
-    while (idx < size && buffer[idx] != '\"') {
-        if (buffer[idx] == '\\') {
-            if (logType != DockerLogType::Log) {
-                return -1;
-            }
-            ++idx; // skip escape char
-            if (idx >= size) {
-                return -1;
-            }
-            switch (buffer[idx]) {
-                case '\"':
-                    buffer[endIndex++] = '\"';
-                    break;
-                case '\\':
+    while (true) {
+        int32_t pos = findQuoteOrBackslash(buffer, idx, size);
+        // runs before the first escape are already in place
+        if (endIndex != idx) {
+            memmove(buffer + endIndex, buffer + idx, pos - idx);
+        }
+        endIndex += pos - idx;
+        idx = pos;
+        if (idx >= size || buffer[idx] == '\"') {
+            return idx;
+        }
+
+        if (logType != DockerLogType::Log) {
+            return -1;
+        }
+        ++idx; // skip escape char
+        if (idx >= size) {
+            return -1;
+        }
+        switch (buffer[idx]) {
+            case '\"':
+                buffer[endIndex++] = '\"';
+                break;
+            case '\\':
+                buffer[endIndex++] = '\\';
+                break;
+            case '/':
+                buffer[endIndex++] = '/';
+                break;
+            case 'b':
+                buffer[endIndex++] = '\b';
+                break;
+            case 'f':
+                buffer[endIndex++] = '\f';
+                break;
+            case 'n':
+                buffer[endIndex++] = '\n';
+                break;
+            case 'r':
+                buffer[endIndex++] = '\r';
+                break;
+            case 't':
+                buffer[endIndex++] = '\t';
+                break;
+            default: {
+                int32_t last = buffer[idx] == 'u' ? parseUnicode(buffer, idx, size, endIndex) : -1;
+                if (last == -1) {
                     buffer[endIndex++] = '\\';
-                    break;
-                case '/':
-                    buffer[endIndex++] = '/';
-                    break;
-                case 'b':
-                    buffer[endIndex++] = '\b';
-                    break;
-                case 'f':
-                    buffer[endIndex++] = '\f';
-                    break;
-                case 'n':
-                    buffer[endIndex++] = '\n';
-                    break;
-                case 'r':
-                    buffer[endIndex++] = '\r';
-                    break;
-                case 't':
-                    buffer[endIndex++] = '\t';
-                    break;
-                default:
-                    if (idx + 4 < size && buffer[idx] == 'u') {
-                        std::string unicode_seq;
-                        unicode_seq.append(buffer + idx + 1, 4);
-                        char32_t unicode_char = std::stoul(unicode_seq, nullptr, 16);
-                        std::string res = convert.to_bytes(unicode_char);
-                        for (size_t i = 0; i < res.size(); ++i) {
-                            buffer[endIndex++] = res[i];
-                        }
-                        idx += 4;
-                    } else {
-                        buffer[endIndex++] = '\\';
-                        buffer[endIndex++] = buffer[idx];
-                    }
-                    break;
+                    buffer[endIndex++] = buffer[idx];
+                } else {
+                    idx = last;
+                }
+                break;
             }
-        } else {
-            buffer[endIndex++] = buffer[idx];
         }
         ++idx;
     }
-    return idx;
 }
 
 // buffer: {"log":"Hello, World!","stream":"stdout","time":"2021-12-01T00:00:00.000Z"}
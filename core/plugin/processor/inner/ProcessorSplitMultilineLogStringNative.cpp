@@ -16,7 +16,7 @@
 
 #include "plugin/processor/inner/ProcessorSplitMultilineLogStringNative.h"
 
-#include <boost/regex.hpp>
+#include <cstring>
 #include <string>
 
 #include "app_config/AppConfig.h"
@@ -145,7 +145,13 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
     StringView sourceVal = sourceEvent.GetContent(mSourceKey);
     StringBuffer sourceKey = logGroup.GetSourceBuffer()->CopyString(mSourceKey);
 
-    std::string exception;
+    const MultilineMatcher& matcher = mMultiline.GetMatcher();
+    // the pattern deciding whether a new log begins when not in a partial log
+    const MultilineMatcher::Pattern headPattern
+        = mMultiline.GetStartPatternReg() != nullptr ? MultilineMatcher::START : MultilineMatcher::CONTINUE;
+    // only the patterns which can change the state are evaluated, as some of them may fall back to boost
+    const uint8_t headCandidates = mMultiline.GetCandidatePatterns(false);
+    const uint8_t partialCandidates = mMultiline.GetCandidatePatterns(true);
     const char* multiStartIndex = nullptr;
     bool isPartialLog = false;
     if (mMultiline.GetStartPatternReg() == nullptr && mMultiline.GetContinuePatternReg() == nullptr
@@ -160,20 +166,16 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
         StringView content = GetNextLine(sourceVal, begin);
         bool isLastLog = begin + content.size() == sourceVal.size();
         ++(*inputLines);
+        // all patterns relevant to the current state are checked against the line at once
+        uint8_t matched
+            = matcher.Classify(content.data(), content.size(), isPartialLog ? partialCandidates : headCandidates);
         if (!isPartialLog) {
             // it is impossible to enter this state if only end pattern is given
-            boost::regex regex;
-            if (mMultiline.GetStartPatternReg() != nullptr) {
-                regex = *mMultiline.GetStartPatternReg();
-            } else {
-                regex = *mMultiline.GetContinuePatternReg();
-            }
-            if (BoostRegexSearch(content.data(), content.size(), regex, exception)) {
+            if (matched & headPattern) {
                 multiStartIndex = content.data();
                 isPartialLog = true;
             } else if (mMultiline.GetEndPatternReg() != nullptr && mMultiline.GetStartPatternReg() == nullptr
-                       && mMultiline.GetContinuePatternReg() != nullptr
-                       && BoostRegexSearch(content.data(), content.size(), *mMultiline.GetEndPatternReg(), exception)) {
+                       && mMultiline.GetContinuePatternReg() != nullptr && (matched & MultilineMatcher::END)) {
                 // case: continue + end
                 CreateNewEvent(content, isLastLog, sourceKey, sourceEvent, logGroup, newEvents);
                 multiStartIndex = content.data() + content.size() + 1;
@@ -184,8 +186,7 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
             }
         } else {
             // case: start + continue or continue + end
-            if (mMultiline.GetContinuePatternReg() != nullptr
-                && BoostRegexSearch(content.data(), content.size(), *mMultiline.GetContinuePatternReg(), exception)) {
+            if (mMultiline.GetContinuePatternReg() != nullptr && (matched & MultilineMatcher::CONTINUE)) {
                 begin += content.size() + 1;
                 continue;
             }
@@ -194,7 +195,7 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
                 if (mMultiline.GetContinuePatternReg() != nullptr) {
                     // current line is not matched against the continue pattern, so the end pattern will decide
                     // if the current log is a match or not
-                    if (BoostRegexSearch(content.data(), content.size(), *mMultiline.GetEndPatternReg(), exception)) {
+                    if (matched & MultilineMatcher::END) {
                         CreateNewEvent(StringView(multiStartIndex, content.data() + content.size() - multiStartIndex),
                                        isLastLog,
                                        sourceKey,
@@ -216,7 +217,7 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
                     isPartialLog = false;
                 } else {
                     // case: start + end or end
-                    if (BoostRegexSearch(content.data(), content.size(), *mMultiline.GetEndPatternReg(), exception)) {
+                    if (matched & MultilineMatcher::END) {
                         CreateNewEvent(StringView(multiStartIndex, content.data() + content.size() - multiStartIndex),
                                        isLastLog,
                                        sourceKey,
@@ -237,7 +238,7 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
             } else {
                 if (mMultiline.GetContinuePatternReg() == nullptr) {
                     // case: start
-                    if (BoostRegexSearch(content.data(), content.size(), *mMultiline.GetStartPatternReg(), exception)) {
+                    if (matched & MultilineMatcher::START) {
                         CreateNewEvent(StringView(multiStartIndex, content.data() - 1 - multiStartIndex),
                                        isLastLog,
                                        sourceKey,
@@ -257,8 +258,7 @@ void ProcessorSplitMultilineLogStringNative::ProcessEvent(PipelineEventGroup& lo
                                    logGroup,
                                    newEvents);
                     mProcMatchedEventsCnt->Add(1);
-                    if (!BoostRegexSearch(
-                            content.data(), content.size(), *mMultiline.GetStartPatternReg(), exception)) {
+                    if (!(matched & MultilineMatcher::START)) {
                         // when no end pattern is given, the only chance to enter unmatched state is when both
                         // start and continue pattern are given, and the current line is not matched against the
                         // start pattern
@@ -368,10 +368,9 @@ StringView ProcessorSplitMultilineLogStringNative::GetNextLine(StringView log, s
         return StringView();
     }
 
-    for (size_t end = begin; end < log.size(); ++end) {
-        if (log[end] == '\n') {
-            return StringView(log.data() + begin, end - begin);
-        }
+    const char* end = static_cast<const char*>(memchr(log.data() + begin, '\n', log.size() - begin));
+    if (end != nullptr) {
+        return StringView(log.data() + begin, end - log.data() - begin);
     }
     return StringView(log.data() + begin, log.size() - begin);
 }
@@ -16,11 +16,14 @@
 
 #include "plugin/processor/inner/ProcessorTagNative.h"
 
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "app_config/AppConfig.h"
 #include "application/Application.h"
 #include "common/Flags.h"
+#include "models/TagInterner.h"
 #include "protobuf/sls/sls_logs.pb.h"
 #include "pipeline/Pipeline.h"
 #ifdef __ENTERPRISE__
@@ -33,6 +36,43 @@ using namespace std;
 
 namespace logtail {
 
+namespace {
+
+// Per thread cache of the agent level tags, so that the tag set and its hash are only rebuilt when any of the tags
+// changes.
+class TagSetCache {
+public:
+    const TagSet& Get(const vector<pair<StringView, StringView>>& tags) {
+        if (!IsSame(tags)) {
+            mLast.clear();
+            mTagSet.Clear();
+            for (const auto& tag : tags) {
+                mLast.emplace_back(tag.first.to_string(), tag.second.to_string());
+                mTagSet.Add(tag.first, tag.second);
+            }
+        }
+        return mTagSet;
+    }
+
+private:
+    bool IsSame(const vector<pair<StringView, StringView>>& tags) const {
+        if (tags.size() != mLast.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < tags.size(); ++i) {
+            if (tags[i].first != StringView(mLast[i].first) || tags[i].second != StringView(mLast[i].second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    vector<pair<string, string>> mLast;
+    TagSet mTagSet;
+};
+
+} // namespace
+
 const string ProcessorTagNative::sName = "processor_tag_native";
 
 bool ProcessorTagNative::Init(const Json::Value& config) {
@@ -46,39 +86,42 @@ void ProcessorTagNative::Process(PipelineEventGroup& logGroup) {
         logGroup.SetTagNoCopy(LOG_RESERVED_KEY_PATH, filePath.substr(0, 511));
     }
 
-    // process level
+    // process level, which are the same for most groups, so they are added as a tag set with its hash precomputed
+    static thread_local vector<pair<StringView, StringView>> sTags;
+    sTags.clear();
 #ifdef __ENTERPRISE__
     string agentTag = EnterpriseConfigProvider::GetInstance()->GetUserDefinedIdSet();
     if (!agentTag.empty()) {
-        auto sb = logGroup.GetSourceBuffer()->CopyString(agentTag);
-        logGroup.SetTagNoCopy(LOG_RESERVED_KEY_USER_DEFINED_ID, StringView(sb.data, sb.size));
+        sTags.emplace_back(LOG_RESERVED_KEY_USER_DEFINED_ID, agentTag);
     }
 #endif
 
     if (!STRING_FLAG(ALIYUN_LOG_FILE_TAGS).empty()) {
         vector<sls_logs::LogTag>& fileTags = AppConfig::GetInstance()->GetFileTags();
-        if (!fileTags.empty()) { // reloadable, so we must get it every time and copy value
+        if (!fileTags.empty()) { // reloadable, so we must get it every time and check the value
             for (size_t i = 0; i < fileTags.size(); ++i) {
-                logGroup.SetTag(fileTags[i].key(), fileTags[i].value());
+                sTags.emplace_back(fileTags[i].key(), fileTags[i].value());
             }
         }
     }
 
-    if (mContext->GetPipeline().IsFlushingThroughGoPipeline()) {
-        return;
-    }
-
-    // process level
-    logGroup.SetTagNoCopy(LOG_RESERVED_KEY_HOSTNAME, LogFileProfiler::mHostname);
-    logGroup.SetTagNoCopy(LOG_RESERVED_KEY_SOURCE, LogFileProfiler::mIpAddr);
-    auto sb = logGroup.GetSourceBuffer()->CopyString(Application::GetInstance()->GetUUID());
-    logGroup.SetTagNoCopy(LOG_RESERVED_KEY_MACHINE_UUID, StringView(sb.data, sb.size));
-    static const vector<sls_logs::LogTag>& sEnvTags = AppConfig::GetInstance()->GetEnvTags();
-    if (!sEnvTags.empty()) {
+    string uuid;
+    bool isFlushingThroughGoPipeline = mContext->GetPipeline().IsFlushingThroughGoPipeline();
+    if (!isFlushingThroughGoPipeline) {
+        sTags.emplace_back(LOG_RESERVED_KEY_HOSTNAME, LogFileProfiler::mHostname);
+        sTags.emplace_back(LOG_RESERVED_KEY_SOURCE, LogFileProfiler::mIpAddr);
+        uuid = Application::GetInstance()->GetUUID();
+        sTags.emplace_back(LOG_RESERVED_KEY_MACHINE_UUID, uuid);
+        static const vector<sls_logs::LogTag>& sEnvTags = AppConfig::GetInstance()->GetEnvTags();
         for (size_t i = 0; i < sEnvTags.size(); ++i) {
-            logGroup.SetTagNoCopy(sEnvTags[i].key(), sEnvTags[i].value());
+            sTags.emplace_back(sEnvTags[i].key(), sEnvTags[i].value());
         }
     }
+
+    // a thread may process groups of both kinds of pipelines, which have different tags
+    static thread_local TagSetCache sTagSet;
+    static thread_local TagSetCache sGoPipelineTagSet;
+    logGroup.SetTagsNoCopy((isFlushingThroughGoPipeline ? sGoPipelineTagSet : sTagSet).Get(sTags));
 }
 
 bool ProcessorTagNative::IsSupportedEvent(const PipelineEventPtr& /*e*/) const {
@@ -21,11 +21,13 @@
 #include "plugin/flusher/sls/DiskBufferWriter.h"
 #include "logger/Logger.h"
 #include "monitor/LogtailAlarm.h"
+#include "monitor/MetricConstants.h"
 #include "pipeline/plugin/interface/HttpFlusher.h"
 #include "pipeline/queue/QueueKeyManager.h"
 #include "pipeline/queue/SenderQueueItem.h"
 #include "pipeline/queue/SenderQueueManager.h"
 #include "common/http/HttpRequest.h"
+#include "runner/sink/file/FileSink.h"
 #include "runner/sink/http/HttpSink.h"
 // TODO: temporarily used here
 #include "plugin/flusher/sls/PackIdManager.h"
@@ -34,14 +36,37 @@
 using namespace std;
 
 DEFINE_FLAG_INT32(check_send_client_timeout_interval, "", 600);
+DEFINE_FLAG_INT32(flusher_runner_thread_num,
+                  "count of threads sending items in sender queues, each serving the queues of some regions",
+                  1);
+DEFINE_FLAG_INT32(flusher_runner_smoothing_max_delay_ms,
+                  "max time to hold items for merging with items ready later when send tps smoothing is enabled",
+                  100);
 
 static const int SEND_BLOCK_COST_TIME_ALARM_INTERVAL_SECOND = 3;
+// rounds with fewer items are held when send tps smoothing is enabled
+static const size_t SMOOTHING_BATCH_SIZE = 40;
 
 namespace logtail {
 
+FlusherRunner::FlusherRunner() {
+    for (size_t i = 0; i < SenderQueueManager::GetInstance()->GetShardCnt(); ++i) {
+        auto shard = make_unique<Shard>();
+        WriteMetrics::GetInstance()->PrepareMetricsRecordRef(
+            shard->mMetricsRecordRef,
+            {{METRIC_LABEL_COMPONENT_NAME, "flusher_runner"}, {METRIC_LABEL_FLUSHER_RUNNER_SHARD, ToString(i)}});
+        shard->mOutItemsTotal = shard->mMetricsRecordRef.CreateCounter(METRIC_RUNNER_FLUSHER_OUT_ITEMS_TOTAL);
+        shard->mBlockedItemsTotal = shard->mMetricsRecordRef.CreateCounter(METRIC_RUNNER_FLUSHER_BLOCKED_ITEMS_TOTAL);
+        shard->mSendingItemsCnt = shard->mMetricsRecordRef.CreateIntGauge(METRIC_RUNNER_FLUSHER_SENDING_ITEMS_CNT);
+        mShards.emplace_back(std::move(shard));
+    }
+}
+
 bool FlusherRunner::Init() {
     srand(time(nullptr));
-    mThreadRes = async(launch::async, &FlusherRunner::Run, this);
+    for (size_t i = 0; i < mShards.size(); ++i) {
+        mShards[i]->mThreadRes = async(launch::async, &FlusherRunner::Run, this, i);
+    }
     mLastCheckSendClientTime = time(nullptr);
     return true;
 }
@@ -49,20 +74,42 @@ bool FlusherRunner::Init() {
 void FlusherRunner::Stop() {
     mIsFlush = true;
     SenderQueueManager::GetInstance()->Trigger();
-    future_status s = mThreadRes.wait_for(chrono::seconds(10));
-    if (s == future_status::ready) {
-        LOG_INFO(sLogger, ("flusher runner", "stopped successfully"));
-    } else {
-        LOG_WARNING(sLogger, ("flusher runner", "forced to stopped"));
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    for (size_t i = 0; i < mShards.size(); ++i) {
+        future_status s = mShards[i]->mThreadRes.wait_until(deadline);
+        if (s == future_status::ready) {
+            LOG_INFO(sLogger, ("flusher runner", "stopped successfully")("shard", i));
+        } else {
+            LOG_WARNING(sLogger, ("flusher runner", "forced to stopped")("shard", i));
+        }
     }
 }
 
-void FlusherRunner::DecreaseHttpSendingCnt() {
-    --mHttpSendingCnt;
-    SenderQueueManager::GetInstance()->Trigger();
+void FlusherRunner::DecreaseHttpSendingCnt(size_t shard) {
+    mShards[shard]->mSendingItemsCnt->Set(--mShards[shard]->mHttpSendingCnt);
+    SenderQueueManager::GetInstance()->Trigger(shard);
+}
+
+int32_t FlusherRunner::GetSendingBufferCount() {
+    int32_t cnt = 0;
+    for (const auto& shard : mShards) {
+        cnt += shard->mHttpSendingCnt;
+    }
+    return cnt;
+}
+
+bool FlusherRunner::IsHttpSendingFull(size_t shard) const {
+    // the send concurrency is shared evenly by shards
+    int32_t limit = max<int32_t>(
+        1, (AppConfig::GetInstance()->GetSendRequestConcurrency() + mShards.size() - 1) / mShards.size());
+    return mShards[shard]->mHttpSendingCnt >= limit;
 }
 
-void FlusherRunner::PushToHttpSink(SenderQueueItem* item, bool withLimit) {
+void FlusherRunner::PushToHttpSink(SenderQueueItem* item) {
+    PushToHttpSink(item, SenderQueueManager::GetInstance()->GetQueueShard(item->mQueueKey));
+}
+
+void FlusherRunner::PushToHttpSink(SenderQueueItem* item, size_t shard) {
     if (!BOOL_FLAG(enable_full_drain_mode) && item->mFlusher->Name() == "flusher_sls"
         && Application::GetInstance()->IsExiting()) {
         DiskBufferWriter::GetInstance()->PushToDiskBuffer(item, 3);
@@ -70,53 +117,57 @@ void FlusherRunner::PushToHttpSink(SenderQueueItem* item, bool withLimit) {
         return;
     }
 
-    int32_t beforeSleepTime = time(NULL);
-    while (withLimit && !Application::GetInstance()->IsExiting()
-           && GetSendingBufferCount() >= AppConfig::GetInstance()->GetSendRequestConcurrency()) {
-        usleep(10 * 1000);
-    }
-    int32_t afterSleepTime = time(NULL);
-    int32_t blockCostTime = afterSleepTime - beforeSleepTime;
-    if (blockCostTime > SEND_BLOCK_COST_TIME_ALARM_INTERVAL_SECOND) {
-        LOG_WARNING(sLogger,
-                    ("sending log group blocked too long because send concurrency reached limit. current "
-                     "concurrency used",
-                     GetSendingBufferCount())("max concurrency", AppConfig::GetInstance()->GetSendRequestConcurrency())(
-                        "blocked time", blockCostTime));
-        LogtailAlarm::GetInstance()->SendAlarm(SENDING_COSTS_TOO_MUCH_TIME_ALARM,
-                                               "sending log group blocked for too much time, cost "
-                                                   + ToString(blockCostTime));
-    }
-
     auto req = static_cast<HttpFlusher*>(item->mFlusher)->BuildRequest(item);
     item->mLastSendTime = time(nullptr);
     req->mEnqueTime = item->mLastSendTime;
-    HttpSink::GetInstance()->AddRequest(std::move(req));
-    ++mHttpSendingCnt;
+    HttpSink::GetInstance(shard)->AddRequest(std::move(req));
+    mShards[shard]->mSendingItemsCnt->Set(++mShards[shard]->mHttpSendingCnt);
 }
 
-void FlusherRunner::Run() {
-    LOG_INFO(sLogger, ("flusher runner", "started"));
+void FlusherRunner::Run(size_t shard) {
+    LOG_INFO(sLogger, ("flusher runner", "started")("shard", shard));
+    auto& s = *mShards[shard];
     while (true) {
         int32_t curTime = time(NULL);
+        bool isExiting = Application::GetInstance()->IsExiting();
+
+        // items are left in sender queues when send concurrency of the shard is used up, and the shard is triggered
+        // once a request is completed
+        bool isHttpSendingFull = !isExiting && IsHttpSendingFull(shard);
+        if (!isHttpSendingFull) {
+            s.mBlockStartTime = 0;
+        } else if (s.mBlockStartTime != 0 && curTime - s.mBlockStartTime > SEND_BLOCK_COST_TIME_ALARM_INTERVAL_SECOND) {
+            LOG_WARNING(sLogger,
+                        ("sending log group blocked too long because send concurrency reached limit. current "
+                         "concurrency used",
+                         s.mHttpSendingCnt)("max concurrency", AppConfig::GetInstance()->GetSendRequestConcurrency())(
+                            "blocked time", curTime - s.mBlockStartTime)("shard", shard));
+            LogtailAlarm::GetInstance()->SendAlarm(SENDING_COSTS_TOO_MUCH_TIME_ALARM,
+                                                   "sending log group blocked for too much time, cost "
+                                                       + ToString(curTime - s.mBlockStartTime));
+            s.mBlockStartTime = curTime;
+        }
 
         vector<SenderQueueItem*> items;
-        SenderQueueManager::GetInstance()->GetAllAvailableItems(items, !Application::GetInstance()->IsExiting());
+        if (!isHttpSendingFull) {
+            SenderQueueManager::GetInstance()->GetAllAvailableItems(items, !isExiting, shard);
+        }
         if (items.empty()) {
-            SenderQueueManager::GetInstance()->Wait(1000);
-        } else {
-            // smoothing send tps, walk around webserver load burst
-            uint32_t bufferPackageCount = items.size();
-            if (!Application::GetInstance()->IsExiting() && AppConfig::GetInstance()->IsSendRandomSleep()) {
-                int64_t sleepMicroseconds = 0;
-                if (bufferPackageCount < 20)
-                    sleepMicroseconds = (rand() % 30) * 10000; // 0ms ~ 300ms
-                else if (bufferPackageCount < 30)
-                    sleepMicroseconds = (rand() % 20) * 10000; // 0ms ~ 200ms
-                else if (bufferPackageCount < 40)
-                    sleepMicroseconds = (rand() % 10) * 10000; // 0ms ~ 100ms
-                if (sleepMicroseconds > 0)
-                    usleep(sleepMicroseconds);
+            SenderQueueManager::GetInstance()->Wait(1000, shard);
+        } else if (!isExiting && AppConfig::GetInstance()->IsSendRandomSleep()) {
+            // smoothing send tps, walk around webserver load burst: a small round is held for a bounded time to be
+            // merged with items ready meanwhile
+            auto deadline = chrono::steady_clock::now()
+                + chrono::milliseconds(INT32_FLAG(flusher_runner_smoothing_max_delay_ms));
+            while (items.size() < SMOOTHING_BATCH_SIZE) {
+                auto now = chrono::steady_clock::now();
+                if (now >= deadline) {
+                    break;
+                }
+                auto waitMs = chrono::duration_cast<chrono::milliseconds>(deadline - now).count() + 1;
+                if (SenderQueueManager::GetInstance()->Wait(waitMs, shard)) {
+                    SenderQueueManager::GetInstance()->GetAllAvailableItems(items, true, shard);
+                }
             }
         }
 
@@ -127,15 +178,25 @@ void FlusherRunner::Run() {
                        *itr)("config-flusher-dst", QueueKeyManager::GetInstance()->GetName((*itr)->mQueueKey))(
                           "wait time", ToString(waitTime))("try cnt", ToString((*itr)->mTryCnt)));
 
-            if (!Application::GetInstance()->IsExiting() && AppConfig::GetInstance()->IsSendFlowControl()) {
-                RateLimiter::FlowControl((*itr)->mRawSize, mSendLastTime, mSendLastByte, true);
+            if (!isExiting && (*itr)->mFlusher->GetSinkType() == SinkType::HTTP && IsHttpSendingFull(shard)) {
+                SenderQueueManager::GetInstance()->ResetItem((*itr)->mQueueKey, *itr);
+                s.mBlockedItemsTotal->Add(1);
+                if (s.mBlockStartTime == 0) {
+                    s.mBlockStartTime = curTime;
+                }
+                continue;
             }
 
-            Dispatch(*itr);
+            if (!isExiting && AppConfig::GetInstance()->IsSendFlowControl()) {
+                RateLimiter::FlowControl((*itr)->mRawSize, s.mSendLastTime, s.mSendLastByte, true);
+            }
+
+            Dispatch(*itr, shard);
+            s.mOutItemsTotal->Add(1);
         }
 
         // TODO: move the following logic to scheduler
-        if ((time(NULL) - mLastCheckSendClientTime) > INT32_FLAG(check_send_client_timeout_interval)) {
+        if (shard == 0 && (time(NULL) - mLastCheckSendClientTime) > INT32_FLAG(check_send_client_timeout_interval)) {
             SLSClientManager::GetInstance()->CleanTimeoutClient();
             PackIdManager::GetInstance()->CleanTimeoutEntry();
             mLastCheckSendClientTime = time(NULL);
@@ -147,10 +208,13 @@ void FlusherRunner::Run() {
     }
 }
 
-void FlusherRunner::Dispatch(SenderQueueItem* item) {
+void FlusherRunner::Dispatch(SenderQueueItem* item, size_t shard) {
     switch (item->mFlusher->GetSinkType()) {
         case SinkType::HTTP:
-            PushToHttpSink(item);
+            PushToHttpSink(item, shard);
+            break;
+        case SinkType::FILE:
+            FileSink::GetInstance()->AddRequest(make_unique<FileSinkRequest>(item));
             break;
         default:
             SenderQueueManager::GetInstance()->RemoveItem(item->mFlusher->GetQueueKey(), item);
@@ -19,13 +19,19 @@
 #include <atomic>
 #include <cstdint>
 #include <future>
+#include <memory>
+#include <vector>
 
+#include "monitor/LogtailMetric.h"
 #include "pipeline/plugin/interface/Flusher.h"
 #include "pipeline/queue/SenderQueueItem.h"
 #include "runner/sink/SinkType.h"
 
 namespace logtail {
 
+// FlusherRunner sends items in sender queues with flusher_runner_thread_num threads. Sender queues are sharded by
+// region, and each thread serves one shard with its own http sink and share of the send concurrency, so that
+// backpressure from one region does not block sending to others.
 class FlusherRunner {
 public:
     FlusherRunner(const FlusherRunner&) = delete;
@@ -39,29 +45,41 @@ public:
     bool Init();
     void Stop();
 
-    void DecreaseHttpSendingCnt();
+    void DecreaseHttpSendingCnt(size_t shard);
 
-    // TODO: should be private
-    void PushToHttpSink(SenderQueueItem* item, bool withLimit = true);
+    // push the item to the http sink of its shard regardless of send concurrency, e.g. for retry
+    void PushToHttpSink(SenderQueueItem* item);
 
-    int32_t GetSendingBufferCount() { return mHttpSendingCnt; }
+    int32_t GetSendingBufferCount();
 
 private:
-    FlusherRunner() = default;
+    struct Shard {
+        std::future<void> mThreadRes;
+        std::atomic_int mHttpSendingCnt{0};
+        // time when http items started to be held for send concurrency, 0 if not held
+        int32_t mBlockStartTime = 0;
+        int64_t mSendLastTime = 0;
+        int32_t mSendLastByte = 0;
+
+        MetricsRecordRef mMetricsRecordRef;
+        CounterPtr mOutItemsTotal;
+        CounterPtr mBlockedItemsTotal;
+        IntGaugePtr mSendingItemsCnt;
+    };
+
+    FlusherRunner();
     ~FlusherRunner() = default;
 
-    void Run();
-    void Dispatch(SenderQueueItem* item);
+    void Run(size_t shard);
+    void Dispatch(SenderQueueItem* item, size_t shard = 0);
+    void PushToHttpSink(SenderQueueItem* item, size_t shard);
+    bool IsHttpSendingFull(size_t shard) const;
 
-    std::future<void> mThreadRes;
+    std::vector<std::unique_ptr<Shard>> mShards;
     std::atomic_bool mIsFlush = false;
 
-    std::atomic_int mHttpSendingCnt{0};
-
     // TODO: temporarily here
     int32_t mLastCheckSendClientTime = 0;
-    int64_t mSendLastTime = 0;
-    int32_t mSendLastByte = 0;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class PluginRegistryUnittest;
@@ -15,8 +15,8 @@
 #include "runner/LogProcess.h"
 
 #include "app_config/AppConfig.h"
-#include "pipeline/batch/TimeoutFlushManager.h"
 #include "common/Flags.h"
+#include "common/TimeUtil.h"
 #include "go_pipeline/LogtailPlugin.h"
 #include "monitor/LogFileProfiler.h"
 #include "monitor/LogtailAlarm.h"
@@ -35,7 +35,10 @@ using namespace std;
 // Note: enable this will spend CPU to do transformation.
 DEFINE_FLAG_BOOL(enable_chinese_tag_path, "Enable Chinese __tag__.__path__", true);
 #endif
-DEFINE_FLAG_INT32(default_flush_merged_buffer_interval, "default flush merged buffer, seconds", 1);
+DEFINE_FLAG_INT32(process_round_wait_timeout_ms,
+                  "interval to warn about processing threads not finishing their current rounds when a pipeline is "
+                  "stopped, in ms",
+                  10000);
 
 namespace logtail {
 
@@ -50,6 +53,7 @@ LogProcess::~LogProcess() {
         }
     }
     delete[] mThreadFlags;
+    delete[] mThreadRounds;
     delete[] mProcessThreads;
 }
 
@@ -63,8 +67,10 @@ void LogProcess::Start() {
     mThreadCount = AppConfig::GetInstance()->GetProcessThreadCount();
     mProcessThreads = new ThreadPtr[mThreadCount];
     mThreadFlags = new atomic_bool[mThreadCount];
+    mThreadRounds = new atomic_uint64_t[mThreadCount];
     for (int32_t threadNo = 0; threadNo < mThreadCount; ++threadNo) {
         mThreadFlags[threadNo] = false;
+        mThreadRounds[threadNo] = 0;
         mProcessThreads[threadNo] = CreateThread([this, threadNo]() { ProcessLoop(threadNo); });
     }
     LOG_INFO(sLogger, ("process daemon", "started"));
@@ -112,6 +118,52 @@ void LogProcess::Resume() {
     LOG_INFO(sLogger, ("process daemon resume", "succeeded"));
 }
 
+void LogProcess::WaitForCurrentRounds() {
+    if (!mInitialized) {
+        return;
+    }
+    vector<uint64_t> rounds(mThreadCount);
+    for (int32_t threadNo = 0; threadNo < mThreadCount; ++threadNo) {
+        rounds[threadNo] = mThreadRounds[threadNo];
+    }
+    auto allRoundsDone = [&]() {
+        for (int32_t threadNo = 0; threadNo < mThreadCount; ++threadNo) {
+            if (mThreadRounds[threadNo] == rounds[threadNo]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // the stopped pipelines may still be used by a thread in its current round, so it is not safe to give up waiting
+    auto timeout = chrono::milliseconds(INT32_FLAG(process_round_wait_timeout_ms));
+    auto deadline = chrono::steady_clock::now() + timeout;
+    ++mRoundWaiterCnt;
+    {
+        unique_lock<mutex> lock(mRoundMux);
+        while (!allRoundsDone()) {
+            if (chrono::steady_clock::now() >= deadline) {
+                string stuckThreads;
+                for (int32_t threadNo = 0; threadNo < mThreadCount; ++threadNo) {
+                    if (mThreadRounds[threadNo] == rounds[threadNo]) {
+                        stuckThreads += (stuckThreads.empty() ? "" : ",") + ToString(threadNo);
+                    }
+                }
+                LOG_WARNING(sLogger,
+                            ("processing threads have not finished their current rounds",
+                             "keep waiting")("stuck threads", stuckThreads)(
+                                "timeout ms", INT32_FLAG(process_round_wait_timeout_ms)));
+                deadline = chrono::steady_clock::now() + timeout;
+            }
+            // wake up threads waiting for items, again on each slice in case they went back to wait before the
+            // trigger
+            ProcessQueueManager::GetInstance()->Trigger();
+            mRoundCV.wait_for(lock, chrono::milliseconds(100));
+        }
+    }
+    --mRoundWaiterCnt;
+}
+
 bool LogProcess::FlushOut(int32_t waitMs) {
     ProcessQueueManager::GetInstance()->Trigger();
     if (ProcessQueueManager::GetInstance()->IsAllQueueEmpty()) {
@@ -138,7 +190,6 @@ bool LogProcess::FlushOut(int32_t waitMs) {
 
 void* LogProcess::ProcessLoop(int32_t threadNo) {
     LOG_DEBUG(sLogger, ("runner/LogProcess.hread", "Start")("threadNo", threadNo));
-    static int32_t lastMergeTime = 0;
     static atomic_int s_processCount{0};
     static atomic_long s_processBytes{0};
     static atomic_int s_processLines{0};
@@ -146,13 +197,13 @@ void* LogProcess::ProcessLoop(int32_t threadNo) {
     int32_t lastUpdateMetricTime = time(NULL);
     while (true) {
         mThreadFlags[threadNo] = false;
-
-        int32_t curTime = time(NULL);
-        if (threadNo == 0 && curTime - lastMergeTime >= INT32_FLAG(default_flush_merged_buffer_interval)) {
-            TimeoutFlushManager::GetInstance()->FlushTimeoutBatch();
-            lastMergeTime = curTime;
+        ++mThreadRounds[threadNo];
+        if (mRoundWaiterCnt > 0) {
+            lock_guard<mutex> lock(mRoundMux);
+            mRoundCV.notify_all();
         }
 
+        int32_t curTime = time(NULL);
         if (threadNo == 0 && curTime - lastUpdateMetricTime >= 40) {
             static auto sMonitor = LogtailMonitor::GetInstance();
 
@@ -210,18 +261,19 @@ void* LogProcess::ProcessLoop(int32_t threadNo) {
             }
             processProfile.Reset();
 
-            int32_t startTime = (int32_t)time(NULL);
+            uint64_t startCycles = GetCurrentCycles();
             vector<PipelineEventGroup> eventGroupList;
             eventGroupList.emplace_back(std::move(item->mEventGroup));
             pipeline->Process(eventGroupList, item->mInputIndex);
-            int32_t elapsedTime = (int32_t)time(NULL) - startTime;
-            if (elapsedTime > 1) {
+            uint64_t endCycles = GetCurrentCycles();
+            uint64_t elapsedTime = endCycles > startCycles ? CyclesToNanoSeconds(endCycles - startCycles) / 1000000 : 0;
+            if (elapsedTime > 1000) {
                 LOG_WARNING(pipeline->GetContext().GetLogger(),
-                            ("event processing took too long, elapsed time", ToString(elapsedTime) + "s")("config",
-                                                                                                          configName));
+                            ("event processing took too long, elapsed time", ToString(elapsedTime) + "ms")("config",
+                                                                                                           configName));
                 pipeline->GetContext().GetAlarm().SendAlarm(PROCESS_TOO_SLOW_ALARM,
                                                             string("event processing took too long, elapsed time: ")
-                                                                + ToString(elapsedTime) + "s\tconfig: " + configName,
+                                                                + ToString(elapsedTime) + "ms\tconfig: " + configName,
                                                             pipeline->GetContext().GetProjectName(),
                                                             pipeline->GetContext().GetLogstoreName(),
                                                             pipeline->GetContext().GetRegion());
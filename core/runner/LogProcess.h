@@ -17,7 +17,9 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
 
 #include "common/Lock.h"
 #include "common/LogRunnable.h"
@@ -39,6 +41,9 @@ public:
     void HoldOn();
     void Resume();
     bool FlushOut(int32_t waitMs);
+    // Wait until every processing thread finishes the round it is running, so that items popped and batches flushed
+    // on timeout before the call are all done. A warning is logged every process_round_wait_timeout_ms until then.
+    void WaitForCurrentRounds();
 
     void* ProcessLoop(int32_t threadNo);
     // TODO: replace key with configName
@@ -58,10 +63,19 @@ private:
     ThreadPtr* mProcessThreads;
     int32_t mThreadCount = 1;
     std::atomic_bool* mThreadFlags;
+    std::atomic_uint64_t* mThreadRounds;
+    // processing threads only notify when someone waits for the end of their rounds
+    std::atomic_int mRoundWaiterCnt{0};
+    std::mutex mRoundMux;
+    std::condition_variable mRoundCV;
     ReadWriteLock mAccessProcessThreadRWL;
 
     IntGaugePtr mAgentProcessQueueFullTotal;
     IntGaugePtr mAgentProcessQueueTotal;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class LogProcessUnittest;
+#endif
 };
 
 } // namespace logtail
\ No newline at end of file
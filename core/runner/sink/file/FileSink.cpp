@@ -0,0 +1,73 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runner/sink/file/FileSink.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "logger/Logger.h"
+#include "pipeline/plugin/interface/FileFlusher.h"
+
+using namespace std;
+
+namespace logtail {
+
+bool FileSink::Init() {
+    mThreadRes = async(launch::async, &FileSink::Run, this);
+    return true;
+}
+
+void FileSink::Stop() {
+    mIsFlush = true;
+    future_status s = mThreadRes.wait_for(chrono::seconds(1));
+    if (s == future_status::ready) {
+        LOG_INFO(sLogger, ("file sink", "stopped successfully"));
+    } else {
+        LOG_WARNING(sLogger, ("file sink", "forced to stopped"));
+    }
+}
+
+void FileSink::Run() {
+    LOG_INFO(sLogger, ("file sink", "started"));
+    vector<unique_ptr<FileSinkRequest>> requests;
+    // there are only a few file flushers, so a vector is faster than a map here
+    vector<pair<FileFlusher*, vector<SenderQueueItem*>>> batches;
+    while (true) {
+        requests.clear();
+        if (!mQueue.WaitAndPopAll(requests, 500)) {
+            if (mIsFlush && mQueue.Empty()) {
+                break;
+            }
+            continue;
+        }
+        for (auto& request : requests) {
+            auto flusher = static_cast<FileFlusher*>(request->mItem->mFlusher);
+            auto iter = find_if(
+                batches.begin(), batches.end(), [flusher](const auto& batch) { return batch.first == flusher; });
+            if (iter == batches.end()) {
+                batches.emplace_back(flusher, vector<SenderQueueItem*>());
+                iter = prev(batches.end());
+            }
+            iter->second.push_back(request->mItem);
+        }
+        for (auto& batch : batches) {
+            batch.first->Write(batch.second);
+        }
+        batches.clear();
+    }
+}
+
+} // namespace logtail
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+#include "pipeline/queue/SenderQueueItem.h"
+#include "runner/sink/Sink.h"
+
+namespace logtail {
+
+struct FileSinkRequest {
+    SenderQueueItem* mItem = nullptr;
+
+    explicit FileSinkRequest(SenderQueueItem* item) : mItem(item) {}
+};
+
+// FileSink writes items of file flushers in a dedicated thread, so that slow disks do not block flusher runners.
+// Requests pending at each round are grouped by flusher, and handed over to it together to be written with as few
+// syscalls as possible.
+class FileSink : public Sink<FileSinkRequest> {
+public:
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    static FileSink* GetInstance() {
+        static FileSink instance;
+        return &instance;
+    }
+
+    bool Init() override;
+    void Stop() override;
+
+private:
+    FileSink() = default;
+    ~FileSink() = default;
+
+    void Run();
+
+    std::future<void> mThreadRes;
+    std::atomic_bool mIsFlush = false;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class FlusherRunnerUnittest;
+    friend class FlusherFileUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -15,25 +15,60 @@
 #include "runner/sink/http/HttpSink.h"
 
 #include "app_config/AppConfig.h"
+#include "common/Flags.h"
 #include "common/StringTools.h"
 #include "common/http/Curl.h"
 #include "logger/Logger.h"
 #include "monitor/LogtailAlarm.h"
 #include "pipeline/plugin/interface/HttpFlusher.h"
 #include "pipeline/queue/QueueKeyManager.h"
-#include "pipeline/queue/SenderQueueItem.h"
+#include "pipeline/queue/SenderQueueManager.h"
 #include "runner/FlusherRunner.h"
 
+DEFINE_FLAG_BOOL(enable_http_sink_http2,
+                 "send requests with http/2 if supported, so that a connection is shared by concurrent requests",
+                 false);
+DEFINE_FLAG_INT32(http_sink_max_host_connections, "max connections to each host from a http sink, 0 means no limit", 0);
+DEFINE_FLAG_INT32(http_sink_max_idle_handlers, "max curl easy handles kept for reuse by a http sink", 64);
+DEFINE_FLAG_INT32(http_sink_tcp_keepalive_idle_sec, "idle time before tcp keepalive probes, 0 means disabled", 60);
+
 using namespace std;
 
 namespace logtail {
 
+HttpSink* HttpSink::GetInstance(size_t shard) {
+    static vector<unique_ptr<HttpSink>> sInstances = [] {
+        vector<unique_ptr<HttpSink>> instances;
+        for (size_t i = 0; i < SenderQueueManager::GetInstance()->GetShardCnt(); ++i) {
+            instances.emplace_back(new HttpSink(i));
+        }
+        return instances;
+    }();
+    return sInstances[shard].get();
+}
+
 bool HttpSink::Init() {
     mClient = curl_multi_init();
     if (mClient == nullptr) {
         LOG_ERROR(sLogger, ("failed to init http sink", "failed to init curl multi client"));
         return false;
     }
+    if (BOOL_FLAG(enable_http_sink_http2)) {
+        if (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) {
+            curl_multi_setopt(mClient, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        } else {
+            LOG_WARNING(sLogger, ("http/2 is not supported by libcurl", "use http/1.1 instead"));
+        }
+    }
+    if (INT32_FLAG(http_sink_max_host_connections) > 0) {
+        curl_multi_setopt(mClient, CURLMOPT_MAX_HOST_CONNECTIONS, (long)INT32_FLAG(http_sink_max_host_connections));
+    }
+    // handles of the sink are only used in the sink thread, so no lock is needed
+    mShare = curl_share_init();
+    if (mShare != nullptr) {
+        curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    }
     mThreadRes = async(launch::async, &HttpSink::Run, this);
     return true;
 }
@@ -42,9 +77,9 @@ void HttpSink::Stop() {
     mIsFlush = true;
     future_status s = mThreadRes.wait_for(chrono::seconds(1));
     if (s == future_status::ready) {
-        LOG_INFO(sLogger, ("http sink", "stopped successfully"));
+        LOG_INFO(sLogger, ("http sink", "stopped successfully")("shard", mShard));
     } else {
-        LOG_WARNING(sLogger, ("http sink", "forced to stopped"));
+        LOG_WARNING(sLogger, ("http sink", "forced to stopped")("shard", mShard));
     }
 }
 
@@ -67,45 +102,92 @@ void HttpSink::Run() {
         }
         DoRun();
     }
+    Cleanup();
+}
+
+void HttpSink::Cleanup() {
+    for (auto handler : mIdleHandlers) {
+        curl_easy_cleanup(handler);
+    }
+    mIdleHandlers.clear();
     auto mc = curl_multi_cleanup(mClient);
     if (mc != CURLM_OK) {
         LOG_ERROR(sLogger, ("failed to cleanup curl multi handle", "exit anyway")("errMsg", curl_multi_strerror(mc)));
     }
+    mClient = nullptr;
+    // the share can only be cleaned up after all handles using it
+    if (mShare != nullptr && curl_share_cleanup(mShare) == CURLSHE_OK) {
+        mShare = nullptr;
+    }
+}
+
+CURL* HttpSink::AcquireHandler() {
+    if (mIdleHandlers.empty()) {
+        return curl_easy_init();
+    }
+    CURL* handler = mIdleHandlers.back();
+    mIdleHandlers.pop_back();
+    return handler;
+}
+
+void HttpSink::ReleaseHandler(CURL* handler) {
+    if (mIdleHandlers.size() >= static_cast<size_t>(INT32_FLAG(http_sink_max_idle_handlers))) {
+        curl_easy_cleanup(handler);
+        return;
+    }
+    // options are cleared, while connections and caches are kept
+    curl_easy_reset(handler);
+    mIdleHandlers.push_back(handler);
 }
 
 bool HttpSink::AddRequestToClient(std::unique_ptr<HttpSinkRequest>&& request) {
-    curl_slist* headers = nullptr;
-    CURL* curl = CreateCurlHandler(request->mMethod,
-                                   request->mHTTPSFlag,
-                                   request->mHost,
-                                   request->mPort,
-                                   request->mUrl,
-                                   request->mQueryString,
-                                   request->mHeader,
-                                   request->mBody,
-                                   request->mResponse,
-                                   headers,
-                                   request->mTimeout,
-                                   AppConfig::GetInstance()->IsHostIPReplacePolicyEnabled(),
-                                   AppConfig::GetInstance()->GetBindInterface());
+    CURL* curl = AcquireHandler();
     if (curl == nullptr) {
-        request->mItem->mStatus = SendingStatus::IDLE;
-        FlusherRunner::GetInstance()->DecreaseHttpSendingCnt();
+        SenderQueueManager::GetInstance()->ResetItem(request->mItem->mQueueKey, request->mItem);
+        FlusherRunner::GetInstance()->DecreaseHttpSendingCnt(mShard);
         LOG_ERROR(sLogger,
                   ("failed to send request", "failed to init curl handler")(
                       "action", "put sender queue item back to sender queue")("item address", request->mItem)(
                       "config-flusher-dst", QueueKeyManager::GetInstance()->GetName(request->mItem->mQueueKey)));
         return false;
     }
+    curl_slist* headers = nullptr;
+    SetCurlHandler(curl,
+                   request->mMethod,
+                   request->mHTTPSFlag,
+                   request->mHost,
+                   request->mPort,
+                   request->mUrl,
+                   request->mQueryString,
+                   request->mHeader,
+                   request->mBody,
+                   request->mResponse,
+                   headers,
+                   request->mTimeout,
+                   AppConfig::GetInstance()->IsHostIPReplacePolicyEnabled(),
+                   AppConfig::GetInstance()->GetBindInterface());
+    if (mShare != nullptr) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, mShare);
+    }
+    if (BOOL_FLAG(enable_http_sink_http2)) {
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        // wait for a connection to be multiplexed rather than opening a new one
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    }
+    if (INT32_FLAG(http_sink_tcp_keepalive_idle_sec) > 0) {
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, (long)INT32_FLAG(http_sink_tcp_keepalive_idle_sec));
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, (long)INT32_FLAG(http_sink_tcp_keepalive_idle_sec));
+    }
 
     request->mPrivateData = headers;
     curl_easy_setopt(curl, CURLOPT_PRIVATE, request.get());
     request->mLastSendTime = time(nullptr);
     auto res = curl_multi_add_handle(mClient, curl);
     if (res != CURLM_OK) {
-        request->mItem->mStatus = SendingStatus::IDLE;
-        FlusherRunner::GetInstance()->DecreaseHttpSendingCnt();
-        curl_easy_cleanup(curl);
+        SenderQueueManager::GetInstance()->ResetItem(request->mItem->mQueueKey, request->mItem);
+        FlusherRunner::GetInstance()->DecreaseHttpSendingCnt(mShard);
+        ReleaseHandler(curl);
         LOG_ERROR(sLogger,
                   ("failed to send request",
                    "failed to add the easy curl handle to multi_handle")("errMsg", curl_multi_strerror(res))(
@@ -201,7 +283,7 @@ void HttpSink::HandleCompletedRequests() {
                     curl_easy_getinfo(handler, CURLINFO_RESPONSE_CODE, &statusCode);
                     request->mResponse.mStatusCode = (int32_t)statusCode;
                     static_cast<HttpFlusher*>(request->mItem->mFlusher)->OnSendDone(request->mResponse, request->mItem);
-                    FlusherRunner::GetInstance()->DecreaseHttpSendingCnt();
+                    FlusherRunner::GetInstance()->DecreaseHttpSendingCnt(mShard);
                     break;
                 }
                 default:
@@ -223,12 +305,12 @@ void HttpSink::HandleCompletedRequests() {
                     } else {
                         static_cast<HttpFlusher*>(request->mItem->mFlusher)
                             ->OnSendDone(request->mResponse, request->mItem);
-                        FlusherRunner::GetInstance()->DecreaseHttpSendingCnt();
+                        FlusherRunner::GetInstance()->DecreaseHttpSendingCnt(mShard);
                     }
                     break;
             }
             curl_multi_remove_handle(mClient, handler);
-            curl_easy_cleanup(handler);
+            ReleaseHandler(handler);
             if (!requestReused) {
                 if (request->mPrivateData) {
                     curl_slist_free_all((curl_slist*)request->mPrivateData);
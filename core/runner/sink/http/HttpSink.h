@@ -21,6 +21,8 @@
 #include <atomic>
 #include <condition_variable>
 #include <future>
+#include <memory>
+#include <vector>
 #include <mutex>
 
 #include "runner/sink/Sink.h"
@@ -28,35 +30,45 @@
 
 namespace logtail {
 
+// There is one sink with its own curl multi handle for each flusher runner shard, so that slow responses from one
+// region do not delay requests to others.
+//
+// Connections are cached by the multi handle per host, and may be shared by concurrent requests with http/2. Easy
+// handles are reused after requests complete, and tls sessions and dns entries are shared by all handles of the sink,
+// so that handshakes are avoided as much as possible.
 class HttpSink : public Sink<HttpSinkRequest> {
 public:
     HttpSink(const HttpSink&) = delete;
     HttpSink& operator=(const HttpSink&) = delete;
+    ~HttpSink() = default;
 
-    static HttpSink* GetInstance() {
-        static HttpSink instance;
-        return &instance;
-    }
+    static HttpSink* GetInstance(size_t shard = 0);
 
     bool Init() override;
     void Stop() override;
 
 private:
-    HttpSink() = default;
-    ~HttpSink() = default;
+    explicit HttpSink(size_t shard) : mShard(shard) {}
 
     void Run();
     bool AddRequestToClient(std::unique_ptr<HttpSinkRequest>&& request);
     void DoRun();
     void HandleCompletedRequests();
+    CURL* AcquireHandler();
+    void ReleaseHandler(CURL* handler);
+    void Cleanup();
 
+    const size_t mShard;
     CURLM* mClient = nullptr;
+    CURLSH* mShare = nullptr;
+    std::vector<CURL*> mIdleHandlers;
 
     std::future<void> mThreadRes;
     std::atomic_bool mIsFlush = false;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class FlusherRunnerUnittest;
+    friend class HttpSinkUnittest;
 #endif
 };
 
@@ -14,6 +14,8 @@
 
 #include "Client.h"
 
+#include <cstring>
+
 #include "CurlImp.h"
 #include "Exception.h"
 #include "Result.h"
@@ -32,6 +34,14 @@ namespace sdk {
         return "127.0.0.1";
     }
 
+    static void AddToSign(HMAC& signer, const string& data) {
+        signer.add(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    static void AddToSign(HMAC& signer, const char* data) {
+        signer.add(reinterpret_cast<const uint8_t*>(data), strlen(data));
+    }
+
     Client::Client(const string& slsHost,
                    const string& accessKeyId,
                    const string& accessKey,
@@ -107,6 +117,7 @@ namespace sdk {
         mSpinLock.lock();
         mAccessKey = accessKey;
         mSpinLock.unlock();
+        ++mSettingVersion;
     }
 
     string Client::GetAccessKey() {
@@ -120,6 +131,7 @@ namespace sdk {
         mSpinLock.lock();
         mAccessKeyId = accessKeyId;
         mSpinLock.unlock();
+        ++mSettingVersion;
     }
 
     string Client::GetAccessKeyId() {
@@ -185,6 +197,7 @@ namespace sdk {
         else
             mIsHostRawIp = false;
         mSpinLock.unlock();
+        ++mSettingVersion;
     }
 
 
@@ -254,15 +267,8 @@ namespace sdk {
                                                                       SenderQueueItem* item,
                                                                       const std::string& hashKey,
                                                                       int64_t hashKeySeqID) {
-        map<string, string> httpHeader;
-        httpHeader[CONTENT_TYPE] = TYPE_LOG_PROTOBUF;
-        if (!mKeyProvider.empty()) {
-            httpHeader[X_LOG_KEYPROVIDER] = mKeyProvider;
-        }
-        httpHeader[X_LOG_BODYRAWSIZE] = std::to_string(rawSize);
-        httpHeader[X_LOG_COMPRESSTYPE] = Client::GetCompressTypeString(compressType);
         return CreateAsynPostLogStoreLogsRequest(
-            project, logstore, compressedLogGroup, httpHeader, hashKey, hashKeySeqID, item);
+            project, logstore, compressType, false, compressedLogGroup, rawSize, hashKey, hashKeySeqID, item);
     }
 
     unique_ptr<HttpSinkRequest> Client::CreatePostLogStoreLogPackageListRequest(const std::string& project,
@@ -271,16 +277,15 @@ namespace sdk {
                                                                                 const std::string& packageListData,
                                                                                 SenderQueueItem* item,
                                                                                 const std::string& hashKey) {
-        map<string, string> httpHeader;
-        httpHeader[CONTENT_TYPE] = TYPE_LOG_PROTOBUF;
-        if (!mKeyProvider.empty()) {
-            httpHeader[X_LOG_KEYPROVIDER] = mKeyProvider;
-        }
-        httpHeader[X_LOG_MODE] = LOG_MODE_BATCH_GROUP;
-        httpHeader[X_LOG_BODYRAWSIZE] = std::to_string(packageListData.size());
-        httpHeader[X_LOG_COMPRESSTYPE] = Client::GetCompressTypeString(compressType);
-        return CreateAsynPostLogStoreLogsRequest(
-            project, logstore, packageListData, httpHeader, hashKey, kInvalidHashKeySeqID, item);
+        return CreateAsynPostLogStoreLogsRequest(project,
+                                                 logstore,
+                                                 compressType,
+                                                 true,
+                                                 packageListData,
+                                                 packageListData.size(),
+                                                 hashKey,
+                                                 kInvalidHashKeySeqID,
+                                                 item);
     }
 
     void Client::SendRequest(const std::string& project,
@@ -314,22 +319,83 @@ namespace sdk {
         }
     }
 
+    shared_ptr<const Client::PostLogStoreLogsTemplate>
+    Client::GetPostLogStoreLogsTemplate(const std::string& project,
+                                        const std::string& logstore,
+                                        sls_logs::SlsCompressType compressType,
+                                        bool isPackageList,
+                                        bool isRoute) {
+        string key = project;
+        key.append("/").append(logstore).append("/").append(to_string(compressType));
+        key.push_back(isPackageList ? 'p' : 'g');
+        key.push_back(isRoute ? 'r' : 'l');
+
+        uint64_t version = mSettingVersion.load();
+        mTemplateLock.lock();
+        auto iter = mPostLogStoreLogsTemplates.find(key);
+        if (iter != mPostLogStoreLogsTemplates.end() && iter->second->mSettingVersion == version) {
+            auto res = iter->second;
+            mTemplateLock.unlock();
+            return res;
+        }
+        mTemplateLock.unlock();
+
+        auto tpl = make_shared<PostLogStoreLogsTemplate>(GetAccessKey());
+        tpl->mSettingVersion = version;
+        tpl->mOperation = LOGSTORES;
+        tpl->mOperation.append("/").append(logstore).append(isRoute ? "/shards/route" : "/shards/lb");
+
+        auto& httpHeader = tpl->mHeader;
+        httpHeader[CONTENT_TYPE] = TYPE_LOG_PROTOBUF;
+        if (!mKeyProvider.empty()) {
+            httpHeader[X_LOG_KEYPROVIDER] = mKeyProvider;
+        }
+        if (isPackageList) {
+            httpHeader[X_LOG_MODE] = LOG_MODE_BATCH_GROUP;
+        }
+        httpHeader[X_LOG_COMPRESSTYPE] = Client::GetCompressTypeString(compressType);
+        httpHeader[HOST] = project.empty() ? GetSlsHost() : project + GetHostFieldSuffix();
+        httpHeader[USER_AGENT] = mUserAgent;
+        httpHeader[X_LOG_APIVERSION] = LOG_API_VERSION;
+        httpHeader[X_LOG_SIGNATUREMETHOD] = HMAC_SHA1;
+        if (!mSecurityToken.empty()) {
+            httpHeader[X_ACS_SECURITY_TOKEN] = mSecurityToken;
+        }
+
+        for (const auto& item : GetCanonicalizedHeaders(httpHeader)) {
+            string& sign = item.first < X_LOG_BODYRAWSIZE ? tpl->mSignBeforeRawSize : tpl->mSignAfterRawSize;
+            sign.append(item.first).append(":").append(item.second).append("\n");
+        }
+        tpl->mSignBeforeRawSize.append(X_LOG_BODYRAWSIZE).append(":");
+        tpl->mSignAfterRawSize.append(tpl->mOperation);
+        tpl->mAuthorizationPrefix = LOG_HEADSIGNATURE_PREFIX + GetAccessKeyId() + ':';
+
+        mTemplateLock.lock();
+        mPostLogStoreLogsTemplates[key] = tpl;
+        mTemplateLock.unlock();
+        return tpl;
+    }
+
     unique_ptr<HttpSinkRequest>
     Client::CreateAsynPostLogStoreLogsRequest(const std::string& project,
                                               const std::string& logstore,
+                                              sls_logs::SlsCompressType compressType,
+                                              bool isPackageList,
                                               const std::string& body,
-                                              std::map<std::string, std::string>& httpHeader,
+                                              size_t rawSize,
                                               const std::string& hashKey,
                                               int64_t hashKeySeqID,
                                               SenderQueueItem* item) {
-        string operation = LOGSTORES;
-        operation.append("/").append(logstore);
-        if (hashKey.empty())
-            operation.append("/shards/lb");
-        else
-            operation.append("/shards/route");
+        auto tpl = GetPostLogStoreLogsTemplate(project, logstore, compressType, isPackageList, !hashKey.empty());
 
-        httpHeader[CONTENT_MD5] = CalcMD5(body);
+        map<string, string> httpHeader = tpl->mHeader;
+        string& contentMd5 = httpHeader[CONTENT_MD5];
+        contentMd5 = CalcMD5(body);
+        string& date = httpHeader[DATE];
+        date = GetDateString();
+        string& bodyRawSize = httpHeader[X_LOG_BODYRAWSIZE];
+        bodyRawSize = to_string(rawSize);
+        httpHeader[CONTENT_LENGTH] = to_string(body.length());
 
         map<string, string> parameterList;
         if (!hashKey.empty()) {
@@ -339,16 +405,44 @@ namespace sdk {
             }
         }
 
-        string host = GetHost(project);
-        SetCommonHeader(httpHeader, (int32_t)(body.length()), project);
-        string signature = GetUrlSignature(HTTP_POST, operation, httpHeader, parameterList, body, GetAccessKey());
-        httpHeader[AUTHORIZATION] = LOG_HEADSIGNATURE_PREFIX + GetAccessKeyId() + ':' + signature;
+        // same as GetUrlSignature, except that only the parts varying between requests are formatted
+        HMAC signer(tpl->mSigner);
+        AddToSign(signer, HTTP_POST);
+        AddToSign(signer, "\n");
+        if (!body.empty()) {
+            AddToSign(signer, contentMd5);
+        }
+        AddToSign(signer, "\n");
+        AddToSign(signer, TYPE_LOG_PROTOBUF);
+        AddToSign(signer, "\n");
+        AddToSign(signer, date);
+        AddToSign(signer, "\n");
+        AddToSign(signer, tpl->mSignBeforeRawSize);
+        AddToSign(signer, bodyRawSize);
+        AddToSign(signer, "\n");
+        AddToSign(signer, tpl->mSignAfterRawSize);
+        for (auto iter = parameterList.begin(); iter != parameterList.end(); ++iter) {
+            AddToSign(signer, iter == parameterList.begin() ? "?" : "&");
+            AddToSign(signer, iter->first);
+            AddToSign(signer, "=");
+            AddToSign(signer, iter->second);
+        }
+        string signature
+            = Base64Enconde(string(reinterpret_cast<const char*>(signer.result()), SHA1_DIGEST_BYTES));
+        httpHeader[AUTHORIZATION] = tpl->mAuthorizationPrefix + signature;
 
         string queryString;
         GetQueryString(parameterList, queryString);
 
-        return make_unique<HttpSinkRequest>(
-            HTTP_POST, mUsingHTTPS, host, mPort, operation, queryString, httpHeader, body, item);
+        return make_unique<HttpSinkRequest>(HTTP_POST,
+                                            mUsingHTTPS,
+                                            GetHost(project),
+                                            mPort,
+                                            tpl->mOperation,
+                                            queryString,
+                                            httpHeader,
+                                            body,
+                                            item);
     }
 
     PostLogStoreLogsResponse
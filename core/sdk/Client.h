@@ -15,8 +15,11 @@
  */
 
 #pragma once
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "Common.h"
 #include "CurlImp.h"
@@ -60,8 +63,14 @@ namespace sdk {
 
         std::string GetHost(const std::string& project);
 
-        void SetUserAgent(const std::string& userAgent) { mUserAgent = userAgent; }
-        void SetKeyProvider(const std::string& keyProvider) { mKeyProvider = keyProvider; }
+        void SetUserAgent(const std::string& userAgent) {
+            mUserAgent = userAgent;
+            ++mSettingVersion;
+        }
+        void SetKeyProvider(const std::string& keyProvider) {
+            mKeyProvider = keyProvider;
+            ++mSettingVersion;
+        }
 
         void SetAccessKey(const std::string& accessKey);
         std::string GetAccessKey();
@@ -76,7 +85,10 @@ namespace sdk {
         // @note not used
         const std::string& GetSecurityToken() { return mSecurityToken; }
         // @note not used
-        void SetSecurityToken(const std::string& securityToken) { mSecurityToken = securityToken; }
+        void SetSecurityToken(const std::string& securityToken) {
+            mSecurityToken = securityToken;
+            ++mSettingVersion;
+        }
         // @note not used
         void RemoveSecurityToken() { SetSecurityToken(""); }
         void SetSlsHostUpdateTime(int32_t uptime) { mSlsHostUpdateTime = uptime; }
@@ -162,11 +174,37 @@ namespace sdk {
                          HttpMessage& httpMessage,
                          std::string* realIpPtr = NULL);
 
+        // Headers and pieces of the string to sign shared by PostLogStoreLogs requests to the same logstore, so that
+        // only the date, content md5 and sizes are formatted and the body is hashed once for each request.
+        struct PostLogStoreLogsTemplate {
+            PostLogStoreLogsTemplate(const std::string& accessKey)
+                : mSigner(reinterpret_cast<const uint8_t*>(accessKey.data()), accessKey.size()) {}
+
+            uint64_t mSettingVersion = 0;
+            std::string mOperation;
+            std::map<std::string, std::string> mHeader;
+            // canonicalized headers sorted before and after x-log-bodyrawsize, followed by the operation
+            std::string mSignBeforeRawSize;
+            std::string mSignAfterRawSize;
+            std::string mAuthorizationPrefix;
+            // HMAC with the access key already padded into its state, which is copied for each request
+            HMAC mSigner;
+        };
+
+        std::shared_ptr<const PostLogStoreLogsTemplate>
+        GetPostLogStoreLogsTemplate(const std::string& project,
+                                    const std::string& logstore,
+                                    sls_logs::SlsCompressType compressType,
+                                    bool isPackageList,
+                                    bool isRoute);
+
         std::unique_ptr<HttpSinkRequest>
         CreateAsynPostLogStoreLogsRequest(const std::string& project,
                                           const std::string& logstore,
+                                          sls_logs::SlsCompressType compressType,
+                                          bool isPackageList,
                                           const std::string& body,
-                                          std::map<std::string, std::string>& httpHeader,
+                                          size_t rawSize,
                                           const std::string& hashKey,
                                           int64_t hashKeySeqID,
                                           SenderQueueItem* item);
@@ -206,6 +244,11 @@ namespace sdk {
 
         SpinLock mSpinLock;
 
+        // increased whenever a setting used by request templates changes, which invalidates all of them
+        std::atomic_uint64_t mSettingVersion{0};
+        std::unordered_map<std::string, std::shared_ptr<const PostLogStoreLogsTemplate>> mPostLogStoreLogsTemplates;
+        SpinLock mTemplateLock;
+
         CurlClient* mClient;
     };
 
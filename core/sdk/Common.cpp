@@ -287,12 +287,16 @@ namespace sdk {
         return strTemp;
     }
 
-    std::string GetDateString(const std::string& dateFormat) {
+    static time_t GetDateTime() {
         time_t now_time;
         time(&now_time);
         if (AppConfig::GetInstance()->EnableLogTimeAutoAdjust()) {
             now_time += GetTimeDelta();
         }
+        return now_time;
+    }
+
+    static std::string FormatDateString(time_t now_time, const std::string& dateFormat) {
         char buffer[128] = {'\0'};
         tm timeInfo;
 #if defined(__linux__)
@@ -304,8 +308,20 @@ namespace sdk {
         return string(buffer);
     }
 
+    std::string GetDateString(const std::string& dateFormat) {
+        return FormatDateString(GetDateTime(), dateFormat);
+    }
+
     std::string GetDateString() {
-        return GetDateString(DATE_FORMAT_RFC822);
+        // every request carries the date, which only changes once per second
+        static thread_local time_t sLastTime = 0;
+        static thread_local std::string sLastDate;
+        time_t now_time = GetDateTime();
+        if (now_time != sLastTime || sLastDate.empty()) {
+            sLastDate = FormatDateString(now_time, DATE_FORMAT_RFC822);
+            sLastTime = now_time;
+        }
+        return sLastDate;
     }
 
     time_t DecodeDateString(const std::string dateString, const std::string& dateFormat) {
@@ -350,6 +366,20 @@ namespace sdk {
         }
     }
 
+    map<string, string> GetCanonicalizedHeaders(const map<string, string>& httpHeader) {
+        map<string, string> endingMap;
+        for (map<string, string>::const_iterator iter = httpHeader.begin(); iter != httpHeader.end(); ++iter) {
+            if (StartWith(iter->first, LOG_OLD_HEADER_PREFIX)) {
+                std::string key = iter->first;
+                endingMap.insert(std::make_pair(key.replace(0, std::strlen(LOG_OLD_HEADER_PREFIX), LOG_HEADER_PREFIX),
+                                                iter->second));
+            } else if (StartWith(iter->first, LOG_HEADER_PREFIX) || StartWith(iter->first, ACS_HEADER_PREFIX)) {
+                endingMap.insert(std::make_pair(iter->first, iter->second));
+            }
+        }
+        return endingMap;
+    }
+
     string GetUrlSignature(const string& httpMethod,
                            const string& operationType,
                            map<string, string>& httpHeader,
@@ -367,7 +397,6 @@ namespace sdk {
         if (iter != httpHeader.end()) {
             contentType = iter->second;
         }
-        std::map<string, string> endingMap;
         osstream.append(httpMethod);
         osstream.append("\n");
         osstream.append(contentMd5);
@@ -376,15 +405,7 @@ namespace sdk {
         osstream.append("\n");
         osstream.append(httpHeader[DATE]);
         osstream.append("\n");
-        for (map<string, string>::const_iterator iter = httpHeader.begin(); iter != httpHeader.end(); ++iter) {
-            if (StartWith(iter->first, LOG_OLD_HEADER_PREFIX)) {
-                std::string key = iter->first;
-                endingMap.insert(std::make_pair(key.replace(0, std::strlen(LOG_OLD_HEADER_PREFIX), LOG_HEADER_PREFIX),
-                                                iter->second));
-            } else if (StartWith(iter->first, LOG_HEADER_PREFIX) || StartWith(iter->first, ACS_HEADER_PREFIX)) {
-                endingMap.insert(std::make_pair(iter->first, iter->second));
-            }
-        }
+        std::map<string, string> endingMap = GetCanonicalizedHeaders(httpHeader);
         for (map<string, string>::const_iterator it = endingMap.begin(); it != endingMap.end(); ++it) {
             osstream.append(it->first);
             osstream.append(":");
@@ -249,6 +249,10 @@ namespace sdk {
 
     void GetQueryString(const std::map<std::string, std::string>& parameterList, std::string& queryString);
 
+    // Headers prefixed with x-log- or x-acs- in order, which are part of the string to sign. The legacy x-sls- prefix is
+    // replaced with x-log-.
+    std::map<std::string, std::string> GetCanonicalizedHeaders(const std::map<std::string, std::string>& httpHeader);
+
     std::string GetUrlSignature(const std::string& httpMethod,
                                 const std::string& operationType,
                                 std::map<std::string, std::string>& httpHeader,
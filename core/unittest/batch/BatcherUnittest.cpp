@@ -13,7 +13,10 @@
 // limitations under the License.
 
 
+#include <string_view>
+
 #include "pipeline/batch/Batcher.h"
+#include "common/HashUtil.h"
 #include "common/JsonUtil.h"
 #include "unittest/Unittest.h"
 #include "unittest/plugin/PluginMock.h"
@@ -29,6 +32,7 @@ public:
     void TestInitWithGroupBatch();
     void TestAddWithoutGroupBatch();
     void TestAddWithGroupBatch();
+    void TestAddWithTagSet();
     void TestFlushEventQueueWithoutGroupBatch();
     void TestFlushEventQueueWithGroupBatch();
     void TestFlushGroupQueue();
@@ -44,11 +48,15 @@ protected:
         sFlusher->SetMetricsRecordRef(FlusherMock::sName, "1", "1", "1");
     }
 
-    void TearDown() override { TimeoutFlushManager::GetInstance()->mTimeoutRecords.clear(); }
+    void TearDown() override { GetTimeoutRecords().clear(); }
 
 private:
     PipelineEventGroup CreateEventGroup(size_t cnt);
 
+    static map<string, map<pair<size_t, size_t>, TimeoutRecord>>& GetTimeoutRecords() {
+        return TimeoutFlushManager::GetInstance()->GetShard("test_config").mTimeoutRecords;
+    }
+
     static unique_ptr<FlusherMock> sFlusher;
 
     PipelineContext mCtx;
@@ -107,6 +115,7 @@ void BatcherUnittest::TestInitWithoutGroupBatch() {
     APSARA_TEST_EQUAL(10U, batch.mEventFlushStrategy.GetMaxCnt());
     APSARA_TEST_EQUAL(1000U, batch.mEventFlushStrategy.GetMaxSizeBytes());
     APSARA_TEST_EQUAL(5U, batch.mEventFlushStrategy.GetTimeoutSecs());
+    APSARA_TEST_EQUAL(5000U, batch.mEventTimeoutMs);
     APSARA_TEST_EQUAL(sFlusher.get(), batch.mFlusher);
 }
 
@@ -130,8 +139,25 @@ void BatcherUnittest::TestInitWithGroupBatch() {
     APSARA_TEST_TRUE(batch.mGroupFlushStrategy);
     APSARA_TEST_EQUAL(1000U, batch.mGroupFlushStrategy->GetMaxSizeBytes());
     APSARA_TEST_EQUAL(2U, batch.mGroupFlushStrategy->GetTimeoutSecs());
+    APSARA_TEST_EQUAL(3000U, batch.mEventTimeoutMs);
+    APSARA_TEST_EQUAL(2000U, batch.mGroupTimeoutMs);
     APSARA_TEST_TRUE(batch.mGroupQueue);
     APSARA_TEST_EQUAL(sFlusher.get(), batch.mFlusher);
+
+    // timeout in milliseconds
+    configStr = R"(
+            {
+                "TimeoutSecs": 5,
+                "TimeoutMs": 300
+            }
+        )";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    Batcher<> msBatch;
+    msBatch.Init(configJson, sFlusher.get(), DefaultFlushStrategyOptions(), true);
+    APSARA_TEST_EQUAL(150U, msBatch.mEventTimeoutMs);
+    APSARA_TEST_EQUAL(150U, msBatch.mGroupTimeoutMs);
+    APSARA_TEST_EQUAL(1U, msBatch.mEventFlushStrategy.GetTimeoutSecs());
+    APSARA_TEST_EQUAL(1U, msBatch.mGroupFlushStrategy->GetTimeoutSecs());
 }
 
 void BatcherUnittest::TestAddWithoutGroupBatch() {
@@ -153,11 +179,11 @@ void BatcherUnittest::TestAddWithoutGroupBatch() {
     APSARA_TEST_EQUAL(1U, batch.mEventQueueMap.size());
     APSARA_TEST_EQUAL(2U, batch.mEventQueueMap[key].mBatch.mEvents.size());
     APSARA_TEST_EQUAL(0U, res.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].size());
-    TimeoutRecord& record = TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key));
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords().size());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords()["test_config"].size());
+    TimeoutRecord& record = GetTimeoutRecords()["test_config"].at(make_pair(0, key));
     time_t updateTime = record.mUpdateTime;
-    APSARA_TEST_EQUAL(3U, record.mTimeoutSecs);
+    APSARA_TEST_EQUAL(3000U, record.mTimeoutMs);
     APSARA_TEST_EQUAL(sFlusher.get(), record.mFlusher);
     APSARA_TEST_EQUAL(key, record.mKey);
     APSARA_TEST_GT(updateTime, 0);
@@ -179,8 +205,7 @@ void BatcherUnittest::TestAddWithoutGroupBatch() {
     APSARA_TEST_EQUAL(buffer2, res[0][0].mSourceBuffers[1].get());
     APSARA_TEST_EQUAL(eoo1, res[0][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
 
     // flush by time then by size
     res.clear();
@@ -201,8 +226,7 @@ void BatcherUnittest::TestAddWithoutGroupBatch() {
     APSARA_TEST_EQUAL(buffer2, res[0][0].mSourceBuffers[0].get());
     APSARA_TEST_EQUAL(eoo2, res[0][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
     APSARA_TEST_EQUAL(1U, res[1].size());
     APSARA_TEST_EQUAL(1U, res[1][0].mEvents.size());
     APSARA_TEST_EQUAL(1U, res[1][0].mTags.mInner.size());
@@ -211,8 +235,7 @@ void BatcherUnittest::TestAddWithoutGroupBatch() {
     APSARA_TEST_EQUAL(buffer3, res[1][0].mSourceBuffers[0].get());
     APSARA_TEST_EQUAL(eoo3, res[1][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[1][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
 }
 
 void BatcherUnittest::TestAddWithGroupBatch() {
@@ -234,11 +257,11 @@ void BatcherUnittest::TestAddWithGroupBatch() {
     APSARA_TEST_EQUAL(1U, batch.mEventQueueMap.size());
     APSARA_TEST_EQUAL(2U, batch.mEventQueueMap[key].mBatch.mEvents.size());
     APSARA_TEST_EQUAL(0U, res.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].size());
-    TimeoutRecord& record = TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key));
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords().size());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords()["test_config"].size());
+    TimeoutRecord& record = GetTimeoutRecords()["test_config"].at(make_pair(0, key));
     time_t updateTime = record.mUpdateTime;
-    APSARA_TEST_EQUAL(2U, record.mTimeoutSecs);
+    APSARA_TEST_EQUAL(2000U, record.mTimeoutMs);
     APSARA_TEST_EQUAL(sFlusher.get(), record.mFlusher);
     APSARA_TEST_EQUAL(key, record.mKey);
     APSARA_TEST_GT(updateTime, 0);
@@ -260,8 +283,7 @@ void BatcherUnittest::TestAddWithGroupBatch() {
     APSARA_TEST_EQUAL(buffer2, res[0][0].mSourceBuffers[1].get());
     APSARA_TEST_EQUAL(eoo1, res[0][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
 
     // flush by time to group batch
     res.clear();
@@ -291,8 +313,7 @@ void BatcherUnittest::TestAddWithGroupBatch() {
     APSARA_TEST_EQUAL(buffer2, res[0][0].mSourceBuffers[0].get());
     APSARA_TEST_EQUAL(eoo2, res[0][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
 
     // flush by time to group batch, and then group flush by size
     res.clear();
@@ -313,8 +334,7 @@ void BatcherUnittest::TestAddWithGroupBatch() {
     APSARA_TEST_EQUAL(buffer3, res[0][0].mSourceBuffers[0].get());
     APSARA_TEST_EQUAL(eoo3, res[0][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
     APSARA_TEST_EQUAL(1U, res[0][1].mEvents.size());
     APSARA_TEST_EQUAL(1U, res[0][1].mTags.mInner.size());
     APSARA_TEST_STREQ("val", res[0][1].mTags.mInner["key"].data());
@@ -322,8 +342,7 @@ void BatcherUnittest::TestAddWithGroupBatch() {
     APSARA_TEST_EQUAL(buffer4, res[0][1].mSourceBuffers[0].get());
     APSARA_TEST_EQUAL(eoo4, res[0][1].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][1].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
 
     // flush by size
     res.clear();
@@ -344,8 +363,7 @@ void BatcherUnittest::TestAddWithGroupBatch() {
     APSARA_TEST_EQUAL(buffer6, res[0][0].mSourceBuffers[1].get());
     APSARA_TEST_EQUAL(eoo5, res[0][0].mExactlyOnceCheckpoint.get());
     APSARA_TEST_STREQ("pack_id", res[0][0].mPackIdPrefix.data());
-    APSARA_TEST_GT(TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, key)).mUpdateTime,
-                   updateTime - 1);
+    APSARA_TEST_GT(GetTimeoutRecords()["test_config"].at(make_pair(0, key)).mUpdateTime, updateTime - 1);
 }
 
 void BatcherUnittest::TestFlushEventQueueWithoutGroupBatch() {
@@ -402,11 +420,11 @@ void BatcherUnittest::TestFlushEventQueueWithGroupBatch() {
     batch.FlushQueue(key, res);
     APSARA_TEST_EQUAL(0U, batch.mEventQueueMap.size());
     APSARA_TEST_EQUAL(0U, res.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
-    APSARA_TEST_EQUAL(2U, TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].size());
-    TimeoutRecord& record = TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, 0));
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords().size());
+    APSARA_TEST_EQUAL(2U, GetTimeoutRecords()["test_config"].size());
+    TimeoutRecord& record = GetTimeoutRecords()["test_config"].at(make_pair(0, 0));
     time_t updateTime = record.mUpdateTime;
-    APSARA_TEST_EQUAL(1U, record.mTimeoutSecs);
+    APSARA_TEST_EQUAL(1000U, record.mTimeoutMs);
     APSARA_TEST_EQUAL(sFlusher.get(), record.mFlusher);
     APSARA_TEST_EQUAL(0U, record.mKey);
     APSARA_TEST_GT(updateTime, 0);
@@ -559,6 +577,40 @@ void BatcherUnittest::TestFlushAllWithGroupBatch() {
     APSARA_TEST_STREQ("pack_id", res[1][0].mPackIdPrefix.data());
 }
 
+void BatcherUnittest::TestAddWithTagSet() {
+    DefaultFlushStrategyOptions strategy;
+    strategy.mMaxCnt = 3;
+    strategy.mMaxSizeBytes = 1000;
+    strategy.mTimeoutSecs = 3;
+
+    Batcher<> batch;
+    batch.Init(Json::Value(), sFlusher.get(), strategy);
+
+    TagSet tags;
+    tags.Add("key", "val");
+    PipelineEventGroup group1(make_shared<SourceBuffer>());
+    group1.SetTagsNoCopy(tags);
+    group1.SetMetadata(EventGroupMetaKey::SOURCE_ID, string("pack_id"));
+    group1.AddLogEvent();
+
+    // the key is the precomputed hash of the tag set, with only source id hashed
+    size_t key = tags.GetHash();
+    HashCombine(key, hash<string_view>{}("pack_id"));
+    APSARA_TEST_EQUAL(key, group1.GetTagsHash());
+
+    vector<BatchedEventsList> res;
+    batch.Add(std::move(group1), res);
+    APSARA_TEST_EQUAL(1U, batch.mEventQueueMap.size());
+    APSARA_TEST_EQUAL(1U, batch.mEventQueueMap[key].mBatch.mEvents.size());
+
+    // group with the same tags copied goes to the same batch item
+    batch.Add(CreateEventGroup(1), res);
+    APSARA_TEST_EQUAL(1U, batch.mEventQueueMap.size());
+    APSARA_TEST_EQUAL(2U, batch.mEventQueueMap[key].mBatch.mEvents.size());
+    APSARA_TEST_STREQ("val", batch.mEventQueueMap[key].mBatch.mTags.mInner["key"].data());
+    APSARA_TEST_EQUAL(0U, res.size());
+}
+
 PipelineEventGroup BatcherUnittest::CreateEventGroup(size_t cnt) {
     PipelineEventGroup group(make_shared<SourceBuffer>());
     group.SetTag(string("key"), string("val"));
@@ -576,6 +628,7 @@ UNIT_TEST_CASE(BatcherUnittest, TestInitWithoutGroupBatch)
 UNIT_TEST_CASE(BatcherUnittest, TestInitWithGroupBatch)
 UNIT_TEST_CASE(BatcherUnittest, TestAddWithoutGroupBatch)
 UNIT_TEST_CASE(BatcherUnittest, TestAddWithGroupBatch)
+UNIT_TEST_CASE(BatcherUnittest, TestAddWithTagSet)
 UNIT_TEST_CASE(BatcherUnittest, TestFlushEventQueueWithoutGroupBatch)
 UNIT_TEST_CASE(BatcherUnittest, TestFlushEventQueueWithGroupBatch)
 UNIT_TEST_CASE(BatcherUnittest, TestFlushGroupQueue)
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <thread>
+
 #include "pipeline/batch/TimeoutFlushManager.h"
 #include "unittest/Unittest.h"
 #include "unittest/plugin/PluginMock.h"
@@ -25,6 +28,8 @@ public:
     void TestUpdateRecord();
     void TestFlushTimeoutBatch();
     void TestClearRecords();
+    void TestFlushByThread();
+    void TestUpdatedRecordDeadline();
 
 protected:
     static void SetUpTestCase() {
@@ -34,9 +39,20 @@ protected:
         sFlusher->SetMetricsRecordRef(FlusherMock::sName, "1", "1", "1");
     }
 
-    void TearDown() override { TimeoutFlushManager::GetInstance()->mTimeoutRecords.clear(); }
+    void TearDown() override {
+        GetTimeoutRecords().clear();
+        GetDeadlines() = {};
+    }
 
 private:
+    static map<string, map<pair<size_t, size_t>, TimeoutRecord>>& GetTimeoutRecords() {
+        return TimeoutFlushManager::GetInstance()->GetShard("test_config").mTimeoutRecords;
+    }
+
+    static decltype(TimeoutFlushManager::Shard::mDeadlines)& GetDeadlines() {
+        return TimeoutFlushManager::GetInstance()->GetShard("test_config").mDeadlines;
+    }
+
     static unique_ptr<FlusherMock> sFlusher;
     static PipelineContext sCtx;
 };
@@ -46,47 +62,95 @@ PipelineContext TimeoutFlushManagerUnittest::sCtx;
 
 void TimeoutFlushManagerUnittest::TestUpdateRecord() {
     // new batch queue
-    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3, sFlusher.get());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].size());
-    auto& record1 = TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, 1));
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3000, sFlusher.get());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords().size());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords()["test_config"].size());
+    auto& record1 = GetTimeoutRecords()["test_config"].at(make_pair(0, 1));
     APSARA_TEST_EQUAL(1U, record1.mKey);
-    APSARA_TEST_EQUAL(3U, record1.mTimeoutSecs);
+    APSARA_TEST_EQUAL(3000U, record1.mTimeoutMs);
     APSARA_TEST_EQUAL(sFlusher.get(), record1.mFlusher);
     APSARA_TEST_GT(record1.mUpdateTime, 0);
 
     // existed batch queue
     time_t lastTime = record1.mUpdateTime;
-    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3, sFlusher.get());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].size());
-    auto& record2 = TimeoutFlushManager::GetInstance()->mTimeoutRecords["test_config"].at(make_pair(0, 1));
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3000, sFlusher.get());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords().size());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords()["test_config"].size());
+    auto& record2 = GetTimeoutRecords()["test_config"].at(make_pair(0, 1));
     APSARA_TEST_EQUAL(1U, record2.mKey);
-    APSARA_TEST_EQUAL(3U, record2.mTimeoutSecs);
+    APSARA_TEST_EQUAL(3000U, record2.mTimeoutMs);
     APSARA_TEST_EQUAL(sFlusher.get(), record2.mFlusher);
     APSARA_TEST_GT(record2.mUpdateTime, lastTime - 1);
 }
 
 void TimeoutFlushManagerUnittest::TestFlushTimeoutBatch() {
     TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 0, 0, sFlusher.get());
-    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3, sFlusher.get());
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3000, sFlusher.get());
     TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 2, 0, sFlusher.get());
 
     TimeoutFlushManager::GetInstance()->FlushTimeoutBatch();
     APSARA_TEST_EQUAL(2U, sFlusher->mFlushedQueues.size()); // key 0 && 2
-    APSARA_TEST_EQUAL(1U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords().size());
 }
 
 void TimeoutFlushManagerUnittest::TestClearRecords() {
-    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3, sFlusher.get());
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3000, sFlusher.get());
+    auto& shard = TimeoutFlushManager::GetInstance()->GetShard("test_config");
+    APSARA_TEST_EQUAL(1U, shard.mConfigIds.count("test_config"));
     TimeoutFlushManager::GetInstance()->ClearRecords("test_config");
 
-    APSARA_TEST_EQUAL(0U, TimeoutFlushManager::GetInstance()->mTimeoutRecords.size());
+    APSARA_TEST_EQUAL(0U, GetTimeoutRecords().size());
+    // the interned config name is released, so that it does not pile up on config reload
+    APSARA_TEST_EQUAL(0U, shard.mConfigIds.count("test_config"));
+    APSARA_TEST_TRUE(shard.mConfigNames.empty());
+}
+
+void TimeoutFlushManagerUnittest::TestFlushByThread() {
+    sFlusher->mFlushedQueues.clear();
+    TimeoutFlushManager::GetInstance()->Init();
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 3000, sFlusher.get());
+    // the thread is waked up by the record with earlier deadline
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 2, 50, sFlusher.get());
+    this_thread::sleep_for(chrono::milliseconds(500));
+    TimeoutFlushManager::GetInstance()->Stop();
+
+    APSARA_TEST_EQUAL(1U, sFlusher->mFlushedQueues.size());
+    APSARA_TEST_EQUAL(2U, sFlusher->mFlushedQueues[0]);
+    APSARA_TEST_EQUAL(1U, GetTimeoutRecords()["test_config"].size());
+}
+
+void TimeoutFlushManagerUnittest::TestUpdatedRecordDeadline() {
+    sFlusher->mFlushedQueues.clear();
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 100, sFlusher.get());
+    // updating an existing record pushes no deadline
+    for (int i = 0; i < 10; ++i) {
+        TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 1, 100, sFlusher.get());
+    }
+    APSARA_TEST_EQUAL(1U, GetDeadlines().size());
+
+    // the deadline popped before the updated one is pushed again
+    auto& record = GetTimeoutRecords()["test_config"].at(make_pair(0, 1));
+    record.mUpdateTime += 10000;
+    this_thread::sleep_for(chrono::milliseconds(150));
+    TimeoutFlushManager::GetInstance()->FlushTimeoutBatch();
+    APSARA_TEST_TRUE(sFlusher->mFlushedQueues.empty());
+    APSARA_TEST_EQUAL(1U, GetDeadlines().size());
+    APSARA_TEST_EQUAL(record.GetDeadline(), GetDeadlines().top().mTime);
+
+    // deadlines of cleared records are dropped
+    TimeoutFlushManager::GetInstance()->ClearRecords("test_config");
+    TimeoutFlushManager::GetInstance()->UpdateRecord("test_config", 0, 2, 0, sFlusher.get());
+    TimeoutFlushManager::GetInstance()->FlushTimeoutBatch();
+    APSARA_TEST_EQUAL(1U, sFlusher->mFlushedQueues.size());
+    APSARA_TEST_EQUAL(2U, sFlusher->mFlushedQueues[0]);
+    APSARA_TEST_EQUAL(1U, GetDeadlines().size());
 }
 
 UNIT_TEST_CASE(TimeoutFlushManagerUnittest, TestUpdateRecord)
 UNIT_TEST_CASE(TimeoutFlushManagerUnittest, TestFlushTimeoutBatch)
 UNIT_TEST_CASE(TimeoutFlushManagerUnittest, TestClearRecords)
+UNIT_TEST_CASE(TimeoutFlushManagerUnittest, TestFlushByThread)
+UNIT_TEST_CASE(TimeoutFlushManagerUnittest, TestUpdatedRecordDeadline)
 
 } // namespace logtail
 
@@ -0,0 +1,179 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include "checkpoint/CheckPointJournal.h"
+#include "common/Flags.h"
+#include "unittest/Unittest.h"
+
+DECLARE_FLAG_INT32(checkpoint_journal_compact_min_records);
+
+using namespace std;
+
+namespace logtail {
+
+class CheckPointJournalUnittest : public ::testing::Test {
+public:
+    void SetUp() override { remove(mPath.c_str()); }
+    void TearDown() override { remove(mPath.c_str()); }
+
+    void TestLoadAfterDump();
+    void TestIncrementalDump();
+    void TestUncommittedTail();
+    void TestCompaction();
+
+private:
+    static void Dump(CheckPointJournal& journal,
+                     const string& path,
+                     const unordered_map<string, string>& records,
+                     int32_t dumpTime = 100) {
+        journal.BeginDump(path);
+        for (const auto& record : records) {
+            journal.Put(record.first, record.second);
+        }
+        APSARA_TEST_TRUE(journal.CommitDump(200, dumpTime));
+    }
+
+    static size_t GetFileSize(const string& path) {
+        ifstream in(path, ios::binary | ios::ate);
+        return static_cast<size_t>(in.tellg());
+    }
+
+    const string mPath = "checkpoint_journal_unittest.journal";
+};
+
+void CheckPointJournalUnittest::TestLoadAfterDump() {
+    unordered_map<string, string> records;
+    int32_t version = 0, dumpTime = 0;
+    CheckPointJournal journal;
+    APSARA_TEST_FALSE(journal.Load(mPath, records, version, dumpTime));
+
+    unordered_map<string, string> expected = {{"a", "1"}, {"b", string("\0\1\2", 3)}, {"c", ""}};
+    Dump(journal, mPath, expected, 123);
+
+    CheckPointJournal loaded;
+    APSARA_TEST_TRUE(loaded.Load(mPath, records, version, dumpTime));
+    APSARA_TEST_TRUE(expected == records);
+    APSARA_TEST_EQUAL(200, version);
+    APSARA_TEST_EQUAL(123, dumpTime);
+    APSARA_TEST_FALSE(loaded.mNeedCompaction);
+
+    // not a journal
+    ofstream(mPath, ios::binary) << "{\"check_point\": {}}";
+    APSARA_TEST_FALSE(loaded.Load(mPath, records, version, dumpTime));
+}
+
+void CheckPointJournalUnittest::TestIncrementalDump() {
+    CheckPointJournal journal;
+    unordered_map<string, string> expected = {{"a", "1"}, {"b", "2"}, {"c", "3"}};
+    Dump(journal, mPath, expected);
+    APSARA_TEST_EQUAL(4U, journal.mRecordCount);
+
+    // nothing changed, only the commit record is written
+    size_t size = GetFileSize(mPath);
+    Dump(journal, mPath, expected);
+    APSARA_TEST_EQUAL(1U, journal.mWrittenRecordCount);
+    APSARA_TEST_FALSE(journal.mCompacting);
+
+    // one put and one delete
+    expected["a"] = "10";
+    expected.erase("b");
+    Dump(journal, mPath, expected);
+    APSARA_TEST_EQUAL(3U, journal.mWrittenRecordCount);
+    APSARA_TEST_GT(GetFileSize(mPath), size);
+
+    unordered_map<string, string> records;
+    int32_t version = 0, dumpTime = 0;
+    CheckPointJournal loaded;
+    APSARA_TEST_TRUE(loaded.Load(mPath, records, version, dumpTime));
+    APSARA_TEST_TRUE(expected == records);
+    APSARA_TEST_EQUAL(journal.mRecordCount, loaded.mRecordCount);
+
+    // continue appending after load
+    expected["d"] = "4";
+    Dump(loaded, mPath, expected);
+    APSARA_TEST_FALSE(loaded.mCompacting);
+    APSARA_TEST_EQUAL(2U, loaded.mWrittenRecordCount);
+    APSARA_TEST_TRUE(CheckPointJournal().Load(mPath, records, version, dumpTime));
+    APSARA_TEST_TRUE(expected == records);
+}
+
+void CheckPointJournalUnittest::TestUncommittedTail() {
+    CheckPointJournal journal;
+    unordered_map<string, string> expected = {{"a", "1"}, {"b", "2"}};
+    Dump(journal, mPath, expected);
+    size_t committedSize = GetFileSize(mPath);
+
+    // a dump interrupted before commit
+    journal.BeginDump(mPath);
+    journal.Put("a", "100");
+    journal.Put("c", "3");
+    journal.mOut.close();
+    // and a torn record
+    ofstream(mPath, ios::binary | ios::app) << "\x10\x00";
+    APSARA_TEST_GT(GetFileSize(mPath), committedSize);
+
+    unordered_map<string, string> records;
+    int32_t version = 0, dumpTime = 0;
+    CheckPointJournal loaded;
+    APSARA_TEST_TRUE(loaded.Load(mPath, records, version, dumpTime));
+    APSARA_TEST_TRUE(expected == records);
+    APSARA_TEST_TRUE(loaded.mNeedCompaction);
+
+    // the journal is rewritten so that the uncommitted records are dropped
+    expected["c"] = "3";
+    Dump(loaded, mPath, expected);
+    APSARA_TEST_TRUE(loaded.mCompacting);
+    APSARA_TEST_TRUE(CheckPointJournal().Load(mPath, records, version, dumpTime));
+    APSARA_TEST_TRUE(expected == records);
+}
+
+void CheckPointJournalUnittest::TestCompaction() {
+    auto bakMinRecords = INT32_FLAG(checkpoint_journal_compact_min_records);
+    INT32_FLAG(checkpoint_journal_compact_min_records) = 8;
+    CheckPointJournal journal;
+    unordered_map<string, string> expected = {{"a", "0"}};
+    Dump(journal, mPath, expected);
+    APSARA_TEST_TRUE(journal.mCompacting);
+    for (int i = 1; i <= 4; ++i) {
+        expected["a"] = to_string(i);
+        Dump(journal, mPath, expected);
+        APSARA_TEST_FALSE(journal.mCompacting);
+    }
+    APSARA_TEST_EQUAL(10U, journal.mRecordCount);
+
+    expected["a"] = "5";
+    Dump(journal, mPath, expected);
+    APSARA_TEST_TRUE(journal.mCompacting);
+    APSARA_TEST_EQUAL(2U, journal.mRecordCount);
+
+    unordered_map<string, string> records;
+    int32_t version = 0, dumpTime = 0;
+    APSARA_TEST_TRUE(CheckPointJournal().Load(mPath, records, version, dumpTime));
+    APSARA_TEST_TRUE(expected == records);
+    INT32_FLAG(checkpoint_journal_compact_min_records) = bakMinRecords;
+}
+
+UNIT_TEST_CASE(CheckPointJournalUnittest, TestLoadAfterDump)
+UNIT_TEST_CASE(CheckPointJournalUnittest, TestIncrementalDump)
+UNIT_TEST_CASE(CheckPointJournalUnittest, TestUncommittedTail)
+UNIT_TEST_CASE(CheckPointJournalUnittest, TestCompaction)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -18,6 +18,7 @@
 #include "common/Flags.h"
 
 DECLARE_FLAG_INT32(checkpoint_find_max_file_count);
+DECLARE_FLAG_BOOL(enable_checkpoint_journal);
 
 namespace logtail {
 
@@ -35,9 +36,11 @@ public:
     static void TearDownTestCase() { bfs::remove_all(kTestRootDir); }
 
     void TestSearchFilePathByDevInodeInDirectory();
+    void TestMigrateJsonToJournal();
 };
 
 UNIT_TEST_CASE(CheckpointManagerUnittest, TestSearchFilePathByDevInodeInDirectory);
+UNIT_TEST_CASE(CheckpointManagerUnittest, TestMigrateJsonToJournal);
 
 void CheckpointManagerUnittest::TestSearchFilePathByDevInodeInDirectory() {
     const std::string kRotateFileName = "test.log.5";
@@ -96,6 +99,90 @@ void CheckpointManagerUnittest::TestSearchFilePathByDevInodeInDirectory() {
     }
 }
 
+void CheckpointManagerUnittest::TestMigrateJsonToJournal() {
+    const std::string checkPointFile = (bfs::path(kTestRootDir) / "logtail_check_point").string();
+    std::string filePathBak = AppConfig::GetInstance()->mCheckPointFilePath;
+    AppConfig::GetInstance()->mCheckPointFilePath = checkPointFile;
+    bool journalBak = BOOL_FLAG(enable_checkpoint_journal);
+    CheckPointManager* manager = CheckPointManager::Instance();
+    manager->RemoveAllCheckPoint();
+
+    // a checkpoint file written by a version without journal
+    const std::string dirName = (bfs::path(kTestRootDir) / "dir").string();
+    const std::string subDirName = (bfs::path(dirName) / "sub").string();
+    std::ofstream(checkPointFile) << R"({
+        "check_point": {
+            "/tmp/test.log*1*2*config_0": {
+                "file_name": "/tmp/test.log",
+                "real_file_name": "/tmp/test.log.1",
+                "offset": "12345",
+                "sig_size": 100,
+                "sig_hash": 9876543210,
+                "update_time": 1700000000,
+                "inode": 2,
+                "dev": 1,
+                "file_open": 1,
+                "container_stopped": 0,
+                "last_force_read": 1,
+                "config_name": "config_0",
+                "sig": "",
+                "idx_in_reader_array": 3
+            }
+        },
+        "dir_check_point": {
+            ")" + dirName + R"(": {
+                "update_time": )" + std::to_string(time(NULL)) + R"(,
+                "sub_dir": [")" + subDirName + R"("]
+            }
+        },
+        "version": 200
+    })";
+    auto checkLoaded = [&]() {
+        CheckPointPtr checkPoint;
+        APSARA_TEST_TRUE_FATAL(manager->GetCheckPoint(DevInode(1, 2), "config_0", checkPoint));
+        APSARA_TEST_EQUAL("/tmp/test.log", checkPoint->mFileName);
+        APSARA_TEST_EQUAL("/tmp/test.log.1", checkPoint->mRealFileName);
+        APSARA_TEST_EQUAL(12345, checkPoint->mOffset);
+        APSARA_TEST_EQUAL(100U, checkPoint->mSignatureSize);
+        APSARA_TEST_EQUAL(9876543210ULL, checkPoint->mSignatureHash);
+        APSARA_TEST_EQUAL(1700000000, checkPoint->mLastUpdateTime);
+        APSARA_TEST_TRUE(checkPoint->mFileOpenFlag);
+        APSARA_TEST_FALSE(checkPoint->mContainerStopped);
+        APSARA_TEST_TRUE(checkPoint->mLastForceRead);
+        APSARA_TEST_EQUAL(3, checkPoint->mIdxInReaderArray);
+        DirCheckPointPtr dirCheckPoint;
+        APSARA_TEST_TRUE_FATAL(manager->GetDirCheckPoint(dirName, dirCheckPoint));
+        APSARA_TEST_EQUAL(1U, dirCheckPoint->mSubDir.size());
+        APSARA_TEST_EQUAL(1U, dirCheckPoint->mSubDir.count(subDirName));
+        APSARA_TEST_TRUE(manager->CheckVersion());
+    };
+
+    BOOL_FLAG(enable_checkpoint_journal) = true;
+    manager->LoadCheckPoint();
+    checkLoaded();
+
+    // the first dump migrates the json file to the journal, and the json file is kept for rollback
+    APSARA_TEST_TRUE(manager->DumpCheckPointToLocal());
+    APSARA_TEST_TRUE(CheckExistance(manager->GetJournalFilePath()));
+    APSARA_TEST_TRUE(CheckExistance(checkPointFile));
+    manager->RemoveAllCheckPoint();
+    manager->LoadCheckPoint();
+    checkLoaded();
+
+    // turning the journal off migrates it back to the json file
+    BOOL_FLAG(enable_checkpoint_journal) = false;
+    APSARA_TEST_TRUE(manager->DumpCheckPointToLocal());
+    APSARA_TEST_TRUE(CheckExistance(checkPointFile));
+    APSARA_TEST_FALSE(CheckExistance(manager->GetJournalFilePath()));
+    manager->RemoveAllCheckPoint();
+    manager->LoadCheckPoint();
+    checkLoaded();
+
+    manager->RemoveAllCheckPoint();
+    BOOL_FLAG(enable_checkpoint_journal) = journalBak;
+    AppConfig::GetInstance()->mCheckPointFilePath = filePathBak;
+}
+
 } // namespace logtail
 
 UNIT_TEST_MAIN
@@ -17,10 +17,12 @@
 #include "app_config/AppConfig.h"
 #include "protobuf/sls/sls_logs.pb.h"
 #include "checkpoint/CheckpointManagerV2.h"
+#include "common/DevInode.h"
 
 DECLARE_FLAG_INT32(logtail_checkpoint_check_gc_interval_sec);
 DECLARE_FLAG_INT32(logtail_checkpoint_expired_threshold_sec);
 DECLARE_FLAG_INT32(logtail_checkpoint_gc_threshold_sec);
+DECLARE_FLAG_BOOL(enable_checkpoint_group_commit);
 
 namespace logtail {
 
@@ -54,6 +56,22 @@ public:
     void TestExtractPrimaryKeyFromRangeKey();
 
     void TestMarkGC();
+
+    void TestAsyncWrite();
+
+    void TestStopAsyncWrites();
+
+private:
+    static RangeCheckpointPB MakeRangeCheckpoint(uint64_t sequenceId) {
+        RangeCheckpointPB rgCpt;
+        rgCpt.set_hash_key(kPrimaryKey);
+        rgCpt.set_sequence_id(sequenceId);
+        rgCpt.set_read_offset(0);
+        rgCpt.set_read_length(0);
+        rgCpt.set_update_time(time(NULL));
+        rgCpt.set_committed(false);
+        return rgCpt;
+    }
 };
 
 UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestBaseMethod);
@@ -61,6 +79,8 @@ UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestProtobufMethod);
 UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestScanCheckpoints);
 UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestExtractPrimaryKeyFromRangeKey);
 UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestMarkGC);
+UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestAsyncWrite);
+UNIT_TEST_CASE(CheckpointManagerV2Unittest, TestStopAsyncWrites);
 
 void CheckpointManagerV2Unittest::TestBaseMethod() {
     CheckpointManagerV2 m;
@@ -342,6 +362,90 @@ void CheckpointManagerV2Unittest::TestMarkGC() {
     }
 }
 
+void CheckpointManagerV2Unittest::TestAsyncWrite() {
+    BOOL_FLAG(enable_checkpoint_group_commit) = true;
+    CheckpointManagerV2 m;
+    m.rebuild();
+    const std::string key = m.MakeRangeKey(kPrimaryKey, 0);
+    std::string value;
+    RangeCheckpointPB rgCpt;
+
+    // pending writes are visible before they are persisted
+    uint64_t seq = m.AsyncSetPB(key, MakeRangeCheckpoint(1));
+    EXPECT_GT(seq, 0U);
+    EXPECT_TRUE(m.GetPB(key, rgCpt));
+    EXPECT_EQ(1U, rgCpt.sequence_id());
+    m.FlushAsyncWrites();
+    EXPECT_TRUE(m.IsPersisted(seq));
+    EXPECT_TRUE(m.readDatabase(key, value));
+    EXPECT_TRUE(rgCpt.ParseFromString(value));
+    EXPECT_EQ(1U, rgCpt.sequence_id());
+
+    // the last write of a key wins
+    for (uint64_t i = 2; i <= 10; ++i) {
+        seq = m.AsyncSetPB(key, MakeRangeCheckpoint(i));
+    }
+    m.FlushAsyncWrites();
+    EXPECT_TRUE(m.IsPersisted(seq));
+    EXPECT_TRUE(m.readDatabase(key, value));
+    EXPECT_TRUE(rgCpt.ParseFromString(value));
+    EXPECT_EQ(10U, rgCpt.sequence_id());
+
+    // a synchronous write is not overwritten by a pending write of the same key
+    m.AsyncSetPB(key, MakeRangeCheckpoint(11));
+    EXPECT_TRUE(m.SetPB(key, MakeRangeCheckpoint(12)));
+    m.FlushAsyncWrites();
+    EXPECT_TRUE(m.readDatabase(key, value));
+    EXPECT_TRUE(rgCpt.ParseFromString(value));
+    EXPECT_EQ(12U, rgCpt.sequence_id());
+
+    // nor is a deletion
+    m.AsyncSetPB(key, MakeRangeCheckpoint(13));
+    m.DeleteCheckpoints(std::vector<std::string>{key});
+    m.FlushAsyncWrites();
+    EXPECT_FALSE(m.read(key, value));
+
+    BOOL_FLAG(enable_checkpoint_group_commit) = false;
+}
+
+void CheckpointManagerV2Unittest::TestStopAsyncWrites() {
+    const size_t keyCnt = 100;
+    BOOL_FLAG(enable_checkpoint_group_commit) = true;
+    {
+        CheckpointManagerV2 m;
+        m.rebuild();
+        // range checkpoints without primary checkpoint are removed by GC
+        PrimaryCheckpointPB cpt;
+        cpt.set_concurrency(keyCnt + 1);
+        cpt.set_sig_hash(0);
+        cpt.set_sig_size(0);
+        EXPECT_TRUE(m.SetPB(kPrimaryKey, cpt));
+        std::vector<uint64_t> seqs;
+        for (size_t i = 0; i < keyCnt; ++i) {
+            seqs.push_back(m.AsyncSetPB(m.MakeRangeKey(kPrimaryKey, i), MakeRangeCheckpoint(i)));
+        }
+        // pending writes are persisted when stopped
+        m.StopAsyncWrites();
+        for (auto seq : seqs) {
+            EXPECT_TRUE(m.IsPersisted(seq));
+        }
+        // writes after stop are persisted synchronously
+        EXPECT_EQ(0U, m.AsyncSetPB(m.MakeRangeKey(kPrimaryKey, keyCnt), MakeRangeCheckpoint(keyCnt)));
+        m.FlushAsyncWrites();
+        m.StopAsyncWrites();
+    }
+    BOOL_FLAG(enable_checkpoint_group_commit) = false;
+
+    CheckpointManagerV2 m;
+    for (size_t i = 0; i <= keyCnt; ++i) {
+        std::string value;
+        RangeCheckpointPB rgCpt;
+        EXPECT_TRUE(m.readDatabase(m.MakeRangeKey(kPrimaryKey, i), value));
+        EXPECT_TRUE(rgCpt.ParseFromString(value));
+        EXPECT_EQ(i, rgCpt.sequence_id());
+    }
+}
+
 } // namespace logtail
 
 UNIT_TEST_MAIN
@@ -0,0 +1,107 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+
+#include "common/AhoCorasickMatcher.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class AhoCorasickMatcherUnittest : public ::testing::Test {
+public:
+    void TestBuild();
+    void TestContains();
+    void TestSameAsFind();
+};
+
+void AhoCorasickMatcherUnittest::TestBuild() {
+    AhoCorasickMatcher matcher;
+    APSARA_TEST_FALSE(matcher.Build({}));
+    APSARA_TEST_FALSE(matcher.IsBuilt());
+    APSARA_TEST_FALSE(matcher.Contains("abc", 3));
+    APSARA_TEST_FALSE(matcher.Build({"abc", ""}));
+    APSARA_TEST_FALSE(matcher.IsBuilt());
+
+    APSARA_TEST_TRUE(matcher.Build({"he", "she", "his", "hers"}));
+    APSARA_TEST_TRUE(matcher.IsBuilt());
+    // h, e, s, i, r and the class of other bytes
+    APSARA_TEST_EQUAL(6U, matcher.mClassCnt);
+    APSARA_TEST_EQUAL("hs", matcher.mFirstBytes);
+
+    APSARA_TEST_TRUE(matcher.Build({"a", "b", "c", "d", "e"}));
+    APSARA_TEST_TRUE(matcher.mFirstBytes.empty());
+}
+
+void AhoCorasickMatcherUnittest::TestContains() {
+    AhoCorasickMatcher matcher;
+    APSARA_TEST_TRUE(matcher.Build({"password=", "pwd=", "token:"}));
+    for (const string& buf : {"password=123",
+                              "user=a, pwd=123",
+                              "a very long line before the anchor, which is skipped by blocks: token:abc",
+                              "passwpwd=",
+                              "ppassword=",
+                              "tokentoken:"}) {
+        APSARA_TEST_TRUE_DESC(matcher.Contains(buf.data(), buf.size()), buf);
+    }
+    for (const string& buf :
+         {"", "password", "pwd", "pass=word", "a very long line without any anchor, which is skipped by blocks"}) {
+        APSARA_TEST_FALSE_DESC(matcher.Contains(buf.data(), buf.size()), buf);
+    }
+    // data is bounded by size
+    string buf = "pwd=";
+    APSARA_TEST_FALSE(matcher.Contains(buf.data(), buf.size() - 1));
+
+    // a literal inside another one is found through the failure link
+    APSARA_TEST_TRUE(matcher.Build({"abcd", "bc"}));
+    APSARA_TEST_TRUE(matcher.Contains("abce", 4));
+}
+
+void AhoCorasickMatcherUnittest::TestSameAsFind() {
+    mt19937 gen(42);
+    const string chars = "abc=:";
+    auto randomString = [&](size_t size) {
+        string res;
+        for (size_t i = 0; i < size; ++i) {
+            res.push_back(chars[gen() % chars.size()]);
+        }
+        return res;
+    };
+    for (int i = 0; i < 1000; ++i) {
+        vector<string> patterns;
+        for (size_t j = 1 + gen() % 8; j > 0; --j) {
+            patterns.push_back(randomString(1 + gen() % 4));
+        }
+        AhoCorasickMatcher matcher;
+        APSARA_TEST_TRUE_FATAL(matcher.Build(patterns));
+        for (int j = 0; j < 20; ++j) {
+            string buf = randomString(gen() % 40);
+            bool expected = false;
+            for (const auto& pattern : patterns) {
+                expected = expected || buf.find(pattern) != string::npos;
+            }
+            APSARA_TEST_EQUAL_FATAL(expected, matcher.Contains(buf.data(), buf.size()));
+        }
+    }
+}
+
+UNIT_TEST_CASE(AhoCorasickMatcherUnittest, TestBuild)
+UNIT_TEST_CASE(AhoCorasickMatcherUnittest, TestContains)
+UNIT_TEST_CASE(AhoCorasickMatcherUnittest, TestSameAsFind)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -0,0 +1,236 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+
+#include "common/CompiledTimeFormat.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class CompiledTimeFormatUnittest : public ::testing::Test {
+public:
+    void TestCompile();
+    void TestParse();
+    void TestParseRejected();
+    void TestSameAsStrptime();
+
+private:
+    // @return true if the fast path accepts buf, in which case the result must be the same as Strptime
+    bool CheckSameAsStrptime(const string& fmt, const string& buf);
+};
+
+bool CompiledTimeFormatUnittest::CheckSameAsStrptime(const string& fmt, const string& buf) {
+    CompiledTimeFormat format;
+    APSARA_TEST_TRUE(format.Compile(fmt));
+    CompiledTimeFormat::MinuteCache cache;
+    LogtailTime fastTime = {0, 0};
+    int fastLength = -1;
+    const char* fastRes = format.Parse(buf.data(), buf.size(), &fastTime, fastLength, cache);
+    if (fastRes == nullptr) {
+        return false;
+    }
+    LogtailTime time = {0, 0};
+    int length = -1;
+    const char* res = Strptime(buf.c_str(), fmt.c_str(), &time, length);
+    APSARA_TEST_TRUE(res != nullptr);
+    APSARA_TEST_EQUAL(res, fastRes);
+    APSARA_TEST_EQUAL(time.tv_sec, fastTime.tv_sec);
+    APSARA_TEST_EQUAL(time.tv_nsec, fastTime.tv_nsec);
+    APSARA_TEST_EQUAL(length, fastLength);
+    return true;
+}
+
+void CompiledTimeFormatUnittest::TestCompile() {
+    CompiledTimeFormat format;
+    APSARA_TEST_TRUE(format.Compile("%Y-%m-%d %H:%M:%S"));
+    APSARA_TEST_EQUAL("0000-00-00 00:00:00", format.mTemplate);
+    APSARA_TEST_EQUAL(0xFFFFU & ~((1U << 4) | (1U << 7) | (1U << 10) | (1U << 13)), format.mDigitMask16);
+    APSARA_TEST_EQUAL((1U << 4) | (1U << 7) | (1U << 10) | (1U << 13), format.mLiteralMask16);
+    APSARA_TEST_FALSE(format.mHasNanosecond);
+    APSARA_TEST_TRUE(format.mSuffix.empty());
+
+    APSARA_TEST_TRUE(format.Compile("[%FT%T.%f%z]"));
+    APSARA_TEST_EQUAL("[0000-00-00T00:00:00.", format.mTemplate);
+    APSARA_TEST_TRUE(format.mHasNanosecond);
+    APSARA_TEST_EQUAL(2U, format.mSuffix.size());
+
+    APSARA_TEST_TRUE(format.Compile("%Y%m%d%H%M"));
+    APSARA_TEST_TRUE(format.Compile("%% %Y/%m/%d %H:%M:%S %z %%"));
+
+    // not supported
+    APSARA_TEST_FALSE(format.Compile("%s"));
+    APSARA_TEST_FALSE(format.Compile("%m-%d %H:%M:%S"));
+    APSARA_TEST_FALSE(format.Compile("%Y-%m-%d %H:%M:%S %Y"));
+    APSARA_TEST_FALSE(format.Compile("%d/%b/%Y:%H:%M:%S"));
+    APSARA_TEST_FALSE(format.Compile("%Y-%m-%d %H:%M:%S.%f %f"));
+    APSARA_TEST_FALSE(format.Compile("%Y-%m-%d %H:%M:%S %z %H"));
+    APSARA_TEST_FALSE(format.Compile("%Y-%m-%d %H:%M:%S %"));
+    APSARA_TEST_FALSE(format.IsCompiled());
+}
+
+void CompiledTimeFormatUnittest::TestParse() {
+    CompiledTimeFormat format;
+    CompiledTimeFormat::MinuteCache cache;
+    LogtailTime time = {0, 0};
+    int length = -1;
+
+    APSARA_TEST_TRUE(format.Compile("%Y-%m-%d %H:%M:%S"));
+    string buf = "2024-07-15 10:20:30 rest";
+    APSARA_TEST_EQUAL(buf.data() + 19, format.Parse(buf.data(), buf.size(), &time, length, cache));
+    APSARA_TEST_EQUAL(-1, length);
+    APSARA_TEST_EQUAL(0, time.tv_nsec);
+    time_t minute = cache.mEpoch;
+    APSARA_TEST_EQUAL(minute + 30, time.tv_sec);
+
+    // the same minute hits the cache
+    buf = "2024-07-15 10:20:59";
+    APSARA_TEST_TRUE(format.Parse(buf.data(), buf.size(), &time, length, cache) != nullptr);
+    APSARA_TEST_EQUAL(minute, cache.mEpoch);
+    APSARA_TEST_EQUAL(minute + 59, time.tv_sec);
+    buf = "2024-07-15 10:21:00";
+    APSARA_TEST_TRUE(format.Parse(buf.data(), buf.size(), &time, length, cache) != nullptr);
+    APSARA_TEST_EQUAL(minute + 60, cache.mEpoch);
+    APSARA_TEST_EQUAL(minute + 60, time.tv_sec);
+
+    APSARA_TEST_TRUE(format.Compile("%Y-%m-%dT%H:%M:%S.%f%z"));
+    buf = "2024-07-15T10:20:30.123Z";
+    APSARA_TEST_EQUAL(buf.data() + buf.size(), format.Parse(buf.data(), buf.size(), &time, length, cache));
+    APSARA_TEST_EQUAL(3, length);
+    APSARA_TEST_EQUAL(123000000, time.tv_nsec);
+    APSARA_TEST_EQUAL(minute + 30, time.tv_sec);
+    // the offset is consumed but not applied, as Strptime does
+    buf = "2024-07-15T10:20:30.123456789+08:00";
+    APSARA_TEST_EQUAL(buf.data() + buf.size(), format.Parse(buf.data(), buf.size(), &time, length, cache));
+    APSARA_TEST_EQUAL(9, length);
+    APSARA_TEST_EQUAL(123456789, time.tv_nsec);
+    APSARA_TEST_EQUAL(minute + 30, time.tv_sec);
+
+    // buf is bounded by len
+    buf = "2024-07-15T10:20:30.123456+0800";
+    APSARA_TEST_EQUAL(nullptr, format.Parse(buf.data(), buf.size() - 1, &time, length, cache));
+    APSARA_TEST_EQUAL(nullptr, format.Parse(buf.data(), 20, &time, length, cache));
+}
+
+void CompiledTimeFormatUnittest::TestParseRejected() {
+    CompiledTimeFormat format;
+    CompiledTimeFormat::MinuteCache cache;
+    LogtailTime time = {0, 0};
+    int length = -1;
+
+    APSARA_TEST_EQUAL(nullptr, format.Parse("2024", 4, &time, length, cache));
+    APSARA_TEST_TRUE(format.Compile("%Y-%m-%d %H:%M:%S.%f %z"));
+    for (const string& buf : {"2024-7-15 10:20:30.1 +0800",
+                              "2024/07/15 10:20:30.1 +0800",
+                              "2024-13-15 10:20:30.1 +0800",
+                              "2024-07-00 10:20:30.1 +0800",
+                              "2024-07-15 24:20:30.1 +0800",
+                              "2024-07-15 10:60:30.1 +0800",
+                              "2024-07-15 10:20:62.1 +0800",
+                              "2024-07-15 10:20:30. +0800",
+                              "2024-07-15 10:20:30.1234567890 +0800",
+                              "2024-07-15 10:20:30.1 +0860",
+                              "2024-07-15 10:20:30.1 CST",
+                              "2024-07-15 10:20:30.1"}) {
+        APSARA_TEST_EQUAL(nullptr, format.Parse(buf.data(), buf.size(), &time, length, cache));
+    }
+    // white spaces in the suffix match any number of white spaces
+    for (const string& buf :
+         {"2024-07-15 10:20:30.1 +08", "2024-07-15 10:20:30.1  +08:", "2024-07-15 10:20:30.1\t-0330"}) {
+        APSARA_TEST_EQUAL(buf.data() + buf.size(), format.Parse(buf.data(), buf.size(), &time, length, cache));
+    }
+}
+
+void CompiledTimeFormatUnittest::TestSameAsStrptime() {
+    const vector<string> formats = {"%Y-%m-%d %H:%M:%S",
+                                    "%Y-%m-%d %H:%M:%S.%f",
+                                    "%Y-%m-%dT%H:%M:%S.%f%z",
+                                    "%Y-%m-%d %H:%M:%S,%f %z",
+                                    "[%Y/%m/%d %H:%M:%S]",
+                                    "%Y%m%d%H%M%S",
+                                    "%Y-%m-%d %H:%M"};
+    mt19937 gen(42);
+    uniform_int_distribution<int> pick(0, 99);
+    // a value within the range of the field most of the time, or random digits of the same width
+    auto appendField = [&](string& buf, int width, int minValue, int maxValue) {
+        if (pick(gen) < 90) {
+            string digits = to_string(uniform_int_distribution<int>(minValue, maxValue)(gen));
+            buf.append(width - min(width, static_cast<int>(digits.size())), '0').append(digits);
+            return;
+        }
+        for (int i = 0; i < width; ++i) {
+            buf.push_back(static_cast<char>('0' + pick(gen) % 10));
+        }
+    };
+    size_t acceptedCnt = 0;
+    for (const auto& fmt : formats) {
+        for (int i = 0; i < 5000; ++i) {
+            string buf;
+            for (size_t j = 0; j < fmt.size(); ++j) {
+                if (fmt[j] != '%') {
+                    buf.push_back(fmt[j]);
+                    continue;
+                }
+                switch (fmt[++j]) {
+                    case 'Y':
+                        appendField(buf, 4, 1970, 2037);
+                        break;
+                    case 'm':
+                        appendField(buf, 2, 1, 12);
+                        break;
+                    case 'd':
+                        appendField(buf, 2, 1, 31);
+                        break;
+                    case 'H':
+                        appendField(buf, 2, 0, 23);
+                        break;
+                    case 'M':
+                        appendField(buf, 2, 0, 59);
+                        break;
+                    case 'S':
+                        appendField(buf, 2, 0, 61);
+                        break;
+                    case 'f':
+                        appendField(buf, 1 + pick(gen) % 9, 0, 0);
+                        break;
+                    case 'z': {
+                        const char* zones[] = {"Z", "+08:00", "-0330", "+08", "+0899", "CST", " +0800"};
+                        buf.append(zones[pick(gen) % 7]);
+                        break;
+                    }
+                }
+            }
+            // sometimes with a random char replaced
+            if (pick(gen) < 10) {
+                buf[pick(gen) % buf.size()] = "0a :-+"[pick(gen) % 6];
+            }
+            if (CheckSameAsStrptime(fmt, buf)) {
+                ++acceptedCnt;
+            }
+        }
+    }
+    // valid time strings are accepted by the fast path
+    APSARA_TEST_TRUE(acceptedCnt > formats.size() * 5000 / 4);
+}
+
+UNIT_TEST_CASE(CompiledTimeFormatUnittest, TestCompile)
+UNIT_TEST_CASE(CompiledTimeFormatUnittest, TestParse)
+UNIT_TEST_CASE(CompiledTimeFormatUnittest, TestParseRejected)
+UNIT_TEST_CASE(CompiledTimeFormatUnittest, TestSameAsStrptime)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
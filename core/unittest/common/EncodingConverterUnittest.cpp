@@ -23,9 +23,22 @@ namespace logtail {
 class EncodingConverterUnittest : public ::testing::Test {
 public:
     void ConvertGbk2Utf8();
+    void ConvertGbk2Utf8MultiLines();
+
+private:
+    static std::string Convert(const std::string& gbkStr, const std::vector<long>& linePosVec) {
+        size_t srcLen = gbkStr.size();
+        size_t requireSize
+            = EncodingConverter::GetInstance()->ConvertGbk2Utf8(gbkStr.data(), &srcLen, nullptr, 0, linePosVec) + 1;
+        std::unique_ptr<char[]> destChar(new char[requireSize]);
+        size_t actualSize = EncodingConverter::GetInstance()->ConvertGbk2Utf8(
+            gbkStr.data(), &srcLen, destChar.get(), requireSize, linePosVec);
+        return std::string(destChar.get(), actualSize);
+    }
 };
 
 APSARA_UNIT_TEST_CASE(EncodingConverterUnittest, ConvertGbk2Utf8, 0);
+APSARA_UNIT_TEST_CASE(EncodingConverterUnittest, ConvertGbk2Utf8MultiLines, 0);
 
 void EncodingConverterUnittest::ConvertGbk2Utf8() {
     char gbkStr[] = "ilogtail\xbf\xc9\xb9\xdb\xb2\xe2\xd0\xd4\xb2\xc9\xbc\xaf\xc6\xf7";
@@ -41,6 +54,27 @@ void EncodingConverterUnittest::ConvertGbk2Utf8() {
     APSARA_TEST_STREQ("ilogtail可观测性采集器", destChar.get());
 }
 
+void EncodingConverterUnittest::ConvertGbk2Utf8MultiLines() {
+    // ascii runs longer than a vector, and the single byte euro sign
+    std::string gbkStr = "2024-01-01 00:00:00 [INFO] \xbf\xc9\xb9\xdb\xb2\xe2 \x80\n"
+                         "\xd0\xd4 0123456789abcdefghijklmnopqrstuvwxyz\n"
+                         "\xb2\xc9\xbc\xaf\xc6\xf7";
+    std::vector<long> linePosVec = {-1};
+    for (size_t i = 0; i + 1 < gbkStr.size(); ++i) {
+        if (gbkStr[i] == '\n') {
+            linePosVec.push_back(i);
+        }
+    }
+    linePosVec.push_back(gbkStr.size() - 1);
+    APSARA_TEST_EQUAL("2024-01-01 00:00:00 [INFO] 可观测 €\n性 0123456789abcdefghijklmnopqrstuvwxyz\n采集器",
+                      Convert(gbkStr, linePosVec));
+
+    // lines with invalid or incomplete characters are kept as is, other lines are still converted
+    gbkStr = "\xbf\xc9\n\xff\xbf\n\xb9\xdb\n\xb2";
+    linePosVec = {-1, 2, 5, 8, 9};
+    APSARA_TEST_EQUAL("可\n\xff\xbf\n观\n\xb2", Convert(gbkStr, linePosVec));
+}
+
 } // namespace logtail
 
 int main(int argc, char** argv) {
@@ -0,0 +1,96 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <future>
+#include <thread>
+
+#include "common/SpscRingBuffer.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class SpscRingBufferUnittest : public ::testing::Test {
+public:
+    void TestPushAndPop();
+    void TestConcurrency();
+};
+
+void SpscRingBufferUnittest::TestPushAndPop() {
+    SpscRingBuffer<unique_ptr<int>> ring(3);
+    APSARA_TEST_EQUAL(4U, ring.Capacity());
+    APSARA_TEST_TRUE(ring.Empty());
+
+    for (int i = 0; i < 4; ++i) {
+        APSARA_TEST_TRUE(ring.TryPush(make_unique<int>(i)));
+    }
+    {
+        auto item = make_unique<int>(4);
+        APSARA_TEST_FALSE(ring.TryPush(std::move(item)));
+        // item is not consumed on failure
+        APSARA_TEST_NOT_EQUAL(nullptr, item);
+    }
+    APSARA_TEST_EQUAL(4U, ring.Size());
+
+    // wrap around
+    for (int i = 0; i < 10; ++i) {
+        unique_ptr<int> res;
+        APSARA_TEST_TRUE(ring.TryPop(res));
+        APSARA_TEST_EQUAL(i, *res);
+        APSARA_TEST_TRUE(ring.TryPush(make_unique<int>(i + 4)));
+    }
+    for (int i = 10; i < 14; ++i) {
+        unique_ptr<int> res;
+        APSARA_TEST_TRUE(ring.TryPop(res));
+        APSARA_TEST_EQUAL(i, *res);
+    }
+    unique_ptr<int> res;
+    APSARA_TEST_FALSE(ring.TryPop(res));
+    APSARA_TEST_TRUE(ring.Empty());
+}
+
+void SpscRingBufferUnittest::TestConcurrency() {
+    const int cnt = 100000;
+    SpscRingBuffer<int> ring(64);
+    auto producer = async(launch::async, [&ring] {
+        for (int i = 0; i < cnt; ++i) {
+            while (!ring.TryPush(int(i))) {
+                this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    while (expected < cnt) {
+        int res = 0;
+        if (!ring.TryPop(res)) {
+            this_thread::yield();
+            continue;
+        }
+        if (res != expected) {
+            break;
+        }
+        ++expected;
+    }
+    producer.get();
+    APSARA_TEST_EQUAL(cnt, expected);
+    APSARA_TEST_TRUE(ring.Empty());
+}
+
+UNIT_TEST_CASE(SpscRingBufferUnittest, TestPushAndPop)
+UNIT_TEST_CASE(SpscRingBufferUnittest, TestConcurrency)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
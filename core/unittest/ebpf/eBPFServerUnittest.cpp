@@ -8,10 +8,16 @@
 #include "ebpf/include/export.h"
 #include "pipeline/Pipeline.h"
 #include "pipeline/PipelineContext.h"
+#include "pipeline/queue/ProcessQueueManager.h"
+#include "pipeline/queue/QueueKeyManager.h"
 #include "ebpf/eBPFServer.h"
 #include "ebpf/SourceManager.h"
 #include "logger/Logger.h"
 #include "ebpf/config.h"
+
+DECLARE_FLAG_INT32(ebpf_security_event_ring_size);
+DECLARE_FLAG_INT32(ebpf_security_event_group_size);
+DECLARE_FLAG_INT32(bounded_process_queue_capacity);
 #include "app_config/AppConfig.h"
 #include "common/JsonUtil.h"
 #include "ebpf/config.h"
@@ -46,6 +52,8 @@ public:
 
     void TestInitAndStop();
 
+    void TestSecurityHandlerBackpressure();
+
 protected:
     void SetUp() override {
         config_ = new eBPFAdminConfig;
@@ -790,6 +798,93 @@ void eBPFServerUnittest::TestInitAndStop() {
     EXPECT_EQ(false, ret);
 }
 
+void eBPFServerUnittest::TestSecurityHandlerBackpressure() {
+    int32_t ringSize = INT32_FLAG(ebpf_security_event_ring_size);
+    INT32_FLAG(ebpf_security_event_ring_size) = 64;
+    SecurityHandler handler(&ctx, ctx.GetProcessQueueKey(), 0);
+    INT32_FLAG(ebpf_security_event_ring_size) = ringSize;
+    EXPECT_EQ(64U, handler.mRing.Capacity());
+
+    auto generate = [](size_t cnt) {
+        std::vector<std::unique_ptr<AbstractSecurityEvent>> events;
+        for (size_t i = 0; i < cnt; ++i) {
+            std::vector<std::pair<std::string, std::string>> tags = {{"call_name", "test"}};
+            events.emplace_back(std::make_unique<AbstractSecurityEvent>(
+                std::move(tags), SecureEventType::SECURE_EVENT_TYPE_PROCESS_SECURE, 0));
+        }
+        return events;
+    };
+
+    // no sampling until half full
+    EXPECT_EQ(0U, handler.GetSampleLevel());
+    handler.handle(generate(33));
+    EXPECT_EQ(33U, handler.mProcessTotalCnt);
+    EXPECT_EQ(0U, handler.mDiscardCnt.load());
+
+    // sampled as the ring fills, and dropped when it is full
+    EXPECT_EQ(1U, handler.GetSampleLevel());
+    handler.handle(generate(32));
+    EXPECT_EQ(49U, handler.mProcessTotalCnt);
+    EXPECT_EQ(16U, handler.mDiscardCnt.load());
+    EXPECT_EQ(2U, handler.GetSampleLevel());
+    for (int i = 0; i < 10; ++i) {
+        handler.handle(generate(100));
+    }
+    EXPECT_EQ(64U, handler.mRing.Size());
+    EXPECT_EQ(1065U, handler.mProcessTotalCnt + handler.mDiscardCnt.load());
+
+    // item pending for the current context is kept, and discarded once the pipeline is updated
+    auto buildPendingItem = [&]() {
+        PipelineEventGroup group(std::make_shared<SourceBuffer>());
+        group.AddLogEvent();
+        handler.mPendingItem = std::make_unique<ProcessQueueItem>(std::move(group), 0);
+        handler.mPendingItemCtxVersion = handler.GetContext().mVersion;
+    };
+    uint64_t discardCnt = handler.mDiscardCnt.load();
+    buildPendingItem();
+    handler.Drain();
+    EXPECT_NE(nullptr, handler.mPendingItem);
+    handler.UpdateContext(&ctx, ctx.GetProcessQueueKey(), 1);
+    EXPECT_EQ(1U, handler.GetContext().mPluginIdx);
+    handler.Drain();
+    EXPECT_EQ(nullptr, handler.mPendingItem);
+    EXPECT_EQ(discardCnt + 1, handler.mDiscardCnt.load());
+    EXPECT_EQ(64U, handler.mRing.Size());
+
+    // events in the ring are pushed to the process queue in groups
+    QueueKey key = QueueKeyManager::GetInstance()->GetKey("test_security_handler");
+    ProcessQueueManager::GetInstance()->CreateOrUpdateBoundedQueue(key, 0);
+    handler.UpdateContext(&ctx, key, 2);
+    EXPECT_TRUE(handler.Drain());
+    EXPECT_TRUE(handler.mRing.Empty());
+    EXPECT_EQ(nullptr, handler.mPendingItem);
+    std::unique_ptr<ProcessQueueItem> item;
+    std::string configName;
+    EXPECT_TRUE(ProcessQueueManager::GetInstance()->PopItem(0, item, configName));
+    EXPECT_EQ("test_security_handler", configName);
+    EXPECT_EQ(64U, item->mEventGroup.GetEvents().size());
+    EXPECT_EQ(2U, item->mInputIndex);
+
+    // events are left in the ring once the process queue is full
+    int32_t groupSize = INT32_FLAG(ebpf_security_event_group_size);
+    INT32_FLAG(ebpf_security_event_group_size) = 1;
+    handler.handle(generate(20));
+    EXPECT_EQ(20U, handler.mRing.Size());
+    EXPECT_TRUE(handler.Drain());
+    EXPECT_FALSE(ProcessQueueManager::GetInstance()->IsValidToPush(key));
+    EXPECT_EQ(20U - INT32_FLAG(bounded_process_queue_capacity), handler.mRing.Size());
+    EXPECT_FALSE(handler.Drain());
+    INT32_FLAG(ebpf_security_event_group_size) = groupSize;
+    ProcessQueueManager::GetInstance()->DeleteQueue(key);
+
+    // events buffered are discarded once the plugin is stopped
+    buildPendingItem();
+    handler.UpdateContext(nullptr, -1, -1);
+    EXPECT_TRUE(handler.Drain());
+    EXPECT_TRUE(handler.mRing.Empty());
+    EXPECT_FALSE(handler.Drain());
+}
+
 UNIT_TEST_CASE(eBPFServerUnittest, TestDefaultEbpfParameters);
 UNIT_TEST_CASE(eBPFServerUnittest, TestDefaultAndLoadEbpfParameters);
 UNIT_TEST_CASE(eBPFServerUnittest, TestLoadEbpfParametersV1);
@@ -800,6 +895,7 @@ UNIT_TEST_CASE(eBPFServerUnittest, TestEnableProcessPlugin)
 UNIT_TEST_CASE(eBPFServerUnittest, TestEnableNetworkSecurePlugin)
 UNIT_TEST_CASE(eBPFServerUnittest, TestEnableFileSecurePlugin)
 UNIT_TEST_CASE(eBPFServerUnittest, TestInitAndStop)
+UNIT_TEST_CASE(eBPFServerUnittest, TestSecurityHandlerBackpressure)
 }
 }
 
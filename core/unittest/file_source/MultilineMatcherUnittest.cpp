@@ -0,0 +1,136 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "file_server/MultilineMatcher.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class MultilineMatcherUnittest : public testing::Test {
+public:
+    void TestExtractPrefilter() const;
+    void TestClassify() const;
+    void TestBoostFallback() const;
+
+private:
+    static void SetPattern(MultilineMatcher& matcher, MultilineMatcher::Pattern pattern, const string& regex) {
+        matcher.SetPattern(pattern, regex, make_shared<boost::regex>(regex));
+    }
+    static bool Match(const MultilineMatcher& matcher, const string& line, MultilineMatcher::Pattern pattern) {
+        return matcher.Match(line.data(), line.size(), pattern);
+    }
+    static uint8_t Classify(const MultilineMatcher& matcher, const string& line) {
+        return matcher.Classify(line.data(), line.size());
+    }
+};
+
+void MultilineMatcherUnittest::TestExtractPrefilter() const {
+    auto prefilter = MultilineMatcher::ExtractPrefilter("Caused by: \\w+");
+    APSARA_TEST_EQUAL("Caused by: ", prefilter.mLiteralPrefix);
+    APSARA_TEST_FALSE(prefilter.mAnyFirstByte);
+
+    prefilter = MultilineMatcher::ExtractPrefilter("\\[\\d+-\\d+");
+    APSARA_TEST_EQUAL("[", prefilter.mLiteralPrefix);
+
+    prefilter = MultilineMatcher::ExtractPrefilter("^\\d{4}-\\d{2}");
+    APSARA_TEST_EQUAL("", prefilter.mLiteralPrefix);
+    APSARA_TEST_FALSE(prefilter.mAnyFirstByte);
+    APSARA_TEST_TRUE(prefilter.Accept("2024-01", 7));
+    APSARA_TEST_FALSE(prefilter.Accept("\tat com", 7));
+    APSARA_TEST_FALSE(prefilter.Accept("", 0));
+
+    prefilter = MultilineMatcher::ExtractPrefilter("[a-cX]yz");
+    APSARA_TEST_TRUE(prefilter.Accept("byz", 3));
+    APSARA_TEST_TRUE(prefilter.Accept("Xyz", 3));
+    APSARA_TEST_FALSE(prefilter.Accept("dyz", 3));
+
+    // the literal before an optional quantifier is not part of the prefix
+    prefilter = MultilineMatcher::ExtractPrefilter("abc?d");
+    APSARA_TEST_EQUAL("ab", prefilter.mLiteralPrefix);
+    prefilter = MultilineMatcher::ExtractPrefilter("ab+c");
+    APSARA_TEST_EQUAL("ab", prefilter.mLiteralPrefix);
+
+    // patterns which are not analyzed accept every line
+    for (const string& regex : {"a?b", "\\s*at", "(abc)", "abc|def", ".*", "[^a]b"}) {
+        prefilter = MultilineMatcher::ExtractPrefilter(regex);
+        APSARA_TEST_EQUAL("", prefilter.mLiteralPrefix);
+        APSARA_TEST_TRUE(prefilter.mAnyFirstByte);
+    }
+}
+
+void MultilineMatcherUnittest::TestClassify() const {
+    MultilineMatcher matcher;
+    SetPattern(matcher, MultilineMatcher::START, "\\[\\d+-\\d+-\\d+");
+    SetPattern(matcher, MultilineMatcher::CONTINUE, "\\s+at ");
+    SetPattern(matcher, MultilineMatcher::END, "[\\w.]+Exception");
+    matcher.Compile();
+    APSARA_TEST_NOT_EQUAL(nullptr, matcher.mSet);
+
+    APSARA_TEST_EQUAL(MultilineMatcher::START, Classify(matcher, "[2024-01-01 00:00:00] ERROR"));
+    APSARA_TEST_EQUAL(MultilineMatcher::CONTINUE, Classify(matcher, "    at com.foo.Bar(Bar.java:10)"));
+    APSARA_TEST_EQUAL(MultilineMatcher::END, Classify(matcher, "java.lang.NullPointerException"));
+    APSARA_TEST_EQUAL(0, Classify(matcher, "other"));
+    APSARA_TEST_EQUAL(0, Classify(matcher, ""));
+    // patterns are anchored at the beginning of the line
+    APSARA_TEST_EQUAL(0, Classify(matcher, "x [2024-01-01"));
+
+    APSARA_TEST_TRUE(Match(matcher, "[2024-01-01", MultilineMatcher::START));
+    APSARA_TEST_FALSE(Match(matcher, "[2024-01-01", MultilineMatcher::END));
+
+    // only patterns given are reported
+    MultilineMatcher startOnly;
+    SetPattern(startOnly, MultilineMatcher::START, "\\d+");
+    startOnly.Compile();
+    APSARA_TEST_EQUAL(nullptr, startOnly.mSet);
+    APSARA_TEST_EQUAL(MultilineMatcher::START, Classify(startOnly, "123"));
+    APSARA_TEST_FALSE(Match(startOnly, "123", MultilineMatcher::END));
+}
+
+void MultilineMatcherUnittest::TestBoostFallback() const {
+    MultilineMatcher matcher;
+    // lookahead is not supported by RE2, and $ has different semantics, so both are matched by boost
+    SetPattern(matcher, MultilineMatcher::START, "(?=\\d)\\d+:");
+    SetPattern(matcher, MultilineMatcher::END, "end$");
+    matcher.Compile();
+    APSARA_TEST_EQUAL(nullptr, matcher.mEntries[0].mRe2);
+    APSARA_TEST_EQUAL(nullptr, matcher.mEntries[2].mRe2);
+    APSARA_TEST_EQUAL(nullptr, matcher.mSet);
+
+    APSARA_TEST_EQUAL(MultilineMatcher::START, Classify(matcher, "12: abc"));
+    APSARA_TEST_EQUAL(MultilineMatcher::END, Classify(matcher, "end"));
+    APSARA_TEST_EQUAL(0, Classify(matcher, "ends"));
+
+    // non-ascii literals are compared byte by byte
+    MultilineMatcher utf8;
+    SetPattern(utf8, MultilineMatcher::START, "开始.");
+    SetPattern(utf8, MultilineMatcher::END, "结束");
+    utf8.Compile();
+    APSARA_TEST_NOT_EQUAL(nullptr, utf8.mSet);
+    APSARA_TEST_EQUAL(MultilineMatcher::START, Classify(utf8, "开始\xff"));
+    APSARA_TEST_EQUAL(MultilineMatcher::END, Classify(utf8, "结束"));
+}
+
+UNIT_TEST_CASE(MultilineMatcherUnittest, TestExtractPrefilter)
+UNIT_TEST_CASE(MultilineMatcherUnittest, TestClassify)
+UNIT_TEST_CASE(MultilineMatcherUnittest, TestBoostFallback)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -16,6 +16,8 @@
 
 #include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "common/JsonUtil.h"
 #include "file_server/MultilineOptions.h"
@@ -29,6 +31,7 @@ namespace logtail {
 class MultilineOptionsUnittest : public testing::Test {
 public:
     void OnSuccessfulInit() const;
+    void TestGetCandidatePatterns() const;
 
 private:
     const string pluginType = "test";
@@ -212,7 +215,30 @@ void MultilineOptionsUnittest::OnSuccessfulInit() const {
     APSARA_TEST_EQUAL(MultilineOptions::UnmatchedContentTreatment::SINGLE_LINE, config->mUnmatchedContentTreatment);
 }
 
+void MultilineOptionsUnittest::TestGetCandidatePatterns() const {
+    const uint8_t start = MultilineMatcher::START, cont = MultilineMatcher::CONTINUE, end = MultilineMatcher::END;
+    // start pattern, continue pattern, end pattern, candidates when not partial, candidates when partial
+    const vector<tuple<string, string, string, uint8_t, uint8_t>> cases = {
+        {"start", "", "", start, start},
+        {"start", "cont", "", start, cont | start},
+        {"start", "", "end", start, end},
+        {"", "cont", "end", cont | end, cont | end},
+        {"", "", "end", cont, end},
+    };
+    for (const auto& item : cases) {
+        Json::Value configJson;
+        configJson["StartPattern"] = get<0>(item);
+        configJson["ContinuePattern"] = get<1>(item);
+        configJson["EndPattern"] = get<2>(item);
+        MultilineOptions config;
+        APSARA_TEST_TRUE(config.Init(configJson, ctx, pluginType));
+        APSARA_TEST_EQUAL(get<3>(item), config.GetCandidatePatterns(false));
+        APSARA_TEST_EQUAL(get<4>(item), config.GetCandidatePatterns(true));
+    }
+}
+
 UNIT_TEST_CASE(MultilineOptionsUnittest, OnSuccessfulInit)
+UNIT_TEST_CASE(MultilineOptionsUnittest, TestGetCandidatePatterns)
 
 } // namespace logtail
 
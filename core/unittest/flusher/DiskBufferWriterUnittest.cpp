@@ -0,0 +1,164 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/FileEncryption.h"
+#include "common/FileSystemUtil.h"
+#include "pipeline/queue/SLSSenderQueueItem.h"
+#include "pipeline/queue/SenderQueueManager.h"
+#include "plugin/flusher/sls/DiskBufferWriter.h"
+#include "plugin/flusher/sls/FlusherSLS.h"
+#include "unittest/Unittest.h"
+
+DECLARE_FLAG_INT32(log_expire_time);
+
+using namespace std;
+
+namespace logtail {
+
+class DiskBufferWriterUnittest : public ::testing::Test {
+public:
+    void TestPartialSendAndResume();
+    void TestBufferReplayItemOnExit();
+    void TestDiscardExpiredRecords();
+
+protected:
+    void SetUp() override {
+        mBufferDir = GetProcessExecutionDir() + "disk_buffer_writer_unittest";
+        bfs::remove_all(mBufferDir);
+        bfs::create_directories(mBufferDir);
+        sWriter->SetBufferFilePath(mBufferDir);
+        sWriter->mReplayFiles.clear();
+        mFlusher.InitForReplay("test_region", "", "test_project", sls_logs::SLS_CMP_LZ4);
+    }
+
+    void TearDown() override {
+        sWriter->mReplayFiles.clear();
+        SenderQueueManager::GetInstance()->Clear();
+        bfs::remove_all(mBufferDir);
+    }
+
+private:
+    // write records to a new buffer file, and return the name of the file
+    string WriteBufferFile(const vector<string>& contents);
+    void ReplayBufferFile(const string& fileName);
+    vector<SenderQueueItem*> GetReplayItems();
+
+    static DiskBufferWriter* sWriter;
+
+    string mBufferDir;
+    FlusherSLS mFlusher;
+};
+
+DiskBufferWriter* DiskBufferWriterUnittest::sWriter = DiskBufferWriter::GetInstance();
+
+string DiskBufferWriterUnittest::WriteBufferFile(const vector<string>& contents) {
+    sWriter->CreateNewFile();
+    string fileName = sWriter->GetBufferFileName();
+    for (const auto& content : contents) {
+        SLSSenderQueueItem item(string(content), content.size(), &mFlusher, mFlusher.GetQueueKey(), "test_logstore");
+        APSARA_TEST_TRUE(sWriter->SendToBufferFile(&item));
+    }
+    return fileName;
+}
+
+void DiskBufferWriterUnittest::ReplayBufferFile(const string& fileName) {
+    unique_lock<mutex> lock(sWriter->mBufferSenderThreadRunningMux);
+    sWriter->SendEncryptionBuffer(fileName, FileEncryption::GetInstance()->GetDefaultKeyVersion(), lock);
+}
+
+vector<SenderQueueItem*> DiskBufferWriterUnittest::GetReplayItems() {
+    vector<SenderQueueItem*> items;
+    for (size_t i = 0; i < SenderQueueManager::GetInstance()->GetShardCnt(); ++i) {
+        SenderQueueManager::GetInstance()->GetAllAvailableItems(items, false, i);
+    }
+    return items;
+}
+
+void DiskBufferWriterUnittest::TestPartialSendAndResume() {
+    string fileName = WriteBufferFile({"content_0", "content_1", "content_2"});
+    ReplayBufferFile(fileName);
+    auto items = GetReplayItems();
+    APSARA_TEST_EQUAL_FATAL(3U, items.size());
+
+    // only the first record is sent before the process exits, others are still being sent
+    SenderQueueManager::GetInstance()->RemoveItem(mFlusher.GetQueueKey(), items[0]);
+    sWriter->CheckReplayFiles();
+    APSARA_TEST_TRUE(CheckExistance(fileName));
+
+    // the file is replayed again after restart, and only records not sent are resent
+    sWriter->mReplayFiles.clear();
+    ReplayBufferFile(fileName);
+    items = GetReplayItems();
+    APSARA_TEST_EQUAL_FATAL(2U, items.size());
+    APSARA_TEST_EQUAL("content_1", items[0]->mData);
+    APSARA_TEST_EQUAL("content_2", items[1]->mData);
+    for (auto item : items) {
+        SenderQueueManager::GetInstance()->RemoveItem(mFlusher.GetQueueKey(), item);
+    }
+    sWriter->CheckReplayFiles();
+    APSARA_TEST_FALSE(CheckExistance(fileName));
+    APSARA_TEST_TRUE(sWriter->mReplayFiles.empty());
+}
+
+void DiskBufferWriterUnittest::TestBufferReplayItemOnExit() {
+    string fileName = WriteBufferFile({"content_0", "content_1"});
+    ReplayBufferFile(fileName);
+    auto items = GetReplayItems();
+    APSARA_TEST_EQUAL_FATAL(2U, items.size());
+
+    // the first record is sent, and the second one is pushed back to the disk buffer on exit, as the flusher runner
+    // does
+    SenderQueueManager::GetInstance()->RemoveItem(mFlusher.GetQueueKey(), items[0]);
+    APSARA_TEST_TRUE(sWriter->PushToDiskBuffer(items[1], 3));
+    SenderQueueManager::GetInstance()->RemoveItem(mFlusher.GetQueueKey(), items[1]);
+    // the record is not copied to a new buffer file, and is kept unhandled in the file being replayed
+    APSARA_TEST_TRUE(sWriter->mQueue.Empty());
+    sWriter->CheckReplayFiles();
+    APSARA_TEST_TRUE(CheckExistance(fileName));
+
+    sWriter->mReplayFiles.clear();
+    ReplayBufferFile(fileName);
+    items = GetReplayItems();
+    APSARA_TEST_EQUAL_FATAL(1U, items.size());
+    APSARA_TEST_EQUAL("content_1", items[0]->mData);
+    SenderQueueManager::GetInstance()->RemoveItem(mFlusher.GetQueueKey(), items[0]);
+    sWriter->CheckReplayFiles();
+    APSARA_TEST_FALSE(CheckExistance(fileName));
+}
+
+void DiskBufferWriterUnittest::TestDiscardExpiredRecords() {
+    string fileName = WriteBufferFile({"content_0", "content_1"});
+    int32_t expireTime = INT32_FLAG(log_expire_time);
+    INT32_FLAG(log_expire_time) = -1;
+    ReplayBufferFile(fileName);
+    INT32_FLAG(log_expire_time) = expireTime;
+
+    // expired records are discarded without being sent, and the file is removed at once
+    APSARA_TEST_TRUE(GetReplayItems().empty());
+    sWriter->CheckReplayFiles();
+    APSARA_TEST_FALSE(CheckExistance(fileName));
+    APSARA_TEST_TRUE(sWriter->mReplayFiles.empty());
+}
+
+UNIT_TEST_CASE(DiskBufferWriterUnittest, TestPartialSendAndResume)
+UNIT_TEST_CASE(DiskBufferWriterUnittest, TestBufferReplayItemOnExit)
+UNIT_TEST_CASE(DiskBufferWriterUnittest, TestDiscardExpiredRecords)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -0,0 +1,306 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <signal.h>
+#include <sys/resource.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "common/JsonUtil.h"
+#include "pipeline/Pipeline.h"
+#include "pipeline/PipelineContext.h"
+#include "pipeline/queue/QueueKeyManager.h"
+#include "pipeline/queue/SenderQueueManager.h"
+#include "plugin/flusher/file/FlusherFile.h"
+#include "protobuf/sls/sls_logs.pb.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class FlusherFileUnittest : public testing::Test {
+public:
+    void OnSuccessfulInit();
+    void OnFailedInit();
+    void TestSendJson();
+    void TestSendProtobuf();
+    void TestRotateBySize();
+    void TestTruncatePartialWrite();
+
+protected:
+    static void SetUpTestCase() { sDir = filesystem::temp_directory_path() / "flusher_file_unittest"; }
+
+    void SetUp() override {
+        ctx.SetConfigName("test_config");
+        ctx.SetPipeline(pipeline);
+        filesystem::remove_all(sDir);
+    }
+
+    void TearDown() override {
+        QueueKeyManager::GetInstance()->Clear();
+        SenderQueueManager::GetInstance()->Clear();
+        filesystem::remove_all(sDir);
+    }
+
+    // send a group with one log event to flusher, and write items generated to file
+    void SendAndWrite(FlusherFile& flusher, const string& content);
+    string ReadFile(const filesystem::path& path);
+
+    static filesystem::path sDir;
+
+private:
+    Pipeline pipeline;
+    PipelineContext ctx;
+};
+
+filesystem::path FlusherFileUnittest::sDir;
+
+void FlusherFileUnittest::SendAndWrite(FlusherFile& flusher, const string& content) {
+    PipelineEventGroup group(make_shared<SourceBuffer>());
+    group.SetTag(string("tag_key"), string("tag_value"));
+    auto e = group.AddLogEvent();
+    e->SetTimestamp(1234567890);
+    e->SetContent(string("content_key"), content);
+    APSARA_TEST_TRUE(flusher.Send(std::move(group)));
+
+    vector<SenderQueueItem*> items;
+    SenderQueueManager::GetInstance()->GetAllAvailableItems(items, false);
+    flusher.Write(items);
+}
+
+string FlusherFileUnittest::ReadFile(const filesystem::path& path) {
+    ifstream fin(path, ios::binary);
+    return string((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+}
+
+void FlusherFileUnittest::OnSuccessfulInit() {
+    unique_ptr<FlusherFile> flusher;
+    Json::Value configJson, optionalGoPipeline;
+    string configStr, errorMsg;
+
+    // only mandatory param
+    configStr = R"(
+        {
+            "Type": "flusher_file",
+            "FilePath": "/tmp/test.log"
+        }
+    )";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    flusher.reset(new FlusherFile());
+    flusher->SetContext(ctx);
+    flusher->SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher->Init(configJson, optionalGoPipeline));
+    APSARA_TEST_TRUE(optionalGoPipeline.isNull());
+    APSARA_TEST_EQUAL("/tmp/test.log", flusher->mFilePath);
+    APSARA_TEST_EQUAL(FlusherFile::Format::JSON, flusher->mFormat);
+    APSARA_TEST_EQUAL(100U * 1024 * 1024, flusher->mMaxFileSize);
+    APSARA_TEST_EQUAL(0U, flusher->mRotateIntervalSecs);
+    APSARA_TEST_EQUAL(5U, flusher->mMaxFiles);
+    APSARA_TEST_EQUAL(nullptr, flusher->mCompressor);
+    APSARA_TEST_NOT_EQUAL(nullptr, SenderQueueManager::GetInstance()->GetQueue(flusher->GetQueueKey()));
+
+    // valid optional param
+    configStr = R"(
+        {
+            "Type": "flusher_file",
+            "FilePath": "/tmp/test.log",
+            "Format": "protobuf",
+            "MaxFileSizeMB": 10,
+            "RotateIntervalSecs": 60,
+            "MaxFiles": 3,
+            "CompressType": "zstd"
+        }
+    )";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    flusher.reset(new FlusherFile());
+    flusher->SetContext(ctx);
+    flusher->SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher->Init(configJson, optionalGoPipeline));
+    APSARA_TEST_EQUAL(FlusherFile::Format::PROTOBUF, flusher->mFormat);
+    APSARA_TEST_EQUAL(10U * 1024 * 1024, flusher->mMaxFileSize);
+    APSARA_TEST_EQUAL(60U, flusher->mRotateIntervalSecs);
+    APSARA_TEST_EQUAL(3U, flusher->mMaxFiles);
+    APSARA_TEST_EQUAL(CompressType::ZSTD, flusher->mCompressor->GetCompressType());
+
+    // invalid optional param
+    configStr = R"(
+        {
+            "Type": "flusher_file",
+            "FilePath": "/tmp/test.log",
+            "Format": "csv",
+            "MaxFileSizeMB": "10",
+            "CompressType": "lz4"
+        }
+    )";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    flusher.reset(new FlusherFile());
+    flusher->SetContext(ctx);
+    flusher->SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher->Init(configJson, optionalGoPipeline));
+    APSARA_TEST_EQUAL(FlusherFile::Format::JSON, flusher->mFormat);
+    APSARA_TEST_EQUAL(100U * 1024 * 1024, flusher->mMaxFileSize);
+    APSARA_TEST_EQUAL(nullptr, flusher->mCompressor);
+}
+
+void FlusherFileUnittest::OnFailedInit() {
+    Json::Value configJson, optionalGoPipeline;
+    string configStr, errorMsg;
+
+    configStr = R"(
+        {
+            "Type": "flusher_file"
+        }
+    )";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    FlusherFile flusher;
+    flusher.SetContext(ctx);
+    flusher.SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_FALSE(flusher.Init(configJson, optionalGoPipeline));
+}
+
+void FlusherFileUnittest::TestSendJson() {
+    Json::Value configJson, optionalGoPipeline;
+    string errorMsg;
+    configJson["Type"] = "flusher_file";
+    configJson["FilePath"] = (sDir / "test.log").string();
+    FlusherFile flusher;
+    flusher.SetContext(ctx);
+    flusher.SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher.Init(configJson, optionalGoPipeline));
+    flusher.mBatcher.GetEventFlushStrategy().SetMaxCnt(1);
+
+    SendAndWrite(flusher, "value1");
+    SendAndWrite(flusher, "value2");
+    APSARA_TEST_EQUAL(
+        "{\"__time__\":1234567890,\"content_key\":\"value1\",\"__tag__:tag_key\":\"tag_value\"}\n"
+        "{\"__time__\":1234567890,\"content_key\":\"value2\",\"__tag__:tag_key\":\"tag_value\"}\n",
+        ReadFile(sDir / "test.log"));
+    APSARA_TEST_TRUE(SenderQueueManager::GetInstance()->IsAllQueueEmpty());
+}
+
+void FlusherFileUnittest::TestSendProtobuf() {
+    Json::Value configJson, optionalGoPipeline;
+    string errorMsg;
+    configJson["Type"] = "flusher_file";
+    configJson["FilePath"] = (sDir / "test.log").string();
+    configJson["Format"] = "protobuf";
+    FlusherFile flusher;
+    flusher.SetContext(ctx);
+    flusher.SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher.Init(configJson, optionalGoPipeline));
+    flusher.mBatcher.GetEventFlushStrategy().SetMaxCnt(1);
+
+    SendAndWrite(flusher, "value1");
+    SendAndWrite(flusher, "value2");
+    string content = ReadFile(sDir / "test.log");
+    size_t pos = 0;
+    for (const auto& value : {"value1", "value2"}) {
+        // size of each log group here is less than 128, so the varint prefix takes one byte
+        size_t size = static_cast<uint8_t>(content[pos]);
+        sls_logs::LogGroup logGroup;
+        APSARA_TEST_TRUE(logGroup.ParseFromString(content.substr(pos + 1, size)));
+        APSARA_TEST_EQUAL(1, logGroup.logs_size());
+        APSARA_TEST_EQUAL(value, logGroup.logs(0).contents(0).value());
+        APSARA_TEST_EQUAL(1, logGroup.logtags_size());
+        APSARA_TEST_EQUAL("tag_key", logGroup.logtags(0).key());
+        pos += 1 + size;
+    }
+    APSARA_TEST_EQUAL(content.size(), pos);
+}
+
+void FlusherFileUnittest::TestRotateBySize() {
+    Json::Value configJson, optionalGoPipeline;
+    string errorMsg;
+    configJson["Type"] = "flusher_file";
+    configJson["FilePath"] = (sDir / "test.log").string();
+    configJson["MaxFiles"] = 2;
+    FlusherFile flusher;
+    flusher.SetContext(ctx);
+    flusher.SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher.Init(configJson, optionalGoPipeline));
+    flusher.mBatcher.GetEventFlushStrategy().SetMaxCnt(1);
+    // each line written is larger than the limit, so that the file is rotated before each write
+    flusher.mMaxFileSize = 100;
+
+    SendAndWrite(flusher, string(60, 'a'));
+    SendAndWrite(flusher, string(60, 'b'));
+    SendAndWrite(flusher, string(60, 'c'));
+    SendAndWrite(flusher, string(60, 'd'));
+    APSARA_TEST_NOT_EQUAL(string::npos, ReadFile(sDir / "test.log").find(string(60, 'd')));
+    APSARA_TEST_NOT_EQUAL(string::npos, ReadFile(sDir / "test.log.1").find(string(60, 'c')));
+    APSARA_TEST_NOT_EQUAL(string::npos, ReadFile(sDir / "test.log.2").find(string(60, 'b')));
+    APSARA_TEST_FALSE(filesystem::exists(sDir / "test.log.3"));
+}
+
+void FlusherFileUnittest::TestTruncatePartialWrite() {
+    Json::Value configJson, optionalGoPipeline;
+    configJson["Type"] = "flusher_file";
+    configJson["FilePath"] = (sDir / "test.log").string();
+    FlusherFile flusher;
+    flusher.SetContext(ctx);
+    flusher.SetMetricsRecordRef(FlusherFile::sName, "1", "1", "1");
+    APSARA_TEST_TRUE(flusher.Init(configJson, optionalGoPipeline));
+    flusher.mBatcher.GetEventFlushStrategy().SetMaxCnt(1);
+
+    // the size of an existing file is taken on open
+    filesystem::create_directories(sDir);
+    {
+        ofstream fout(sDir / "test.log", ios::binary);
+        fout << "existing\n";
+    }
+    for (const auto& content : {string(60, 'a'), string(60, 'b')}) {
+        PipelineEventGroup group(make_shared<SourceBuffer>());
+        group.AddLogEvent()->SetContent(string("content_key"), content);
+        APSARA_TEST_TRUE(flusher.Send(std::move(group)));
+    }
+    vector<SenderQueueItem*> items;
+    SenderQueueManager::GetInstance()->GetAllAvailableItems(items, false);
+    APSARA_TEST_EQUAL_FATAL(2U, items.size());
+    string firstItem = items[0]->mData, secondItem = items[1]->mData;
+
+    // the second item is partially written before the file size limit is hit
+    rlimit oldLimit;
+    getrlimit(RLIMIT_FSIZE, &oldLimit);
+    auto oldHandler = signal(SIGXFSZ, SIG_IGN);
+    rlimit limit = oldLimit;
+    limit.rlim_cur = string("existing\n").size() + firstItem.size() + secondItem.size() / 2;
+    setrlimit(RLIMIT_FSIZE, &limit);
+    flusher.Write(items);
+    setrlimit(RLIMIT_FSIZE, &oldLimit);
+    signal(SIGXFSZ, oldHandler);
+    APSARA_TEST_EQUAL("existing\n" + firstItem, ReadFile(sDir / "test.log"));
+
+    // the second item is written again from start
+    items.clear();
+    SenderQueueManager::GetInstance()->GetAllAvailableItems(items, false);
+    APSARA_TEST_EQUAL_FATAL(1U, items.size());
+    flusher.Write(items);
+    APSARA_TEST_EQUAL("existing\n" + firstItem + secondItem, ReadFile(sDir / "test.log"));
+    APSARA_TEST_EQUAL(filesystem::file_size(sDir / "test.log"), flusher.mFileSize);
+}
+
+UNIT_TEST_CASE(FlusherFileUnittest, OnSuccessfulInit)
+UNIT_TEST_CASE(FlusherFileUnittest, OnFailedInit)
+UNIT_TEST_CASE(FlusherFileUnittest, TestSendJson)
+UNIT_TEST_CASE(FlusherFileUnittest, TestSendProtobuf)
+UNIT_TEST_CASE(FlusherFileUnittest, TestRotateBySize)
+UNIT_TEST_CASE(FlusherFileUnittest, TestTruncatePartialWrite)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
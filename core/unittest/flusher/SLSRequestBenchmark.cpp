@@ -0,0 +1,81 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "common/TimeUtil.h"
+#include "logger/Logger.h"
+#include "sdk/Client.h"
+#include "sdk/Common.h"
+
+using namespace std;
+using namespace logtail;
+
+// Build the request the way it was done before headers and signing were cached per logstore.
+static unique_ptr<HttpSinkRequest> BuildRequestFromScratch(sdk::Client& client, const string& body, uint32_t rawSize) {
+    map<string, string> httpHeader;
+    httpHeader[sdk::CONTENT_TYPE] = sdk::TYPE_LOG_PROTOBUF;
+    httpHeader[sdk::X_LOG_BODYRAWSIZE] = to_string(rawSize);
+    httpHeader[sdk::X_LOG_COMPRESSTYPE] = sdk::Client::GetCompressTypeString(sls_logs::SLS_CMP_LZ4);
+    httpHeader[sdk::CONTENT_MD5] = sdk::CalcMD5(body);
+    httpHeader[sdk::HOST] = "project" + client.GetHostFieldSuffix();
+    httpHeader[sdk::USER_AGENT] = "ali-log-logtail";
+    httpHeader[sdk::X_LOG_APIVERSION] = sdk::LOG_API_VERSION;
+    httpHeader[sdk::X_LOG_SIGNATUREMETHOD] = sdk::HMAC_SHA1;
+    httpHeader[sdk::DATE] = sdk::GetDateString(DATE_FORMAT_RFC822);
+    httpHeader[sdk::CONTENT_LENGTH] = to_string(body.size());
+    string operation = "/logstores/logstore/shards/lb";
+    map<string, string> parameterList;
+    string signature
+        = sdk::GetUrlSignature(sdk::HTTP_POST, operation, httpHeader, parameterList, body, client.GetAccessKey());
+    httpHeader[sdk::AUTHORIZATION] = sdk::LOG_HEADSIGNATURE_PREFIX + client.GetAccessKeyId() + ':' + signature;
+    return make_unique<HttpSinkRequest>(
+        sdk::HTTP_POST, false, client.GetHost("project"), 80, operation, "", httpHeader, body, nullptr);
+}
+
+static void BM_BuildRequest(size_t bodySize, int batchSize) {
+    sdk::Client client("cn-hangzhou.log.aliyuncs.com", "accessKeyId", "accessKeySecret");
+    string body(bodySize, 'a');
+
+    uint64_t startTime = GetCurrentTimeInMicroSeconds();
+    for (int i = 0; i < batchSize; ++i) {
+        auto request = BuildRequestFromScratch(client, body, bodySize * 4);
+    }
+    uint64_t scratchTime = GetCurrentTimeInMicroSeconds() - startTime;
+
+    startTime = GetCurrentTimeInMicroSeconds();
+    for (int i = 0; i < batchSize; ++i) {
+        auto request = client.CreatePostLogStoreLogsRequest(
+            "project", "logstore", sls_logs::SLS_CMP_LZ4, body, bodySize * 4, nullptr);
+    }
+    uint64_t templateTime = GetCurrentTimeInMicroSeconds() - startTime;
+
+    cout << "body size: " << bodySize << "\tfrom scratch: " << scratchTime * 1000 / batchSize
+         << " ns/req\twith template: " << templateTime * 1000 / batchSize << " ns/req" << endl;
+}
+
+int main(int argc, char** argv) {
+    logtail::Logger::Instance().InitGlobalLoggers();
+#ifdef NDEBUG
+    std::cout << "release" << std::endl;
+#else
+    std::cout << "debug" << std::endl;
+#endif
+    for (size_t bodySize : {256, 4 * 1024, 64 * 1024, 512 * 1024}) {
+        BM_BuildRequest(bodySize, 10000);
+    }
+    return 0;
+}
@@ -24,6 +24,7 @@ class LogEventUnittest : public ::testing::Test {
 public:
     void TestTimestampOp();
     void TestSetContent();
+    void TestSetContents();
     void TestDelContent();
     void TestReadContentOp();
     void TestIterateContent();
@@ -84,6 +85,27 @@ void LogEventUnittest::TestSetContent() {
     }
 }
 
+void LogEventUnittest::TestSetContents() {
+    mLogEvent->SetContent(string("key1"), string("value1"));
+    size_t size = mLogEvent->DataSize();
+    string key2("key2"), key3("key3");
+    string value("value");
+    // existing keys are overwritten in place, and later contents win
+    mLogEvent->SetContentsNoCopy({{StringView(key2), StringView(value)},
+                                  {StringView("key1"), StringView(value)},
+                                  {StringView(key3), StringView(value)},
+                                  {StringView(key2), StringView(value.data(), 3)}});
+    APSARA_TEST_EQUAL(3U, mLogEvent->Size());
+    APSARA_TEST_EQUAL(size + 4 + 3 + 4 + 5 - 1, mLogEvent->DataSize());
+    vector<pair<string, string>> answers = {{"key1", "value"}, {"key2", "val"}, {"key3", "value"}};
+    size_t i = 0;
+    for (const auto& content : *mLogEvent) {
+        APSARA_TEST_EQUAL(answers[i].first, content.first.to_string());
+        APSARA_TEST_EQUAL(answers[i].second, content.second.to_string());
+        ++i;
+    }
+}
+
 void LogEventUnittest::TestDelContent() {
     mLogEvent->SetContent(string("key1"), string("value1"));
     {
@@ -204,6 +226,7 @@ void LogEventUnittest::TestFromJsonToJson() {
 
 UNIT_TEST_CASE(LogEventUnittest, TestTimestampOp)
 UNIT_TEST_CASE(LogEventUnittest, TestSetContent)
+UNIT_TEST_CASE(LogEventUnittest, TestSetContents)
 UNIT_TEST_CASE(LogEventUnittest, TestDelContent)
 UNIT_TEST_CASE(LogEventUnittest, TestReadContentOp)
 UNIT_TEST_CASE(LogEventUnittest, TestIterateContent)
@@ -16,6 +16,7 @@
 
 #include "common/JsonUtil.h"
 #include "models/PipelineEventGroup.h"
+#include "models/TagInterner.h"
 #include "unittest/Unittest.h"
 
 namespace logtail {
@@ -27,6 +28,9 @@ public:
     void TestSetMetadata();
     void TestDelMetadata();
     void TestFromJsonToJson();
+    void TestGetTagsHash();
+    void TestInternTag();
+    void TestSetTagsNoCopy();
 
 protected:
     void SetUp() override {
@@ -135,11 +139,90 @@ void PipelineEventGroupUnittest::TestFromJsonToJson() {
     APSARA_TEST_STREQ_FATAL(CompactJson(inJson).c_str(), CompactJson(outJson).c_str());
 }
 
+void PipelineEventGroupUnittest::TestGetTagsHash() {
+    mEventGroup->SetTag(std::string("key1"), std::string("value1"));
+    mEventGroup->SetTag(std::string("key2"), std::string("value2"));
+    size_t hash = mEventGroup->GetTagsHash();
+
+    // same tags in another buffer give the same hash
+    PipelineEventGroup group(std::make_shared<SourceBuffer>());
+    group.SetTag(std::string("key2"), std::string("value2"));
+    group.SetTag(std::string("key1"), std::string("value1"));
+    APSARA_TEST_EQUAL(hash, group.GetTagsHash());
+
+    mEventGroup->SetTag(std::string("key1"), std::string("value3"));
+    APSARA_TEST_NOT_EQUAL(hash, mEventGroup->GetTagsHash());
+    mEventGroup->SetTag(std::string("key1"), std::string("value1"));
+    APSARA_TEST_EQUAL(hash, mEventGroup->GetTagsHash());
+
+    mEventGroup->SetMetadata(EventGroupMetaKey::SOURCE_ID, std::string("source"));
+    APSARA_TEST_NOT_EQUAL(hash, mEventGroup->GetTagsHash());
+    mEventGroup->DelMetadata(EventGroupMetaKey::SOURCE_ID);
+    APSARA_TEST_EQUAL(hash, mEventGroup->GetTagsHash());
+
+    // tags hash is kept up to date as tags change
+    mEventGroup->DelTag("key2");
+    APSARA_TEST_TRUE(mEventGroup->mTagsHashValid);
+    APSARA_TEST_NOT_EQUAL(hash, mEventGroup->GetTagsHash());
+    // and recomputed once tags are changed through the sized map
+    mEventGroup->GetSizedTags().Insert("key2", "value2");
+    APSARA_TEST_FALSE(mEventGroup->mTagsHashValid);
+    APSARA_TEST_EQUAL(hash, mEventGroup->GetTagsHash());
+    APSARA_TEST_TRUE(mEventGroup->mTagsHashValid);
+
+    PipelineEventGroup movedGroup(std::move(*mEventGroup));
+    APSARA_TEST_TRUE(movedGroup.mTagsHashValid);
+    APSARA_TEST_EQUAL(hash, movedGroup.GetTagsHash());
+}
+
+void PipelineEventGroupUnittest::TestInternTag() {
+    std::string value = "interned_value";
+    StringView view1 = TagInterner::GetInstance()->Intern(value);
+    size_t size = TagInterner::GetInstance()->Size();
+    StringView view2 = TagInterner::GetInstance()->Intern(StringView(value));
+    APSARA_TEST_EQUAL(view1.data(), view2.data());
+    APSARA_TEST_EQUAL(size, TagInterner::GetInstance()->Size());
+    APSARA_TEST_EQUAL(value, view1.to_string());
+    APSARA_TEST_NOT_EQUAL(value.data(), view1.data());
+
+    mEventGroup->SetTagNoCopy(TagInterner::GetInstance()->Intern("key"), view1);
+    APSARA_TEST_EQUAL(view1.data(), mEventGroup->GetTag("key").data());
+}
+
+void PipelineEventGroupUnittest::TestSetTagsNoCopy() {
+    TagSet tags;
+    tags.Add("key1", "value0");
+    tags.Add("key2", "value2");
+    tags.Add("key1", "value1");
+    APSARA_TEST_EQUAL(2U, tags.GetTags().size());
+
+    mEventGroup->SetTag(std::string("key1"), std::string("value3"));
+    mEventGroup->SetTagsNoCopy(tags);
+    APSARA_TEST_EQUAL(2U, mEventGroup->GetTags().size());
+    APSARA_TEST_EQUAL("value1", mEventGroup->GetTag("key1").to_string());
+    APSARA_TEST_EQUAL(TagInterner::GetInstance()->Intern("value2").data(), mEventGroup->GetTag("key2").data());
+    APSARA_TEST_EQUAL(tags.GetHash(), mEventGroup->mTagsHash);
+
+    // the same hash as tags copied one by one
+    PipelineEventGroup group(std::make_shared<SourceBuffer>());
+    group.SetTag(std::string("key2"), std::string("value2"));
+    group.SetTag(std::string("key1"), std::string("value1"));
+    APSARA_TEST_EQUAL(group.GetTagsHash(), mEventGroup->GetTagsHash());
+
+    mEventGroup->SetTag(std::string("key3"), std::string("value3"));
+    APSARA_TEST_NOT_EQUAL(group.GetTagsHash(), mEventGroup->GetTagsHash());
+    mEventGroup->DelTag("key3");
+    APSARA_TEST_EQUAL(group.GetTagsHash(), mEventGroup->GetTagsHash());
+}
+
 UNIT_TEST_CASE(PipelineEventGroupUnittest, TestSwapEvents)
 UNIT_TEST_CASE(PipelineEventGroupUnittest, TestCopy)
 UNIT_TEST_CASE(PipelineEventGroupUnittest, TestSetMetadata)
 UNIT_TEST_CASE(PipelineEventGroupUnittest, TestDelMetadata)
 UNIT_TEST_CASE(PipelineEventGroupUnittest, TestFromJsonToJson)
+UNIT_TEST_CASE(PipelineEventGroupUnittest, TestGetTagsHash)
+UNIT_TEST_CASE(PipelineEventGroupUnittest, TestInternTag)
+UNIT_TEST_CASE(PipelineEventGroupUnittest, TestSetTagsNoCopy)
 
 } // namespace logtail
 
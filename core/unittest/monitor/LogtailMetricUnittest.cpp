@@ -13,15 +13,20 @@
 // limitations under the License.
 
 #include "unittest/Unittest.h"
+#include <array>
 #include <fstream>
 #include <json/json.h>
 #include <list>
 #include <atomic>
 #include <thread>
 #include "LogtailMetric.h"
+#include "common/Flags.h"
+#include "common/JsonUtil.h"
 #include "MetricExportor.h"
 #include "MetricConstants.h"
 
+DECLARE_FLAG_INT32(stage_latency_sample_interval);
+
 namespace logtail {
 
 
@@ -40,11 +45,17 @@ public:
     void TestCreateMetricAutoDelete();
     void TestCreateMetricAutoDeleteMultiThread();
     void TestCreateAndDeleteMetric();
+    void TestHistogram();
+    void TestShardedCounter();
+    void TestShouldSampleStageLatency();
 };
 
 APSARA_UNIT_TEST_CASE(ILogtailMetricUnittest, TestCreateMetricAutoDelete, 0);
 APSARA_UNIT_TEST_CASE(ILogtailMetricUnittest, TestCreateMetricAutoDeleteMultiThread, 1);
 APSARA_UNIT_TEST_CASE(ILogtailMetricUnittest, TestCreateAndDeleteMetric, 2);
+APSARA_UNIT_TEST_CASE(ILogtailMetricUnittest, TestHistogram, 3);
+APSARA_UNIT_TEST_CASE(ILogtailMetricUnittest, TestShardedCounter, 4);
+APSARA_UNIT_TEST_CASE(ILogtailMetricUnittest, TestShouldSampleStageLatency, 5);
 
 
 void ILogtailMetricUnittest::TestCreateMetricAutoDelete() {
@@ -328,6 +339,108 @@ void ILogtailMetricUnittest::TestCreateAndDeleteMetric() {
     delete fileMetric1;
 }
 
+void ILogtailMetricUnittest::TestHistogram() {
+    APSARA_TEST_EQUAL(0U, Histogram::GetBucketIndex(0));
+    APSARA_TEST_EQUAL(1U, Histogram::GetBucketIndex(1));
+    APSARA_TEST_EQUAL(3U, Histogram::GetBucketIndex(3));
+    APSARA_TEST_EQUAL(4U, Histogram::GetBucketIndex(4));
+    APSARA_TEST_EQUAL(8U, Histogram::GetBucketIndex(8));
+    APSARA_TEST_EQUAL(8U, Histogram::GetBucketIndex(9));
+    APSARA_TEST_EQUAL(9U, Histogram::GetBucketIndex(10));
+    APSARA_TEST_EQUAL(36U, Histogram::GetBucketIndex(1024));
+    APSARA_TEST_EQUAL(36U, Histogram::GetBucketIndex(1279));
+    APSARA_TEST_EQUAL(37U, Histogram::GetBucketIndex(1280));
+    APSARA_TEST_EQUAL(Histogram::sBucketCnt - 1, Histogram::GetBucketIndex(UINT64_MAX));
+    APSARA_TEST_EQUAL(4U, Histogram::GetBucketUpperBound(3));
+    APSARA_TEST_EQUAL(10U, Histogram::GetBucketUpperBound(8));
+    APSARA_TEST_EQUAL(1280U, Histogram::GetBucketUpperBound(36));
+    APSARA_TEST_EQUAL(UINT64_MAX, Histogram::GetBucketUpperBound(Histogram::sBucketCnt - 1));
+    // buckets are contiguous
+    for (size_t i = Histogram::sSubBucketCnt; i + 1 < Histogram::sBucketCnt; ++i) {
+        APSARA_TEST_EQUAL(i, Histogram::GetBucketIndex(Histogram::GetBucketUpperBound(i) - 1));
+        APSARA_TEST_EQUAL(i + 1, Histogram::GetBucketIndex(Histogram::GetBucketUpperBound(i)));
+    }
+
+    MetricsRecordRef record;
+    WriteMetrics::GetInstance()->PrepareMetricsRecordRef(record, {{"project", "project1"}});
+    HistogramPtr histogram = record.CreateHistogram("latency_ns");
+    histogram->Observe(600);
+    histogram->Observe(900);
+    histogram->Observe(3000);
+    APSARA_TEST_EQUAL(3U, histogram->GetCount());
+    APSARA_TEST_EQUAL(4500U, histogram->GetSum());
+    APSARA_TEST_EQUAL(1U, histogram->GetBucketCount(Histogram::GetBucketIndex(600)));
+    APSARA_TEST_EQUAL(1U, histogram->GetBucketCount(Histogram::GetBucketIndex(900)));
+
+    ReadMetrics::GetInstance()->UpdateMetrics();
+    // collection takes the delta
+    APSARA_TEST_EQUAL(0U, histogram->GetCount());
+    MetricsRecord* tmp = ReadMetrics::GetInstance()->GetHead();
+    APSARA_TEST_EQUAL(1U, tmp->GetHistograms().size());
+    APSARA_TEST_EQUAL(3U, tmp->GetHistograms()[0]->GetCount());
+
+    std::string content;
+    ReadMetrics::GetInstance()->ReadAsFileBuffer(content);
+    Json::Value res;
+    std::string errorMsg;
+    APSARA_TEST_TRUE(ParseJsonTable(content, res, errorMsg));
+    APSARA_TEST_EQUAL("3", res["value.latency_ns_count"].asString());
+    APSARA_TEST_EQUAL("4500", res["value.latency_ns_sum"].asString());
+    APSARA_TEST_EQUAL("1", res["value.latency_ns_bucket_lt_640"].asString());
+    APSARA_TEST_EQUAL("1", res["value.latency_ns_bucket_lt_1024"].asString());
+    APSARA_TEST_EQUAL("1", res["value.latency_ns_bucket_lt_3072"].asString());
+}
+
+void ILogtailMetricUnittest::TestShardedCounter() {
+    MetricsRecordRef record;
+    WriteMetrics::GetInstance()->PrepareMetricsRecordRef(record, {{"project", "project1"}});
+    CounterPtr counter = record.CreateCounter("in_events_total");
+
+    // more threads than shards, so that some shards are shared
+    size_t threadCnt = counter->GetShardCnt() + 4;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCnt; ++i) {
+        threads.emplace_back([counter]() {
+            for (int j = 0; j < 1000; ++j) {
+                counter->Add(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    APSARA_TEST_EQUAL(threadCnt * 1000, counter->GetValue());
+
+    ReadMetrics::GetInstance()->UpdateMetrics();
+    APSARA_TEST_EQUAL(0U, counter->GetValue());
+    MetricsRecord* tmp = ReadMetrics::GetInstance()->GetHead();
+    APSARA_TEST_EQUAL(1U, tmp->GetCounters().size());
+    APSARA_TEST_EQUAL(threadCnt * 1000, tmp->GetCounters()[0]->GetValue());
+    APSARA_TEST_EQUAL(1U, tmp->GetCounters()[0]->GetShardCnt());
+}
+
+void ILogtailMetricUnittest::TestShouldSampleStageLatency() {
+    int32_t interval = INT32_FLAG(stage_latency_sample_interval);
+    INT32_FLAG(stage_latency_sample_interval) = 2;
+    // interleaved calls from different stages must not alias, so every stage is sampled every other call
+    std::array<int, static_cast<size_t>(LatencyStage::COUNT)> sampled{};
+    for (int i = 0; i < 10; ++i) {
+        for (auto stage : {LatencyStage::PROCESS, LatencyStage::PROCESS_QUEUE, LatencyStage::SENDER_QUEUE}) {
+            if (ShouldSampleStageLatency(stage)) {
+                ++sampled[static_cast<size_t>(stage)];
+            }
+        }
+    }
+    for (int cnt : sampled) {
+        APSARA_TEST_EQUAL(5, cnt);
+    }
+
+    INT32_FLAG(stage_latency_sample_interval) = 0;
+    APSARA_TEST_FALSE(ShouldSampleStageLatency(LatencyStage::PROCESS));
+    APSARA_TEST_FALSE(ShouldSampleStageLatency(LatencyStage::PROCESS));
+    INT32_FLAG(stage_latency_sample_interval) = interval;
+}
+
 } // namespace logtail
 
 int main(int argc, char** argv) {
@@ -0,0 +1,145 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+
+#include "network/protocols/LatencySketch.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class LatencySketchUnittest : public ::testing::Test {
+public:
+    void TestQuantile();
+    void TestMerge();
+    void TestClear();
+    void TestToString();
+    void TestCollapse();
+};
+
+static bool IsNear(double actual, double expected) {
+    return fabs(actual - expected) <= expected * LatencySketch::kRelativeAccuracy;
+}
+
+void LatencySketchUnittest::TestQuantile() {
+    LatencySketch sketch;
+    APSARA_TEST_TRUE(sketch.IsEmpty());
+    APSARA_TEST_EQUAL(0.0, sketch.GetQuantile(0.5));
+
+    // 1000, 2000, ..., 1000000 ns
+    for (int64_t i = 1; i <= 1000; ++i) {
+        sketch.Add(i * 1000);
+    }
+    APSARA_TEST_EQUAL(1000U, sketch.GetCount());
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(0), 1000));
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(0.5), 500000));
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(0.9), 900000));
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(0.99), 990000));
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(1), 1000000));
+
+    // values no more than 1 are counted as 0
+    LatencySketch zero;
+    zero.Add(0, 3);
+    zero.Add(100);
+    APSARA_TEST_EQUAL(4U, zero.GetCount());
+    APSARA_TEST_EQUAL(0.0, zero.GetQuantile(0.5));
+    APSARA_TEST_TRUE(IsNear(zero.GetQuantile(1), 100));
+}
+
+void LatencySketchUnittest::TestMerge() {
+    LatencySketch all, low, high;
+    for (int64_t i = 1; i <= 500; ++i) {
+        all.Add(i * 10);
+        low.Add(i * 10);
+    }
+    for (int64_t i = 501; i <= 1000; ++i) {
+        all.Add(i * 10000);
+        high.Add(i * 10000);
+    }
+    high.Add(0);
+    all.Add(0);
+
+    // merging into the sketch with higher range extends it downwards
+    high.Merge(low);
+    APSARA_TEST_EQUAL(all.GetCount(), high.GetCount());
+    APSARA_TEST_EQUAL(all.mZeroCount, high.mZeroCount);
+    APSARA_TEST_EQUAL(all.mOffset, high.mOffset);
+    APSARA_TEST_TRUE(all.mCounts == high.mCounts);
+    for (double q : {0.1, 0.5, 0.9, 0.99}) {
+        APSARA_TEST_EQUAL(all.GetQuantile(q), high.GetQuantile(q));
+    }
+
+    LatencySketch empty;
+    high.Merge(empty);
+    APSARA_TEST_EQUAL(all.GetCount(), high.GetCount());
+    empty.Merge(all);
+    APSARA_TEST_EQUAL(all.ToString(), empty.ToString());
+}
+
+void LatencySketchUnittest::TestClear() {
+    LatencySketch sketch;
+    sketch.Add(1000);
+    sketch.Add(100000);
+    size_t bucketCnt = sketch.mCounts.size();
+    sketch.Clear();
+    APSARA_TEST_TRUE(sketch.IsEmpty());
+    APSARA_TEST_EQUAL(bucketCnt, sketch.mCounts.size());
+    APSARA_TEST_EQUAL(0.0, sketch.GetQuantile(0.99));
+
+    sketch.Add(5000);
+    APSARA_TEST_EQUAL(1U, sketch.GetCount());
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(0.5), 5000));
+}
+
+void LatencySketchUnittest::TestToString() {
+    LatencySketch sketch;
+    APSARA_TEST_TRUE(sketch.ToString().find("\"zero\":0,\"offset\":0,\"counts\":[]}") != string::npos);
+
+    sketch.Add(0);
+    sketch.Add(1000, 2);
+    sketch.Add(100000);
+    sketch.Clear();
+    sketch.Add(1000, 2);
+    // emptied buckets at both ends are skipped
+    string expected = ",\"zero\":0,\"offset\":" + to_string(sketch.mOffset) + ",\"counts\":[2]}";
+    string res = sketch.ToString();
+    APSARA_TEST_EQUAL(0, res.compare(res.size() - expected.size(), expected.size(), expected));
+}
+
+void LatencySketchUnittest::TestCollapse() {
+    LatencySketch sketch;
+    sketch.Add(2);
+    // far beyond the range of kMaxBucketCnt buckets
+    sketch.Add(INT64_MAX / 2);
+    APSARA_TEST_EQUAL(LatencySketch::kMaxBucketCnt, sketch.mCounts.size());
+    APSARA_TEST_EQUAL(2U, sketch.GetCount());
+    APSARA_TEST_TRUE(IsNear(sketch.GetQuantile(1), static_cast<double>(INT64_MAX / 2)));
+
+    // values below the lowest bucket kept fall into it
+    sketch.Add(2);
+    APSARA_TEST_EQUAL(LatencySketch::kMaxBucketCnt, sketch.mCounts.size());
+    APSARA_TEST_EQUAL(2U, sketch.mCounts[0]);
+}
+
+UNIT_TEST_CASE(LatencySketchUnittest, TestQuantile)
+UNIT_TEST_CASE(LatencySketchUnittest, TestMerge)
+UNIT_TEST_CASE(LatencySketchUnittest, TestClear)
+UNIT_TEST_CASE(LatencySketchUnittest, TestToString)
+UNIT_TEST_CASE(LatencySketchUnittest, TestCollapse)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -238,6 +238,24 @@ public:
         inferMySQL();
     }
 
+    void TestMetricTagsOwnKeys() {
+        PipelineEventGroup group(std::make_shared<SourceBuffer>());
+        ObserverMetricTags tags(*group.GetSourceBuffer());
+        {
+            // e.g. tags of a config released before the group is sent
+            std::string key = "config_tag_key";
+            std::string value = "config_tag_value";
+            tags.Add(key, StringView(value));
+        }
+        AddAnyMetricTag(tags, observer::kInterval, 15);
+        AddObserverMetric(group, tags, "test_metric", 1.0, 0);
+
+        APSARA_TEST_EQUAL_FATAL(1U, group.GetEvents().size());
+        const auto& event = group.GetEvents()[0].Cast<MetricEvent>();
+        APSARA_TEST_EQUAL("config_tag_value", event.GetTag("config_tag_key").to_string());
+        APSARA_TEST_EQUAL("15", event.GetTag(observer::kInterval).to_string());
+    }
+
     NetworkObserver* mObserver = NetworkObserver::GetInstance();
 };
 
@@ -248,6 +266,7 @@ APSARA_UNIT_TEST_CASE(NetworkObserverUnittest, TestToPB, 0);
 APSARA_UNIT_TEST_CASE(NetworkObserverUnittest, TestRawPacketUDPReader, 0);
 APSARA_UNIT_TEST_CASE(NetworkObserverUnittest, TestRawPacketTCPReader, 0);
 APSARA_UNIT_TEST_CASE(NetworkObserverUnittest, TestInferProtocol, 0);
+APSARA_UNIT_TEST_CASE(NetworkObserverUnittest, TestMetricTagsOwnKeys, 0);
 } // namespace logtail
 
 
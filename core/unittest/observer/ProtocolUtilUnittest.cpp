@@ -130,6 +130,125 @@ public:
         APSARA_TEST_EQUAL(v12 < v10, false);
     }
 
+    static MySQLProtocolEvent MakeAggEvent(const std::string& query, PacketRoleType role = PacketRoleType::Server) {
+        MySQLProtocolEvent event;
+        event.Key.ConnKey.HashVal = 1;
+        event.Key.ConnKey.Role = role;
+        event.Key.ConnKey.RemoteIp = "10.0.0.1";
+        event.Key.Query = query;
+        event.Info.LatencyNs = 1000;
+        return event;
+    }
+
+    static std::string GetLogContent(const sls_logs::Log& log, const std::string& key) {
+        for (const auto& content : log.contents()) {
+            if (content.key() == key) {
+                return content.value();
+            }
+        }
+        return "";
+    }
+
+    void TestAggregatorEviction() {
+        MySQLProtocolEventAggregator aggregator(2, 4);
+        APSARA_TEST_EQUAL(8U, aggregator.mSlots.size());
+        for (int i = 0; i < 10; ++i) {
+            APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("hot")));
+        }
+        for (int i = 1; i <= 9; ++i) {
+            APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("cold" + std::to_string(i))));
+        }
+        // client limit is reached
+        APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("client", PacketRoleType::Client)));
+        APSARA_TEST_FALSE(aggregator.AddEvent(MakeAggEvent("unknown", PacketRoleType::Unknown)));
+        APSARA_TEST_EQUAL(4U, aggregator.mSize);
+
+        std::vector<sls_logs::Log> logs;
+        google::protobuf::RepeatedPtrField<sls_logs::Log_Content> globalTags;
+        aggregator.FlushLogs(logs, "", globalTags, 15);
+        // the overflow item comes first, and the client key evicts a server key
+        APSARA_TEST_EQUAL(5U, logs.size());
+        APSARA_TEST_EQUAL(PacketRoleTypeToString(PacketRoleType::Server), GetLogContent(logs[0], observer::kRole));
+        APSARA_TEST_EQUAL(observer::kOverflowValue, GetLogContent(logs[0], observer::kQuery));
+        APSARA_TEST_EQUAL(observer::kOverflowValue, GetLogContent(logs[0], observer::kRemoteAddr));
+        bool foundHot = false, foundClient = false;
+        int64_t total = 0;
+        for (const auto& log : logs) {
+            if (GetLogContent(log, observer::kQuery) == "hot") {
+                foundHot = true;
+                APSARA_TEST_EQUAL("10", GetLogContent(log, observer::kCount));
+            } else if (GetLogContent(log, observer::kQuery) == "client") {
+                foundClient = true;
+            }
+            total += std::stoll(GetLogContent(log, observer::kCount));
+        }
+        APSARA_TEST_TRUE(foundClient);
+        APSARA_TEST_TRUE(foundHot);
+        APSARA_TEST_EQUAL(20, total);
+
+        // items without events in the last interval are removed
+        logs.clear();
+        aggregator.FlushLogs(logs, "", globalTags, 15);
+        APSARA_TEST_EQUAL(0U, logs.size());
+        APSARA_TEST_EQUAL(0U, aggregator.mSize);
+        for (const auto& slot : aggregator.mSlots) {
+            APSARA_TEST_EQUAL(MySQLProtocolEventAggItemManager::kInvalidIndex, slot.Index);
+        }
+
+        // pooled items are reused
+        for (int i = 0; i < 4; ++i) {
+            APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("new" + std::to_string(i))));
+        }
+        APSARA_TEST_EQUAL(4U, aggregator.mAggItemManager.mAllocated);
+    }
+
+    void TestAggregatorEraseSlot() {
+        MySQLProtocolEventAggregator aggregator(16, 16);
+        for (int i = 0; i < 16; ++i) {
+            APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("q" + std::to_string(i))));
+        }
+        std::vector<sls_logs::Log> logs;
+        google::protobuf::RepeatedPtrField<sls_logs::Log_Content> globalTags;
+        aggregator.FlushLogs(logs, "", globalTags, 15);
+        // keep half of keys, so that the others are removed by the next flush
+        for (int i = 0; i < 16; i += 2) {
+            APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("q" + std::to_string(i))));
+        }
+        logs.clear();
+        aggregator.FlushLogs(logs, "", globalTags, 15);
+        APSARA_TEST_EQUAL(8U, logs.size());
+        APSARA_TEST_EQUAL(8U, aggregator.mSize);
+        // remaining keys can still be found after deletion
+        for (int i = 0; i < 16; i += 2) {
+            APSARA_TEST_TRUE(aggregator.AddEvent(MakeAggEvent("q" + std::to_string(i))));
+        }
+        APSARA_TEST_EQUAL(8U, aggregator.mSize);
+    }
+
+    void TestAggregatorHashCollision() {
+        MySQLProtocolEventAggregator aggregator(16, 16);
+        MySQLProtocolEvent first = MakeAggEvent("first");
+        MySQLProtocolEvent second = MakeAggEvent("second");
+        uint64_t hashVal = second.Key.Hash();
+        APSARA_TEST_TRUE(aggregator.AddEvent(std::move(first)));
+        // make the key stored collide with the next one
+        for (auto& slot : aggregator.mSlots) {
+            if (slot.Index != MySQLProtocolEventAggItemManager::kInvalidIndex) {
+                slot.Hash = hashVal;
+            }
+        }
+        APSARA_TEST_TRUE(aggregator.AddEvent(std::move(second)));
+        APSARA_TEST_EQUAL(2U, aggregator.mSize);
+
+        std::vector<sls_logs::Log> logs;
+        google::protobuf::RepeatedPtrField<sls_logs::Log_Content> globalTags;
+        aggregator.FlushLogs(logs, "", globalTags, 15);
+        APSARA_TEST_EQUAL(2U, logs.size());
+        for (const auto& log : logs) {
+            APSARA_TEST_EQUAL("1", GetLogContent(log, observer::kCount));
+        }
+    }
+
     void PrintCache(TestCache& cache, ExpectTestCacheMeta meta) {
         std::cout << "=============================\n"
                   << "req head: " << cache.mHeadRequestsIdx << "req tail:" << cache.mTailRequestsIdx
@@ -339,6 +458,9 @@ APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestCommonCacheContinueOneByOneAndRe
 APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestCommonCacheInsertOldResp, 0);
 APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestCommonCacheInsertNewReq, 0);
 APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestCommonCacheTryMatchingReq, 0);
+APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestAggregatorEviction, 0);
+APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestAggregatorEraseSlot, 0);
+APSARA_UNIT_TEST_CASE(ProtocolUtilUnittest, TestAggregatorHashCollision, 0);
 } // namespace logtail
 
 
@@ -47,6 +47,7 @@ public:
     void TestProcess() const;
     void TestSend() const;
     void TestFlushBatch() const;
+    void TestStartAndStop() const;
 
 protected:
     static void SetUpTestCase() {
@@ -59,7 +60,7 @@ protected:
     static void TearDownTestCase() { PluginRegistry::GetInstance()->UnloadPlugins(); }
 
     void TearDown() override {
-        TimeoutFlushManager::GetInstance()->mTimeoutRecords.clear();
+        TimeoutFlushManager::GetInstance()->GetShard(configName).mTimeoutRecords.clear();
         QueueKeyManager::GetInstance()->Clear();
         ProcessQueueManager::GetInstance()->Clear();
     }
@@ -2814,7 +2815,7 @@ void PipelineUnittest::TestFlushBatch() const {
         TimeoutFlushManager::GetInstance()->UpdateRecord(configName, 0, 1, 3, nullptr);
         TimeoutFlushManager::GetInstance()->UpdateRecord(configName, 1, 1, 3, nullptr);
         APSARA_TEST_TRUE(pipeline.FlushBatch());
-        APSARA_TEST_TRUE(TimeoutFlushManager::GetInstance()->mTimeoutRecords.empty());
+        APSARA_TEST_TRUE(TimeoutFlushManager::GetInstance()->GetShard(configName).mTimeoutRecords.empty());
     }
     {
         // some failed
@@ -2822,7 +2823,33 @@ void PipelineUnittest::TestFlushBatch() const {
         TimeoutFlushManager::GetInstance()->UpdateRecord(configName, 0, 1, 3, nullptr);
         TimeoutFlushManager::GetInstance()->UpdateRecord(configName, 1, 1, 3, nullptr);
         APSARA_TEST_FALSE(pipeline.FlushBatch());
-        APSARA_TEST_TRUE(TimeoutFlushManager::GetInstance()->mTimeoutRecords.empty());
+        APSARA_TEST_TRUE(TimeoutFlushManager::GetInstance()->GetShard(configName).mTimeoutRecords.empty());
+    }
+}
+
+void PipelineUnittest::TestStartAndStop() const {
+    Pipeline pipeline;
+    pipeline.mName = configName;
+    auto key = QueueKeyManager::GetInstance()->GetKey(configName);
+    ProcessQueueManager::GetInstance()->CreateOrUpdateBoundedQueue(key, 0);
+    auto& queue = *ProcessQueueManager::GetInstance()->mQueues[key].first;
+    {
+        // only the process queue of the pipeline is invalidated to pop
+        auto otherKey = QueueKeyManager::GetInstance()->GetKey("other_config");
+        ProcessQueueManager::GetInstance()->CreateOrUpdateBoundedQueue(otherKey, 0);
+        TimeoutFlushManager::GetInstance()->UpdateRecord(configName, 0, 1, 3, nullptr);
+        pipeline.Stop(true);
+        APSARA_TEST_FALSE(queue->mValidToPop);
+        APSARA_TEST_TRUE((*ProcessQueueManager::GetInstance()->mQueues[otherKey].first)->mValidToPop);
+        APSARA_TEST_TRUE(TimeoutFlushManager::GetInstance()->GetShard(configName).mTimeoutRecords.empty());
+    }
+    {
+        pipeline.Start();
+        APSARA_TEST_TRUE(queue->mValidToPop);
+    }
+    {
+        pipeline.Stop(false);
+        APSARA_TEST_FALSE(queue->mValidToPop);
     }
 }
 
@@ -2835,6 +2862,7 @@ UNIT_TEST_CASE(PipelineUnittest, OnInputFileWithContainerDiscovery)
 UNIT_TEST_CASE(PipelineUnittest, TestProcess)
 UNIT_TEST_CASE(PipelineUnittest, TestSend)
 UNIT_TEST_CASE(PipelineUnittest, TestFlushBatch)
+UNIT_TEST_CASE(PipelineUnittest, TestStartAndStop)
 
 } // namespace logtail
 
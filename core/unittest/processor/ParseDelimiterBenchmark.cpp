@@ -0,0 +1,129 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "config/PipelineConfig.h"
+#include "models/LogEvent.h"
+#include "pipeline/plugin/instance/ProcessorInstance.h"
+#include "plugin/processor/ProcessorParseDelimiterNative.h"
+#include "unittest/Unittest.h"
+
+
+using namespace logtail;
+
+
+std::string formatSize(long long size) {
+    static const char* units[] = {" B", "KB", "MB", "GB", "TB"};
+    int index = 0;
+    double doubleSize = static_cast<double>(size);
+    while (doubleSize >= 1024.0 && index < 4) {
+        doubleSize /= 1024.0;
+        index++;
+    }
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) << std::setw(6) << std::setfill(' ') << doubleSize << " " << units[index];
+    return ss.str();
+}
+
+static void BM_Delimiter(int size, int batchSize, bool quoted) {
+    logtail::Logger::Instance().InitGlobalLoggers();
+
+    PipelineContext mContext;
+    mContext.SetConfigName("project##config_0");
+
+    // 40 columns, some of which are quoted with separators and escaped quotes inside
+    const int columnCnt = 40;
+    Json::Value config;
+    config["SourceKey"] = "content";
+    config["Separator"] = ",";
+    config["Quote"] = "\"";
+    config["Keys"] = Json::arrayValue;
+    std::string data;
+    for (int i = 0; i < columnCnt; i++) {
+        config["Keys"].append("key" + std::to_string(i));
+        if (i != 0) {
+            data += ",";
+        }
+        if (quoted && i % 4 == 0) {
+            data += "\"value, with \"\"quote\"\" " + std::to_string(i) + "\"";
+        } else {
+            data += "value_" + std::to_string(i);
+        }
+    }
+    ProcessorParseDelimiterNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorParseDelimiterNative::sName, "1", "1", "1");
+    std::cout << "log size:\t" << formatSize(data.size() * size) << std::endl;
+
+    // make events
+    Json::Value root;
+    Json::Value events;
+    for (int i = 0; i < size; i++) {
+        Json::Value event;
+        event["type"] = 1;
+        event["timestamp"] = 1234567890;
+        event["timestampNanosecond"] = 0;
+        {
+            Json::Value contents;
+            contents["content"] = data;
+            event["contents"] = std::move(contents);
+        }
+        events.append(event);
+    }
+
+    root["events"] = events;
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+    std::ostringstream oss;
+    writer->write(root, &oss);
+    std::string inJson = oss.str();
+
+    bool init = processor.Init(config);
+    if (init) {
+        int count = 0;
+        uint64_t durationTime = 0;
+        for (int i = 0; i < batchSize; i++) {
+            count++;
+            auto sourceBuffer = std::make_shared<SourceBuffer>();
+            PipelineEventGroup eventGroup(sourceBuffer);
+            eventGroup.FromJsonString(inJson);
+
+            uint64_t startTime = GetCurrentTimeInMicroSeconds();
+            processor.Process(eventGroup);
+            durationTime += GetCurrentTimeInMicroSeconds() - startTime;
+        }
+        std::cout << "durationTime: " << durationTime << std::endl;
+        std::cout << "process: "
+                  << formatSize(data.size() * (uint64_t)count * 1000000 * (uint64_t)size / durationTime) << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    logtail::Logger::Instance().InitGlobalLoggers();
+#ifdef NDEBUG
+    std::cout << "release" << std::endl;
+#else
+    std::cout << "debug" << std::endl;
+#endif
+    std::cout << "delimiter" << std::endl;
+    BM_Delimiter(512, 100, false);
+    std::cout << "delimiter with quote" << std::endl;
+    BM_Delimiter(512, 100, true);
+    return 0;
+}
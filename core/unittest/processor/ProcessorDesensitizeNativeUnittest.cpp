@@ -11,6 +11,8 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <random>
+
 #include "common/JsonUtil.h"
 #include "models/LogEvent.h"
 #include "pipeline/plugin/instance/ProcessorInstance.h"
@@ -34,6 +36,8 @@ public:
     void TestCastSensWordMulti();
     void TestMultipleLines();
     void TestMultipleLinesWithProcessorMergeMultilineLogNative();
+    void TestExtractAnchors();
+    void TestAnchorPrefilter();
 
     PipelineContext mContext;
 };
@@ -54,6 +58,10 @@ UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestMultipleLines);
 
 UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestMultipleLinesWithProcessorMergeMultilineLogNative);
 
+UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestExtractAnchors);
+
+UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestAnchorPrefilter);
+
 PluginInstance::PluginMeta getPluginMeta(){
     PluginInstance::PluginMeta pluginMeta{"testgetPluginID", "testNodeID", "testNodeChildID"};
     return pluginMeta;
@@ -1523,6 +1531,163 @@ void ProcessorDesensitizeNativeUnittest::TestCastSensWordMulti() {
         APSARA_TEST_STREQ_FATAL(CompactJson(expectJson).c_str(), CompactJson(outJson).c_str());
     }
 }
+
+void ProcessorDesensitizeNativeUnittest::TestExtractAnchors() {
+    std::vector<std::string> anchors;
+    const std::vector<std::pair<std::string, std::vector<std::string>>> cases = {
+        {"pwd=", {"pwd="}},
+        {"'password':'", {"'password':'"}},
+        {"password|pwd|token", {"password", "pwd", "token"}},
+        {"(?:password|passwd)\\s*[=:]\\s*", {"password", "passwd"}},
+        {"\\bpass(word)?=", {"pass"}},
+        {"\"?token\"?:", {"token"}},
+        {"user_\\d+_secret=", {"_secret="}},
+        {"a+b{2}c", {"a"}},
+        {"a+b{2,}c", {"a"}},
+        {"a+b{2,3}c", {"a"}},
+        {"(?P<key>key|secret)\\.value=", {".value="}},
+        {"\\[pwd\\]\\t", {"[pwd]\t"}},
+        {"[a-z]+_(id|key)", {"id", "key"}},
+        {"\\w+=", {"="}},
+        {"^pwd=$", {"pwd="}},
+    };
+    for (const auto& item : cases) {
+        APSARA_TEST_TRUE_DESC(ProcessorDesensitizeNative::ExtractAnchors(item.first, anchors), item.first);
+        APSARA_TEST_EQUAL_DESC(item.second, anchors, item.first);
+    }
+    // no literal is required, or the syntax is not handled
+    for (const std::string& regex : {"",
+                                     "\\w+",
+                                     "pwd=|\\d+",
+                                     "(pwd=)?",
+                                     "(?i)password=",
+                                     "(?i:password)=",
+                                     "\\x41=",
+                                     "\\pN=",
+                                     "a{,2}",
+                                     // braces not in a valid repetition are literals in RE2
+                                     "(pwd=)a{1|b}",
+                                     "a{1",
+                                     "a{1,2,3}",
+                                     "a{1x}",
+                                     "密?="}) {
+        APSARA_TEST_FALSE_DESC(ProcessorDesensitizeNative::ExtractAnchors(regex, anchors), regex);
+    }
+}
+
+void ProcessorDesensitizeNativeUnittest::TestAnchorPrefilter() {
+    // lines rejected by the prefilter must not be matched by the regex
+    const std::vector<std::pair<std::string, std::string>> patterns = {
+        {"pwd=", "[^,]*"},
+        {"(?:password|pwd)\\s*[=:]\\s*", "[^,]*"},
+        {"\\bp(wd)?=", "[^,]*"},
+        {"[ab]+_(ab|ba)=", "[^,]*"},
+        {"(a|b)+c{2}", "[^,]*"},
+        // the alternation at the top level of the whole regex matches without the part before
+        {"pwd=", "[^,]*|ab="},
+    };
+    const std::string chars = "pwdabc_=: ";
+    std::mt19937 gen(42);
+    for (const auto& pattern : patterns) {
+        Json::Value config = GetCastSensWordConfig("content", "const", "***", pattern.first, pattern.second, true);
+        ProcessorDesensitizeNative processor;
+        processor.SetContext(mContext);
+        processor.SetMetricsRecordRef(ProcessorDesensitizeNative::sName, "1", "1", "1");
+        APSARA_TEST_TRUE_FATAL(processor.Init(config));
+        APSARA_TEST_TRUE_FATAL(processor.mAnchorMatcher.IsBuilt());
+        size_t rejectedCnt = 0;
+        for (int i = 0; i < 20000; ++i) {
+            std::string line;
+            for (size_t j = gen() % 32; j > 0; --j) {
+                line.push_back(chars[gen() % chars.size()]);
+            }
+            if (!processor.mAnchorMatcher.Contains(line.data(), line.size())) {
+                ++rejectedCnt;
+                APSARA_TEST_FALSE_FATAL(re2::RE2::PartialMatch(line, *processor.mRegex));
+            }
+        }
+        APSARA_TEST_TRUE(rejectedCnt > 0);
+    }
+    {
+        // no literal is required by one of the top level alternatives
+        Json::Value config = GetCastSensWordConfig("content", "const", "***", "pwd=", "[^,]*|\\d+", true);
+        ProcessorDesensitizeNative processor;
+        processor.SetContext(mContext);
+        processor.SetMetricsRecordRef(ProcessorDesensitizeNative::sName, "1", "1", "1");
+        APSARA_TEST_TRUE_FATAL(processor.Init(config));
+        APSARA_TEST_FALSE(processor.mAnchorMatcher.IsBuilt());
+    }
+    {
+        // an invalid repetition is a literal, so the alternation after it matches without the part before
+        Json::Value config = GetCastSensWordConfig("content", "const", "***", "pwd=", "a{1|b}", true);
+        ProcessorDesensitizeNative processor;
+        processor.SetContext(mContext);
+        processor.SetMetricsRecordRef(ProcessorDesensitizeNative::sName, "1", "1", "1");
+        APSARA_TEST_TRUE_FATAL(processor.Init(config));
+        APSARA_TEST_FALSE(processor.mAnchorMatcher.IsBuilt());
+        APSARA_TEST_TRUE(re2::RE2::PartialMatch("xb}", *processor.mRegex));
+    }
+
+    // events without anchors are left untouched
+    Json::Value config = GetCastSensWordConfig("content");
+    ProcessorDesensitizeNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorDesensitizeNative::sName, "1", "1", "1");
+    APSARA_TEST_TRUE_FATAL(processor.Init(config));
+    std::string inJson = R"({
+        "events" :
+        [
+            {
+                "contents" :
+                {
+                    "content" : "user=abc, password=123"
+                },
+                "timestampNanosecond" : 0,
+                "timestamp" : 12345678901,
+                "type" : 1
+            },
+            {
+                "contents" :
+                {
+                    "content" : "user=abc, pwd=123"
+                },
+                "timestampNanosecond" : 0,
+                "timestamp" : 12345678901,
+                "type" : 1
+            }
+        ]
+    })";
+    std::string expectJson = R"({
+        "events" :
+        [
+            {
+                "contents" :
+                {
+                    "content" : "user=abc, password=123"
+                },
+                "timestamp" : 12345678901,
+                "timestampNanosecond" : 0,
+                "type" : 1
+            },
+            {
+                "contents" :
+                {
+                    "content" : "user=abc, pwd=********"
+                },
+                "timestamp" : 12345678901,
+                "timestampNanosecond" : 0,
+                "type" : 1
+            }
+        ]
+    })";
+    auto sourceBuffer = std::make_shared<SourceBuffer>();
+    PipelineEventGroup eventGroup(sourceBuffer);
+    eventGroup.FromJsonString(inJson);
+    processor.Process(eventGroup);
+    APSARA_TEST_STREQ_FATAL(CompactJson(expectJson).c_str(), CompactJson(eventGroup.ToJsonString()).c_str());
+    APSARA_TEST_EQUAL(2U, processor.mProcDesensitizeRecodesTotal->GetValue());
+}
+
 } // namespace logtail
 
 UNIT_TEST_MAIN
@@ -2262,6 +2262,43 @@ void ProcessorParseContainerLogNativeUnittest::TestParseDockerLog() {
         APSARA_TEST_FALSE(result);
         delete[] buffer;
     }
+    // Test with escapes beyond the first blocks scanned at once
+    {
+        DockerLog dockerLog;
+        std::string prefix(70, 'a');
+        std::string str = R"({"log":")" + prefix + R"(\"quoted\"\tand more)" + prefix
+            + R"(\n","stream":"stderr","time":"2021-12-01T00:00:00.000Z"})";
+        int32_t size = str.size();
+
+        bool result = ProcessorParseContainerLogNative::ParseDockerLog(&str[0], size, dockerLog);
+
+        APSARA_TEST_TRUE(result);
+        APSARA_TEST_EQUAL(prefix + "\"quoted\"\tand more" + prefix + "\n", dockerLog.log.to_string());
+        APSARA_TEST_EQUAL("stderr", dockerLog.stream);
+        APSARA_TEST_EQUAL("2021-12-01T00:00:00.000Z", dockerLog.time);
+    }
+    // Test with surrogate pairs and invalid unicode escapes
+    {
+        DockerLog dockerLog;
+        std::string str
+            = R"({"log":"\ud83c\udf0d \ud83c \udf0d \u12zz","stream":"stdout","time":"2021-12-01T00:00:00.000Z"})";
+        int32_t size = str.size();
+
+        bool result = ProcessorParseContainerLogNative::ParseDockerLog(&str[0], size, dockerLog);
+
+        APSARA_TEST_TRUE(result);
+        APSARA_TEST_EQUAL("🌍 \xEF\xBF\xBD \xEF\xBF\xBD \\u12zz", dockerLog.log.to_string());
+    }
+    // Test with escapes in stream field
+    {
+        DockerLog dockerLog;
+        std::string str = R"({"log":"Hello","stream":"std\nout","time":"2021-12-01T00:00:00.000Z"})";
+        int32_t size = str.size();
+
+        bool result = ProcessorParseContainerLogNative::ParseDockerLog(&str[0], size, dockerLog);
+
+        APSARA_TEST_FALSE(result);
+    }
 }
 
 } // namespace logtail
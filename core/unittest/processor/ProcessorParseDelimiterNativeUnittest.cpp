@@ -47,6 +47,7 @@ public:
     void TestAllowingShortenedFields();
     void TestExtend();
     void TestEmpty();
+    void TestQuoteWithOverflowedFields();
     PipelineContext mContext;
 };
 
@@ -64,6 +65,7 @@ UNIT_TEST_CASE(ProcessorParseDelimiterNativeUnittest, TestProcessEventDiscardUnm
 UNIT_TEST_CASE(ProcessorParseDelimiterNativeUnittest, TestAllowingShortenedFields);
 UNIT_TEST_CASE(ProcessorParseDelimiterNativeUnittest, TestExtend);
 UNIT_TEST_CASE(ProcessorParseDelimiterNativeUnittest, TestEmpty);
+UNIT_TEST_CASE(ProcessorParseDelimiterNativeUnittest, TestQuoteWithOverflowedFields);
 
 PluginInstance::PluginMeta getPluginMeta(){
     PluginInstance::PluginMeta pluginMeta{"testgetPluginID", "testNodeID", "testNodeChildID"};
@@ -411,6 +413,98 @@ void ProcessorParseDelimiterNativeUnittest::TestInit() {
     APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, mContext));
 }
 
+void ProcessorParseDelimiterNativeUnittest::TestQuoteWithOverflowedFields() {
+    // fields of all events in the group are split at once
+    std::string inJson = R"({
+        "events" :
+        [
+            {
+                "contents" :
+                {
+                    "content" : "2024-07-15 10:20:30,\"GET /index.html?a=1,b=\"\"2\"\"\",\"Mozilla/5.0, (X11)\",200"
+                },
+                "timestamp" : 12345678901,
+                "timestampNanosecond": 0,
+                "type" : 1
+            },
+            {
+                "contents" :
+                {
+                    "content" : "2024-07-15 10:20:31,GET /,curl/8.0,404,0.001"
+                },
+                "timestamp" : 12345678901,
+                "timestampNanosecond": 0,
+                "type" : 1
+            },
+            {
+                "contents" :
+                {
+                    "content" : "2024-07-15 10:20:32,GET /\"a\",curl/8.0"
+                },
+                "timestamp" : 12345678901,
+                "timestampNanosecond": 0,
+                "type" : 1
+            }
+        ]
+    })";
+
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "__column2__": ",Mozilla/5.0, (X11),200",
+                    "request": "GET /index.html?a=1,b=\"2\"",
+                    "time": "2024-07-15 10:20:30"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "__column2__": ",curl/8.0,404,0.001",
+                    "request": "GET /",
+                    "time": "2024-07-15 10:20:31"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "__raw__": "2024-07-15 10:20:32,GET /\"a\",curl/8.0"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+
+    auto sourceBuffer = std::make_shared<SourceBuffer>();
+    PipelineEventGroup eventGroup(sourceBuffer);
+    eventGroup.FromJsonString(inJson);
+
+    Json::Value config;
+    config["SourceKey"] = "content";
+    config["Separator"] = ",";
+    config["Quote"] = "\"";
+    config["Keys"] = Json::arrayValue;
+    config["Keys"].append("time");
+    config["Keys"].append("request");
+    config["OverflowedFieldsTreatment"] = "keep";
+    config["KeepingSourceWhenParseFail"] = true;
+    config["KeepingSourceWhenParseSucceed"] = false;
+    config["RenamedSourceKey"] = "__raw__";
+
+    ProcessorParseDelimiterNative& processor = *(new ProcessorParseDelimiterNative);
+    ProcessorInstance processorInstance(&processor, getPluginMeta());
+    APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, mContext));
+    processor.Process(eventGroup);
+    std::string outJson = eventGroup.ToJsonString();
+    APSARA_TEST_STREQ_FATAL(CompactJson(expectJson).c_str(), CompactJson(outJson).c_str());
+}
+
 void ProcessorParseDelimiterNativeUnittest::TestExtend() {
     // not Extend
     {
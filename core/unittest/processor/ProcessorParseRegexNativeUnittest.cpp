@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <cstdlib>
+#include <random>
 
 #include "common/JsonUtil.h"
+#include "common/StringTools.h"
 #include "config/PipelineConfig.h"
 #include "models/LogEvent.h"
 #include "pipeline/plugin/instance/ProcessorInstance.h"
@@ -35,6 +37,9 @@ public:
     void TestProcessEventKeyCountUnmatch();
     void TestProcessRegexRaw();
     void TestProcessRegexContent();
+    void TestInitMatcher();
+    void TestMatchSameAsBoost();
+    void TestSwitchToRe2();
 
 protected:
     void SetUp() override { ctx.SetConfigName("test_config"); }
@@ -676,6 +681,153 @@ void ProcessorParseRegexNativeUnittest::TestProcessEventKeyCountUnmatch() {
     APSARA_TEST_EQUAL_FATAL(count, processor.mProcKeyCountNotMatchErrorTotal->GetValue());
 }
 
+void ProcessorParseRegexNativeUnittest::TestInitMatcher() {
+    Json::Value config;
+    config["SourceKey"] = "content";
+    config["Keys"] = Json::arrayValue;
+    config["Keys"].append("key1");
+    auto init = [&](const std::string& regex) {
+        config["Regex"] = regex;
+        std::unique_ptr<ProcessorParseRegexNative> processor(new ProcessorParseRegexNative);
+        processor->SetContext(ctx);
+        processor->SetMetricsRecordRef(ProcessorParseRegexNative::sName, "1", "1", "1");
+        APSARA_TEST_TRUE(processor->Init(config));
+        return processor;
+    };
+    {
+        auto processor = init(R"(([^,]*),([^,]+),(.*))");
+        APSARA_TEST_TRUE(processor->mIsLiteralSplit);
+        APSARA_TEST_EQUAL(3U, processor->mSplitFields.size());
+        APSARA_TEST_EQUAL(',', processor->mSplitFields[0].mStop);
+        APSARA_TEST_FALSE(processor->mSplitFields[0].mNonEmpty);
+        APSARA_TEST_TRUE(processor->mSplitFields[1].mNonEmpty);
+        APSARA_TEST_TRUE(processor->mSplitFields[2].mToEnd);
+        APSARA_TEST_EQUAL(",", processor->mSplitFields[2].mPrefix);
+    }
+    {
+        auto processor = init(R"re(^([^ ]*) ([^ ]*) \[([^\]]*)\] "(.*)"$)re");
+        APSARA_TEST_TRUE(processor->mIsLiteralSplit);
+        APSARA_TEST_EQUAL(4U, processor->mSplitFields.size());
+        APSARA_TEST_EQUAL(']', processor->mSplitFields[2].mStop);
+        APSARA_TEST_EQUAL("\"", processor->mSplitSuffix);
+    }
+    {
+        auto processor = init(R"(([^,]*),(.*)\$)");
+        APSARA_TEST_TRUE(processor->mIsLiteralSplit);
+        APSARA_TEST_EQUAL("$", processor->mSplitSuffix);
+    }
+    // captures which may be backtracked into are left to the regex engine
+    for (const std::string& regex : {R"(([^,]*)([^,]*))",
+                                     R"(([^,]*)x(.*))",
+                                     R"((.*),(.*))",
+                                     R"(([^,]*?),(.*))",
+                                     R"((\w+)\t(\w+).*)",
+                                     R"(^(\w+)$)"}) {
+        auto processor = init(regex);
+        APSARA_TEST_FALSE(processor->mIsLiteralSplit);
+        APSARA_TEST_TRUE(processor->mRe2 != nullptr);
+    }
+    // not supported by RE2
+    for (const std::string& regex : {R"((\w+) \1)", R"((?<=a)(b))", R"((a$)(b))", R"((\w+)\v)"}) {
+        auto processor = init(regex);
+        APSARA_TEST_FALSE(processor->mIsLiteralSplit);
+        APSARA_TEST_TRUE(processor->mRe2 == nullptr);
+    }
+}
+
+void ProcessorParseRegexNativeUnittest::TestMatchSameAsBoost() {
+    // regex and a line it matches, which is randomly mutated
+    const std::vector<std::pair<std::string, std::string>> cases
+        = {{R"(([^,]*),([^,]+),(.*))", "a,b,c,d"},
+           {R"re(([^ ]*) ([^ ]*) \[([^\]]*)\] "(.*)")re", "a b [a b] \"a\"b\""},
+           {R"(\[([^,]+)\](.+)\])", "[a]b]"},
+           {R"(([^,]*),(.*)\$)", "a,b$"},
+           {R"((\w+)\t(\w+).*)", "ab\tb a"},
+           {R"((a+?)(b*)(.*))", "aab a"},
+           {R"((a|ab)(c|bcd)?(.*))", "abcd"},
+           {R"(\[(.*?)\] (\S+)(\s*))", "[a] b] b "},
+           {R"(^([^,]*),([ab]+|(\[))(.*)$)", "a,[b"}};
+    const std::string chars = "ab ,[]\"\t\n$";
+    std::mt19937 gen(42);
+    Json::Value config;
+    config["SourceKey"] = "content";
+    config["Keys"] = Json::arrayValue;
+    config["Keys"].append("key1");
+    for (const auto& item : cases) {
+        config["Regex"] = item.first;
+        ProcessorParseRegexNative processor;
+        processor.SetContext(ctx);
+        processor.SetMetricsRecordRef(ProcessorParseRegexNative::sName, "1", "1", "1");
+        APSARA_TEST_TRUE_FATAL(processor.Init(config));
+        // both engines are checked when RE2 can be used
+        for (bool re2Preferred : {false, true}) {
+            if (re2Preferred && (processor.mIsLiteralSplit || processor.mRe2 == nullptr)) {
+                continue;
+            }
+            processor.mRe2Preferred = re2Preferred;
+            size_t matchedCnt = 0;
+            for (int i = 0; i < 20000; ++i) {
+                std::string line = item.second;
+                for (size_t j = gen() % 4; j > 0; --j) {
+                    size_t pos = gen() % (line.size() + 1);
+                    switch (gen() % 3) {
+                        case 0:
+                            line.insert(pos, 1, chars[gen() % chars.size()]);
+                            break;
+                        case 1:
+                            line.erase(pos, 1);
+                            break;
+                        default:
+                            line.replace(pos, 1, 1, chars[gen() % chars.size()]);
+                            break;
+                    }
+                }
+                boost::match_results<const char*> what;
+                std::string exception;
+                bool expected = BoostRegexMatch(line.data(), line.size(), processor.mReg, exception, what);
+                std::vector<StringView> captures;
+                APSARA_TEST_EQUAL_FATAL(expected, processor.Match(StringView(line), 10, captures, exception));
+                if (!expected) {
+                    continue;
+                }
+                ++matchedCnt;
+                APSARA_TEST_EQUAL_FATAL(what.size() - 1, captures.size());
+                for (size_t j = 0; j < captures.size(); ++j) {
+                    APSARA_TEST_EQUAL_FATAL(what[j + 1].str(), captures[j].to_string());
+                }
+            }
+            APSARA_TEST_TRUE(matchedCnt > 0);
+        }
+    }
+}
+
+void ProcessorParseRegexNativeUnittest::TestSwitchToRe2() {
+    Json::Value config;
+    config["SourceKey"] = "content";
+    config["Regex"] = "(x+x+)+y";
+    config["Keys"] = Json::arrayValue;
+    config["Keys"].append("key1");
+    ProcessorParseRegexNative processor;
+    processor.SetContext(ctx);
+    processor.SetMetricsRecordRef(ProcessorParseRegexNative::sName, "1", "1", "1");
+    APSARA_TEST_TRUE_FATAL(processor.Init(config));
+    APSARA_TEST_TRUE_FATAL(processor.mRe2 != nullptr);
+    APSARA_TEST_FALSE(processor.mRe2Preferred);
+
+    std::vector<StringView> captures;
+    std::string exception;
+    APSARA_TEST_TRUE(processor.Match(StringView("xxxy"), 1, captures, exception));
+    APSARA_TEST_FALSE(processor.mRe2Preferred);
+    // boost gives up on the line, which is then matched by RE2
+    std::string line(64, 'x');
+    APSARA_TEST_FALSE(processor.Match(StringView(line), 1, captures, exception));
+    APSARA_TEST_TRUE(exception.empty());
+    APSARA_TEST_TRUE(processor.mRe2Preferred);
+    APSARA_TEST_TRUE(processor.Match(StringView("xxxy"), 1, captures, exception));
+    APSARA_TEST_EQUAL(1U, captures.size());
+    APSARA_TEST_EQUAL("xxx", captures[0].to_string());
+}
+
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestInit)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, OnSuccessfulInit)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessWholeLine)
@@ -686,6 +838,9 @@ UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessEventDiscardUnmatch
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessEventKeyCountUnmatch)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessRegexRaw)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessRegexContent)
+UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestInitMatcher)
+UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestMatchSameAsBoost)
+UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestSwitchToRe2)
 
 } // namespace logtail
 
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <limits>
+
 #include "plugin/flusher/sls/FlusherSLS.h"
 #include "pipeline/queue/ExactlyOnceSenderQueue.h"
 #include "pipeline/queue/SLSSenderQueueItem.h"
@@ -131,6 +133,17 @@ void ExactlyOnceSenderQueueUnittest::TestGetAllAvailableItems() {
             item->mStatus = SendingStatus::IDLE;
         }
     }
+    {
+        // checkpoint not persisted
+        auto& cpt = static_cast<SLSSenderQueueItem*>(mQueue->mQueue[0].get())->mExactlyOnceCheckpoint;
+        cpt->writeSeq = numeric_limits<uint64_t>::max();
+        vector<SenderQueueItem*> items;
+        mQueue->GetAllAvailableItems(items, false);
+        APSARA_TEST_EQUAL(1U, items.size());
+        APSARA_TEST_EQUAL(mQueue->mQueue[1].get(), items[0]);
+        items[0]->mStatus = SendingStatus::IDLE;
+        cpt->writeSeq = 0;
+    }
     {
         // with limits, limited by concurrency limiter
         mQueue->mRateLimiter->mMaxSendBytesPerSecond = 100;
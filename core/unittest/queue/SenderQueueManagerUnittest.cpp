@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "common/StringTools.h"
 #include "plugin/flusher/sls/FlusherSLS.h"
 #include "pipeline/queue/ExactlyOnceQueueManager.h"
 #include "pipeline/queue/QueueKeyManager.h"
@@ -33,6 +34,8 @@ public:
     void TestGetQueue();
     void TestPushQueue();
     void TestGetAllAvailableItems();
+    void TestReadyQueues();
+    void TestShard();
     void TestRemoveItem();
     void TestIsAllQueueEmpty();
 
@@ -203,7 +206,7 @@ void SenderQueueManagerUnittest::TestGetAllAvailableItems() {
         sManager->GetAllAvailableItems(items, false);
         APSARA_TEST_EQUAL(4U, items.size());
         for (auto& item : items) {
-            item->mStatus = SendingStatus::IDLE;
+            sManager->ResetItem(item->mQueueKey, item);
         }
     }
     auto regionConcurrencyLimiter = FlusherSLS::GetRegionConcurrencyLimiter(mFlusher.mRegion);
@@ -217,6 +220,89 @@ void SenderQueueManagerUnittest::TestGetAllAvailableItems() {
     }
 }
 
+void SenderQueueManagerUnittest::TestReadyQueues() {
+    sManager->CreateQueue(0, vector<shared_ptr<ConcurrencyLimiter>>{sConcurrencyLimiter}, sMaxRate);
+    sManager->CreateQueue(1, vector<shared_ptr<ConcurrencyLimiter>>{sConcurrencyLimiter}, sMaxRate);
+    vector<SenderQueueItem*> items;
+    sManager->GetAllAvailableItems(items);
+    APSARA_TEST_TRUE(items.empty());
+    APSARA_TEST_TRUE(sManager->mShards[0].mReadyQueues.empty());
+
+    auto item = GenerateItem();
+    auto ptr = item.get();
+    sManager->PushQueue(0, std::move(item));
+    APSARA_TEST_EQUAL(1U, sManager->mShards[0].mReadyQueues.size());
+    sManager->GetAllAvailableItems(items);
+    APSARA_TEST_EQUAL(1U, items.size());
+    APSARA_TEST_TRUE(sManager->mShards[0].mReadyQueues.empty());
+    items.clear();
+    sManager->GetAllAvailableItems(items);
+    APSARA_TEST_TRUE(items.empty());
+
+    // limited by concurrency limiter
+    sConcurrencyLimiter->SetLimit(0);
+    item = GenerateItem();
+    item->mQueueKey = 1;
+    sManager->PushQueue(1, std::move(item));
+    sManager->GetAllAvailableItems(items);
+    APSARA_TEST_TRUE(items.empty());
+    APSARA_TEST_TRUE(sManager->mShards[0].mReadyQueues.empty());
+    APSARA_TEST_EQUAL(1U, sManager->mShards[0].mLimitedQueues.count(1));
+
+    // limited queues are visited again once an item is released
+    sConcurrencyLimiter->Reset();
+    APSARA_TEST_TRUE(sManager->RemoveItem(0, ptr));
+    APSARA_TEST_TRUE(sManager->mShards[0].mLimitedQueues.empty());
+    sManager->GetAllAvailableItems(items);
+    APSARA_TEST_EQUAL(1U, items.size());
+    APSARA_TEST_EQUAL(1, items[0]->mQueueKey);
+
+    // item put back to be sent again
+    sManager->ResetItem(1, items[0]);
+    items.clear();
+    sManager->GetAllAvailableItems(items);
+    APSARA_TEST_EQUAL(1U, items.size());
+}
+
+void SenderQueueManagerUnittest::TestShard() {
+    sManager->mShards.resize(2);
+    sManager->mValidToPop.resize(2, false);
+    string region0 = "region_0", region1;
+    for (size_t i = 1; region1.empty(); ++i) {
+        if (hash<string>()("region_" + ToString(i)) % 2 != hash<string>()(region0) % 2) {
+            region1 = "region_" + ToString(i);
+        }
+    }
+    sManager->CreateQueue(0, vector<shared_ptr<ConcurrencyLimiter>>(), 0, region0);
+    sManager->CreateQueue(1, vector<shared_ptr<ConcurrencyLimiter>>(), 0, region1);
+    size_t shard0 = sManager->GetQueueShard(0), shard1 = sManager->GetQueueShard(1);
+    APSARA_TEST_NOT_EQUAL(shard0, shard1);
+    sManager->Wait(0, shard0);
+    sManager->Wait(0, shard1);
+
+    auto item = GenerateItem();
+    item->mQueueKey = 1;
+    sManager->PushQueue(1, std::move(item));
+    // only the shard of the queue is triggered
+    APSARA_TEST_FALSE(sManager->Wait(0, shard0));
+    APSARA_TEST_TRUE(sManager->Wait(0, shard1));
+
+    vector<SenderQueueItem*> items;
+    sManager->GetAllAvailableItems(items, true, shard0);
+    APSARA_TEST_TRUE(items.empty());
+    sManager->GetAllAvailableItems(items, true, shard1);
+    APSARA_TEST_EQUAL(1U, items.size());
+    APSARA_TEST_EQUAL(1, items[0]->mQueueKey);
+
+    // queue moved to another shard when recreated
+    sManager->CreateQueue(1, vector<shared_ptr<ConcurrencyLimiter>>(), 0, region0);
+    APSARA_TEST_EQUAL(shard0, sManager->GetQueueShard(1));
+    APSARA_TEST_TRUE(sManager->mShards[shard1].mReadyQueues.empty());
+
+    sManager->mShards.resize(1);
+    sManager->mValidToPop.resize(1);
+}
+
 void SenderQueueManagerUnittest::TestRemoveItem() {
     sManager->CreateQueue(0, vector<shared_ptr<ConcurrencyLimiter>>{sConcurrencyLimiter}, sMaxRate);
     ExactlyOnceQueueManager::GetInstance()->CreateOrUpdateQueue(1, 0, "test_config", sCheckpoints);
@@ -286,6 +372,8 @@ UNIT_TEST_CASE(SenderQueueManagerUnittest, TestDeleteQueue)
 UNIT_TEST_CASE(SenderQueueManagerUnittest, TestGetQueue)
 UNIT_TEST_CASE(SenderQueueManagerUnittest, TestPushQueue)
 UNIT_TEST_CASE(SenderQueueManagerUnittest, TestGetAllAvailableItems)
+UNIT_TEST_CASE(SenderQueueManagerUnittest, TestReadyQueues)
+UNIT_TEST_CASE(SenderQueueManagerUnittest, TestShard)
 UNIT_TEST_CASE(SenderQueueManagerUnittest, TestRemoveItem)
 UNIT_TEST_CASE(SenderQueueManagerUnittest, TestIsAllQueueEmpty)
 
@@ -0,0 +1,122 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "file_server/reader/AsyncFileReader.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class AsyncFileReaderUnittest : public ::testing::Test {
+public:
+    static void SetUpTestCase() {
+        // the ring is set up on first use
+        BOOL_FLAG(enable_async_file_read) = true;
+        sReader = AsyncFileReader::GetInstance();
+    }
+
+    void SetUp() override {
+        ofstream(mFilePath, ios::binary) << mContent;
+        mFd = open(mFilePath.c_str(), O_RDONLY);
+    }
+
+    void TearDown() override {
+        close(mFd);
+        remove(mFilePath.c_str());
+    }
+
+    void TestRead();
+    void TestWaitFor();
+
+private:
+    static void WaitDone(const shared_ptr<AsyncReadRequest>& request, vector<Event*>& events) {
+        for (int i = 0; i < 100 && !request->mDone; ++i) {
+            sReader->Reap(events);
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        sReader->Reap(events);
+    }
+
+    static AsyncFileReader* sReader;
+    const string mFilePath = "async_file_reader_test.log";
+    const string mContent = "first line\nsecond line\n";
+    int mFd = -1;
+};
+
+AsyncFileReader* AsyncFileReaderUnittest::sReader = nullptr;
+
+void AsyncFileReaderUnittest::TestRead() {
+    if (!sReader->IsAvailable()) {
+        // io_uring is not supported in this environment
+        return;
+    }
+    APSARA_TEST_EQUAL(nullptr, sReader->Submit(mFd, 0, 0, 0));
+
+    const size_t reserved = 4;
+    auto request = sReader->Submit(mFd, 6, reserved, 100);
+    APSARA_TEST_NOT_EQUAL(nullptr, request);
+    vector<Event*> events;
+    WaitDone(request, events);
+    APSARA_TEST_TRUE(request->mDone);
+    APSARA_TEST_TRUE(events.empty());
+    APSARA_TEST_EQUAL(static_cast<int64_t>(mContent.size() - 6), request->mResult);
+    APSARA_TEST_EQUAL(mContent.substr(6), string(request->mData + reserved, request->mResult));
+    APSARA_TEST_TRUE(sReader->mInflightRequests.empty());
+
+    // read on an invalid fd reports the error rather than failing the submission
+    request = sReader->Submit(1000000, 0, 0, 100);
+    APSARA_TEST_NOT_EQUAL(nullptr, request);
+    WaitDone(request, events);
+    APSARA_TEST_TRUE(request->mDone);
+    APSARA_TEST_EQUAL(-EBADF, request->mResult);
+}
+
+void AsyncFileReaderUnittest::TestWaitFor() {
+    if (!sReader->IsAvailable()) {
+        return;
+    }
+    auto request = sReader->Submit(mFd, 0, 0, 100);
+    APSARA_TEST_NOT_EQUAL(nullptr, request);
+    sReader->WaitFor(request, new Event("dir", "file", EVENT_MODIFY, -1));
+    vector<Event*> events;
+    WaitDone(request, events);
+    APSARA_TEST_EQUAL(1U, events.size());
+    APSARA_TEST_EQUAL("file", events[0]->GetObject());
+    APSARA_TEST_EQUAL(nullptr, request->mWakeupEvent);
+    delete events[0];
+
+    // the event is pushed back at once if the read has completed
+    events.clear();
+    sReader->WaitFor(request, new Event("dir", "file", EVENT_MODIFY, -1));
+    sReader->Reap(events);
+    APSARA_TEST_EQUAL(1U, events.size());
+    delete events[0];
+}
+
+UNIT_TEST_CASE(AsyncFileReaderUnittest, TestRead)
+UNIT_TEST_CASE(AsyncFileReaderUnittest, TestWaitFor)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -70,6 +70,7 @@ public:
     }
     void TestReadGBK();
     void TestReadUTF8();
+    void TestReadUTF8Mmap();
 
     std::unique_ptr<char[]> expectedContent;
     static std::string logPathDir;
@@ -82,6 +83,7 @@ public:
 
 UNIT_TEST_CASE(LogFileReaderUnittest, TestReadGBK);
 UNIT_TEST_CASE(LogFileReaderUnittest, TestReadUTF8);
+UNIT_TEST_CASE(LogFileReaderUnittest, TestReadUTF8Mmap);
 
 std::string LogFileReaderUnittest::logPathDir;
 std::string LogFileReaderUnittest::gbkFile;
@@ -506,6 +508,75 @@ void LogFileReaderUnittest::TestReadUTF8() {
     }
 }
 
+void LogFileReaderUnittest::TestReadUTF8Mmap() {
+    { // buffer size big enough
+        MultilineOptions multilineOpts;
+        FileReaderOptions readerOpts;
+        readerOpts.mInputType = FileReaderOptions::InputType::InputFile;
+        readerOpts.mEnableMmapRead = true;
+        LogFileReader reader(
+            logPathDir, utf8File, DevInode(), std::make_pair(&readerOpts, &ctx), std::make_pair(&multilineOpts, &ctx));
+        reader.UpdateReaderManual();
+        reader.InitReader(true, LogFileReader::BACKWARD_TO_BEGINNING);
+        reader.CheckFileSignatureAndOffset(true);
+        LogBuffer logBuffer;
+        bool moreData = false;
+        reader.ReadUTF8(logBuffer, reader.mLogFileOp.GetFileSize(), moreData);
+        APSARA_TEST_FALSE_FATAL(moreData);
+        APSARA_TEST_STREQ_FATAL(expectedContent.get(), logBuffer.rawBuffer.data());
+        APSARA_TEST_EQUAL_FATAL(1UL, logBuffer.sourcebuffer->mPinnedRegions.size());
+    }
+    { // read twice, the cached part is mapped again rather than copied
+        MultilineOptions multilineOpts;
+        FileReaderOptions readerOpts;
+        readerOpts.mInputType = FileReaderOptions::InputType::InputFile;
+        readerOpts.mEnableMmapRead = true;
+        LogFileReader reader(
+            logPathDir, utf8File, DevInode(), std::make_pair(&readerOpts, &ctx), std::make_pair(&multilineOpts, &ctx));
+        reader.UpdateReaderManual();
+        reader.InitReader(true, LogFileReader::BACKWARD_TO_BEGINNING);
+        int64_t fileSize = reader.mLogFileOp.GetFileSize();
+        reader.CheckFileSignatureAndOffset(true);
+        LogFileReader::BUFFER_SIZE = fileSize - 13;
+        LogBuffer logBuffer;
+        bool moreData = false;
+        reader.ReadUTF8(logBuffer, fileSize, moreData);
+        APSARA_TEST_TRUE_FATAL(moreData);
+        std::string expectedPart(expectedContent.get());
+        expectedPart.resize(expectedPart.rfind("iLogtail") - 1);
+        APSARA_TEST_STREQ_FATAL(expectedPart.c_str(), logBuffer.rawBuffer.data());
+        APSARA_TEST_GT_FATAL(reader.mCache.size(), 0UL);
+
+        LogBuffer logBuffer2;
+        reader.ReadUTF8(logBuffer2, fileSize, moreData);
+        APSARA_TEST_FALSE_FATAL(moreData);
+        expectedPart = expectedContent.get();
+        expectedPart = expectedPart.substr(expectedPart.rfind("iLogtail"));
+        APSARA_TEST_STREQ_FATAL(expectedPart.c_str(), logBuffer2.rawBuffer.data());
+        APSARA_TEST_EQUAL_FATAL(0UL, reader.mCache.size());
+        APSARA_TEST_EQUAL_FATAL(1UL, logBuffer2.sourcebuffer->mPinnedRegions.size());
+    }
+    { // whole window forced out, the content is copied to leave room for the terminator
+        MultilineOptions multilineOpts;
+        FileReaderOptions readerOpts;
+        readerOpts.mInputType = FileReaderOptions::InputType::InputFile;
+        readerOpts.mEnableMmapRead = true;
+        LogFileReader reader(
+            logPathDir, utf8File, DevInode(), std::make_pair(&readerOpts, &ctx), std::make_pair(&multilineOpts, &ctx));
+        LogFileReader::BUFFER_SIZE = 15;
+        reader.UpdateReaderManual();
+        reader.InitReader(true, LogFileReader::BACKWARD_TO_BEGINNING);
+        reader.CheckFileSignatureAndOffset(true);
+        LogBuffer logBuffer;
+        bool moreData = false;
+        reader.ReadUTF8(logBuffer, reader.mLogFileOp.GetFileSize(), moreData);
+        APSARA_TEST_TRUE_FATAL(moreData);
+        APSARA_TEST_STREQ_FATAL(std::string(expectedContent.get(), LogFileReader::BUFFER_SIZE).c_str(),
+                                logBuffer.rawBuffer.data());
+        APSARA_TEST_EQUAL_FATAL(0UL, logBuffer.sourcebuffer->mPinnedRegions.size());
+    }
+}
+
 class LogMultiBytesUnittest : public ::testing::Test {
 public:
     static void SetUpTestCase() {
@@ -101,6 +101,60 @@ TEST_F(SDKClientUnittest, TestGetRealIp) {
     EXPECT_EQ(resp.realIp.size(), 0L);
 }
 
+static void CheckPostLogStoreLogsRequest(const std::string& accessKeyId,
+                                         const std::string& accessKey,
+                                         const HttpSinkRequest& request) {
+    std::map<std::string, std::string> header = request.mHeader;
+    header.erase(sdk::AUTHORIZATION);
+    std::map<std::string, std::string> parameterList;
+    if (!request.mQueryString.empty()) {
+        size_t pos = request.mQueryString.find("&seqid=");
+        parameterList["key"] = sdk::UrlDecode(request.mQueryString.substr(4, pos - 4));
+        if (pos != std::string::npos) {
+            parameterList["seqid"] = request.mQueryString.substr(pos + 7);
+        }
+    }
+    std::string signature
+        = sdk::GetUrlSignature(sdk::HTTP_POST, request.mUrl, header, parameterList, request.mBody, accessKey);
+    EXPECT_EQ(sdk::LOG_HEADSIGNATURE_PREFIX + accessKeyId + ':' + signature,
+              request.mHeader.at(sdk::AUTHORIZATION));
+}
+
+TEST_F(SDKClientUnittest, TestCreatePostLogStoreLogsRequest) {
+    sdk::Client client("cn-hangzhou.log.aliyuncs.com", "id", "key", INT32_FLAG(sls_client_send_timeout), "", "");
+    client.SetKeyProvider("provider");
+    std::string body = "compressed data";
+
+    auto request
+        = client.CreatePostLogStoreLogsRequest("project", "logstore", sls_logs::SLS_CMP_LZ4, body, 100, nullptr);
+    EXPECT_EQ("/logstores/logstore/shards/lb", request->mUrl);
+    EXPECT_EQ("project.cn-hangzhou.log.aliyuncs.com", request->mHeader[sdk::HOST]);
+    EXPECT_EQ("100", request->mHeader[sdk::X_LOG_BODYRAWSIZE]);
+    EXPECT_EQ(sdk::CalcMD5(body), request->mHeader[sdk::CONTENT_MD5]);
+    EXPECT_EQ(std::to_string(body.size()), request->mHeader[sdk::CONTENT_LENGTH]);
+    CheckPostLogStoreLogsRequest("id", "key", *request);
+
+    // the template is reused with different bodies
+    request = client.CreatePostLogStoreLogsRequest(
+        "project", "logstore", sls_logs::SLS_CMP_LZ4, "another body", 200, nullptr, "key/1", 3);
+    EXPECT_EQ("/logstores/logstore/shards/route", request->mUrl);
+    EXPECT_EQ("200", request->mHeader[sdk::X_LOG_BODYRAWSIZE]);
+    CheckPostLogStoreLogsRequest("id", "key", *request);
+
+    request = client.CreatePostLogStoreLogPackageListRequest(
+        "project", "logstore", sls_logs::SLS_CMP_ZSTD, body, nullptr);
+    EXPECT_EQ(sdk::LOG_MODE_BATCH_GROUP, request->mHeader[sdk::X_LOG_MODE]);
+    CheckPostLogStoreLogsRequest("id", "key", *request);
+
+    // templates are rebuilt once settings change
+    client.SetAccessKeyId("id2");
+    client.SetAccessKey("key2");
+    client.SetSecurityToken("token");
+    request = client.CreatePostLogStoreLogsRequest("project", "logstore", sls_logs::SLS_CMP_LZ4, body, 100, nullptr);
+    EXPECT_EQ("token", request->mHeader[sdk::X_ACS_SECURITY_TOKEN]);
+    CheckPostLogStoreLogsRequest("id2", "key2", *request);
+}
+
 /*
 TEST_F(SDKClientUnittest, PostLogstoreLogsSuccessOpenSource) {
     std::string uid = "";
@@ -0,0 +1,256 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/Flags.h"
+#include "common/http/Curl.h"
+#include "runner/sink/http/HttpSink.h"
+#include "unittest/Unittest.h"
+
+DECLARE_FLAG_INT32(http_sink_max_idle_handlers);
+
+using namespace std;
+
+namespace logtail {
+
+// Minimal http/1.1 server on localhost, which records the raw requests it receives and keeps connections alive.
+class MockHttpServer {
+public:
+    MockHttpServer() {
+        mListenFd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(mListenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(mListenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        mPort = ntohs(addr.sin_port);
+        listen(mListenFd, 8);
+        mThread = thread(&MockHttpServer::Serve, this);
+    }
+
+    ~MockHttpServer() {
+        mStopped = true;
+        shutdown(mListenFd, SHUT_RDWR);
+        int connFd = mConnFd.load();
+        if (connFd >= 0) {
+            shutdown(connFd, SHUT_RDWR);
+        }
+        mThread.join();
+        close(mListenFd);
+    }
+
+    int32_t GetPort() const { return mPort; }
+
+    vector<string> GetRequests() {
+        lock_guard<mutex> lock(mMux);
+        return mRequests;
+    }
+
+private:
+    void Serve() {
+        while (!mStopped) {
+            int connFd = accept(mListenFd, nullptr, nullptr);
+            if (connFd < 0) {
+                return;
+            }
+            mConnFd = connFd;
+            string buffer;
+            char data[4096];
+            while (true) {
+                size_t headerEnd = buffer.find("\r\n\r\n");
+                if (headerEnd != string::npos) {
+                    size_t bodySize = 0;
+                    size_t pos = buffer.find("Content-Length:");
+                    if (pos != string::npos && pos < headerEnd) {
+                        bodySize = stoul(buffer.substr(pos + 15));
+                    }
+                    size_t requestSize = headerEnd + 4 + bodySize;
+                    if (buffer.size() >= requestSize) {
+                        {
+                            lock_guard<mutex> lock(mMux);
+                            mRequests.push_back(buffer.substr(0, requestSize));
+                        }
+                        buffer.erase(0, requestSize);
+                        const string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+                        write(connFd, response.data(), response.size());
+                        continue;
+                    }
+                }
+                ssize_t n = read(connFd, data, sizeof(data));
+                if (n <= 0) {
+                    break;
+                }
+                buffer.append(data, n);
+            }
+            mConnFd = -1;
+            close(connFd);
+        }
+    }
+
+    int mListenFd = -1;
+    atomic_int mConnFd{-1};
+    int32_t mPort = 0;
+    atomic_bool mStopped{false};
+    thread mThread;
+    mutex mMux;
+    vector<string> mRequests;
+};
+
+class HttpSinkUnittest : public ::testing::Test {
+public:
+    void TestReuseHandler();
+    void TestMaxIdleHandlers();
+    void TestResetHandlerOptions();
+    void TestInitAndStop();
+
+protected:
+    void TearDown() override {
+        for (auto handler : mSink.mIdleHandlers) {
+            curl_easy_cleanup(handler);
+        }
+        mSink.mIdleHandlers.clear();
+    }
+
+private:
+    HttpSink mSink{0};
+};
+
+void HttpSinkUnittest::TestReuseHandler() {
+    CURL* handler = mSink.AcquireHandler();
+    APSARA_TEST_NOT_EQUAL(nullptr, handler);
+    mSink.ReleaseHandler(handler);
+    APSARA_TEST_EQUAL(1U, mSink.mIdleHandlers.size());
+
+    // the released handler is used by the next request
+    APSARA_TEST_EQUAL(handler, mSink.AcquireHandler());
+    APSARA_TEST_TRUE(mSink.mIdleHandlers.empty());
+    CURL* another = mSink.AcquireHandler();
+    APSARA_TEST_NOT_EQUAL(handler, another);
+    mSink.ReleaseHandler(handler);
+    mSink.ReleaseHandler(another);
+    APSARA_TEST_EQUAL(2U, mSink.mIdleHandlers.size());
+}
+
+void HttpSinkUnittest::TestMaxIdleHandlers() {
+    int32_t maxIdleHandlers = INT32_FLAG(http_sink_max_idle_handlers);
+    INT32_FLAG(http_sink_max_idle_handlers) = 2;
+    vector<CURL*> handlers;
+    for (int i = 0; i < 5; ++i) {
+        handlers.push_back(mSink.AcquireHandler());
+    }
+    for (auto handler : handlers) {
+        mSink.ReleaseHandler(handler);
+    }
+    // handlers beyond the cap are cleaned up on release
+    APSARA_TEST_EQUAL(2U, mSink.mIdleHandlers.size());
+    APSARA_TEST_EQUAL(handlers[0], mSink.mIdleHandlers[0]);
+    APSARA_TEST_EQUAL(handlers[1], mSink.mIdleHandlers[1]);
+    INT32_FLAG(http_sink_max_idle_handlers) = maxIdleHandlers;
+}
+
+void HttpSinkUnittest::TestResetHandlerOptions() {
+    MockHttpServer server;
+
+    // body is not copied by curl, so it must outlive the request
+    string body = "first_body";
+    CURL* handler = mSink.AcquireHandler();
+    HttpResponse response1;
+    curl_slist* headers1 = nullptr;
+    SetCurlHandler(handler,
+                   "POST",
+                   false,
+                   "127.0.0.1",
+                   server.GetPort(),
+                   "/first",
+                   "",
+                   {{"x-first-header", "first"}},
+                   body,
+                   response1,
+                   headers1,
+                   5,
+                   false);
+    APSARA_TEST_EQUAL(CURLE_OK, curl_easy_perform(handler));
+    curl_slist_free_all(headers1);
+    APSARA_TEST_EQUAL("ok", response1.mBody);
+    mSink.ReleaseHandler(handler);
+
+    // the same handler is reused with neither the headers nor the body of the former request
+    CURL* reused = mSink.AcquireHandler();
+    APSARA_TEST_EQUAL(handler, reused);
+    HttpResponse response2;
+    curl_slist* headers2 = nullptr;
+    SetCurlHandler(reused,
+                   "GET",
+                   false,
+                   "127.0.0.1",
+                   server.GetPort(),
+                   "/second",
+                   "",
+                   {},
+                   "",
+                   response2,
+                   headers2,
+                   5,
+                   false);
+    APSARA_TEST_EQUAL(CURLE_OK, curl_easy_perform(reused));
+    APSARA_TEST_EQUAL(nullptr, headers2);
+    APSARA_TEST_EQUAL("ok", response2.mBody);
+    // and the connection is kept across the reset
+    long newConnections = -1;
+    curl_easy_getinfo(reused, CURLINFO_NUM_CONNECTS, &newConnections);
+    APSARA_TEST_EQUAL(0, newConnections);
+    mSink.ReleaseHandler(reused);
+
+    vector<string> requests = server.GetRequests();
+    APSARA_TEST_EQUAL_FATAL(2U, requests.size());
+    APSARA_TEST_EQUAL(0U, requests[0].find("POST /first "));
+    APSARA_TEST_NOT_EQUAL(string::npos, requests[0].find("x-first-header:first"));
+    APSARA_TEST_NOT_EQUAL(string::npos, requests[0].find("first_body"));
+    APSARA_TEST_EQUAL(0U, requests[1].find("GET /second "));
+    APSARA_TEST_EQUAL(string::npos, requests[1].find("x-first-header"));
+    APSARA_TEST_EQUAL(string::npos, requests[1].find("first_body"));
+    APSARA_TEST_EQUAL(string::npos, requests[1].find("Content-Length"));
+}
+
+void HttpSinkUnittest::TestInitAndStop() {
+    HttpSink sink(0);
+    APSARA_TEST_TRUE(sink.Init());
+    // tls sessions and dns entries are shared by all handlers of the sink
+    APSARA_TEST_NOT_EQUAL(nullptr, sink.mShare);
+    sink.Stop();
+    APSARA_TEST_EQUAL(nullptr, sink.mClient);
+    APSARA_TEST_EQUAL(nullptr, sink.mShare);
+    APSARA_TEST_TRUE(sink.mIdleHandlers.empty());
+}
+
+UNIT_TEST_CASE(HttpSinkUnittest, TestReuseHandler)
+UNIT_TEST_CASE(HttpSinkUnittest, TestMaxIdleHandlers)
+UNIT_TEST_CASE(HttpSinkUnittest, TestResetHandlerOptions)
+UNIT_TEST_CASE(HttpSinkUnittest, TestInitAndStop)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -0,0 +1,67 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "common/Flags.h"
+#include "runner/LogProcess.h"
+#include "unittest/Unittest.h"
+
+DECLARE_FLAG_INT32(process_round_wait_timeout_ms);
+
+using namespace std;
+
+namespace logtail {
+
+class LogProcessUnittest : public ::testing::Test {
+public:
+    void TestWaitForRoundBeyondTimeout();
+};
+
+void LogProcessUnittest::TestWaitForRoundBeyondTimeout() {
+    int32_t timeoutBak = INT32_FLAG(process_round_wait_timeout_ms);
+    INT32_FLAG(process_round_wait_timeout_ms) = 100;
+    LogProcess* process = LogProcess::GetInstance();
+    // a single processing thread, whose round is simulated by its round counter
+    process->mThreadCount = 1;
+    process->mThreadRounds = new atomic_uint64_t[1];
+    process->mThreadRounds[0] = 0;
+    process->mInitialized = true;
+
+    // the round outlives several timeouts, and the pipeline must not be stopped before it ends
+    atomic_bool roundFinished = false;
+    thread processThread([&]() {
+        this_thread::sleep_for(chrono::milliseconds(500));
+        roundFinished = true;
+        ++process->mThreadRounds[0];
+    });
+    auto start = chrono::steady_clock::now();
+    process->WaitForCurrentRounds();
+    APSARA_TEST_TRUE(roundFinished);
+    APSARA_TEST_TRUE(chrono::steady_clock::now() - start >= chrono::milliseconds(500));
+    processThread.join();
+
+    process->mInitialized = false;
+    delete[] process->mThreadRounds;
+    process->mThreadRounds = nullptr;
+    INT32_FLAG(process_round_wait_timeout_ms) = timeoutBak;
+}
+
+UNIT_TEST_CASE(LogProcessUnittest, TestWaitForRoundBeyondTimeout)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN